@@ -0,0 +1,1861 @@
+// Host-native compute unit benchmark of the Shinobi Immortals program.
+//
+// The program is compiled for the host, unmodified, together with a replacement solana_sdk.h (solana_sdk.h in this
+// directory) and a set of syscall shims (bench_shim.c) that charge compute units according to the runtime's cost
+// model.  The programs that it invokes are emulated (bench_programs.c).  A scenario that exercises every instruction
+// is then executed against an in-memory account database, and the syscall, program address derivation and
+// cross-program invocation costs of each instruction are reported.
+//
+// The cost of the program's own BPF instructions is not modelled; the harness measures the costs that dominate this
+// program (program address derivations, sha256, and cross-program invocations), which are also the costs that
+// changes to the program's design most directly affect.
+//
+// Usage: shinobi_bench [-c] [name=value ...]
+//   -c          Print the cost model and exit
+//   name=value  Override a cost model value
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_constants.h"
+
+// The program defines its own memcpy, which on the host must not replace the C library's
+#define memcpy shinobi_program_memcpy
+#include "entrypoint.c"
+#undef memcpy
+
+#include "bench_programs.c"
+
+
+// Maximum data size of any account in the harness
+#define BENCH_MAX_DATA_LEN (10 * 1024)
+
+// Maximum number of accounts in the harness
+#define BENCH_MAX_ACCOUNTS 256
+
+// Maximum number of accounts in a single transaction
+#define BENCH_MAX_TRANSACTION_ACCOUNTS 64
+
+// Maximum size of a serialized transaction, which must fit in a single network packet
+#define BENCH_MAX_TRANSACTION_SIZE 1232
+
+// Maximum number of entries revealed by a single RevealEntries transaction.  Each entry costs two accounts and the
+// proof of its level 0 metadata, about 360 bytes in all, so only two fit in a transaction along with a range proof.
+#define BENCH_MAX_REVEAL_ENTRIES 2
+
+// Size of the buffer into which program input is serialized
+#define BENCH_INPUT_BUFFER_SIZE (2 * 1024 * 1024)
+
+// Space reserved after each account's data in the serialized input
+#define BENCH_MAX_PERMITTED_DATA_INCREASE (10 * 1024)
+
+
+typedef struct
+{
+    SolPubkey key;
+
+    SolPubkey owner;
+
+    uint64_t lamports;
+
+    uint64_t data_len;
+
+    uint8_t data[BENCH_MAX_DATA_LEN];
+
+    bool executable;
+
+} BenchAccount;
+
+
+// An account as passed to a transaction
+typedef struct
+{
+    const SolPubkey *key;
+
+    bool is_writable;
+
+    bool is_signer;
+
+} BenchMeta;
+
+#define RO(k)  { &(k), false, false }
+#define RW(k)  { &(k), true,  false }
+#define ROS(k) { &(k), false, true  }
+#define RWS(k) { &(k), true,  true  }
+
+
+static BenchAccount bench_accounts[BENCH_MAX_ACCOUNTS];
+
+static int bench_accounts_count;
+
+static uint8_t bench_input[BENCH_INPUT_BUFFER_SIZE] __attribute__((aligned(16)));
+
+// Totals over all executed instructions
+static BenchStats bench_totals;
+
+static uint64_t bench_transaction_count;
+
+
+// Account database ----------------------------------------------------------------------------------------------------
+
+static BenchAccount *get_account(const SolPubkey *key)
+{
+    for (int i = 0; i < bench_accounts_count; i++) {
+        if (SolPubkey_same(&(bench_accounts[i].key), key)) {
+            return &(bench_accounts[i]);
+        }
+    }
+
+    if (bench_accounts_count == BENCH_MAX_ACCOUNTS) {
+        fprintf(stderr, "Too many accounts\n");
+        exit(1);
+    }
+
+    // Accounts that do not exist yet are empty system accounts
+    BenchAccount *account = &(bench_accounts[bench_accounts_count++]);
+
+    memset(account, 0, sizeof(*account));
+
+    account->key = *key;
+
+    return account;
+}
+
+
+static SolPubkey make_key(const char *name)
+{
+    SolBytes bytes = { (const uint8_t *) name, strlen(name) };
+
+    SolPubkey key;
+
+    bench_sha256(&bytes, 1, key.x);
+
+    return key;
+}
+
+
+static void fund(const SolPubkey *key, uint64_t lamports)
+{
+    get_account(key)->lamports += lamports;
+}
+
+
+static void make_executable(const SolPubkey *key)
+{
+    BenchAccount *account = get_account(key);
+
+    account->executable = true;
+    account->lamports = 1;
+}
+
+
+// Transactions --------------------------------------------------------------------------------------------------------
+
+static uint8_t *append(uint8_t *d, const void *src, uint64_t len)
+{
+    memcpy(d, src, len);
+
+    return &(d[len]);
+}
+
+
+static void print_stats_header()
+{
+    printf("%-36s %5s %8s %8s %5s %5s %5s %8s %8s %8s %8s\n", "Instruction", "Accts", "InBytes", "SysCU", "PDAs",
+           "SHA", "CPIs", "CpiCU", "CpiBytes", "Program", "Callees");
+}
+
+
+static void print_stats(const char *label, uint64_t accounts, uint64_t input_bytes, const BenchStats *stats)
+{
+    printf("%-36s %5lu %8lu %8lu %5lu %5lu %5lu %8lu %8lu %8lu %8lu\n", label, (unsigned long) accounts,
+           (unsigned long) input_bytes, (unsigned long) stats->syscall_units, (unsigned long) stats->pda_count,
+           (unsigned long) stats->sha256_count, (unsigned long) stats->cpi_count, (unsigned long) stats->cpi_units,
+           (unsigned long) stats->cpi_bytes, (unsigned long) (stats->syscall_units + stats->cpi_units),
+           (unsigned long) stats->callee_units);
+}
+
+
+// Returns the number of bytes needed to encode [value] as a compact-u16
+static uint64_t compact_u16_size(uint64_t value)
+{
+    return (value < 0x80) ? 1 : ((value < 0x4000) ? 2 : 3);
+}
+
+
+// Ends the benchmark if a transaction holding just the one instruction would not fit in a network packet.  This is
+// checked by the instructions whose batch sizes are chosen to fit.
+static void check_transaction_size(const char *label, const BenchMeta *metas, int metas_len, uint64_t data_len)
+{
+    // The program is an account of the transaction too
+    uint64_t keys = 1, signers = 0;
+
+    for (int i = 0; i < metas_len; i++) {
+        bool is_first = true, is_signer = metas[i].is_signer;
+        for (int j = 0; j < metas_len; j++) {
+            if (SolPubkey_same(metas[i].key, metas[j].key)) {
+                is_first &= (j >= i);
+                is_signer |= metas[j].is_signer;
+            }
+        }
+        if (is_first) {
+            keys += 1;
+            signers += is_signer;
+        }
+    }
+
+    uint64_t size = (compact_u16_size(signers) + (signers * 64) +
+                     // Message header, account keys, and recent blockhash
+                     3 + compact_u16_size(keys) + (keys * sizeof(SolPubkey)) + sizeof(SolPubkey) +
+                     // The instruction
+                     compact_u16_size(1) + 1 + compact_u16_size(metas_len) + metas_len +
+                     compact_u16_size(data_len) + data_len);
+
+    if (size > BENCH_MAX_TRANSACTION_SIZE) {
+        fprintf(stderr, "%s: transaction of %lu bytes does not fit in a packet\n", label, (unsigned long) size);
+        exit(1);
+    }
+}
+
+
+// Executes one instruction of the program as a transaction: serializes the accounts and instruction data as the
+// runtime's loader does, runs the program entrypoint, verifies the result, and writes the modified accounts back
+// into the account database.  Any failure ends the benchmark.
+static void execute(const char *label, const BenchMeta *metas, int metas_len, const void *data, uint64_t data_len)
+{
+    if (metas_len > BENCH_MAX_TRANSACTION_ACCOUNTS) {
+        fprintf(stderr, "%s: too many accounts\n", label);
+        exit(1);
+    }
+
+    // The index of the first occurrence of each account, and its combined permissions
+    int first[BENCH_MAX_TRANSACTION_ACCOUNTS];
+    bool is_writable[BENCH_MAX_TRANSACTION_ACCOUNTS];
+    bool is_signer[BENCH_MAX_TRANSACTION_ACCOUNTS];
+    uint8_t *serialized[BENCH_MAX_TRANSACTION_ACCOUNTS];
+
+    for (int i = 0; i < metas_len; i++) {
+        first[i] = i;
+        for (int j = 0; j < i; j++) {
+            if (SolPubkey_same(metas[i].key, metas[j].key)) {
+                first[i] = j;
+                break;
+            }
+        }
+        is_writable[i] = metas[i].is_writable;
+        is_signer[i] = metas[i].is_signer;
+        is_writable[first[i]] |= metas[i].is_writable;
+        is_signer[first[i]] |= metas[i].is_signer;
+    }
+
+    uint64_t lamports_before = 0;
+
+    uint8_t *d = bench_input;
+
+    uint64_t count = metas_len;
+    d = append(d, &count, sizeof(count));
+
+    for (int i = 0; i < metas_len; i++) {
+        if (first[i] != i) {
+            uint8_t dup[8] = { (uint8_t) first[i] };
+            d = append(d, dup, sizeof(dup));
+            continue;
+        }
+        BenchAccount *account = get_account(metas[i].key);
+        lamports_before += account->lamports;
+        uint8_t flags[8] = { 0xFF, is_signer[i], is_writable[i], account->executable };
+        d = append(d, flags, sizeof(flags));
+        serialized[i] = d;
+        d = append(d, &(account->key), sizeof(account->key));
+        d = append(d, &(account->owner), sizeof(account->owner));
+        d = append(d, &(account->lamports), sizeof(account->lamports));
+        d = append(d, &(account->data_len), sizeof(account->data_len));
+        d = append(d, account->data, account->data_len);
+        memset(d, 0, BENCH_MAX_PERMITTED_DATA_INCREASE);
+        d += BENCH_MAX_PERMITTED_DATA_INCREASE;
+        while (((uint64_t) (d - bench_input)) % 8) {
+            *d++ = 0;
+        }
+        uint64_t rent_epoch = 0;
+        d = append(d, &rent_epoch, sizeof(rent_epoch));
+    }
+
+    d = append(d, &data_len, sizeof(data_len));
+    d = append(d, data, data_len);
+    d = append(d, &(Constants.self_program_pubkey), sizeof(SolPubkey));
+
+    uint64_t input_bytes = d - bench_input;
+
+    memset(&bench_stats, 0, sizeof(bench_stats));
+
+    bench_program_id = Constants.self_program_pubkey;
+
+    memset(bench_heap, 0, HEAP_LENGTH);
+
+    uint64_t ret = entrypoint(bench_input);
+
+    if (ret) {
+        fprintf(stderr, "%s: failed with error %lu\n", label, (unsigned long) ret);
+        exit(1);
+    }
+
+    // Verify the results, then write back
+    uint64_t lamports_after = 0;
+
+    for (int i = 0; i < metas_len; i++) {
+        if (first[i] != i) {
+            continue;
+        }
+        BenchAccount *account = get_account(metas[i].key);
+        uint8_t *s = serialized[i] + sizeof(SolPubkey);
+        SolPubkey *owner = (SolPubkey *) s;
+        uint64_t *lamports = (uint64_t *) (s + sizeof(SolPubkey));
+        uint64_t *new_data_len = (uint64_t *) (s + sizeof(SolPubkey) + sizeof(uint64_t));
+        uint8_t *new_data = s + sizeof(SolPubkey) + sizeof(uint64_t) + sizeof(uint64_t);
+        lamports_after += *lamports;
+        if (*new_data_len > BENCH_MAX_DATA_LEN) {
+            fprintf(stderr, "%s: account data too large\n", label);
+            exit(1);
+        }
+        bool changed = ((*lamports != account->lamports) || !SolPubkey_same(owner, &(account->owner)) ||
+                        (*new_data_len != account->data_len) || memcmp(new_data, account->data, *new_data_len));
+        if (changed && !is_writable[i]) {
+            fprintf(stderr, "%s: read-only account %d was modified\n", label, i);
+            exit(1);
+        }
+        account->owner = *owner;
+        account->lamports = *lamports;
+        account->data_len = *new_data_len;
+        memcpy(account->data, new_data, *new_data_len);
+        // Accounts left with no lamports are removed at the end of the transaction
+        if (account->lamports == 0) {
+            SolPubkey key = account->key;
+            memset(account, 0, sizeof(*account));
+            account->key = key;
+        }
+    }
+
+    if (lamports_before != lamports_after) {
+        fprintf(stderr, "%s: lamports not conserved\n", label);
+        exit(1);
+    }
+
+    print_stats(label, metas_len, input_bytes, &bench_stats);
+
+    bench_totals.syscall_units += bench_stats.syscall_units;
+    bench_totals.pda_count += bench_stats.pda_count;
+    bench_totals.sha256_count += bench_stats.sha256_count;
+    bench_totals.cpi_count += bench_stats.cpi_count;
+    bench_totals.cpi_units += bench_stats.cpi_units;
+    bench_totals.cpi_bytes += bench_stats.cpi_bytes;
+    bench_totals.callee_units += bench_stats.callee_units;
+    bench_transaction_count += 1;
+}
+
+
+// Addresses -----------------------------------------------------------------------------------------------------------
+
+// Finds a program derived address of this program from a prefix byte and up to two additional seeds
+static uint8_t find_pda(SolPubkey *address, uint8_t prefix, const void *seed_1, uint64_t seed_1_len,
+                        const void *seed_2, uint64_t seed_2_len)
+{
+    SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
+                              { (const uint8_t *) seed_1, seed_1_len },
+                              { (const uint8_t *) seed_2, seed_2_len } };
+
+    return bench_find_program_address(seeds, seed_2 ? 3 : 2, &(Constants.self_program_pubkey), address);
+}
+
+
+static SolPubkey find_ata(const SolPubkey *owner, const SolPubkey *mint)
+{
+    SolSignerSeed seeds[] = { { owner->x, sizeof(SolPubkey) },
+                              { Constants.spl_token_program_pubkey.x, sizeof(SolPubkey) },
+                              { mint->x, sizeof(SolPubkey) } };
+
+    SolPubkey address;
+
+    bench_find_program_address(seeds, ARRAY_LEN(seeds), &(Constants.spl_associated_token_account_program_pubkey),
+                               &address);
+
+    return address;
+}
+
+
+static SolPubkey find_metaplex_metadata(const SolPubkey *mint)
+{
+    SolSignerSeed seeds[] = { { (const uint8_t *) "metadata", 8 },
+                              { Constants.metaplex_program_pubkey.x, sizeof(SolPubkey) },
+                              { mint->x, sizeof(SolPubkey) } };
+
+    SolPubkey address;
+
+    bench_find_program_address(seeds, ARRAY_LEN(seeds), &(Constants.metaplex_program_pubkey), &address);
+
+    return address;
+}
+
+
+// Scenario ------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    SolPubkey address;
+
+    uint8_t bump_seed;
+
+    SolPubkey whitelist;
+
+    uint8_t whitelist_bump_seed;
+
+    SolPubkey whitelist_shards[WHITELIST_SHARD_COUNT];
+
+    uint8_t whitelist_shard_bump_seeds[WHITELIST_SHARD_COUNT];
+
+    // Bit N is set once whitelist shard N has had entries added to it
+    uint16_t whitelist_shard_mask;
+
+    BlockConfiguration config;
+
+    // The single URI prefix of the block, shared by every level of every entry
+    char uri_prefix[MAX_URI_PREFIX_LENGTH + 1];
+
+} BenchBlock;
+
+
+typedef struct
+{
+    uint16_t index;
+
+    SolPubkey mint, token, entry, metadata, bridge;
+
+    uint8_t mint_bump_seed, token_bump_seed, entry_bump_seed, bridge_bump_seed;
+
+    EntryMetadata values;
+
+    // The metadata of each level, which values commits to with its level_metadata_merkle_root
+    LevelMetadata levels[9];
+
+    salt_t salt;
+
+} BenchEntry;
+
+
+// The leaf of a buyer in a Merkle whitelist, with the proof that it is in the whitelist's Merkle tree
+typedef struct
+{
+    uint16_t first_slot;
+
+    uint8_t allowance;
+
+    uint8_t proof_length;
+
+    sha256_t proof[MAX_WHITELIST_PROOF_LENGTH];
+
+} BenchWhitelistLeaf;
+
+
+static SolPubkey admin, buyer_1, buyer_2, bidder_1, bidder_2, new_authority, stake_1, stake_b, split_into;
+
+// Data buffer for instructions, aligned so that instruction data structures may be built in place
+static uint8_t data_buffer[8 * 1024] __attribute__((aligned(16)));
+
+
+static void make_block(BenchBlock *block, uint32_t group_number, uint32_t block_number)
+{
+    memset(block, 0, sizeof(*block));
+
+    block->bump_seed = find_pda(&(block->address), PDA_Account_Seed_Prefix_Block, &group_number,
+                                sizeof(group_number), &block_number, sizeof(block_number));
+
+    block->whitelist_bump_seed = find_pda(&(block->whitelist), PDA_Account_Seed_Prefix_Whitelist,
+                                          &(block->address), sizeof(SolPubkey), 0, 0);
+
+    for (uint8_t i = 0; i < WHITELIST_SHARD_COUNT; i++) {
+        block->whitelist_shard_bump_seeds[i] = find_pda(&(block->whitelist_shards[i]),
+                                                        PDA_Account_Seed_Prefix_Whitelist_Shard, &(block->address),
+                                                        sizeof(SolPubkey), &i, sizeof(i));
+    }
+
+    block->config.group_number = group_number;
+    block->config.block_number = block_number;
+
+    snprintf(block->uri_prefix, sizeof(block->uri_prefix), "https://www.shinobi-systems.com/immortals/%u/%u/",
+             group_number, block_number);
+}
+
+
+// Forward declaration
+static uint64_t compute_level_metadata_proof(const BenchEntry *entry, uint8_t level, sha256_t *root,
+                                             LevelMetadataProof *proof);
+
+
+static void make_entry(BenchEntry *entry, const BenchBlock *block, uint16_t index)
+{
+    memset(entry, 0, sizeof(*entry));
+
+    entry->index = index;
+
+    entry->mint_bump_seed = find_pda(&(entry->mint), PDA_Account_Seed_Prefix_Mint, &(block->address),
+                                     sizeof(SolPubkey), &index, sizeof(index));
+    entry->token_bump_seed = find_pda(&(entry->token), PDA_Account_Seed_Prefix_Token, &(entry->mint),
+                                      sizeof(SolPubkey), 0, 0);
+    entry->entry_bump_seed = find_pda(&(entry->entry), PDA_Account_Seed_Prefix_Entry, &(entry->mint),
+                                      sizeof(SolPubkey), 0, 0);
+    entry->bridge_bump_seed = find_pda(&(entry->bridge), PDA_Account_Seed_Prefix_Bridge, &(entry->mint),
+                                       sizeof(SolPubkey), 0, 0);
+    entry->metadata = find_metaplex_metadata(&(entry->mint));
+
+    // Metadata values are arbitrary but fully populated so that every byte is written and hashed
+    entry->values.level_1_ki = 10;
+    for (int i = 0; i < 16; i++) {
+        entry->values.random[i] = (index * 16) + i;
+    }
+    for (int level = 0; level < 9; level++) {
+        LevelMetadata *l = &(entry->levels[level]);
+        l->form = level;
+        l->skill = 0x55;
+        l->ki_factor = 1000 * (level + 1);
+        snprintf((char *) l->name, sizeof(l->name), "Shinobi %u-%u L%d", block->config.group_number, index, level);
+        l->uri_prefix_index = 0;
+        snprintf((char *) l->uri_suffix, sizeof(l->uri_suffix), "%u/%d.json", index, level);
+        char uri[MAX_URI_PREFIX_LENGTH + URI_SUFFIX_LENGTH + 1];
+        snprintf(uri, sizeof(uri), "%s%s", block->uri_prefix, (char *) l->uri_suffix);
+        SolBytes bytes = { (uint8_t *) uri, strlen(uri) };
+        bench_sha256(&bytes, 1, l->uri_contents_sha256.x);
+    }
+    compute_level_metadata_proof(entry, 0, &(entry->values.level_metadata_merkle_root), 0);
+
+    entry->salt = 0x5A17000000000000ul + index;
+}
+
+
+static void compute_reveal_sha256(const BenchEntry *entry, sha256_t *result)
+{
+    uint8_t buffer[sizeof(sha256_t) + sizeof(salt_t)];
+
+    SolBytes bytes = { (const uint8_t *) &(entry->values), sizeof(entry->values) };
+
+    bench_sha256(&bytes, 1, buffer);
+
+    memcpy(&(buffer[sizeof(sha256_t)]), &(entry->salt), sizeof(salt_t));
+
+    bytes.addr = buffer;
+    bytes.len = sizeof(buffer);
+
+    bench_sha256(&bytes, 1, result->x);
+}
+
+
+// Computes the hash of a Merkle whitelist leaf, as whitelist_merkle_check() does
+static void compute_whitelist_leaf_hash(const SolPubkey *wallet, uint16_t first_slot, uint8_t allowance,
+                                        sha256_t *result)
+{
+    uint8_t prefix = MERKLE_LEAF_PREFIX;
+
+    SolBytes bytes[] = { { &prefix, sizeof(prefix) }, { wallet->x, sizeof(*wallet) },
+                         { (const uint8_t *) &first_slot, sizeof(first_slot) }, { &allowance, sizeof(allowance) } };
+
+    bench_sha256(bytes, ARRAY_LEN(bytes), result->x);
+}
+
+
+// Computes the hash of a reveal Merkle leaf, as reveal_single_entry() does
+static void compute_reveal_leaf_hash(const BenchEntry *entry, sha256_t *result)
+{
+    uint8_t prefix = MERKLE_LEAF_PREFIX;
+
+    uint8_t buffer[sizeof(sha256_t) + sizeof(salt_t)];
+
+    SolBytes bytes = { (const uint8_t *) &(entry->values), sizeof(entry->values) };
+
+    bench_sha256(&bytes, 1, buffer);
+
+    memcpy(&(buffer[sizeof(sha256_t)]), &(entry->salt), sizeof(salt_t));
+
+    SolBytes leaf[] = { { &prefix, sizeof(prefix) }, { (const uint8_t *) &(entry->index), sizeof(entry->index) },
+                        { buffer, sizeof(buffer) } };
+
+    bench_sha256(leaf, ARRAY_LEN(leaf), result->x);
+}
+
+
+// Replaces [hashes] with the root of the Merkle tree whose leaves are [hashes], and returns in [proof] the proof of
+// the [range_count] leaves starting at [first], in the order that compute_merkle_range_root() consumes it
+static void compute_merkle_root(sha256_t *hashes, uint32_t count, uint32_t first, uint32_t range_count,
+                                sha256_t *proof, uint8_t *proof_length)
+{
+    uint8_t prefix = MERKLE_NODE_PREFIX;
+
+    uint32_t last = first + range_count - 1;
+
+    *proof_length = 0;
+
+    while (count > 1) {
+        // The siblings of the ends of the range are part of the proof, if they are outside of the range
+        if (first & 1) {
+            proof[(*proof_length)++] = hashes[first - 1];
+        }
+        if (!(last & 1) && ((last + 1) < count)) {
+            proof[(*proof_length)++] = hashes[last + 1];
+        }
+
+        // Hash each pair of nodes into the next level up, carrying a node without a sibling up unchanged
+        for (uint32_t i = 0; i < count; i += 2) {
+            if ((i + 1) == count) {
+                hashes[i / 2] = hashes[i];
+                continue;
+            }
+            bool is_less = (memcmp(&(hashes[i]), &(hashes[i + 1]), sizeof(sha256_t)) < 0);
+            SolBytes bytes[] = { { &prefix, sizeof(prefix) },
+                                 { is_less ? hashes[i].x : hashes[i + 1].x, sizeof(sha256_t) },
+                                 { is_less ? hashes[i + 1].x : hashes[i].x, sizeof(sha256_t) } };
+            bench_sha256(bytes, ARRAY_LEN(bytes), hashes[i / 2].x);
+        }
+
+        count = (count + 1) / 2;
+        first /= 2;
+        last /= 2;
+    }
+}
+
+
+// Computes the root of the level metadata Merkle tree of [entry] into [root], and if [proof] is non-null, writes the
+// LevelMetadataProof of [level] into it, as get_proven_level_metadata() checks it.  [proof] need not be aligned.
+// Returns the size of the LevelMetadataProof.
+static uint64_t compute_level_metadata_proof(const BenchEntry *entry, uint8_t level, sha256_t *root,
+                                             LevelMetadataProof *proof)
+{
+    uint8_t prefix = MERKLE_LEAF_PREFIX;
+
+    sha256_t hashes[9];
+
+    for (uint8_t i = 0; i < 9; i++) {
+        SolBytes bytes[] = { { &prefix, sizeof(prefix) }, { &i, sizeof(i) },
+                             { (const uint8_t *) &(entry->levels[i]), sizeof(LevelMetadata) } };
+        bench_sha256(bytes, ARRAY_LEN(bytes), hashes[i].x);
+    }
+
+    sha256_t level_proof[MAX_LEVEL_METADATA_PROOF_LENGTH];
+    uint8_t proof_length;
+
+    compute_merkle_root(hashes, 9, level, 1, level_proof, &proof_length);
+
+    *root = hashes[0];
+
+    if (proof) {
+        memcpy(&(proof->level_metadata), &(entry->levels[level]), sizeof(LevelMetadata));
+        memcpy(&(proof->proof_length), &proof_length, sizeof(proof_length));
+        memcpy(proof->proof, level_proof, proof_length * sizeof(sha256_t));
+    }
+
+    return compute_level_metadata_proof_size(proof_length);
+}
+
+
+// Creates an Initialized stake account whose staker and withdrawer are [owner], as a user would before staking
+static void make_stake_account(const SolPubkey *key, const SolPubkey *owner, uint64_t lamports)
+{
+    BenchAccount *account = get_account(key);
+
+    account->owner = Constants.stake_program_pubkey;
+    account->data_len = STAKE_ACCOUNT_DATA_LEN;
+    account->lamports = lamports;
+
+    Stake stake;
+    memset(&stake, 0, sizeof(stake));
+    stake.state = StakeState_Initialized;
+    stake.meta.rent_exempt_reserve = bench_rent_exempt_minimum(STAKE_ACCOUNT_DATA_LEN);
+    stake.meta.authorize.staker = *owner;
+    stake.meta.authorize.withdrawer = *owner;
+
+    SolAccountInfo info = { &(account->key), &(account->lamports), account->data_len, account->data,
+                            &(account->owner), 0, false, true, false };
+    bench_encode_stake(&info, &stake);
+}
+
+
+// Simulates staking rewards being paid into a delegated stake account at an epoch boundary
+static void add_stake_rewards(const SolPubkey *key, uint64_t lamports)
+{
+    BenchAccount *account = get_account(key);
+
+    SolAccountInfo info = { &(account->key), &(account->lamports), account->data_len, account->data,
+                            &(account->owner), 0, false, true, false };
+
+    Stake stake;
+    if (!bench_decode_stake(&info, &stake) || (stake.state != StakeState_Stake)) {
+        fprintf(stderr, "Rewards paid to undelegated stake account\n");
+        exit(1);
+    }
+
+    stake.stake.delegation.stake += lamports;
+    account->lamports += lamports;
+
+    bench_encode_stake(&info, &stake);
+}
+
+
+static void advance_clock(int64_t seconds, uint64_t epochs)
+{
+    bench_clock.unix_timestamp += seconds;
+    bench_clock.slot += (seconds * 1000) / 400;
+    bench_clock.epoch += epochs;
+    bench_clock.leader_schedule_epoch = bench_clock.epoch + 1;
+    if (epochs) {
+        bench_clock.epoch_start_timestamp = bench_clock.unix_timestamp;
+    }
+}
+
+
+static void tx_initialize()
+{
+    BenchMeta metas[] = { RWS(Constants.superuser_pubkey), RW(Constants.config_pubkey),
+                          RW(Constants.authority_pubkey), RW(Constants.master_stake_pubkey),
+                          RO(Constants.shinobi_systems_vote_pubkey), RW(Constants.ki_mint_pubkey),
+                          RW(Constants.ki_metadata_pubkey), RW(Constants.bid_marker_mint_pubkey),
+                          RW(Constants.bid_marker_metadata_pubkey), RO(Constants.clock_sysvar_pubkey),
+                          RO(Constants.rent_sysvar_pubkey), RO(Constants.stake_history_sysvar_pubkey),
+                          RO(Constants.stake_config_pubkey), RO(Constants.system_program_pubkey),
+                          RO(Constants.stake_program_pubkey), RO(Constants.spl_token_program_pubkey),
+                          RO(Constants.metaplex_program_pubkey) };
+
+    InitializeData data = { Instruction_Initialize, Constants.superuser_pubkey };
+
+    execute("Initialize", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_set_admin()
+{
+    BenchMeta metas[] = { ROS(Constants.superuser_pubkey), RW(Constants.config_pubkey) };
+
+    UpdateAdminData data = { Instruction_SetAdmin, admin };
+
+    execute("SetAdmin", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+// Adds the entries to the whitelist of the block, with one AddWhitelistEntries instruction per whitelist shard that
+// the entries belong in
+static void tx_add_whitelist_entries(BenchBlock *block, const SolPubkey *entries, uint16_t count)
+{
+    for (uint8_t shard_index = 0; shard_index < WHITELIST_SHARD_COUNT; shard_index++) {
+        BenchMeta metas[] = { RO(Constants.config_pubkey), ROS(admin), RWS(admin), RO(block->address),
+                              RW(block->whitelist), RW(block->whitelist_shards[shard_index]),
+                              RO(Constants.system_program_pubkey) };
+
+        AddWhitelistEntriesData *data = (AddWhitelistEntriesData *) data_buffer;
+        data->instruction_code = Instruction_AddWhitelistEntries;
+        data->whitelist_shard_index = shard_index;
+        data->whitelist_shard_bump_seed = block->whitelist_shard_bump_seeds[shard_index];
+        data->count = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            if (whitelist_shard_index(&(entries[i])) == shard_index) {
+                data->entries[data->count++] = entries[i];
+            }
+        }
+
+        if (data->count == 0) {
+            continue;
+        }
+
+        block->whitelist_shard_mask |= (1 << shard_index);
+
+        execute("AddWhitelistEntries", metas, ARRAY_LEN(metas), data, add_whitelist_entries_data_size(data->count));
+    }
+}
+
+
+static void tx_create_block(const BenchBlock *block, commission_t commission)
+{
+    BenchMeta metas[] = { RO(Constants.config_pubkey), ROS(admin), RWS(admin), RW(block->address),
+                          RO(Constants.system_program_pubkey) };
+
+    CreateBlockData *data = (CreateBlockData *) data_buffer;
+    memset(data, 0, sizeof(*data));
+    data->instruction_code = Instruction_CreateBlock;
+    data->block_bump_seed = block->bump_seed;
+    data->initial_commission = commission;
+    data->whitelist_bump_seed = block->whitelist_bump_seed;
+    data->config = block->config;
+
+    // The one URI prefix follows as its length and then its characters
+    uint8_t prefix_len = strlen(block->uri_prefix);
+    data->uri_prefixes[0] = prefix_len;
+    memcpy(&(data->uri_prefixes[1]), block->uri_prefix, prefix_len);
+
+    execute("CreateBlock", metas, ARRAY_LEN(metas), data, sizeof(*data) + 1 + prefix_len);
+}
+
+
+static void tx_add_entries_to_block(const BenchBlock *block, BenchEntry *entries, uint16_t count)
+{
+    BenchMeta metas[BENCH_MAX_TRANSACTION_ACCOUNTS] = { RO(Constants.config_pubkey), ROS(admin), RWS(admin),
+                                                        RW(block->address), RO(Constants.authority_pubkey),
+                                                        RO(Constants.system_program_pubkey),
+                                                        RO(Constants.spl_token_program_pubkey),
+                                                        RO(Constants.metaplex_program_pubkey),
+                                                        RO(Constants.rent_sysvar_pubkey) };
+
+    // Blocks with a reveal Merkle root carry no per-entry reveal hashes
+    bool has_reveal_merkle_root = !is_all_zeroes(&(block->config.reveal_merkle_root), sizeof(sha256_t));
+
+    uint64_t data_size = compute_add_entries_data_size(count, has_reveal_merkle_root);
+
+    AddEntriesToBlockData *data = (AddEntriesToBlockData *) data_buffer;
+    memset(data, 0, data_size);
+    data->instruction_code = Instruction_AddEntriesToBlock;
+    strcpy((char *) data->metaplex_metadata_uri, "https://www.shinobi-systems.com/immortals/mystery.json");
+    data->first_entry = entries[0].index;
+
+    for (uint16_t i = 0; i < count; i++) {
+        BenchEntry *entry = &(entries[i]);
+        BenchMeta entry_metas[] = { RW(entry->entry), RW(entry->mint), RW(entry->token), RW(entry->metadata) };
+        memcpy(&(metas[9 + (4 * i)]), entry_metas, sizeof(entry_metas));
+        AddEntryBumpSeeds *bump_seeds;
+        if (has_reveal_merkle_root) {
+            bump_seeds = &(data->merkle_entries[i]);
+        }
+        else {
+            compute_reveal_sha256(entry, &(data->entries[i].reveal_sha256));
+            bump_seeds = &(data->entries[i].bump_seeds);
+        }
+        bump_seeds->mint_bump_seed = entry->mint_bump_seed;
+        bump_seeds->token_bump_seed = entry->token_bump_seed;
+        bump_seeds->entry_bump_seed = entry->entry_bump_seed;
+        bump_seeds->bridge_bump_seed = entry->bridge_bump_seed;
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "AddEntriesToBlock (%u entries)", count);
+
+    execute(label, metas, 9 + (4 * count), data, data_size);
+}
+
+
+static void tx_set_metadata_bytes(const BenchBlock *block, const BenchEntry *entry)
+{
+    BenchMeta metas[] = { RO(Constants.config_pubkey), ROS(admin), RO(block->address), RW(entry->entry) };
+
+    // Each transaction can carry about 1,000 bytes of metadata
+    const uint16_t chunk = 1000;
+
+    for (uint16_t start = 0; start < sizeof(EntryMetadata); start += chunk) {
+        uint16_t count = sizeof(EntryMetadata) - start;
+        if (count > chunk) {
+            count = chunk;
+        }
+        SetMetadataBytesData *data = (SetMetadataBytesData *) data_buffer;
+        data->instruction_code = Instruction_SetMetadataBytes;
+        data->start_index = start;
+        data->bytes_count = count;
+        memcpy(data->bytes, &(((uint8_t *) &(entry->values))[start]), count);
+        char label[64];
+        snprintf(label, sizeof(label), "SetMetadataBytes (%u bytes)", count);
+        execute(label, metas, ARRAY_LEN(metas), data, compute_set_metadata_bytes_data_size(count));
+    }
+}
+
+
+// Sets the entire metadata of the entries with SetMetadataBytesMany instructions.  With 100 bytes of metadata and an
+// account per entry, seven entries fit in a single transaction.
+static void tx_set_metadata_bytes_many(const BenchBlock *block, BenchEntry **entries, uint16_t count)
+{
+    const uint8_t max_batch = 7;
+
+    for (uint16_t first = 0; first < count; first += max_batch) {
+        uint8_t batch = ((count - first) < max_batch) ? (count - first) : max_batch;
+
+        SetMetadataBytesManyData *data = (SetMetadataBytesManyData *) data_buffer;
+        data->instruction_code = Instruction_SetMetadataBytesMany;
+
+        BenchMeta metas[BENCH_MAX_TRANSACTION_ACCOUNTS] = { RO(Constants.config_pubkey), ROS(admin),
+                                                            RO(block->address) };
+        for (uint8_t i = 0; i < batch; i++) {
+            BenchMeta entry_meta = RW(entries[first + i]->entry);
+            metas[3 + i] = entry_meta;
+            data->metadata[i] = entries[first + i]->values;
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "SetMetadataBytesMany (%u entries)", batch);
+        check_transaction_size(label, metas, 3 + batch, compute_set_metadata_bytes_many_data_size(batch));
+        execute(label, metas, 3 + batch, data, compute_set_metadata_bytes_many_data_size(batch));
+    }
+}
+
+
+// Reveals the entries, supplying [proof] of their range if the block has a reveal Merkle root
+static void tx_reveal_entries(const BenchBlock *block, BenchEntry **entries, uint16_t count, const sha256_t *proof,
+                              uint8_t proof_length)
+{
+    BenchMeta metas[BENCH_MAX_TRANSACTION_ACCOUNTS] = { RO(Constants.config_pubkey), RWS(admin),
+                                                        RW(block->address), RW(Constants.authority_pubkey),
+                                                        RO(Constants.system_program_pubkey),
+                                                        RO(Constants.metaplex_program_pubkey) };
+
+    RevealEntriesData *data = (RevealEntriesData *) data_buffer;
+    data->instruction_code = Instruction_RevealEntries;
+    data->first_entry = entries[0]->index;
+
+    for (uint16_t i = 0; i < count; i++) {
+        BenchMeta entry_metas[] = { RW(entries[i]->entry), RW(entries[i]->metadata) };
+        memcpy(&(metas[6 + (2 * i)]), entry_metas, sizeof(entry_metas));
+        data->entry_salt[i] = entries[i]->salt;
+    }
+
+    uint64_t data_size = compute_reveal_entries_data_size(count);
+
+    // The level 0 metadata of each entry, with its proof
+    for (uint16_t i = 0; i < count; i++) {
+        sha256_t root;
+        data_size += compute_level_metadata_proof(entries[i], 0, &root,
+                                                  (LevelMetadataProof *) &(data_buffer[data_size]));
+    }
+
+    if (proof) {
+        RevealEntriesProof *reveal_proof = (RevealEntriesProof *) &(data_buffer[data_size]);
+        reveal_proof->proof_length = proof_length;
+        memcpy(reveal_proof->proof, proof, proof_length * sizeof(sha256_t));
+        data_size += compute_reveal_entries_proof_size(proof_length);
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "RevealEntries (%u entries)", count);
+
+    check_transaction_size(label, metas, 6 + (2 * count), data_size);
+
+    execute(label, metas, 6 + (2 * count), data, data_size);
+}
+
+
+// Buys an entry, supplying [leaf] if the block has a Merkle whitelist, in which case the block account stands in for
+// the whitelist account and the optional whitelist shard account is left off
+static void tx_buy_with_leaf(const char *label, const BenchBlock *block, const BenchEntry *entry,
+                             const SolPubkey *buyer, const BenchWhitelistLeaf *leaf)
+{
+    SolPubkey destination = find_ata(buyer, &(entry->mint));
+
+    const SolPubkey *whitelist = leaf ? &(block->address) : &(block->whitelist);
+
+    const SolPubkey *whitelist_shard = &(block->whitelist_shards[whitelist_shard_index(buyer)]);
+
+    BenchMeta metas[] = { RWS(*buyer), RO(Constants.config_pubkey), RW(admin), RW(Constants.authority_pubkey),
+                          RW(block->address), RW(*whitelist), RW(entry->entry), RW(entry->token),
+                          RO(entry->mint), RW(destination), RO(*buyer), RW(entry->metadata),
+                          RO(Constants.self_program_pubkey), RO(Constants.spl_token_program_pubkey),
+                          RO(Constants.spl_associated_token_account_program_pubkey),
+                          RO(Constants.metaplex_program_pubkey), RO(Constants.system_program_pubkey),
+                          RW(*whitelist_shard) };
+
+    BuyData *data = (BuyData *) data_buffer;
+    memset(data, 0, buy_data_size(0));
+    data->instruction_code = Instruction_Buy;
+    data->maximum_price_lamports = 100 * LAMPORTS_PER_SOL;
+    if (leaf) {
+        data->whitelist_first_slot = leaf->first_slot;
+        data->whitelist_allowance = leaf->allowance;
+        data->whitelist_proof_length = leaf->proof_length;
+        memcpy(data->whitelist_proof, leaf->proof, leaf->proof_length * sizeof(sha256_t));
+    }
+
+    execute(label, metas, leaf ? (ARRAY_LEN(metas) - 1) : ARRAY_LEN(metas), data,
+            buy_data_size(data->whitelist_proof_length));
+}
+
+
+static void tx_buy(const char *label, const BenchBlock *block, const BenchEntry *entry, const SolPubkey *buyer)
+{
+    tx_buy_with_leaf(label, block, entry, buyer, 0);
+}
+
+
+// Buys a revealed entry of a block without a Merkle whitelist and stakes it to [stake_account], in one instruction.
+// The optional whitelist shard account is only supplied if the block has whitelist shards.
+static void tx_buy_and_stake(const BenchBlock *block, const BenchEntry *entry, const SolPubkey *buyer,
+                             const SolPubkey *stake_account)
+{
+    SolPubkey destination = find_ata(buyer, &(entry->mint));
+
+    const SolPubkey *whitelist_shard = &(block->whitelist_shards[whitelist_shard_index(buyer)]);
+
+    BenchMeta metas[] = { RWS(*buyer), RO(Constants.config_pubkey), RW(admin), RW(Constants.authority_pubkey),
+                          RW(block->address), RW(block->whitelist), RW(entry->entry), RW(entry->token),
+                          RO(entry->mint), RW(destination), RO(*buyer), RW(entry->metadata),
+                          RO(Constants.self_program_pubkey), RO(Constants.spl_token_program_pubkey),
+                          RO(Constants.spl_associated_token_account_program_pubkey),
+                          RO(Constants.metaplex_program_pubkey), RO(Constants.system_program_pubkey),
+                          RW(*stake_account), ROS(*buyer), RO(Constants.shinobi_systems_vote_pubkey),
+                          RO(Constants.clock_sysvar_pubkey), RO(Constants.stake_program_pubkey),
+                          RO(Constants.stake_config_pubkey), RO(Constants.stake_history_sysvar_pubkey),
+                          RW(*whitelist_shard) };
+
+    BuyData data;
+    memset(&data, 0, sizeof(data));
+    data.instruction_code = Instruction_BuyAndStake;
+    data.maximum_price_lamports = 100 * LAMPORTS_PER_SOL;
+
+    execute("BuyAndStake", metas, block->whitelist_shard_mask ? ARRAY_LEN(metas) : (ARRAY_LEN(metas) - 1), &data,
+            buy_data_size(0));
+}
+
+
+static void tx_refund(const BenchBlock *block, const BenchEntry *entry, const SolPubkey *owner)
+{
+    SolPubkey token = find_ata(owner, &(entry->mint));
+
+    BenchMeta metas[] = { ROS(*owner), RO(block->address), RW(entry->entry), RW(Constants.authority_pubkey),
+                          RO(token), RW(*owner) };
+
+    uint8_t data = Instruction_Refund;
+
+    execute("Refund", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_stake(const BenchBlock *block, const BenchEntry *entry, const SolPubkey *owner,
+                  const SolPubkey *stake_account)
+{
+    SolPubkey token = find_ata(owner, &(entry->mint));
+
+    BenchMeta metas[] = { RO(block->address), RW(entry->entry), ROS(*owner), RO(token), RW(*stake_account),
+                          ROS(*owner), RO(Constants.shinobi_systems_vote_pubkey), RO(Constants.authority_pubkey),
+                          RO(Constants.clock_sysvar_pubkey), RO(Constants.stake_program_pubkey),
+                          RO(Constants.stake_config_pubkey), RO(Constants.stake_history_sysvar_pubkey) };
+
+    uint8_t data = Instruction_Stake;
+
+    execute("Stake", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_set_block_commission(const BenchBlock *block, commission_t commission)
+{
+    BenchMeta metas[] = { RO(Constants.config_pubkey), ROS(admin), RW(block->address) };
+
+    SetBlockCommissionData data = { Instruction_SetBlockCommission, commission };
+
+    execute("SetBlockCommission", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_set_settlement_threshold(uint64_t threshold_lamports)
+{
+    BenchMeta metas[] = { RW(Constants.config_pubkey), ROS(admin) };
+
+    SetSettlementThresholdData data = { Instruction_SetSettlementThreshold, threshold_lamports };
+
+    execute("SetSettlementThreshold", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_take_commission_or_delegate(const BenchBlock *block, const BenchEntry *entry,
+                                        const SolPubkey *stake_account)
+{
+    BenchMeta metas[] = { RWS(admin), RO(block->address), RW(entry->entry), RW(*stake_account),
+                          RW(Constants.master_stake_pubkey), RW(entry->bridge), RO(Constants.authority_pubkey),
+                          RO(Constants.clock_sysvar_pubkey), RO(Constants.system_program_pubkey),
+                          RO(Constants.stake_program_pubkey), RO(Constants.stake_history_sysvar_pubkey),
+                          RO(Constants.config_pubkey) };
+
+    uint8_t data = Instruction_TakeCommissionOrDelegate;
+
+    execute("TakeCommissionOrDelegate", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_harvest(const BenchEntry *entry, const SolPubkey *owner, const SolPubkey *stake_account)
+{
+    SolPubkey token = find_ata(owner, &(entry->mint));
+
+    SolPubkey ki_destination = find_ata(owner, &(Constants.ki_mint_pubkey));
+
+    BenchMeta metas[] = { RWS(*owner), RW(entry->entry), ROS(*owner), RO(token), RO(*stake_account),
+                          RW(ki_destination), RO(*owner), RW(Constants.ki_mint_pubkey),
+                          RO(Constants.authority_pubkey), RO(Constants.system_program_pubkey),
+                          RO(Constants.spl_token_program_pubkey),
+                          RO(Constants.spl_associated_token_account_program_pubkey) };
+
+    uint8_t data = Instruction_Harvest;
+
+    execute("Harvest", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+// Takes commission from, or delegates the stake accounts of, the staked entries of the block, whose stake accounts
+// are [stake_accounts], stopping once the estimated compute units used would exceed [compute_unit_budget]
+static void tx_take_commission_or_delegate_many(const BenchBlock *block, BenchEntry **entries,
+                                                const SolPubkey *stake_accounts, uint8_t count,
+                                                uint32_t compute_unit_budget)
+{
+    BenchMeta metas[BENCH_MAX_TRANSACTION_ACCOUNTS] = { RWS(admin), RO(block->address),
+                                                        RW(Constants.master_stake_pubkey),
+                                                        RO(Constants.authority_pubkey),
+                                                        RO(Constants.clock_sysvar_pubkey),
+                                                        RO(Constants.system_program_pubkey),
+                                                        RO(Constants.stake_program_pubkey),
+                                                        RO(Constants.stake_history_sysvar_pubkey),
+                                                        RW(Constants.config_pubkey) };
+    for (uint8_t i = 0; i < count; i++) {
+        BenchMeta triple[] = { RW(entries[i]->entry), RW(stake_accounts[i]), RW(entries[i]->bridge) };
+        memcpy(&(metas[9 + (i * 3)]), triple, sizeof(triple));
+    }
+
+    TakeCommissionOrDelegateManyData data = { Instruction_TakeCommissionOrDelegateMany, compute_unit_budget };
+
+    char label[64];
+    snprintf(label, sizeof(label), "TakeCommissionOrDelegateMany (%u)", count);
+    execute(label, metas, 9 + (count * 3), &data, sizeof(data));
+}
+
+
+// Harvests the Ki of all of the staked entries of [owner], whose stake accounts are [stake_accounts], in one
+// transaction
+static void tx_harvest_many(BenchEntry **entries, const SolPubkey *stake_accounts, uint8_t count,
+                            const SolPubkey *owner)
+{
+    SolPubkey ki_destination = find_ata(owner, &(Constants.ki_mint_pubkey));
+
+    BenchMeta metas[BENCH_MAX_TRANSACTION_ACCOUNTS] = { RWS(*owner), ROS(*owner), RW(ki_destination), RO(*owner),
+                                                        RW(Constants.ki_mint_pubkey),
+                                                        RO(Constants.authority_pubkey),
+                                                        RO(Constants.system_program_pubkey),
+                                                        RO(Constants.spl_token_program_pubkey),
+                                                        RO(Constants.spl_associated_token_account_program_pubkey) };
+    SolPubkey tokens[(BENCH_MAX_TRANSACTION_ACCOUNTS - 9) / 3];
+    for (uint8_t i = 0; i < count; i++) {
+        tokens[i] = find_ata(owner, &(entries[i]->mint));
+        BenchMeta triple[] = { RW(entries[i]->entry), RO(tokens[i]), RO(stake_accounts[i]) };
+        memcpy(&(metas[9 + (i * 3)]), triple, sizeof(triple));
+    }
+
+    uint8_t data = Instruction_HarvestMany;
+
+    char label[64];
+    snprintf(label, sizeof(label), "HarvestMany (%u entries)", count);
+    execute(label, metas, 9 + (count * 3), &data, sizeof(data));
+}
+
+
+// Levels up the entry from [from_level] to [level], which may be more than one level above it
+static void tx_level_up(const BenchBlock *block, const BenchEntry *entry, const SolPubkey *owner, uint8_t from_level,
+                        uint8_t level)
+{
+    SolPubkey token = find_ata(owner, &(entry->mint));
+
+    SolPubkey ki_source = find_ata(owner, &(Constants.ki_mint_pubkey));
+
+    BenchMeta metas[] = { RW(entry->entry), ROS(*owner), RO(token), RW(entry->metadata), RW(ki_source),
+                          ROS(*owner), RW(Constants.ki_mint_pubkey), RO(Constants.authority_pubkey),
+                          RO(Constants.spl_token_program_pubkey), RO(Constants.metaplex_program_pubkey),
+                          RO(block->address) };
+
+    LevelUpData *data = (LevelUpData *) data_buffer;
+    data->instruction_code = Instruction_LevelUp;
+    data->target_level = level;
+
+    sha256_t root;
+    compute_level_metadata_proof(entry, level, &root, &(data->level_metadata_proof));
+
+    char label[64];
+    snprintf(label, sizeof(label), "LevelUp (%u levels)", level - from_level);
+    execute(label, metas, ARRAY_LEN(metas), data, compute_level_up_data_size(data->level_metadata_proof.proof_length));
+}
+
+
+static void tx_destake(const BenchBlock *block, const BenchEntry *entry, const SolPubkey *owner,
+                    const SolPubkey *stake_account)
+{
+    SolPubkey token = find_ata(owner, &(entry->mint));
+
+    SolPubkey ki_destination = find_ata(owner, &(Constants.ki_mint_pubkey));
+
+    BenchMeta metas[] = { RWS(*owner), RO(block->address), RW(entry->entry), ROS(*owner), RO(token),
+                          RW(*stake_account), RW(ki_destination), RO(*owner), RW(Constants.master_stake_pubkey),
+                          RW(entry->bridge), RW(Constants.ki_mint_pubkey), RO(Constants.authority_pubkey),
+                          RO(Constants.clock_sysvar_pubkey), RO(Constants.system_program_pubkey),
+                          RO(Constants.stake_program_pubkey), RO(Constants.stake_history_sysvar_pubkey),
+                          RO(Constants.spl_token_program_pubkey),
+                          RO(Constants.spl_associated_token_account_program_pubkey), RO(Constants.config_pubkey) };
+
+    uint8_t data = Instruction_Destake;
+
+    execute("Destake", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_reauthorize(const BenchBlock *block, const BenchEntry *entry, const SolPubkey *owner)
+{
+    SolPubkey token = find_ata(owner, &(entry->mint));
+
+    // The entry is not staked, so the system program stands in for the stake account
+    BenchMeta metas[] = { RO(Constants.config_pubkey), ROS(admin), RW(entry->entry), ROS(*owner), RO(token),
+                          RW(entry->metadata), RO(Constants.system_program_pubkey), RO(Constants.authority_pubkey),
+                          RO(Constants.clock_sysvar_pubkey), RO(Constants.metaplex_program_pubkey),
+                          RO(Constants.stake_program_pubkey), RO(block->address), RWS(*owner),
+                          RW(Constants.master_stake_pubkey), RW(entry->bridge), RO(Constants.system_program_pubkey),
+                          RO(Constants.stake_history_sysvar_pubkey) };
+
+    ReauthorizeData data = { Instruction_ReAuthorize, new_authority };
+
+    execute("ReAuthorize", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_refresh_cache()
+{
+    BenchMeta metas[] = { RW(Constants.config_pubkey), RO(Constants.stake_program_pubkey) };
+
+    uint8_t data = Instruction_RefreshCache;
+
+    execute("RefreshCache", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_split_master_stake()
+{
+    BenchMeta metas[] = { RO(Constants.config_pubkey), RWS(admin), RW(Constants.master_stake_pubkey),
+                          RWS(split_into), RO(Constants.system_program_pubkey), RO(Constants.authority_pubkey),
+                          RO(Constants.clock_sysvar_pubkey), RO(Constants.system_program_pubkey),
+                          RO(Constants.stake_program_pubkey), RO(Constants.stake_history_sysvar_pubkey) };
+
+    SplitMasterStakeData data = { Instruction_SplitMasterStake, 0 };
+
+    execute("SplitMasterStake", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_delete_whitelist(const BenchBlock *block)
+{
+    BenchMeta metas[4 + WHITELIST_SHARD_COUNT] = { RO(Constants.config_pubkey), RWS(admin), RO(block->address),
+                                                   RW(block->whitelist) };
+
+    uint8_t count = 4;
+    for (uint8_t i = 0; i < WHITELIST_SHARD_COUNT; i++) {
+        if (block->whitelist_shard_mask & (1 << i)) {
+            metas[count++] = (BenchMeta) RW(block->whitelist_shards[i]);
+        }
+    }
+
+    DeleteWhitelistData data = { Instruction_DeleteWhitelist };
+
+    execute("DeleteWhitelist", metas, count, &data, sizeof(data));
+}
+
+
+typedef struct
+{
+    SolPubkey marker_token, bid;
+
+    uint8_t marker_token_bump_seed, bid_bump_seed;
+
+} BenchBid;
+
+
+static BenchBid find_bid(const BenchEntry *entry, const SolPubkey *bidder)
+{
+    BenchBid bid;
+
+    bid.marker_token_bump_seed = find_pda(&(bid.marker_token), PDA_Account_Seed_Prefix_Bid_Marker_Token,
+                                          &(entry->mint), sizeof(SolPubkey), bidder, sizeof(SolPubkey));
+
+    bid.bid_bump_seed = find_pda(&(bid.bid), PDA_Account_Seed_Prefix_Bid, &(bid.marker_token), sizeof(SolPubkey),
+                                 0, 0);
+
+    return bid;
+}
+
+
+static void tx_place_bid(const BenchEntry *entry, const SolPubkey *bidder)
+{
+    BenchBid bid = find_bid(entry, bidder);
+
+    BenchMeta metas[] = { RWS(*bidder), RW(entry->entry), RW(Constants.bid_marker_mint_pubkey),
+                          RW(bid.marker_token), RW(bid.bid), RO(Constants.authority_pubkey),
+                          RO(Constants.system_program_pubkey), RO(Constants.self_program_pubkey),
+                          RO(Constants.spl_token_program_pubkey) };
+
+    BidData data = { Instruction_Bid, bid.marker_token_bump_seed, bid.bid_bump_seed, 0, 100 * LAMPORTS_PER_SOL };
+
+    execute("Bid", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+// Bids on [entry], outbidding the winning bid of [previous_bidder], which is refunded in the same instruction
+static void tx_place_bid_refunding(const BenchEntry *entry, const SolPubkey *bidder, const SolPubkey *previous_bidder)
+{
+    BenchBid bid = find_bid(entry, bidder);
+
+    BenchBid previous_bid = find_bid(entry, previous_bidder);
+
+    BenchMeta metas[] = { RWS(*bidder), RW(entry->entry), RW(Constants.bid_marker_mint_pubkey),
+                          RW(bid.marker_token), RW(bid.bid), RO(Constants.authority_pubkey),
+                          RO(Constants.system_program_pubkey), RO(Constants.self_program_pubkey),
+                          RO(Constants.spl_token_program_pubkey), RW(previous_bid.bid), RW(*previous_bidder) };
+
+    BidData data = { Instruction_Bid, bid.marker_token_bump_seed, bid.bid_bump_seed, 0, 100 * LAMPORTS_PER_SOL };
+
+    execute("Bid (refunding)", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void tx_claim_losing(const char *label, const BenchEntry *entry, const SolPubkey *bidder)
+{
+    BenchBid bid = find_bid(entry, bidder);
+
+    BenchMeta metas[] = { RWS(*bidder), RO(entry->entry), RW(bid.bid), RW(Constants.bid_marker_mint_pubkey),
+                          RW(bid.marker_token), RO(Constants.authority_pubkey),
+                          RO(Constants.spl_token_program_pubkey) };
+
+    uint8_t data = Instruction_ClaimLosing;
+
+    execute(label, metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+// Claims the losing bids of [bidder] on all of [entries] in one transaction
+static void tx_claim_losing_many(BenchEntry **entries, uint8_t count, const SolPubkey *bidder)
+{
+    BenchMeta metas[BENCH_MAX_TRANSACTION_ACCOUNTS] = { RWS(*bidder), RW(Constants.bid_marker_mint_pubkey),
+                                                        RO(Constants.authority_pubkey),
+                                                        RO(Constants.spl_token_program_pubkey) };
+    BenchBid bids[(BENCH_MAX_TRANSACTION_ACCOUNTS - 4) / 3];
+    for (uint8_t i = 0; i < count; i++) {
+        bids[i] = find_bid(entries[i], bidder);
+        BenchMeta triple[] = { RO(entries[i]->entry), RW(bids[i].bid), RW(bids[i].marker_token) };
+        memcpy(&(metas[4 + (i * 3)]), triple, sizeof(triple));
+    }
+
+    uint8_t data = Instruction_ClaimLosingMany;
+
+    char label[64];
+    snprintf(label, sizeof(label), "ClaimLosingMany (%u bids)", count);
+    execute(label, metas, 4 + (count * 3), &data, sizeof(data));
+}
+
+
+static void tx_claim_winning(const BenchEntry *entry, const SolPubkey *bidder)
+{
+    BenchBid bid = find_bid(entry, bidder);
+
+    SolPubkey destination = find_ata(bidder, &(entry->mint));
+
+    BenchMeta metas[] = { RWS(*bidder), RW(entry->entry), RW(bid.bid), RO(Constants.config_pubkey), RW(admin),
+                          RW(entry->token), RO(entry->mint), RO(Constants.authority_pubkey), RW(destination),
+                          RO(*bidder), RO(Constants.system_program_pubkey), RO(Constants.spl_token_program_pubkey),
+                          RO(Constants.spl_associated_token_account_program_pubkey),
+                          RW(Constants.bid_marker_mint_pubkey), RW(bid.marker_token) };
+
+    uint8_t data = Instruction_ClaimWinning;
+
+    execute("ClaimWinning", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+// Claims the winning bid of [bidder] on [entry] and stakes the entry to [stake_account], in one instruction
+static void tx_claim_winning_and_stake(const BenchBlock *block, const BenchEntry *entry, const SolPubkey *bidder,
+                                       const SolPubkey *stake_account)
+{
+    BenchBid bid = find_bid(entry, bidder);
+
+    SolPubkey destination = find_ata(bidder, &(entry->mint));
+
+    BenchMeta metas[] = { RWS(*bidder), RW(entry->entry), RW(bid.bid), RO(Constants.config_pubkey), RW(admin),
+                          RW(entry->token), RO(entry->mint), RO(Constants.authority_pubkey), RW(destination),
+                          RO(*bidder), RO(Constants.system_program_pubkey), RO(Constants.spl_token_program_pubkey),
+                          RO(Constants.spl_associated_token_account_program_pubkey),
+                          RW(Constants.bid_marker_mint_pubkey), RW(bid.marker_token), RO(block->address),
+                          RW(*stake_account), ROS(*bidder), RO(Constants.shinobi_systems_vote_pubkey),
+                          RO(Constants.clock_sysvar_pubkey), RO(Constants.stake_program_pubkey),
+                          RO(Constants.stake_config_pubkey), RO(Constants.stake_history_sysvar_pubkey) };
+
+    uint8_t data = Instruction_ClaimWinningAndStake;
+
+    execute("ClaimWinningAndStake", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+// Bids on [entry], whose bids are escrowed in the entry, outbidding [previous_bidder], or [bidder] itself if there is
+// no bid yet
+static void tx_escrowed_bid(const BenchEntry *entry, const SolPubkey *bidder, const SolPubkey *previous_bidder)
+{
+    BenchMeta metas[] = { RWS(*bidder), RW(entry->entry), RW(*previous_bidder),
+                          RO(Constants.system_program_pubkey) };
+
+    EscrowedBidData data = { Instruction_EscrowedBid, 0, 100 * LAMPORTS_PER_SOL };
+
+    execute("EscrowedBid", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+// Claims the winning bid of [bidder] on [entry], whose bids are escrowed in the entry, which is passed as the bid
+static void tx_claim_escrowed_winning(const BenchEntry *entry, const SolPubkey *bidder)
+{
+    SolPubkey destination = find_ata(bidder, &(entry->mint));
+
+    BenchMeta metas[] = { RWS(*bidder), RW(entry->entry), RW(entry->entry), RO(Constants.config_pubkey), RW(admin),
+                          RW(entry->token), RO(entry->mint), RO(Constants.authority_pubkey), RW(destination),
+                          RO(*bidder), RO(Constants.system_program_pubkey), RO(Constants.spl_token_program_pubkey),
+                          RO(Constants.spl_associated_token_account_program_pubkey) };
+
+    uint8_t data = Instruction_ClaimWinning;
+
+    execute("ClaimWinning (escrowed)", metas, ARRAY_LEN(metas), &data, sizeof(data));
+}
+
+
+static void run_scenario()
+{
+    admin = make_key("admin");
+    buyer_1 = make_key("buyer 1");
+    buyer_2 = make_key("buyer 2");
+    bidder_1 = make_key("bidder 1");
+    bidder_2 = make_key("bidder 2");
+    new_authority = make_key("new authority");
+    stake_1 = make_key("stake 1");
+    stake_b = make_key("stake b");
+    split_into = make_key("split into");
+
+    fund(&(Constants.superuser_pubkey), 1000 * LAMPORTS_PER_SOL);
+    fund(&admin, 1000 * LAMPORTS_PER_SOL);
+    fund(&buyer_1, 100 * LAMPORTS_PER_SOL);
+    fund(&buyer_2, 100 * LAMPORTS_PER_SOL);
+    fund(&bidder_1, 100 * LAMPORTS_PER_SOL);
+    fund(&bidder_2, 100 * LAMPORTS_PER_SOL);
+
+    make_executable(&(Constants.self_program_pubkey));
+    make_executable(&(Constants.system_program_pubkey));
+    make_executable(&(Constants.stake_program_pubkey));
+    make_executable(&(Constants.spl_token_program_pubkey));
+    make_executable(&(Constants.spl_associated_token_account_program_pubkey));
+    make_executable(&(Constants.metaplex_program_pubkey));
+    fund(&(Constants.shinobi_systems_vote_pubkey), LAMPORTS_PER_SOL);
+    fund(&(Constants.clock_sysvar_pubkey), 1);
+    fund(&(Constants.rent_sysvar_pubkey), 1);
+    fund(&(Constants.stake_history_sysvar_pubkey), 1);
+    fund(&(Constants.stake_config_pubkey), 1);
+
+    bench_clock.slot = 150000000;
+    bench_clock.epoch = 350;
+    bench_clock.leader_schedule_epoch = 351;
+    bench_clock.unix_timestamp = 1660000000;
+    bench_clock.epoch_start_timestamp = bench_clock.unix_timestamp;
+
+    print_stats_header();
+
+    tx_initialize();
+
+    tx_set_admin();
+
+    // Block A: three entries, two of them sold as mysteries, with a whitelist
+    BenchBlock block_a;
+    make_block(&block_a, 1, 1);
+    block_a.config.total_entry_count = 3;
+    block_a.config.total_mystery_count = 2;
+    block_a.config.mystery_phase_duration = 10000;
+    block_a.config.mystery_start_price_lamports = 2 * LAMPORTS_PER_SOL;
+    block_a.config.reveal_period_duration = 1000;
+    block_a.config.minimum_price_lamports = LAMPORTS_PER_SOL;
+    block_a.config.has_auction = false;
+    block_a.config.duration = 1000;
+    block_a.config.final_start_price_lamports = 2 * LAMPORTS_PER_SOL;
+    block_a.config.whitelist_duration = 100;
+
+    BenchEntry entries_a[3];
+    for (uint16_t i = 0; i < ARRAY_LEN(entries_a); i++) {
+        make_entry(&(entries_a[i]), &block_a, i);
+    }
+
+    SolPubkey whitelisted[] = { buyer_1, buyer_2 };
+    tx_add_whitelist_entries(&block_a, whitelisted, ARRAY_LEN(whitelisted));
+
+    tx_create_block(&block_a, 0x0CCC);
+
+    tx_add_entries_to_block(&block_a, entries_a, ARRAY_LEN(entries_a));
+
+    advance_clock(10, 0);
+
+    tx_buy("Buy (mystery, whitelisted)", &block_a, &(entries_a[0]), &buyer_1);
+
+    tx_buy("Buy (mystery, whitelisted)", &block_a, &(entries_a[1]), &buyer_2);
+
+    tx_set_metadata_bytes(&block_a, &(entries_a[0]));
+
+    tx_set_metadata_bytes(&block_a, &(entries_a[2]));
+
+    {
+        BenchEntry *reveal[] = { &(entries_a[0]) };
+        tx_reveal_entries(&block_a, reveal, ARRAY_LEN(reveal), 0, 0);
+    }
+
+    {
+        BenchEntry *reveal[] = { &(entries_a[2]) };
+        tx_reveal_entries(&block_a, reveal, ARRAY_LEN(reveal), 0, 0);
+    }
+
+    // Entry 1 is never revealed, so its purchaser may have a refund once the reveal period has passed
+    advance_clock(1001, 0);
+
+    tx_refund(&block_a, &(entries_a[1]), &buyer_2);
+
+    tx_buy("Buy (revealed)", &block_a, &(entries_a[2]), &buyer_1);
+
+    make_stake_account(&stake_1, &buyer_1, (5 * LAMPORTS_PER_SOL) + bench_rent_exempt_minimum(STAKE_ACCOUNT_DATA_LEN));
+
+    tx_stake(&block_a, &(entries_a[0]), &buyer_1, &stake_1);
+
+    advance_clock(2 * 24 * 60 * 60, 1);
+
+    tx_refresh_cache();
+
+    tx_set_block_commission(&block_a, 0x0CCC + 1310);
+
+    add_stake_rewards(&stake_1, LAMPORTS_PER_SOL);
+
+    tx_take_commission_or_delegate(&block_a, &(entries_a[0]), &stake_1);
+
+    tx_harvest(&(entries_a[0]), &buyer_1, &stake_1);
+
+    tx_level_up(&block_a, &(entries_a[0]), &buyer_1, 0, 1);
+
+    tx_level_up(&block_a, &(entries_a[0]), &buyer_1, 1, 4);
+
+    advance_clock(2 * 24 * 60 * 60, 1);
+
+    tx_refresh_cache();
+
+    add_stake_rewards(&stake_1, LAMPORTS_PER_SOL);
+
+    tx_destake(&block_a, &(entries_a[0]), &buyer_1, &stake_1);
+
+    tx_reauthorize(&block_a, &(entries_a[2]), &buyer_1);
+
+    tx_split_master_stake();
+
+    tx_delete_whitelist(&block_a);
+
+    // Block B: four entries sold by auction.  Bidder 1 is outbid on the first and claims the losing bid; bidder 2 is
+    // outbid on the second by a bid that refunds them at once, and bidder 1, who wins it, claims and stakes it at once.
+    // Bidder 1 is also outbid on the last two, and claims both losing bids at once.
+    BenchBlock block_b;
+    make_block(&block_b, 1, 2);
+    block_b.config.total_entry_count = 4;
+    block_b.config.total_mystery_count = 0;
+    block_b.config.reveal_period_duration = 1000;
+    block_b.config.minimum_price_lamports = LAMPORTS_PER_SOL;
+    block_b.config.has_auction = true;
+    block_b.config.duration = 3600;
+    block_b.config.final_start_price_lamports = LAMPORTS_PER_SOL;
+
+    BenchEntry entries_b[4];
+    for (uint16_t i = 0; i < ARRAY_LEN(entries_b); i++) {
+        make_entry(&(entries_b[i]), &block_b, i);
+    }
+
+    tx_create_block(&block_b, 0x0CCC);
+
+    tx_add_entries_to_block(&block_b, entries_b, ARRAY_LEN(entries_b));
+
+    for (uint16_t i = 0; i < ARRAY_LEN(entries_b); i++) {
+        tx_set_metadata_bytes(&block_b, &(entries_b[i]));
+    }
+
+    for (uint16_t first = 0; first < ARRAY_LEN(entries_b); first += BENCH_MAX_REVEAL_ENTRIES) {
+        BenchEntry *reveal[] = { &(entries_b[first]), &(entries_b[first + 1]) };
+        tx_reveal_entries(&block_b, reveal, ARRAY_LEN(reveal), 0, 0);
+    }
+
+    advance_clock(60, 0);
+
+    tx_place_bid(&(entries_b[0]), &bidder_1);
+
+    tx_place_bid(&(entries_b[1]), &bidder_2);
+
+    tx_place_bid_refunding(&(entries_b[1]), &bidder_1, &bidder_2);
+
+    tx_place_bid(&(entries_b[2]), &bidder_1);
+
+    tx_place_bid(&(entries_b[3]), &bidder_1);
+
+    advance_clock(60, 0);
+
+    tx_place_bid(&(entries_b[0]), &bidder_2);
+
+    tx_place_bid(&(entries_b[2]), &bidder_2);
+
+    tx_place_bid(&(entries_b[3]), &bidder_2);
+
+    advance_clock(3600, 0);
+
+    tx_claim_losing("ClaimLosing", &(entries_b[0]), &bidder_1);
+
+    // The bid of bidder 2 on entry 1 was refunded when it was outbid, leaving only its bid marker token to reclaim
+    tx_claim_losing("ClaimLosing (refunded bid)", &(entries_b[1]), &bidder_2);
+
+    {
+        BenchEntry *losing[] = { &(entries_b[2]), &(entries_b[3]) };
+        tx_claim_losing_many(losing, ARRAY_LEN(losing), &bidder_1);
+    }
+
+    tx_claim_winning(&(entries_b[0]), &bidder_2);
+
+    make_stake_account(&stake_b, &bidder_1, (5 * LAMPORTS_PER_SOL) + bench_rent_exempt_minimum(STAKE_ACCOUNT_DATA_LEN));
+
+    tx_claim_winning_and_stake(&block_b, &(entries_b[1]), &bidder_1, &stake_b);
+
+    // Block C: two entries sold by fixed price to buyers on a Merkle whitelist of 10,000 wallets, where buyer 1 is
+    // allowed two purchases and everyone else one
+    BenchBlock block_c;
+    make_block(&block_c, 1, 3);
+    block_c.config.total_entry_count = 2;
+    block_c.config.total_mystery_count = 0;
+    block_c.config.reveal_period_duration = 1000;
+    block_c.config.minimum_price_lamports = LAMPORTS_PER_SOL;
+    block_c.config.has_auction = false;
+    block_c.config.duration = 1000;
+    block_c.config.final_start_price_lamports = 2 * LAMPORTS_PER_SOL;
+    block_c.config.whitelist_duration = 100000;
+
+    static sha256_t whitelist_hashes[10000];
+    uint32_t buyer_1_index = 1234, buyer_2_index = 5678;
+    BenchWhitelistLeaf buyer_1_leaf, buyer_2_leaf;
+    uint16_t slot = 0;
+    for (uint32_t i = 0; i < ARRAY_LEN(whitelist_hashes); i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "whitelisted %u", i);
+        SolPubkey wallet = (i == buyer_1_index) ? buyer_1 : (i == buyer_2_index) ? buyer_2 : make_key(name);
+        uint8_t allowance = (i == buyer_1_index) ? 2 : 1;
+        if (i == buyer_1_index) {
+            buyer_1_leaf.first_slot = slot;
+            buyer_1_leaf.allowance = allowance;
+        }
+        else if (i == buyer_2_index) {
+            buyer_2_leaf.first_slot = slot;
+            buyer_2_leaf.allowance = allowance;
+        }
+        compute_whitelist_leaf_hash(&wallet, slot, allowance, &(whitelist_hashes[i]));
+        slot += allowance;
+    }
+    block_c.config.whitelist_slot_count = slot;
+
+    // Each proof is computed from a fresh copy of the leaf hashes, since computing the root consumes them
+    static sha256_t whitelist_scratch[ARRAY_LEN(whitelist_hashes)];
+    memcpy(whitelist_scratch, whitelist_hashes, sizeof(whitelist_hashes));
+    compute_merkle_root(whitelist_scratch, ARRAY_LEN(whitelist_hashes), buyer_2_index, 1, buyer_2_leaf.proof,
+                        &(buyer_2_leaf.proof_length));
+    memcpy(whitelist_scratch, whitelist_hashes, sizeof(whitelist_hashes));
+    compute_merkle_root(whitelist_scratch, ARRAY_LEN(whitelist_hashes), buyer_1_index, 1, buyer_1_leaf.proof,
+                        &(buyer_1_leaf.proof_length));
+    block_c.config.whitelist_merkle_root = whitelist_scratch[0];
+
+    BenchEntry entries_c[2];
+    for (uint16_t i = 0; i < ARRAY_LEN(entries_c); i++) {
+        make_entry(&(entries_c[i]), &block_c, i);
+    }
+
+    tx_create_block(&block_c, 0x0CCC);
+
+    tx_add_entries_to_block(&block_c, entries_c, ARRAY_LEN(entries_c));
+
+    tx_set_metadata_bytes(&block_c, &(entries_c[0]));
+
+    tx_set_metadata_bytes(&block_c, &(entries_c[1]));
+
+    {
+        BenchEntry *reveal[] = { &(entries_c[0]), &(entries_c[1]) };
+        tx_reveal_entries(&block_c, reveal, ARRAY_LEN(reveal), 0, 0);
+    }
+
+    tx_buy_with_leaf("Buy (Merkle whitelisted)", &block_c, &(entries_c[0]), &buyer_1, &buyer_1_leaf);
+
+    tx_buy_with_leaf("Buy (Merkle whitelisted)", &block_c, &(entries_c[1]), &buyer_2, &buyer_2_leaf);
+
+    // Block D: twelve entries added in a single transaction, which passes more accounts than would fit in a stack
+    // array of account infos.  The block commits to the reveal of its entries with a reveal Merkle root, and its
+    // entries' metadata is set several entries at a time, and then the entries are revealed in ranges that each fit in
+    // a transaction, each with the proof of its range.
+    BenchBlock block_d;
+    make_block(&block_d, 1, 4);
+    block_d.config.total_entry_count = 12;
+    block_d.config.total_mystery_count = 0;
+    block_d.config.reveal_period_duration = 1000;
+    block_d.config.minimum_price_lamports = LAMPORTS_PER_SOL;
+    block_d.config.has_auction = false;
+    block_d.config.duration = 1000;
+    block_d.config.final_start_price_lamports = 2 * LAMPORTS_PER_SOL;
+
+    BenchEntry entries_d[12];
+    sha256_t reveal_hashes[ARRAY_LEN(entries_d)];
+    for (uint16_t i = 0; i < ARRAY_LEN(entries_d); i++) {
+        make_entry(&(entries_d[i]), &block_d, i);
+        compute_reveal_leaf_hash(&(entries_d[i]), &(reveal_hashes[i]));
+    }
+
+    // The root is computed from a copy of the leaf hashes, since computing the root consumes them
+    sha256_t reveal_scratch[ARRAY_LEN(reveal_hashes)];
+    sha256_t reveal_proof[MAX_MERKLE_RANGE_PROOF_LENGTH];
+    uint8_t reveal_proof_length;
+    memcpy(reveal_scratch, reveal_hashes, sizeof(reveal_hashes));
+    compute_merkle_root(reveal_scratch, ARRAY_LEN(reveal_hashes), 0, 1, reveal_proof, &reveal_proof_length);
+    block_d.config.reveal_merkle_root = reveal_scratch[0];
+
+    tx_create_block(&block_d, 0x0CCC);
+
+    tx_add_entries_to_block(&block_d, entries_d, ARRAY_LEN(entries_d));
+
+    {
+        BenchEntry *set[ARRAY_LEN(entries_d)];
+        for (uint16_t i = 0; i < ARRAY_LEN(set); i++) {
+            set[i] = &(entries_d[i]);
+        }
+        tx_set_metadata_bytes_many(&block_d, set, ARRAY_LEN(set));
+    }
+
+    for (uint16_t first = 0; first < ARRAY_LEN(entries_d); first += BENCH_MAX_REVEAL_ENTRIES) {
+        BenchEntry *reveal[] = { &(entries_d[first]), &(entries_d[first + 1]) };
+        memcpy(reveal_scratch, reveal_hashes, sizeof(reveal_hashes));
+        compute_merkle_root(reveal_scratch, ARRAY_LEN(reveal_hashes), first, ARRAY_LEN(reveal), reveal_proof,
+                            &reveal_proof_length);
+        tx_reveal_entries(&block_d, reveal, ARRAY_LEN(reveal), reveal_proof, reveal_proof_length);
+    }
+
+    // Buyer 1 buys and stakes four entries of block D, the last in a single BuyAndStake instruction, and once they
+    // have earned rewards, harvests the Ki of all of them at once
+    {
+        BenchEntry *staked[4];
+        SolPubkey stake_accounts[ARRAY_LEN(staked)];
+        for (uint8_t i = 0; i < ARRAY_LEN(staked); i++) {
+            char name[32];
+            snprintf(name, sizeof(name), "stake d %u", i);
+            staked[i] = &(entries_d[i]);
+            stake_accounts[i] = make_key(name);
+            make_stake_account(&(stake_accounts[i]), &buyer_1,
+                               (5 * LAMPORTS_PER_SOL) + bench_rent_exempt_minimum(STAKE_ACCOUNT_DATA_LEN));
+            if (i == (ARRAY_LEN(staked) - 1)) {
+                tx_buy_and_stake(&block_d, staked[i], &buyer_1, &(stake_accounts[i]));
+            }
+            else {
+                tx_buy("Buy (revealed)", &block_d, staked[i], &buyer_1);
+                tx_stake(&block_d, staked[i], &buyer_1, &(stake_accounts[i]));
+            }
+        }
+
+        advance_clock(2 * 24 * 60 * 60, 1);
+
+        for (uint8_t i = 0; i < ARRAY_LEN(staked); i++) {
+            add_stake_rewards(&(stake_accounts[i]), LAMPORTS_PER_SOL);
+        }
+
+        tx_harvest_many(staked, stake_accounts, ARRAY_LEN(staked), &buyer_1);
+
+        // Once the entries have earned more rewards, the crank takes commission from them with a budget that only
+        // covers two of them, and then from the remaining two
+        advance_clock(2 * 24 * 60 * 60, 1);
+
+        for (uint8_t i = 0; i < ARRAY_LEN(staked); i++) {
+            add_stake_rewards(&(stake_accounts[i]), LAMPORTS_PER_SOL);
+        }
+
+        tx_take_commission_or_delegate_many(&block_d, staked, stake_accounts, ARRAY_LEN(staked),
+                                            2 * (TAKE_COMMISSION_CHECK_UNITS + TAKE_COMMISSION_CHARGE_UNITS));
+
+        tx_take_commission_or_delegate_many(&block_d, &(staked[2]), &(stake_accounts[2]), ARRAY_LEN(staked) - 2,
+                                            1400000);
+
+        // With a settlement threshold of 0.05 SOL, the commission on one epoch of rewards is only accrued in the
+        // entries, and is settled once a second epoch of rewards brings it to the threshold
+        tx_set_settlement_threshold(LAMPORTS_PER_SOL / 20);
+
+        for (uint8_t epoch = 0; epoch < 2; epoch++) {
+            advance_clock(2 * 24 * 60 * 60, 1);
+
+            for (uint8_t i = 0; i < ARRAY_LEN(staked); i++) {
+                add_stake_rewards(&(stake_accounts[i]), LAMPORTS_PER_SOL);
+            }
+
+            tx_take_commission_or_delegate_many(&block_d, staked, stake_accounts, ARRAY_LEN(staked), 1400000);
+        }
+    }
+
+    // Block E: one entry sold by an auction whose bids are escrowed in the entry.  Bidder 1 and bidder 2 each bid
+    // twice, each bid refunding the bid that it outbids, and bidder 2 claims the winning bid; no Bid accounts or bid
+    // marker tokens are created, and there are no losing bids to claim.
+    BenchBlock block_e;
+    make_block(&block_e, 1, 5);
+    block_e.config.total_entry_count = 1;
+    block_e.config.total_mystery_count = 0;
+    block_e.config.reveal_period_duration = 1000;
+    block_e.config.minimum_price_lamports = LAMPORTS_PER_SOL;
+    block_e.config.has_auction = true;
+    block_e.config.escrow_bids = true;
+    block_e.config.duration = 3600;
+    block_e.config.final_start_price_lamports = LAMPORTS_PER_SOL;
+
+    BenchEntry entry_e;
+    make_entry(&entry_e, &block_e, 0);
+
+    tx_create_block(&block_e, 0x0CCC);
+
+    tx_add_entries_to_block(&block_e, &entry_e, 1);
+
+    tx_set_metadata_bytes(&block_e, &entry_e);
+
+    {
+        BenchEntry *reveal[] = { &entry_e };
+        tx_reveal_entries(&block_e, reveal, ARRAY_LEN(reveal), 0, 0);
+    }
+
+    advance_clock(60, 0);
+
+    tx_escrowed_bid(&entry_e, &bidder_1, &bidder_1);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        advance_clock(60, 0);
+        if (i & 1) {
+            tx_escrowed_bid(&entry_e, &bidder_1, &bidder_2);
+        }
+        else {
+            tx_escrowed_bid(&entry_e, &bidder_2, &bidder_1);
+        }
+    }
+
+    advance_clock(3600, 0);
+
+    tx_claim_escrowed_winning(&entry_e, &bidder_2);
+
+    printf("\n");
+    printf("%-36s %5s %8s %8lu %5lu %5lu %5lu %8lu %8lu %8lu %8lu\n", "Total", "", "",
+           (unsigned long) bench_totals.syscall_units, (unsigned long) bench_totals.pda_count,
+           (unsigned long) bench_totals.sha256_count, (unsigned long) bench_totals.cpi_count,
+           (unsigned long) bench_totals.cpi_units, (unsigned long) bench_totals.cpi_bytes,
+           (unsigned long) (bench_totals.syscall_units + bench_totals.cpi_units),
+           (unsigned long) bench_totals.callee_units);
+    printf("%lu instructions executed\n", (unsigned long) bench_transaction_count);
+}
+
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-c")) {
+            bench_print_cost_model();
+            return 0;
+        }
+        char *equals = strchr(argv[i], '=');
+        if (!equals) {
+            fprintf(stderr, "Usage: %s [-c] [name=value ...]\n", argv[0]);
+            return 1;
+        }
+        *equals = 0;
+        if (!bench_set_cost(argv[i], strtoull(&(equals[1]), 0, 10))) {
+            fprintf(stderr, "Unknown cost model value: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    run_scenario();
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+// Declarations shared between the syscall shim (bench_shim.c) and the benchmark harness (bench.c)
+
+#include "solana_sdk.h"
+
+#include "inc/clock.h"
+
+
+// The compute unit cost model.  The defaults are the compute budget values of the Solana 1.14 runtime, which is the
+// release that the program is built and tested against.  Every value can be overridden on the bench command line.
+typedef struct
+{
+    // Charged for every sol_invoke/sol_invoke_signed
+    uint64_t invoke_units;
+
+    // Charged for every sol_create_program_address, and for every bump seed tried by sol_try_find_program_address
+    uint64_t create_program_address_units;
+
+    // sol_sha256 costs sha256_base_cost + sha256_byte_cost per 2 bytes hashed (at least mem_op_base_cost per slice)
+    uint64_t sha256_base_cost;
+    uint64_t sha256_byte_cost;
+
+    // Minimum cost of any syscall that operates on a slice of memory
+    uint64_t mem_op_base_cost;
+
+    // Base cost of a syscall that has no more specific cost, i.e. sol_get_return_data
+    uint64_t syscall_base_cost;
+
+    // sysvar syscalls cost sysvar_base_cost + the size of the sysvar
+    uint64_t sysvar_base_cost;
+
+    // Cost of a log syscall
+    uint64_t log_units;
+
+    // Cost of a sol_log_64 syscall
+    uint64_t log_64_units;
+
+    // Cost of a sol_log_compute_units syscall
+    uint64_t log_compute_units_units;
+
+    // Instruction data and account data passed to a cross-program invocation cost one unit per this many bytes
+    uint64_t cpi_bytes_per_unit;
+
+    // These are not runtime costs; they are estimates of what each invoked program itself consumes per invocation,
+    // which is not otherwise visible to the harness since those programs are emulated.  They are reported
+    // separately so that they never hide a change to this program's own cost.
+    uint64_t system_program_units;
+    uint64_t stake_program_units;
+    uint64_t spl_token_program_units;
+    uint64_t spl_ata_program_units;
+    uint64_t metaplex_program_units;
+
+} BenchCostModel;
+
+
+// Counters accumulated by the shim while an instruction executes
+typedef struct
+{
+    // Units charged for syscalls other than cross-program invocations
+    uint64_t syscall_units;
+
+    // Number of program address derivations (sol_create_program_address calls and sol_try_find_program_address
+    // iterations)
+    uint64_t pda_count;
+
+    // Number of sha256 syscalls
+    uint64_t sha256_count;
+
+    // Number of cross-program invocations
+    uint64_t cpi_count;
+
+    // Units charged for cross-program invocations
+    uint64_t cpi_units;
+
+    // Bytes of instruction data and account data passed to cross-program invocations
+    uint64_t cpi_bytes;
+
+    // Estimated units consumed by the invoked programs
+    uint64_t callee_units;
+
+} BenchStats;
+
+
+extern BenchCostModel bench_cost_model;
+
+extern BenchStats bench_stats;
+
+// The values returned by sol_get_clock_sysvar
+extern Clock bench_clock;
+
+// The values returned by sol_get_rent_sysvar
+extern uint64_t bench_rent_lamports_per_byte_year;
+extern double bench_rent_exemption_threshold;
+
+// The program id of the program being executed, used as the return data program id by sol_set_return_data
+extern SolPubkey bench_program_id;
+
+
+// Sets a cost model value by name; returns false if there is no such value
+extern bool bench_set_cost(const char *name, uint64_t value);
+
+// Prints all cost model values
+extern void bench_print_cost_model(void);
+
+// Computes a SHA-256 hash without charging any compute units
+extern void bench_sha256(const SolBytes *bytes, int bytes_len, uint8_t *result);
+
+// Derives a program address without charging any compute units; returns false if the seeds do not produce a valid
+// program address.  The runtime hashes the seeds, program id and the marker "ProgramDerivedAddress" with SHA-256 and
+// rejects results that are on the ed25519 curve.  The harness uses the same hash but, having no curve arithmetic,
+// rejects a deterministic half of the results instead, so that bump seed searches take a realistic number of tries.
+extern bool bench_derive_address(const SolSignerSeed *seeds, int seeds_len, const SolPubkey *program_id,
+                                 SolPubkey *address);
+
+// Searches for the bump seed of a program address without charging any compute units
+extern uint8_t bench_find_program_address(const SolSignerSeed *seeds, int seeds_len, const SolPubkey *program_id,
+                                          SolPubkey *address);
+
+// Implemented by the harness: executes a cross-program invocation of an emulated program.  Returns 0 on success.
+extern uint64_t bench_process_instruction(const SolInstruction *instruction, const SolAccountInfo *account_infos,
+                                          int account_infos_len);
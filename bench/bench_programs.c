@@ -0,0 +1,920 @@
+#pragma once
+
+// Emulations of the programs that this program invokes: the System, Stake, SPL Token, SPL Associated Token Account
+// and Metaplex Token Metadata programs.  Only the instructions that this program actually uses are implemented, and
+// only to the extent needed to produce the account state that this program later reads back.  This file is included
+// by bench.c after program/entrypoint.c so that it can use the program's own account data definitions.
+//
+// The emulated programs are not charged for as executed instructions; instead each invocation adds the configured
+// per-program estimate in bench_cost_model to bench_stats.callee_units.
+
+#include "bench.h"
+
+
+// Size of a Metaplex metadata account as created by CreateMetadataAccountV2
+#define BENCH_METAPLEX_METADATA_ACCOUNT_SIZE 679
+
+// Size of an SPL token mint account
+#define BENCH_MINT_ACCOUNT_SIZE sizeof(SolanaMintAccountData)
+
+// Size of an SPL token account
+#define BENCH_TOKEN_ACCOUNT_SIZE sizeof(SolanaTokenProgramTokenData)
+
+// Maximum size of an account
+#define BENCH_MAX_ACCOUNT_SIZE (10 * 1024 * 1024)
+
+// The minimum delegation returned by the emulated GetMinimumDelegation
+#define BENCH_MINIMUM_STAKE_DELEGATION LAMPORTS_PER_SOL
+
+// Error returned by emulated programs for any failure; the harness reports failures by the log line that precedes
+// them rather than by code
+#define BENCH_PROGRAM_ERROR 1000
+
+
+// The account infos passed to the current invocation
+static SolAccountInfo *bench_infos;
+
+static int bench_infos_len;
+
+
+static uint64_t bench_fail(const char *program, const char *message)
+{
+    fprintf(stderr, "  %s: %s\n", program, message);
+
+    return BENCH_PROGRAM_ERROR;
+}
+
+
+// Returns the account info for [key] from the account infos of the current invocation; every account referenced
+// by an invocation was already verified by sol_invoke_signed to have been passed in
+static SolAccountInfo *bench_info(const SolPubkey *key)
+{
+    for (int i = 0; i < bench_infos_len; i++) {
+        if (SolPubkey_same(bench_infos[i].key, key)) {
+            return &(bench_infos[i]);
+        }
+    }
+
+    return 0;
+}
+
+
+static SolAccountInfo *bench_instruction_account(const SolInstruction *instruction, uint64_t index)
+{
+    if (index >= instruction->account_len) {
+        return 0;
+    }
+
+    return bench_info(instruction->accounts[index].pubkey);
+}
+
+
+// Changes the size of an account, which the runtime records in the serialized data length immediately preceding
+// the account data.  All account infos for the same account are updated as the runtime does after an invoke.
+static void bench_resize(SolAccountInfo *account, uint64_t size)
+{
+    uint64_t old_size = account->data_len;
+
+    if (size > old_size) {
+        memset(&(account->data[old_size]), 0, size - old_size);
+    }
+
+    for (int i = 0; i < bench_infos_len; i++) {
+        if (SolPubkey_same(bench_infos[i].key, account->key)) {
+            bench_infos[i].data_len = size;
+        }
+    }
+
+    ((uint64_t *) account->data)[-1] = size;
+}
+
+
+static bool bench_move_lamports(SolAccountInfo *from, SolAccountInfo *to, uint64_t lamports)
+{
+    if (*(from->lamports) < lamports) {
+        return false;
+    }
+
+    *(from->lamports) -= lamports;
+    *(to->lamports) += lamports;
+
+    return true;
+}
+
+
+static uint64_t bench_rent_exempt_minimum(uint64_t size)
+{
+    return (uint64_t) (((double) ((size + 128) * bench_rent_lamports_per_byte_year)) *
+                       bench_rent_exemption_threshold);
+}
+
+
+// Funds, allocates and assigns an account as the owning program would via the System program
+static uint64_t bench_create(const char *program, SolAccountInfo *funding, SolAccountInfo *account,
+                             const SolPubkey *owner, uint64_t size)
+{
+    uint64_t rent = bench_rent_exempt_minimum(size);
+
+    if (*(account->lamports) < rent) {
+        if (!bench_move_lamports(funding, account, rent - *(account->lamports))) {
+            return bench_fail(program, "insufficient funds to create account");
+        }
+    }
+
+    if (account->data_len || !is_system_program(account->owner)) {
+        return bench_fail(program, "account already in use");
+    }
+
+    bench_resize(account, size);
+
+    *(account->owner) = *owner;
+
+    return 0;
+}
+
+
+// System program ------------------------------------------------------------------------------------------------------
+
+static uint64_t bench_system_program(const SolInstruction *instruction)
+{
+    bench_stats.callee_units += bench_cost_model.system_program_units;
+
+    if (instruction->data_len < sizeof(uint32_t)) {
+        return bench_fail("System", "invalid instruction data");
+    }
+
+    SolAccountInfo *account = bench_instruction_account(instruction, 0);
+
+    if (!account || !account->is_writable) {
+        return bench_fail("System", "invalid account");
+    }
+
+    switch (*(uint32_t *) instruction->data) {
+    case 0: { // CreateAccount
+        SolAccountInfo *new_account = bench_instruction_account(instruction, 1);
+        if (!new_account || !new_account->is_writable) {
+            return bench_fail("System", "invalid CreateAccount new account");
+        }
+        if (*(new_account->lamports) || new_account->data_len || !is_system_program(new_account->owner)) {
+            return bench_fail("System", "CreateAccount of account already in use");
+        }
+        uint64_t space = *(uint64_t *) &(instruction->data[12]);
+        if (space > BENCH_MAX_ACCOUNT_SIZE) {
+            return bench_fail("System", "CreateAccount of too much space");
+        }
+        if (!bench_move_lamports(account, new_account, *(uint64_t *) &(instruction->data[4]))) {
+            return bench_fail("System", "CreateAccount with more lamports than are available");
+        }
+        bench_resize(new_account, space);
+        *(new_account->owner) = *(SolPubkey *) &(instruction->data[20]);
+        return 0;
+    }
+
+    case 1: // Assign
+        if (!is_system_program(account->owner)) {
+            return bench_fail("System", "Assign of account not owned by the System program");
+        }
+        *(account->owner) = *(SolPubkey *) &(instruction->data[4]);
+        return 0;
+
+    case 2: { // Transfer
+        SolAccountInfo *to = bench_instruction_account(instruction, 1);
+        if (!to || !to->is_writable) {
+            return bench_fail("System", "invalid Transfer destination");
+        }
+        if (!is_system_program(account->owner) || account->data_len) {
+            return bench_fail("System", "Transfer from account that is not a plain system account");
+        }
+        if (!bench_move_lamports(account, to, *(uint64_t *) &(instruction->data[4]))) {
+            return bench_fail("System", "Transfer of more lamports than are available");
+        }
+        return 0;
+    }
+
+    case 8: { // Allocate
+        uint64_t space = *(uint64_t *) &(instruction->data[4]);
+        if (!is_system_program(account->owner) || account->data_len) {
+            return bench_fail("System", "Allocate of account already in use");
+        }
+        if (space > BENCH_MAX_ACCOUNT_SIZE) {
+            return bench_fail("System", "Allocate of too much space");
+        }
+        bench_resize(account, space);
+        return 0;
+    }
+
+    default:
+        return bench_fail("System", "unsupported instruction");
+    }
+}
+
+
+// Stake program -------------------------------------------------------------------------------------------------------
+
+static bool bench_decode_stake(const SolAccountInfo *account, Stake *stake)
+{
+    sol_memset(stake, 0, sizeof(*stake));
+
+    return decode_stake_account(account, stake);
+}
+
+
+static void bench_encode_stake(SolAccountInfo *account, const Stake *stake)
+{
+    uint8_t *d = account->data;
+
+    memset(d, 0, account->data_len);
+
+    *(uint32_t *) d = stake->state;
+    d += 4;
+
+    if (stake->state == StakeState_Uninitialized) {
+        return;
+    }
+
+    memcpy(d, &(stake->meta.rent_exempt_reserve), 8), d += 8;
+    memcpy(d, &(stake->meta.authorize.staker), 32), d += 32;
+    memcpy(d, &(stake->meta.authorize.withdrawer), 32), d += 32;
+    memcpy(d, &(stake->meta.lockup.unix_timestamp), 8), d += 8;
+    memcpy(d, &(stake->meta.lockup.epoch), 8), d += 8;
+    memcpy(d, &(stake->meta.lockup.custodian), 32), d += 32;
+
+    if (stake->state != StakeState_Stake) {
+        return;
+    }
+
+    memcpy(d, &(stake->stake.delegation.voter_pubkey), 32), d += 32;
+    memcpy(d, &(stake->stake.delegation.stake), 8), d += 8;
+    memcpy(d, &(stake->stake.delegation.activation_epoch), 8), d += 8;
+    memcpy(d, &(stake->stake.delegation.deactivation_epoch), 8), d += 8;
+    memcpy(d, &(stake->stake.delegation.warmup_cooldown_rate), 8), d += 8;
+    memcpy(d, &(stake->stake.credits_observed), 8);
+}
+
+
+static bool bench_is_active_stake(const Stake *stake)
+{
+    return ((stake->state == StakeState_Stake) && (stake->stake.delegation.deactivation_epoch == UINT64_MAX));
+}
+
+
+static uint64_t bench_stake_program(const SolInstruction *instruction)
+{
+    bench_stats.callee_units += bench_cost_model.stake_program_units;
+
+    if (instruction->data_len < sizeof(uint32_t)) {
+        return bench_fail("Stake", "invalid instruction data");
+    }
+
+    uint32_t code = *(uint32_t *) instruction->data;
+
+    if (code == 13) { // GetMinimumDelegation
+        uint64_t minimum = BENCH_MINIMUM_STAKE_DELEGATION;
+        sol_set_return_data((uint8_t *) &minimum, sizeof(minimum));
+        return 0;
+    }
+
+    SolAccountInfo *account = bench_instruction_account(instruction, 0);
+
+    Stake stake;
+
+    if (!account || !account->is_writable || !bench_decode_stake(account, &stake)) {
+        return bench_fail("Stake", "invalid stake account");
+    }
+
+    switch (code) {
+    case 0: { // Initialize
+        if (stake.state != StakeState_Uninitialized) {
+            return bench_fail("Stake", "Initialize of initialized stake account");
+        }
+        const uint8_t *d = &(instruction->data[4]);
+        stake.state = StakeState_Initialized;
+        stake.meta.rent_exempt_reserve = bench_rent_exempt_minimum(STAKE_ACCOUNT_DATA_LEN);
+        memcpy(&(stake.meta.authorize.staker), d, 32), d += 32;
+        memcpy(&(stake.meta.authorize.withdrawer), d, 32), d += 32;
+        memcpy(&(stake.meta.lockup.unix_timestamp), d, 8), d += 8;
+        memcpy(&(stake.meta.lockup.epoch), d, 8), d += 8;
+        memcpy(&(stake.meta.lockup.custodian), d, 32);
+        if (*(account->lamports) < stake.meta.rent_exempt_reserve) {
+            return bench_fail("Stake", "Initialize of stake account that is not rent exempt");
+        }
+        break;
+    }
+
+    case 1: { // Authorize
+        SolPubkey new_authority;
+        memcpy(&new_authority, &(instruction->data[4]), sizeof(new_authority));
+        uint32_t authorize_type;
+        memcpy(&authorize_type, &(instruction->data[4 + 32]), sizeof(authorize_type));
+        SolAccountInfo *authority = bench_instruction_account(instruction, 2);
+        if ((stake.state != StakeState_Initialized) && (stake.state != StakeState_Stake)) {
+            return bench_fail("Stake", "Authorize of uninitialized stake account");
+        }
+        if (!authority) {
+            return bench_fail("Stake", "Authorize without authority");
+        }
+        if (authorize_type == 0) {
+            if (!SolPubkey_same(authority->key, &(stake.meta.authorize.staker)) &&
+                !SolPubkey_same(authority->key, &(stake.meta.authorize.withdrawer))) {
+                return bench_fail("Stake", "Authorize of staker not signed by staker or withdrawer");
+            }
+            stake.meta.authorize.staker = new_authority;
+        }
+        else {
+            if (!SolPubkey_same(authority->key, &(stake.meta.authorize.withdrawer))) {
+                return bench_fail("Stake", "Authorize of withdrawer not signed by withdrawer");
+            }
+            stake.meta.authorize.withdrawer = new_authority;
+        }
+        break;
+    }
+
+    case 2: { // DelegateStake
+        SolAccountInfo *vote = bench_instruction_account(instruction, 1);
+        if (!vote) {
+            return bench_fail("Stake", "DelegateStake without vote account");
+        }
+        if ((stake.state != StakeState_Initialized) &&
+            ((stake.state != StakeState_Stake) || bench_is_active_stake(&stake))) {
+            return bench_fail("Stake", "DelegateStake of active stake account");
+        }
+        uint64_t delegation = *(account->lamports) - stake.meta.rent_exempt_reserve;
+        if (delegation < BENCH_MINIMUM_STAKE_DELEGATION) {
+            return bench_fail("Stake", "DelegateStake of less than the minimum delegation");
+        }
+        stake.state = StakeState_Stake;
+        stake.stake.delegation.voter_pubkey = *(vote->key);
+        stake.stake.delegation.stake = delegation;
+        stake.stake.delegation.activation_epoch = bench_clock.epoch;
+        stake.stake.delegation.deactivation_epoch = UINT64_MAX;
+        stake.stake.delegation.warmup_cooldown_rate = 0.25;
+        stake.stake.credits_observed = 0;
+        break;
+    }
+
+    case 3: { // Split
+        uint64_t lamports;
+        memcpy(&lamports, &(instruction->data[4]), sizeof(lamports));
+        SolAccountInfo *split_into = bench_instruction_account(instruction, 1);
+        Stake split;
+        if (!split_into || !split_into->is_writable || !bench_decode_stake(split_into, &split) ||
+            (split.state != StakeState_Uninitialized)) {
+            return bench_fail("Stake", "Split into invalid stake account");
+        }
+        if ((stake.state != StakeState_Initialized) && (stake.state != StakeState_Stake)) {
+            return bench_fail("Stake", "Split of uninitialized stake account");
+        }
+        if ((lamports == 0) || (lamports > *(account->lamports))) {
+            return bench_fail("Stake", "Split of invalid lamports amount");
+        }
+        split = stake;
+        if (stake.state == StakeState_Stake) {
+            // If the destination is not already rent exempt, the shortfall comes out of the split stake
+            uint64_t reserve = split.meta.rent_exempt_reserve;
+            uint64_t shortfall = (*(split_into->lamports) >= reserve) ? 0 : (reserve - *(split_into->lamports));
+            if ((lamports <= shortfall) || (lamports > stake.stake.delegation.stake)) {
+                return bench_fail("Stake", "Split of more than the delegated stake");
+            }
+            split.stake.delegation.stake = lamports - shortfall;
+            stake.stake.delegation.stake -= lamports;
+        }
+        if (!bench_move_lamports(account, split_into, lamports)) {
+            return bench_fail("Stake", "Split of more lamports than are available");
+        }
+        bench_encode_stake(split_into, &split);
+        break;
+    }
+
+    case 4: { // Withdraw
+        uint64_t lamports;
+        memcpy(&lamports, &(instruction->data[4]), sizeof(lamports));
+        SolAccountInfo *to = bench_instruction_account(instruction, 1);
+        if (!to || !to->is_writable) {
+            return bench_fail("Stake", "Withdraw to invalid account");
+        }
+        uint64_t locked = 0;
+        if (stake.state != StakeState_Uninitialized) {
+            locked = stake.meta.rent_exempt_reserve;
+            if (bench_is_active_stake(&stake)) {
+                locked += stake.stake.delegation.stake;
+            }
+        }
+        if ((lamports != *(account->lamports)) && ((*(account->lamports) - locked) < lamports)) {
+            return bench_fail("Stake", "Withdraw of locked lamports");
+        }
+        bench_move_lamports(account, to, lamports);
+        break;
+    }
+
+    case 5: // Deactivate
+        if (!bench_is_active_stake(&stake)) {
+            return bench_fail("Stake", "Deactivate of inactive stake account");
+        }
+        stake.stake.delegation.deactivation_epoch = bench_clock.epoch;
+        break;
+
+    case 7: { // Merge
+        SolAccountInfo *source = bench_instruction_account(instruction, 1);
+        Stake merge;
+        if (!source || !source->is_writable || !bench_decode_stake(source, &merge) ||
+            ((merge.state != StakeState_Initialized) && (merge.state != StakeState_Stake))) {
+            return bench_fail("Stake", "Merge of invalid stake account");
+        }
+        if (!SolPubkey_same(&(stake.meta.authorize.staker), &(merge.meta.authorize.staker)) ||
+            !SolPubkey_same(&(stake.meta.authorize.withdrawer), &(merge.meta.authorize.withdrawer))) {
+            return bench_fail("Stake", "Merge of stake accounts with different authorities");
+        }
+        if (stake.state == StakeState_Stake) {
+            stake.stake.delegation.stake += (merge.state == StakeState_Stake) ? merge.stake.delegation.stake :
+                (*(source->lamports) - merge.meta.rent_exempt_reserve);
+        }
+        bench_move_lamports(source, account, *(source->lamports));
+        merge.state = StakeState_Uninitialized;
+        bench_encode_stake(source, &merge);
+        break;
+    }
+
+    default:
+        return bench_fail("Stake", "unsupported instruction");
+    }
+
+    bench_encode_stake(account, &stake);
+
+    return 0;
+}
+
+
+// SPL Token program ---------------------------------------------------------------------------------------------------
+
+static SolanaMintAccountData *bench_mint(const SolAccountInfo *account)
+{
+    if (!account || !is_spl_token_program(account->owner) || (account->data_len != BENCH_MINT_ACCOUNT_SIZE)) {
+        return 0;
+    }
+
+    return (SolanaMintAccountData *) account->data;
+}
+
+
+static SolanaTokenProgramTokenData *bench_token(const SolAccountInfo *account)
+{
+    if (!account || !is_spl_token_program(account->owner) || (account->data_len != BENCH_TOKEN_ACCOUNT_SIZE)) {
+        return 0;
+    }
+
+    SolanaTokenProgramTokenData *token = (SolanaTokenProgramTokenData *) account->data;
+
+    return (token->account_state == SolanaTokenAccountState_Initialized) ? token : 0;
+}
+
+
+static uint64_t bench_initialize_token(SolAccountInfo *account, const SolAccountInfo *mint_account,
+                                       const SolPubkey *owner)
+{
+    if (!account || !is_spl_token_program(account->owner) || (account->data_len != BENCH_TOKEN_ACCOUNT_SIZE) ||
+        ((SolanaTokenProgramTokenData *) account->data)->account_state) {
+        return bench_fail("SPL Token", "InitializeAccount of invalid account");
+    }
+
+    SolanaMintAccountData *mint = bench_mint(mint_account);
+    if (!mint || !mint->is_initialized) {
+        return bench_fail("SPL Token", "InitializeAccount with invalid mint");
+    }
+
+    SolanaTokenProgramTokenData *token = (SolanaTokenProgramTokenData *) account->data;
+
+    token->mint = *(mint_account->key);
+    token->owner = *owner;
+    token->account_state = SolanaTokenAccountState_Initialized;
+
+    return 0;
+}
+
+
+static uint64_t bench_spl_token_program(const SolInstruction *instruction)
+{
+    bench_stats.callee_units += bench_cost_model.spl_token_program_units;
+
+    if (instruction->data_len < 1) {
+        return bench_fail("SPL Token", "invalid instruction data");
+    }
+
+    const uint8_t *data = instruction->data;
+
+    SolAccountInfo *account_0 = bench_instruction_account(instruction, 0);
+    SolAccountInfo *account_1 = bench_instruction_account(instruction, 1);
+    SolAccountInfo *account_2 = bench_instruction_account(instruction, 2);
+
+    uint64_t amount = 0;
+    if (instruction->data_len >= 9) {
+        memcpy(&amount, &(data[1]), sizeof(amount));
+    }
+
+    switch (data[0]) {
+    case 3: { // Transfer
+        SolanaTokenProgramTokenData *source = bench_token(account_0);
+        SolanaTokenProgramTokenData *destination = bench_token(account_1);
+        if (!source || !destination || !SolPubkey_same(&(source->mint), &(destination->mint))) {
+            return bench_fail("SPL Token", "Transfer between invalid accounts");
+        }
+        if (!account_2 || !SolPubkey_same(&(source->owner), account_2->key)) {
+            return bench_fail("SPL Token", "Transfer not signed by owner");
+        }
+        if (source->amount < amount) {
+            return bench_fail("SPL Token", "Transfer of more tokens than are available");
+        }
+        source->amount -= amount;
+        destination->amount += amount;
+        return 0;
+    }
+
+    case 6: { // SetAuthority
+        SolanaMintAccountData *mint = bench_mint(account_0);
+        uint32_t authority_type;
+        memcpy(&authority_type, &(data[1]), sizeof(authority_type));
+        if (!mint || (authority_type != 0)) {
+            return bench_fail("SPL Token", "unsupported SetAuthority");
+        }
+        if (!mint->has_mint_authority || !account_1 || !SolPubkey_same(&(mint->mint_authority), account_1->key)) {
+            return bench_fail("SPL Token", "SetAuthority not signed by mint authority");
+        }
+        mint->has_mint_authority = data[5];
+        memcpy(&(mint->mint_authority), &(data[6]), sizeof(SolPubkey));
+        return 0;
+    }
+
+    case 7: { // MintTo
+        SolanaMintAccountData *mint = bench_mint(account_0);
+        SolanaTokenProgramTokenData *token = bench_token(account_1);
+        if (!mint || !token || !SolPubkey_same(&(token->mint), account_0->key)) {
+            return bench_fail("SPL Token", "MintTo invalid accounts");
+        }
+        if (!mint->has_mint_authority || !account_2 || !SolPubkey_same(&(mint->mint_authority), account_2->key)) {
+            return bench_fail("SPL Token", "MintTo not signed by mint authority");
+        }
+        mint->supply += amount;
+        token->amount += amount;
+        return 0;
+    }
+
+    case 8: { // Burn
+        SolanaTokenProgramTokenData *token = bench_token(account_0);
+        SolanaMintAccountData *mint = bench_mint(account_1);
+        if (!mint || !token || !SolPubkey_same(&(token->mint), account_1->key)) {
+            return bench_fail("SPL Token", "Burn invalid accounts");
+        }
+        if (!account_2 || !SolPubkey_same(&(token->owner), account_2->key)) {
+            return bench_fail("SPL Token", "Burn not signed by owner");
+        }
+        if (token->amount < amount) {
+            return bench_fail("SPL Token", "Burn of more tokens than are available");
+        }
+        token->amount -= amount;
+        mint->supply -= amount;
+        return 0;
+    }
+
+    case 9: { // CloseAccount
+        SolanaTokenProgramTokenData *token = bench_token(account_0);
+        if (!token || !account_1 || !account_1->is_writable) {
+            return bench_fail("SPL Token", "CloseAccount invalid accounts");
+        }
+        if (!account_2 || !SolPubkey_same(&(token->owner), account_2->key)) {
+            return bench_fail("SPL Token", "CloseAccount not signed by owner");
+        }
+        if (token->amount) {
+            return bench_fail("SPL Token", "CloseAccount of account holding tokens");
+        }
+        bench_move_lamports(account_0, account_1, *(account_0->lamports));
+        memset(account_0->data, 0, account_0->data_len);
+        return 0;
+    }
+
+    case 18: // InitializeAccount3
+        return bench_initialize_token(account_0, account_1, (SolPubkey *) &(data[1]));
+
+    case 20: { // InitializeMint2
+        if (!account_0 || !is_spl_token_program(account_0->owner) ||
+            (account_0->data_len != BENCH_MINT_ACCOUNT_SIZE) ||
+            ((SolanaMintAccountData *) account_0->data)->is_initialized) {
+            return bench_fail("SPL Token", "InitializeMint2 of invalid account");
+        }
+        SolanaMintAccountData *mint = (SolanaMintAccountData *) account_0->data;
+        mint->decimals = data[1];
+        mint->has_mint_authority = 1;
+        memcpy(&(mint->mint_authority), &(data[2]), sizeof(SolPubkey));
+        mint->has_freeze_authority = data[34];
+        memcpy(&(mint->freeze_authority), &(data[35]), sizeof(SolPubkey));
+        mint->is_initialized = true;
+        return 0;
+    }
+
+    default:
+        return bench_fail("SPL Token", "unsupported instruction");
+    }
+}
+
+
+// SPL Associated Token Account program --------------------------------------------------------------------------------
+
+static uint64_t bench_spl_ata_program(const SolInstruction *instruction)
+{
+    bench_stats.callee_units += bench_cost_model.spl_ata_program_units;
+
+    if ((instruction->data_len != 1) || (instruction->data[0] != 1)) {
+        return bench_fail("SPL ATA", "unsupported instruction");
+    }
+
+    SolAccountInfo *funding = bench_instruction_account(instruction, 0);
+    SolAccountInfo *account = bench_instruction_account(instruction, 1);
+    SolAccountInfo *owner = bench_instruction_account(instruction, 2);
+    SolAccountInfo *mint = bench_instruction_account(instruction, 3);
+
+    if (!funding || !account || !owner || !mint) {
+        return bench_fail("SPL ATA", "missing accounts");
+    }
+
+    // The associated token account address is derived from the owner, token program, and mint
+    SolSignerSeed seeds[] = { { owner->key->x, sizeof(SolPubkey) },
+                              { Constants.spl_token_program_pubkey.x, sizeof(SolPubkey) },
+                              { mint->key->x, sizeof(SolPubkey) } };
+    SolPubkey address;
+    bench_find_program_address(seeds, ARRAY_LEN(seeds), &(Constants.spl_associated_token_account_program_pubkey),
+                               &address);
+    if (!SolPubkey_same(&address, account->key)) {
+        return bench_fail("SPL ATA", "invalid associated token account address");
+    }
+
+    // CreateIdempotent succeeds without change if the account already exists
+    SolanaTokenProgramTokenData *token = bench_token(account);
+    if (token) {
+        if (!SolPubkey_same(&(token->mint), mint->key) || !SolPubkey_same(&(token->owner), owner->key)) {
+            return bench_fail("SPL ATA", "existing account has the wrong mint or owner");
+        }
+        return 0;
+    }
+
+    uint64_t ret = bench_create("SPL ATA", funding, account, &(Constants.spl_token_program_pubkey),
+                                BENCH_TOKEN_ACCOUNT_SIZE);
+    if (ret) {
+        return ret;
+    }
+
+    return bench_initialize_token(account, mint, owner->key);
+}
+
+
+// Metaplex Token Metadata program -------------------------------------------------------------------------------------
+
+// Returns the length of the Borsh encoded metadata data at [data], or 0 if it is not valid
+static uint32_t bench_metadata_data_len(const uint8_t *data, uint32_t data_len)
+{
+    uint32_t offset = 0;
+
+    // name, symbol, uri
+    for (int i = 0; i < 3; i++) {
+        uint32_t len;
+        if ((offset + 4) > data_len) {
+            return 0;
+        }
+        memcpy(&len, &(data[offset]), sizeof(len));
+        offset += 4 + len;
+    }
+
+    // seller_fee_basis_points, creators option
+    offset += 2;
+    if ((offset + 1) > data_len) {
+        return 0;
+    }
+    if (data[offset++]) {
+        uint32_t count;
+        if ((offset + 4) > data_len) {
+            return 0;
+        }
+        memcpy(&count, &(data[offset]), sizeof(count));
+        offset += 4 + (count * 34);
+    }
+
+    // collection option: { verified, key }
+    if ((offset + 1) > data_len) {
+        return 0;
+    }
+    if (data[offset++]) {
+        offset += 33;
+    }
+
+    // uses option: { use_method, remaining, total }
+    if ((offset + 1) > data_len) {
+        return 0;
+    }
+    if (data[offset++]) {
+        offset += 17;
+    }
+
+    return (offset <= data_len) ? offset : 0;
+}
+
+
+// The metadata account is { key = 4, update_authority, mint, data, primary_sale_happened, is_mutable }
+static uint64_t bench_metaplex_program(const SolInstruction *instruction)
+{
+    bench_stats.callee_units += bench_cost_model.metaplex_program_units;
+
+    if (instruction->data_len < 1) {
+        return bench_fail("Metaplex", "invalid instruction data");
+    }
+
+    SolAccountInfo *metadata = bench_instruction_account(instruction, 0);
+    if (!metadata || !metadata->is_writable) {
+        return bench_fail("Metaplex", "invalid metadata account");
+    }
+
+    const uint8_t *data = &(instruction->data[1]);
+    uint32_t data_len = instruction->data_len - 1;
+
+    switch (instruction->data[0]) {
+    case 7: { // SignMetadata
+        SolAccountInfo *creator = bench_instruction_account(instruction, 1);
+        uint8_t *d = &(metadata->data[1 + 32 + 32]);
+        uint32_t len = bench_metadata_data_len(d, metadata->data_len - (1 + 32 + 32));
+        if (!creator || !len) {
+            return bench_fail("Metaplex", "SignMetadata of invalid metadata");
+        }
+        // Skip name, symbol, uri, and seller_fee_basis_points to get to the creators
+        uint32_t offset = 0;
+        for (int i = 0; i < 3; i++) {
+            uint32_t string_len;
+            memcpy(&string_len, &(d[offset]), sizeof(string_len));
+            offset += 4 + string_len;
+        }
+        offset += 2;
+        if (d[offset++]) {
+            uint32_t count;
+            memcpy(&count, &(d[offset]), sizeof(count));
+            offset += 4;
+            for (uint32_t i = 0; i < count; i++, offset += 34) {
+                if (SolPubkey_same((SolPubkey *) &(d[offset]), creator->key)) {
+                    d[offset + 32] = 1;
+                    return 0;
+                }
+            }
+        }
+        return bench_fail("Metaplex", "SignMetadata by non-creator");
+    }
+
+    case 15: { // UpdateMetadataAccountV2
+        SolAccountInfo *authority = bench_instruction_account(instruction, 1);
+        if (!authority || !SolPubkey_same((SolPubkey *) &(metadata->data[1]), authority->key)) {
+            return bench_fail("Metaplex", "Update not signed by update authority");
+        }
+        uint32_t old_len = bench_metadata_data_len(&(metadata->data[1 + 32 + 32]),
+                                                   metadata->data_len - (1 + 32 + 32));
+        if (!old_len) {
+            return bench_fail("Metaplex", "Update of invalid metadata");
+        }
+        uint8_t primary_sale_happened = metadata->data[1 + 32 + 32 + old_len];
+        uint8_t is_mutable = metadata->data[1 + 32 + 32 + old_len + 1];
+        if (!is_mutable) {
+            return bench_fail("Metaplex", "Update of immutable metadata");
+        }
+        uint8_t new_data[BENCH_METAPLEX_METADATA_ACCOUNT_SIZE];
+        uint32_t new_len = old_len;
+        memcpy(new_data, &(metadata->data[1 + 32 + 32]), old_len);
+        // Option<Data>
+        if (data_len < 1) {
+            return bench_fail("Metaplex", "invalid Update data");
+        }
+        if (*data++) {
+            data_len -= 1;
+            new_len = bench_metadata_data_len(data, data_len);
+            if (!new_len || ((1 + 32 + 32 + new_len + 2) > BENCH_METAPLEX_METADATA_ACCOUNT_SIZE)) {
+                return bench_fail("Metaplex", "invalid Update data");
+            }
+            memcpy(new_data, data, new_len);
+            data += new_len, data_len -= new_len;
+        }
+        else {
+            data_len -= 1;
+        }
+        // Option<Pubkey> update_authority
+        if ((data_len >= 1) && *data++) {
+            memcpy(&(metadata->data[1]), data, sizeof(SolPubkey));
+            data += sizeof(SolPubkey);
+            data_len -= sizeof(SolPubkey);
+        }
+        data_len -= 1;
+        // Option<bool> primary_sale_happened
+        if ((data_len >= 1) && *data++) {
+            if (!*data && primary_sale_happened) {
+                return bench_fail("Metaplex", "primary_sale_happened cannot be unset");
+            }
+            primary_sale_happened = *data++;
+            data_len -= 1;
+        }
+        data_len -= 1;
+        // Option<bool> is_mutable
+        if ((data_len >= 1) && *data++) {
+            is_mutable = *data;
+        }
+        uint8_t *d = &(metadata->data[1 + 32 + 32]);
+        memset(d, 0, metadata->data_len - (1 + 32 + 32));
+        memcpy(d, new_data, new_len);
+        d[new_len] = primary_sale_happened;
+        d[new_len + 1] = is_mutable;
+        return 0;
+    }
+
+    case 16: { // CreateMetadataAccountV2
+        SolAccountInfo *mint = bench_instruction_account(instruction, 1);
+        SolAccountInfo *mint_authority = bench_instruction_account(instruction, 2);
+        SolAccountInfo *payer = bench_instruction_account(instruction, 3);
+        SolAccountInfo *update_authority = bench_instruction_account(instruction, 4);
+        if (!mint || !mint_authority || !payer || !update_authority) {
+            return bench_fail("Metaplex", "Create missing accounts");
+        }
+        SolanaMintAccountData *mint_data = bench_mint(mint);
+        if (!mint_data || !mint_data->has_mint_authority ||
+            !SolPubkey_same(&(mint_data->mint_authority), mint_authority->key)) {
+            return bench_fail("Metaplex", "Create not signed by mint authority");
+        }
+        // The real program also verifies that the metadata address is derived from "metadata", its program id, and
+        // the mint.  That is not checked here because the Ki and bid marker metadata addresses are fixed at build
+        // time from real program address derivation, which the harness cannot reproduce.
+        uint32_t len = bench_metadata_data_len(data, data_len);
+        if (!len || (data_len != (len + 1)) || ((1 + 32 + 32 + len + 2) > BENCH_METAPLEX_METADATA_ACCOUNT_SIZE)) {
+            return bench_fail("Metaplex", "invalid Create data");
+        }
+        uint64_t ret = bench_create("Metaplex", payer, metadata, &(Constants.metaplex_program_pubkey),
+                                    BENCH_METAPLEX_METADATA_ACCOUNT_SIZE);
+        if (ret) {
+            return ret;
+        }
+        uint8_t *d = metadata->data;
+        d[0] = 4; // Key::MetadataV1
+        memcpy(&(d[1]), update_authority->key, sizeof(SolPubkey));
+        memcpy(&(d[1 + 32]), mint->key, sizeof(SolPubkey));
+        memcpy(&(d[1 + 32 + 32]), data, len);
+        d[1 + 32 + 32 + len] = 0; // primary_sale_happened
+        d[1 + 32 + 32 + len + 1] = data[len]; // is_mutable
+        return 0;
+    }
+
+    default:
+        return bench_fail("Metaplex", "unsupported instruction");
+    }
+}
+
+
+// Dispatch ------------------------------------------------------------------------------------------------------------
+
+uint64_t bench_process_instruction(const SolInstruction *instruction, const SolAccountInfo *account_infos,
+                                   int account_infos_len)
+{
+    // Emulated programs write through the caller's account infos, just as the runtime updates the caller's view of
+    // accounts after an invoke
+    SolAccountInfo *saved_infos = bench_infos;
+    int saved_infos_len = bench_infos_len;
+    SolPubkey saved_program_id = bench_program_id;
+
+    bench_infos = (SolAccountInfo *) account_infos;
+    bench_infos_len = account_infos_len;
+    bench_program_id = *(instruction->program_id);
+
+    // An invoked program may only modify accounts that the instruction passes as writable
+    for (uint64_t i = 0; i < instruction->account_len; i++) {
+        SolAccountInfo *info = bench_info(instruction->accounts[i].pubkey);
+        if (instruction->accounts[i].is_writable && !info->is_writable) {
+            bench_infos = saved_infos, bench_infos_len = saved_infos_len, bench_program_id = saved_program_id;
+            return bench_fail("Runtime", "invoke passes read-only account as writable");
+        }
+    }
+
+    uint64_t ret;
+
+    const SolPubkey *program_id = instruction->program_id;
+
+    if (is_system_program(program_id)) {
+        ret = bench_system_program(instruction);
+    }
+    else if (is_stake_program(program_id)) {
+        ret = bench_stake_program(instruction);
+    }
+    else if (is_spl_token_program(program_id)) {
+        ret = bench_spl_token_program(instruction);
+    }
+    else if (SolPubkey_same(program_id, &(Constants.spl_associated_token_account_program_pubkey))) {
+        ret = bench_spl_ata_program(instruction);
+    }
+    else if (is_metaplex_metadata_program(program_id)) {
+        ret = bench_metaplex_program(instruction);
+    }
+    else {
+        ret = bench_fail("Runtime", "invoke of unknown program");
+    }
+
+    bench_infos = saved_infos;
+    bench_infos_len = saved_infos_len;
+    bench_program_id = saved_program_id;
+
+    return ret;
+}
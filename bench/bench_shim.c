@@ -0,0 +1,521 @@
+
+// Host implementations of the Solana syscalls and SDK functions that the program uses.  Each syscall charges compute
+// units according to bench_cost_model, into bench_stats.  Cross-program invocations are charged here and then handed
+// to the harness, which emulates the invoked program.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+
+// Limits that the runtime places on program address seeds
+#define MAX_SEEDS 16
+#define MAX_SEED_LEN 32
+
+// Maximum size of return data
+#define MAX_RETURN_DATA 1024
+
+
+BenchCostModel bench_cost_model =
+{
+    /* invoke_units */                      1000,
+    /* create_program_address_units */      1500,
+    /* sha256_base_cost */                  85,
+    /* sha256_byte_cost */                  1,
+    /* mem_op_base_cost */                  10,
+    /* syscall_base_cost */                 100,
+    /* sysvar_base_cost */                  100,
+    /* log_units */                         100,
+    /* log_64_units */                      100,
+    /* log_compute_units_units */           100,
+    /* cpi_bytes_per_unit */                250,
+    /* system_program_units */              150,
+    /* stake_program_units */               750,
+    /* spl_token_program_units */           4500,
+    /* spl_ata_program_units */             20000,
+    /* metaplex_program_units */            30000
+};
+
+BenchStats bench_stats;
+
+uint8_t bench_heap[HEAP_LENGTH] __attribute__((aligned(16)));
+
+Clock bench_clock;
+
+uint64_t bench_rent_lamports_per_byte_year = 3480;
+
+double bench_rent_exemption_threshold = 2.0;
+
+SolPubkey bench_program_id;
+
+static uint8_t return_data[MAX_RETURN_DATA];
+
+static uint64_t return_data_len;
+
+static SolPubkey return_data_program_id;
+
+
+static const struct
+{
+    const char *name;
+    uint64_t *value;
+} cost_names[] =
+{
+    { "invoke_units",                   &(bench_cost_model.invoke_units) },
+    { "create_program_address_units",   &(bench_cost_model.create_program_address_units) },
+    { "sha256_base_cost",               &(bench_cost_model.sha256_base_cost) },
+    { "sha256_byte_cost",               &(bench_cost_model.sha256_byte_cost) },
+    { "mem_op_base_cost",               &(bench_cost_model.mem_op_base_cost) },
+    { "syscall_base_cost",              &(bench_cost_model.syscall_base_cost) },
+    { "sysvar_base_cost",               &(bench_cost_model.sysvar_base_cost) },
+    { "log_units",                      &(bench_cost_model.log_units) },
+    { "log_64_units",                   &(bench_cost_model.log_64_units) },
+    { "log_compute_units_units",        &(bench_cost_model.log_compute_units_units) },
+    { "cpi_bytes_per_unit",             &(bench_cost_model.cpi_bytes_per_unit) },
+    { "system_program_units",           &(bench_cost_model.system_program_units) },
+    { "stake_program_units",            &(bench_cost_model.stake_program_units) },
+    { "spl_token_program_units",        &(bench_cost_model.spl_token_program_units) },
+    { "spl_ata_program_units",          &(bench_cost_model.spl_ata_program_units) },
+    { "metaplex_program_units",         &(bench_cost_model.metaplex_program_units) }
+};
+
+
+bool bench_set_cost(const char *name, uint64_t value)
+{
+    for (size_t i = 0; i < (sizeof(cost_names) / sizeof(cost_names[0])); i++) {
+        if (!strcmp(cost_names[i].name, name)) {
+            *(cost_names[i].value) = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void bench_print_cost_model(void)
+{
+    for (size_t i = 0; i < (sizeof(cost_names) / sizeof(cost_names[0])); i++) {
+        printf("%-32s %lu\n", cost_names[i].name, (unsigned long) *(cost_names[i].value));
+    }
+}
+
+
+// SHA-256 -------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    uint32_t state[8];
+
+    uint64_t total_len;
+
+    uint8_t block[64];
+
+    uint32_t block_len;
+
+} Sha256;
+
+
+static const uint32_t sha256_k[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+
+static void sha256_transform(Sha256 *sha, const uint8_t *block)
+{
+    uint32_t w[64];
+
+    for (int i = 0; i < 16; i++) {
+        w[i] = (((uint32_t) block[i * 4]) << 24) | (((uint32_t) block[(i * 4) + 1]) << 16) |
+            (((uint32_t) block[(i * 4) + 2]) << 8) | ((uint32_t) block[(i * 4) + 3]);
+    }
+
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = sha->state[0], b = sha->state[1], c = sha->state[2], d = sha->state[3];
+    uint32_t e = sha->state[4], f = sha->state[5], g = sha->state[6], h = sha->state[7];
+
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g, g = f, f = e, e = d + t1, d = c, c = b, b = a, a = t1 + t2;
+    }
+
+    sha->state[0] += a, sha->state[1] += b, sha->state[2] += c, sha->state[3] += d;
+    sha->state[4] += e, sha->state[5] += f, sha->state[6] += g, sha->state[7] += h;
+}
+
+
+static void sha256_init(Sha256 *sha)
+{
+    static const uint32_t initial_state[8] =
+        { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+    memcpy(sha->state, initial_state, sizeof(initial_state));
+    sha->total_len = 0;
+    sha->block_len = 0;
+}
+
+
+static void sha256_update(Sha256 *sha, const uint8_t *data, uint64_t len)
+{
+    sha->total_len += len;
+
+    while (len--) {
+        sha->block[sha->block_len++] = *data++;
+        if (sha->block_len == sizeof(sha->block)) {
+            sha256_transform(sha, sha->block);
+            sha->block_len = 0;
+        }
+    }
+}
+
+
+static void sha256_final(Sha256 *sha, uint8_t *result)
+{
+    uint64_t bit_len = sha->total_len * 8;
+
+    uint8_t pad = 0x80;
+    sha256_update(sha, &pad, 1);
+
+    pad = 0;
+    while (sha->block_len != 56) {
+        sha256_update(sha, &pad, 1);
+    }
+
+    uint8_t length[8];
+    for (int i = 0; i < 8; i++) {
+        length[i] = (uint8_t) (bit_len >> (56 - (i * 8)));
+    }
+    sha256_update(sha, length, sizeof(length));
+
+    for (int i = 0; i < 8; i++) {
+        result[i * 4] = (uint8_t) (sha->state[i] >> 24);
+        result[(i * 4) + 1] = (uint8_t) (sha->state[i] >> 16);
+        result[(i * 4) + 2] = (uint8_t) (sha->state[i] >> 8);
+        result[(i * 4) + 3] = (uint8_t) sha->state[i];
+    }
+}
+
+
+void bench_sha256(const SolBytes *bytes, int bytes_len, uint8_t *result)
+{
+    Sha256 sha;
+
+    sha256_init(&sha);
+
+    for (int i = 0; i < bytes_len; i++) {
+        sha256_update(&sha, bytes[i].addr, bytes[i].len);
+    }
+
+    sha256_final(&sha, result);
+}
+
+
+// Program addresses ---------------------------------------------------------------------------------------------------
+
+bool bench_derive_address(const SolSignerSeed *seeds, int seeds_len, const SolPubkey *program_id,
+                          SolPubkey *address)
+{
+    if (seeds_len > MAX_SEEDS) {
+        return false;
+    }
+
+    Sha256 sha;
+
+    sha256_init(&sha);
+
+    for (int i = 0; i < seeds_len; i++) {
+        if (seeds[i].len > MAX_SEED_LEN) {
+            return false;
+        }
+        sha256_update(&sha, seeds[i].addr, seeds[i].len);
+    }
+
+    sha256_update(&sha, program_id->x, sizeof(program_id->x));
+
+    sha256_update(&sha, (const uint8_t *) "ProgramDerivedAddress", 21);
+
+    sha256_final(&sha, address->x);
+
+    // Stand-in for the ed25519 curve check, which rejects about half of all hashes
+    return !(address->x[31] & 1);
+}
+
+
+uint8_t bench_find_program_address(const SolSignerSeed *seeds, int seeds_len, const SolPubkey *program_id,
+                                   SolPubkey *address)
+{
+    SolSignerSeed bump_seeds[MAX_SEEDS + 1];
+
+    memcpy(bump_seeds, seeds, sizeof(SolSignerSeed) * seeds_len);
+
+    for (int bump_seed = 255; bump_seed > 0; bump_seed--) {
+        uint8_t bump = (uint8_t) bump_seed;
+        bump_seeds[seeds_len].addr = &bump;
+        bump_seeds[seeds_len].len = sizeof(bump);
+        if (bench_derive_address(bump_seeds, seeds_len + 1, program_id, address)) {
+            return bump;
+        }
+    }
+
+    fprintf(stderr, "No valid bump seed\n");
+
+    return 0;
+}
+
+
+// SDK functions -------------------------------------------------------------------------------------------------------
+
+void *sol_memcpy(void *dst, const void *src, int len)
+{
+    uint8_t *d = (uint8_t *) dst;
+    const uint8_t *s = (const uint8_t *) src;
+
+    while (len-- > 0) {
+        *d++ = *s++;
+    }
+
+    return dst;
+}
+
+
+void *sol_memset(void *b, int c, size_t len)
+{
+    uint8_t *a = (uint8_t *) b;
+
+    while (len--) {
+        *a++ = (uint8_t) c;
+    }
+
+    return b;
+}
+
+
+int sol_memcmp(const void *s1, const void *s2, int n)
+{
+    const uint8_t *a = (const uint8_t *) s1;
+    const uint8_t *b = (const uint8_t *) s2;
+
+    for (int i = 0; i < n; i++) {
+        if (a[i] != b[i]) {
+            return a[i] - b[i];
+        }
+    }
+
+    return 0;
+}
+
+
+size_t sol_strlen(const char *s)
+{
+    size_t len = 0;
+
+    while (*s++) {
+        len++;
+    }
+
+    return len;
+}
+
+
+// Syscalls ------------------------------------------------------------------------------------------------------------
+
+static uint64_t max_u64(uint64_t a, uint64_t b)
+{
+    return (a > b) ? a : b;
+}
+
+
+uint64_t sol_sha256(const SolBytes *bytes, int bytes_len, uint8_t *result)
+{
+    bench_stats.syscall_units += bench_cost_model.sha256_base_cost;
+
+    for (int i = 0; i < bytes_len; i++) {
+        bench_stats.syscall_units += max_u64(bench_cost_model.mem_op_base_cost,
+                                             bench_cost_model.sha256_byte_cost * (bytes[i].len / 2));
+    }
+
+    bench_stats.sha256_count += 1;
+
+    bench_sha256(bytes, bytes_len, result);
+
+    return 0;
+}
+
+
+uint64_t sol_create_program_address(const SolSignerSeed *seeds, int seeds_len, const SolPubkey *program_id,
+                                    SolPubkey *program_address)
+{
+    bench_stats.syscall_units += bench_cost_model.create_program_address_units;
+
+    bench_stats.pda_count += 1;
+
+    return bench_derive_address(seeds, seeds_len, program_id, program_address) ? 0 : 1;
+}
+
+
+uint64_t sol_try_find_program_address(const SolSignerSeed *seeds, int seeds_len, const SolPubkey *program_id,
+                                      SolPubkey *program_address, uint8_t *bump_seed)
+{
+    if (seeds_len >= MAX_SEEDS) {
+        return 1;
+    }
+
+    SolSignerSeed bump_seeds[MAX_SEEDS];
+
+    memcpy(bump_seeds, seeds, sizeof(SolSignerSeed) * seeds_len);
+
+    // The runtime charges for every bump seed tried
+    for (int bump = 255; bump > 0; bump--) {
+        *bump_seed = (uint8_t) bump;
+        bump_seeds[seeds_len].addr = bump_seed;
+        bump_seeds[seeds_len].len = sizeof(*bump_seed);
+        if (!sol_create_program_address(bump_seeds, seeds_len + 1, program_id, program_address)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+uint64_t sol_get_clock_sysvar(void *ret)
+{
+    bench_stats.syscall_units += bench_cost_model.sysvar_base_cost + sizeof(Clock);
+
+    memcpy(ret, &bench_clock, sizeof(Clock));
+
+    return 0;
+}
+
+
+uint64_t sol_get_rent_sysvar(void *ret)
+{
+    // The Rent sysvar is { u64 lamports_per_byte_year, f64 exemption_threshold, u8 burn_percent }, 24 bytes with
+    // padding
+    uint8_t rent[24];
+
+    memset(rent, 0, sizeof(rent));
+    memcpy(&(rent[0]), &bench_rent_lamports_per_byte_year, sizeof(uint64_t));
+    memcpy(&(rent[8]), &bench_rent_exemption_threshold, sizeof(double));
+    rent[16] = 50;
+
+    bench_stats.syscall_units += bench_cost_model.sysvar_base_cost + sizeof(rent);
+
+    memcpy(ret, rent, sizeof(rent));
+
+    return 0;
+}
+
+
+void sol_set_return_data(const uint8_t *data, uint64_t length)
+{
+    if (length > MAX_RETURN_DATA) {
+        length = MAX_RETURN_DATA;
+    }
+
+    memcpy(return_data, data, length);
+
+    return_data_len = length;
+
+    return_data_program_id = bench_program_id;
+}
+
+
+uint64_t sol_get_return_data(uint8_t *data, uint64_t length, SolPubkey *program_id)
+{
+    bench_stats.syscall_units += bench_cost_model.syscall_base_cost +
+        ((length + sizeof(SolPubkey)) / bench_cost_model.cpi_bytes_per_unit);
+
+    if (length > return_data_len) {
+        length = return_data_len;
+    }
+
+    memcpy(data, return_data, length);
+
+    *program_id = return_data_program_id;
+
+    return return_data_len;
+}
+
+
+void sol_log_(const char *message, uint64_t length)
+{
+    (void) message;
+
+    bench_stats.syscall_units += max_u64(bench_cost_model.log_units, length);
+}
+
+
+void sol_log_64_(uint64_t arg1, uint64_t arg2, uint64_t arg3, uint64_t arg4, uint64_t arg5)
+{
+    (void) arg1, (void) arg2, (void) arg3, (void) arg4, (void) arg5;
+
+    bench_stats.syscall_units += bench_cost_model.log_64_units;
+}
+
+
+void sol_log_compute_units_(void)
+{
+    bench_stats.syscall_units += bench_cost_model.log_compute_units_units;
+}
+
+
+uint64_t sol_invoke_signed(const SolInstruction *instruction, const SolAccountInfo *account_infos,
+                           int account_infos_len, const SolSignerSeeds *signers_seeds, int signers_seeds_len)
+{
+    (void) signers_seeds, (void) signers_seeds_len;
+
+    uint64_t units = bench_cost_model.invoke_units + (instruction->data_len / bench_cost_model.cpi_bytes_per_unit);
+
+    uint64_t bytes = instruction->data_len;
+
+    // Every account referenced by the instruction must have been passed in, and the data of each is charged for
+    for (uint64_t i = 0; i < instruction->account_len; i++) {
+        int j;
+        for (j = 0; j < account_infos_len; j++) {
+            if (SolPubkey_same(instruction->accounts[i].pubkey, account_infos[j].key)) {
+                break;
+            }
+        }
+        if (j == account_infos_len) {
+            fprintf(stderr, "Cross-program invocation references an account that was not passed in\n");
+            return 1;
+        }
+        // The program decodes account infos lazily, and the runtime would read the fields of an account info that was
+        // never decoded as garbage, so every account that the invocation references must have been requested first
+        if (!account_infos[j].lamports) {
+            fprintf(stderr, "Cross-program invocation references account %d, which was not requested first\n", j);
+            exit(1);
+        }
+        units += account_infos[j].data_len / bench_cost_model.cpi_bytes_per_unit;
+        bytes += account_infos[j].data_len;
+    }
+
+    bench_stats.cpi_count += 1;
+    bench_stats.cpi_units += units;
+    bench_stats.cpi_bytes += bytes;
+
+    // Return data is cleared by every invoke
+    return_data_len = 0;
+
+    return bench_process_instruction(instruction, account_infos, account_infos_len);
+}
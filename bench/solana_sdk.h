@@ -0,0 +1,134 @@
+#pragma once
+
+// Host replacement for the Solana SDK's solana_sdk.h, used only by the benchmark harness.  It declares the same types
+// and functions that the program uses from the SDK, with the same layouts as the BPF SDK, so that program/entrypoint.c
+// can be compiled unmodified for the host.  The functions are implemented by bench_shim.c.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define SIZE_PUBKEY 32
+
+typedef struct
+{
+    uint8_t x[SIZE_PUBKEY];
+} SolPubkey;
+
+
+typedef struct
+{
+    SolPubkey *key;
+    uint64_t *lamports;
+    uint64_t data_len;
+    uint8_t *data;
+    SolPubkey *owner;
+    uint64_t rent_epoch;
+    bool is_signer;
+    bool is_writable;
+    bool executable;
+} SolAccountInfo;
+
+
+typedef struct
+{
+    SolAccountInfo *ka;
+    uint64_t ka_num;
+    const uint8_t *data;
+    uint64_t data_len;
+    const SolPubkey *program_id;
+} SolParameters;
+
+
+typedef struct
+{
+    const uint8_t *addr;
+    uint64_t len;
+} SolSignerSeed;
+
+
+typedef struct
+{
+    const SolSignerSeed *addr;
+    uint64_t len;
+} SolSignerSeeds;
+
+
+typedef struct
+{
+    SolPubkey *pubkey;
+    bool is_writable;
+    bool is_signer;
+} SolAccountMeta;
+
+
+typedef struct
+{
+    SolPubkey *program_id;
+    SolAccountMeta *accounts;
+    uint64_t account_len;
+    uint8_t *data;
+    uint64_t data_len;
+} SolInstruction;
+
+
+typedef struct
+{
+    const uint8_t *addr;
+    uint64_t len;
+} SolBytes;
+
+
+static bool SolPubkey_same(const SolPubkey *one, const SolPubkey *two)
+{
+    for (int i = 0; i < SIZE_PUBKEY; i++) {
+        if (one->x[i] != two->x[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// The runtime allows account data to grow by this much during an instruction, and so reserves this much space after
+// each account's data in the serialized input
+#define MAX_PERMITTED_DATA_INCREASE (10 * 1024)
+
+// The runtime provides each program invocation with a zeroed heap of HEAP_LENGTH bytes at HEAP_START_ADDRESS.  The
+// shim provides bench_heap, which the harness zeroes before each instruction.
+extern uint8_t bench_heap[];
+#define HEAP_START_ADDRESS ((uint64_t) bench_heap)
+#define HEAP_LENGTH (32 * 1024)
+
+// Memory functions.  These are loops in the SDK rather than syscalls, so the shim does not charge for them.
+extern void *sol_memcpy(void *dst, const void *src, int len);
+extern void *sol_memset(void *b, int c, size_t len);
+extern int sol_memcmp(const void *s1, const void *s2, int n);
+extern size_t sol_strlen(const char *s);
+
+// Syscalls
+extern uint64_t sol_sha256(const SolBytes *bytes, int bytes_len, uint8_t *result);
+extern uint64_t sol_create_program_address(const SolSignerSeed *seeds, int seeds_len, const SolPubkey *program_id,
+                                           SolPubkey *program_address);
+extern uint64_t sol_try_find_program_address(const SolSignerSeed *seeds, int seeds_len, const SolPubkey *program_id,
+                                             SolPubkey *program_address, uint8_t *bump_seed);
+extern uint64_t sol_invoke_signed(const SolInstruction *instruction, const SolAccountInfo *account_infos,
+                                  int account_infos_len, const SolSignerSeeds *signers_seeds, int signers_seeds_len);
+extern uint64_t sol_get_return_data(uint8_t *data, uint64_t length, SolPubkey *program_id);
+extern void sol_set_return_data(const uint8_t *data, uint64_t length);
+extern void sol_log_(const char *message, uint64_t length);
+extern void sol_log_64_(uint64_t arg1, uint64_t arg2, uint64_t arg3, uint64_t arg4, uint64_t arg5);
+extern void sol_log_compute_units_(void);
+
+#define sol_log(message) sol_log_(message, sol_strlen(message))
+#define sol_log_64 sol_log_64_
+#define sol_log_compute_units() sol_log_compute_units_()
+
+
+static uint64_t sol_invoke(const SolInstruction *instruction, const SolAccountInfo *account_infos,
+                           int account_infos_len)
+{
+    return sol_invoke_signed(instruction, account_infos, account_infos_len, 0, 0);
+}
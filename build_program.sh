@@ -40,6 +40,7 @@ $SDK_ROOT/bpf/dependencies/bpf-tools/llvm/bin/clang
     -I$SOURCE_ROOT/program                                                                \
     -o program.po                                                                         \
     -c $SOURCE_ROOT/program/entrypoint.c                                                  \
+    ${SHINOBI_PROFILE:+-DSHINOBI_PROFILE}                                                 \
     -DSUPERUSER_PUBKEY_ARRAY="$SUPERUSER_PUBKEY_C_ARRAY"                                  \
     -DCONFIG_PUBKEY_ARRAY="$CONFIG_PUBKEY_C_ARRAY"                                        \
     -DCONFIG_BUMP_SEED="$CONFIG_BUMP_SEED"                                                \
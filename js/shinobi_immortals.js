@@ -4,13 +4,19 @@ const SolanaWeb3 = require("@solana/web3.js");
 const Buffer = require("buffer");
 const bs58 = require("bs58");
 const { _buy_tx,
+        _buy_and_stake_with_vote_account_tx,
         _refund_tx,
         _bid_tx,
+        _escrowed_bid_tx,
         _claim_losing_tx,
+        _claim_losing_many_tx,
         _claim_winning_tx,
+        _claim_escrowed_winning_tx,
+        _claim_winning_and_stake_with_vote_account_tx,
         _stake_with_vote_account_tx,
         _destake_tx,
         _harvest_tx,
+        _harvest_many_tx,
         _level_up_tx
       } = require("./tx.js");
 
@@ -963,16 +969,25 @@ class Block
         this.mystery_start_price_lamports = buffer_le_u64(data, 24);
         this.reveal_period_duration = buffer_le_u32(data, 32);
         this.minimum_price_lamports = buffer_le_u64(data, 40);
-        this.has_auction = buffer_le_u32(data, 48);
+        this.has_auction = data[48];
+        this.escrow_bids = data[49];
         this.duration = buffer_le_u32(data, 52);
         this.non_auction_start_price_lamports = buffer_le_u64(data, 56);
         this.whitelist_duration = buffer_le_u32(data, 64);
-        this.added_entries_count = buffer_le_u16(data, 72);
-        this.block_start_timestamp = Number(buffer_le_s64(data, 80));
-        this.mysteries_sold_count = buffer_le_u16(data, 88);
-        this.mystery_phase_end_timestamp = Number(buffer_le_s64(data, 96));
-        this.commission = buffer_le_u16(data, 104);
-        this.last_commission_change_epoch = Number(buffer_le_u64(data, 112));
+        this.whitelist_slot_count = buffer_le_u16(data, 68);
+        this.whitelist_merkle_root = buffer_sha256(data, 70);
+        this.reveal_merkle_root = buffer_sha256(data, 102);
+        this.added_entries_count = buffer_le_u16(data, 136);
+        this.block_start_timestamp = Number(buffer_le_s64(data, 144));
+        this.mysteries_sold_count = buffer_le_u16(data, 152);
+        this.mystery_phase_end_timestamp = Number(buffer_le_s64(data, 160));
+        this.commission = buffer_le_u16(data, 168);
+        this.last_commission_change_epoch = Number(buffer_le_u64(data, 176));
+        this.whitelist_claimed_count = buffer_le_u16(data, 184);
+        this.uri_prefixes = [ ];
+        for (let i = 0; i < 4; i += 1) {
+            this.uri_prefixes[i] = buffer_string(data, 186 + (i * 96), 96);
+        }
     }
 
     update(data)
@@ -1008,6 +1023,11 @@ class Block
             changed = true;
         }
 
+        if (new_block.whitelist_claimed_count != this.whitelist_claimed_count) {
+            this.whitelist_claimed_count = new_block.whitelist_claimed_count;
+            changed = true;
+        }
+
         return changed;
     }
 
@@ -1066,6 +1086,7 @@ class Entry
         this.metaplex_metadata_address = buffer_address(data, 110);
         this.minimum_price_lamports = buffer_le_u64(data, 144);
         this.has_auction = data[152];
+        this.escrow_bids = data[153];
         this.duration = buffer_le_u32(data, 156);
         this.non_auction_start_price_lamports = buffer_le_u64(data, 160);
         this.reveal_sha256 = buffer_sha256(data, 168);
@@ -1074,18 +1095,19 @@ class Entry
         this.refund_awarded = data[216];
         this.commission = buffer_le_u16(data, 218);
         this.auction_highest_bid_lamports = buffer_le_u64(data, 224);
+        // If escrow_bids is true, this is instead the address of the bidder of the highest bid, which the entry
+        // holds in escrow
         this.auction_winning_bid_address = buffer_address(data, 232);
         this.owned_stake_account = buffer_address(data, 264);
         this.owned_stake_initial_lamports = buffer_le_u64(data, 296);
         this.owned_stake_epoch = Number(buffer_le_u64(data, 304));
         this.owned_last_ki_harvest_stake_account_lamports = buffer_le_u64(data, 312);
         this.owned_last_commission_charge_stake_account_lamports = buffer_le_u64(data, 320);
-        this.level = data[328];
+        this.owned_accrued_commission_lamports = buffer_le_u64(data, 328);
+        this.level = data[336];
         
-        this.metadata_level_1_ki = buffer_le_u32(data, 332);
-        this.metadata_random = [ buffer_le_u32(data, 336),
-                                 buffer_le_u32(data, 340),
-                                 buffer_le_u32(data, 344),
+        this.metadata_level_1_ki = buffer_le_u32(data, 340);
+        this.metadata_random = [ buffer_le_u32(data, 344),
                                  buffer_le_u32(data, 348),
                                  buffer_le_u32(data, 352),
                                  buffer_le_u32(data, 356),
@@ -1098,19 +1120,18 @@ class Entry
                                  buffer_le_u32(data, 384),
                                  buffer_le_u32(data, 388),
                                  buffer_le_u32(data, 392),
-                                 buffer_le_u32(data, 396) ];
-        this.level_metadata = [ ];
-        
-        for (let i = 0; i < 9; i += 1) {
-            this.level_metadata[i] = {
-                form : data[400 + (i * 292)],
-                skill : data[404 + (i * 292)],
-                ki_factor : buffer_le_u32(data, 408 + (i * 292)),
-                name : buffer_string(data, 412 + (i * 292), 48),
-                uri : buffer_string(data, 460 + (i * 292), 200),
-                uri_contents_sha256 : buffer_sha256(data, 660 + (i * 292))
-            };
-        }
+                                 buffer_le_u32(data, 396),
+                                 buffer_le_u32(data, 400),
+                                 buffer_le_u32(data, 404) ];
+        this.level_metadata_merkle_root = buffer_sha256(data, 408);
+        // Only the values of the current level are stored in the entry; the metadata of all levels is committed to by
+        // level_metadata_merkle_root
+        this.current_level = {
+            form : buffer_le_u32(data, 440),
+            skill : data[444],
+            ki_factor : buffer_le_u32(data, 448)
+        };
+        this.second_metaplex_metadata_creator = buffer_address(data, 456);
     }
 
     update(data)
@@ -1179,37 +1200,21 @@ class Entry
                 new_entry.owned_last_commission_charge_stake_account_lamports;
             changed = true;
         }
+
+        if (new_entry.owned_accrued_commission_lamports != this.owned_accrued_commission_lamports) {
+            this.owned_accrued_commission_lamports = new_entry.owned_accrued_commission_lamports;
+            changed = true;
+        }
         
         if (new_entry.level != this.level) {
             this.level = new_entry.level;
             changed = true;
         }
 
-        let new_level_metadata = [ ];
-
-        let level_metadata_changed = false;
-        
-        for (let i = 0; i < 9; i += 1) {
-            new_level_metadata[i] = {
-                form : data[400 + (i * 292)],
-                skill : data[404 + (i * 292)],
-                ki_factor : buffer_le_u32(data, 408 + (i * 292)),
-                name : buffer_string(data, 412 + (i * 292), 48),
-                uri : buffer_string(data, 460 + (i * 292), 200),
-                uri_contents_sha256 : buffer_sha256(data, 660 + (i * 292))
-            };
-            if ((new_level_metadata[i].form != this.level_metadata[i].form) ||
-                (new_level_metadata[i].skill != this.level_metadata[i].skill) ||
-                (new_level_metadata[i].ki_factor != this.level_metadata[i].ki_factor) ||
-                (new_level_metadata[i].name != this.level_metadata[i].name) ||
-                (new_level_metadata[i].uri != this.level_metadata[i].uri) ||
-                (new_level_metadata[i].uri_contents_sha256 != this.level_metadata[i].uri_contents_sha256)) {
-                level_metadata_changed = true;
-            }
-        }
-
-        if (level_metadata_changed) {
-            this.level_metadata = new_level_metadata;
+        if ((new_entry.current_level.form != this.current_level.form) ||
+            (new_entry.current_level.skill != this.current_level.skill) ||
+            (new_entry.current_level.ki_factor != this.current_level.ki_factor)) {
+            this.current_level = new_entry.current_level;
             changed = true;
         }
 
@@ -1358,8 +1363,10 @@ class Entry
 
         let stake = buffer_le_u64(result.data, 0);
 
-        return (((Number(stake - this.owned_last_ki_harvest_stake_account_lamports) *
-                  this.level_metadata[this.level].ki_factor) / LAMPORTS_PER_SOL) | 0);
+        // Accrued commission is still in the stake account but is not harvested on; see compute_ki_harvest()
+        return (((Number(stake - this.owned_accrued_commission_lamports -
+                         this.owned_last_ki_harvest_stake_account_lamports) *
+                  this.current_level.ki_factor) / LAMPORTS_PER_SOL) | 0);
     }
 
     // Private implementation follows ---------------------------------------------------------------------------------
@@ -1529,7 +1536,9 @@ class Wallet
     }
 
     // Returns an iterator over { entry_address, bid_address, lamports }.  lamports is the number of lamports in the
-    // bid account, which could be more than the bid if lamports were added post-bid.
+    // bid account, which could be more than the bid if lamports were added post-bid.  A bid that was refunded when it
+    // was outbid has 0 lamports, and is still returned so that its bid marker token account can be reclaimed by
+    // claiming it as a losing bid.
     async get_bids()
     {
         await this.update_token_data();
@@ -1605,6 +1614,9 @@ class Wallet
             let new_bids_by_entry_address = new Map();
 
             let new_bids_by_entry_mint = new Map();
+
+            // Bid marker token accounts whose bid accounts no longer exist
+            let orphaned_bid_marker_token_addresses = new Set();
             
             let promises = [ ];
 
@@ -1635,7 +1647,8 @@ class Wallet
                 // If its mint is the bid mint, then it's a bid token, so add an async function to fetch the
                 // details of the bid and add it to new_bids_by_entry_address
                 if (mint_address == g_bid_marker_mint_address) {
-                    promises.push(this.process_bid(address, new_bids_by_entry_address, new_bids_by_entry_mint));
+                    promises.push(this.process_bid(address, new_bids_by_entry_address, new_bids_by_entry_mint,
+                                                   orphaned_bid_marker_token_addresses));
                 }
                 // Else if its mint is the ki mint, then add its ki tokens to the total
                 else if (mint_address == g_ki_mint_address) {
@@ -1652,6 +1665,25 @@ class Wallet
 
             await Promise.all(promises);
 
+            // A bid marker token account does not record its entry, so the entries of bid marker token accounts
+            // whose bids were refunded when outbid are found by checking the bid marker token address of every entry
+            if (orphaned_bid_marker_token_addresses.size > 0) {
+                for (let iter = this.cluster.entry_iter(); !iter.done(); ) {
+                    let entry = iter.value();
+                    if (entry == null) {
+                        continue;
+                    }
+                    let bid_marker_token_address = get_bid_marker_token_address(entry.mint_address, wallet_address);
+                    if (orphaned_bid_marker_token_addresses.has(bid_marker_token_address)) {
+                        let value = { entry_address : entry.address,
+                                      bid_address : get_bid_address(bid_marker_token_address),
+                                      lamports : 0 };
+                        new_bids_by_entry_address.set(entry.address, value);
+                        new_bids_by_entry_mint.set(entry.mint_address, value);
+                    }
+                }
+            }
+
             // Now rebuild this.ki_balance, this.entry_addresses, this.bids_by_entry_address, and
             // this.bids_by_entry_mint from the resulting data
             if (wallet_address_holder == this.wallet_address_holder) {
@@ -1757,7 +1789,8 @@ class Wallet
         }
     }
 
-    async process_bid(bid_marker_token_address, bids_by_entry_address, bids_by_entry_mint)
+    async process_bid(bid_marker_token_address, bids_by_entry_address, bids_by_entry_mint,
+                      orphaned_bid_marker_token_addresses)
     {
         let bid_address = get_bid_address(bid_marker_token_address);
         
@@ -1771,6 +1804,13 @@ class Wallet
                                                      });
             }, "fetch bid account");
 
+        // The bid account no longer exists if the bid was refunded when it was outbid, but the bid marker token account
+        // is still left to reclaim
+        if (result == null) {
+            orphaned_bid_marker_token_addresses.add(bid_marker_token_address);
+            return;
+        }
+
         let entry_mint_address = buffer_address(result.data, 0);
 
         let entry_address = get_entry_address(entry_mint_address);
@@ -1832,10 +1872,29 @@ class Wallet
     //         with an updated version of the transaction
     
     // Returns the string transaction id of the completed transaction.  Throws an error on all failures.
-    async buy_entry(entry, maximum_price_lamports, sign_callback)
+    // If the entry's block has a Merkle whitelist (entry.block.whitelist_slot_count > 0) and is in its whitelist
+    // period, whitelist_leaf must be the wallet's leaf of the whitelist, as published by the admin:
+    //    { first_slot : <number>, allowance : <number>, proof : [ <hex string of each proof hash> ] }
+    async buy_entry(entry, maximum_price_lamports, sign_callback, whitelist_leaf)
     {
         return this.complete_tx((wallet_address) => {
-            return this.make_buy_tx(entry, maximum_price_lamports, wallet_address);
+            return this.make_buy_tx(entry, maximum_price_lamports, wallet_address, whitelist_leaf);
+        }, sign_callback);
+    }
+
+    // Buys an entry that has already been revealed and stakes it to stake_account in the same transaction.  The
+    // wallet must be the withdraw authority of the stake account.
+    async buy_and_stake_entry(entry, maximum_price_lamports, stake_account, sign_callback, whitelist_leaf)
+    {
+        let vote_account = await this.get_shinobi_systems_vote_account();
+
+        if (vote_account == null) {
+            throw new Error("Shinobi Immortals vote account does not exist");
+        }
+
+        return this.complete_tx((wallet_address) => {
+            return this.make_buy_and_stake_with_vote_account_tx(entry, maximum_price_lamports, stake_account,
+                                                                vote_account, wallet_address, whitelist_leaf);
         }, sign_callback);
     }
 
@@ -1860,6 +1919,31 @@ class Wallet
         }, sign_callback);
     }
 
+    // Claims the losing bids of the wallet on all of the given entries, reclaiming their bid marker tokens, in one
+    // transaction
+    async claim_losing_entries(entries, sign_callback)
+    {
+        return this.complete_tx((wallet_address) => {
+            return this.make_claim_losing_many_tx(entries, wallet_address);
+        }, sign_callback);
+    }
+
+    // Claims the winning bid of an entry and stakes the entry to stake_account in the same transaction.  The wallet
+    // must be the withdraw authority of the stake account.
+    async claim_and_stake_entry(entry, stake_account, sign_callback)
+    {
+        let vote_account = await this.get_shinobi_systems_vote_account();
+
+        if (vote_account == null) {
+            throw new Error("Shinobi Immortals vote account does not exist");
+        }
+
+        return this.complete_tx((wallet_address) => {
+            return this.make_claim_winning_and_stake_with_vote_account_tx(entry, stake_account, vote_account,
+                                                                          wallet_address);
+        }, sign_callback);
+    }
+
     async stake_entry(entry, stake_account, sign_callback)
     {
         let vote_account = await this.get_shinobi_systems_vote_account();
@@ -1887,33 +1971,109 @@ class Wallet
         }, sign_callback);
     }
     
-    async level_up_entry(entry, sign_callback)
+    // Harvests the Ki of all of the given entries, which must all be staked and owned by the wallet, in one transaction
+    async harvest_entries(entries, sign_callback)
+    {
+        return this.complete_tx((wallet_address) => {
+            return this.make_harvest_many_tx(entries, wallet_address);
+        }, sign_callback);
+    }
+    
+    // level_metadata_proof is the bytes of the LevelMetadataProof of the level after the entry's current level, as
+    // published for the entry's block
+    async level_up_entry(entry, level_metadata_proof, sign_callback)
+    {
+        return this.complete_tx((wallet_address) => {
+            return this.make_level_up_tx(entry, 0, level_metadata_proof, wallet_address);
+        }, sign_callback);
+    }
+    
+    // Levels up the entry to target_level, which may be any level above the entry's current level, burning the Ki of
+    // all of the levels in between.  level_metadata_proof is the bytes of the LevelMetadataProof of target_level, as
+    // published for the entry's block.
+    async level_up_entry_to(entry, target_level, level_metadata_proof, sign_callback)
     {
         return this.complete_tx((wallet_address) => {
-            return this.make_level_up_tx(entry, wallet_address);
+            return this.make_level_up_tx(entry, target_level, level_metadata_proof, wallet_address);
         }, sign_callback);
     }
     
     // Private implementation follows ---------------------------------------------------------------------------------
 
-    async make_buy_tx(entry, maximum_price_lamports, wallet_address)
+    async make_buy_tx(entry, maximum_price_lamports, wallet_address, whitelist_leaf)
     {
         let admin_address = await this.fetch_admin_address();
 
         let token_destination_address = get_associated_token_address(wallet_address, entry.mint_address);
 
+        // A block with a Merkle whitelist uses no whitelist accounts, so its own address is supplied in their place
+        let whitelist_address, whitelist_shard_address;
+        if (entry.block.whitelist_slot_count > 0) {
+            whitelist_address = entry.block.address;
+            whitelist_shard_address = entry.block.address;
+        }
+        else {
+            whitelist_address = get_whitelist_address(entry.block.address);
+            whitelist_shard_address = get_whitelist_shard_address(entry.block.address, wallet_address);
+        }
+
         return _buy_tx({ funding_pubkey : wallet_address,
                          config_pubkey : g_config_address,
                          admin_pubkey : admin_address,
                          block_pubkey : entry.block.address,
-                         whitelist_pubkey : get_whitelist_address(entry.block.address),
+                         whitelist_pubkey : whitelist_address,
+                         whitelist_shard_pubkey : whitelist_shard_address,
                          entry_pubkey : entry.address,
                          entry_token_pubkey : entry.token_address,
                          entry_mint_pubkey : entry.mint_address,
                          token_destination_pubkey : token_destination_address,
                          token_destination_owner_pubkey : wallet_address,
                          metaplex_metadata_pubkey : entry.metaplex_metadata_address,
-                         maximum_price_lamports : maximum_price_lamports });
+                         maximum_price_lamports : maximum_price_lamports,
+                         whitelist_first_slot : whitelist_leaf ? whitelist_leaf.first_slot : 0,
+                         whitelist_allowance : whitelist_leaf ? whitelist_leaf.allowance : 0,
+                         whitelist_proof : whitelist_leaf ? whitelist_leaf.proof : [ ] });
+    }
+    
+    async make_buy_and_stake_with_vote_account_tx(entry, maximum_price_lamports, stake_address, vote_account_address,
+                                                  wallet_address, whitelist_leaf)
+    {
+        let admin_address = await this.fetch_admin_address();
+
+        let token_destination_address = get_associated_token_address(wallet_address, entry.mint_address);
+
+        // A block with a Merkle whitelist uses no whitelist accounts, so its own address is supplied in their place
+        let whitelist_address, whitelist_shard_address;
+        if (entry.block.whitelist_slot_count > 0) {
+            whitelist_address = entry.block.address;
+            whitelist_shard_address = entry.block.address;
+        }
+        else {
+            whitelist_address = get_whitelist_address(entry.block.address);
+            whitelist_shard_address = get_whitelist_shard_address(entry.block.address, wallet_address);
+        }
+
+        return _buy_and_stake_with_vote_account_tx({ funding_pubkey : wallet_address,
+                                                     config_pubkey : g_config_address,
+                                                     admin_pubkey : admin_address,
+                                                     block_pubkey : entry.block.address,
+                                                     whitelist_pubkey : whitelist_address,
+                                                     whitelist_shard_pubkey : whitelist_shard_address,
+                                                     entry_pubkey : entry.address,
+                                                     entry_token_pubkey : entry.token_address,
+                                                     entry_mint_pubkey : entry.mint_address,
+                                                     token_destination_pubkey : token_destination_address,
+                                                     token_destination_owner_pubkey : wallet_address,
+                                                     metaplex_metadata_pubkey : entry.metaplex_metadata_address,
+                                                     stake_pubkey : stake_address,
+                                                     withdraw_authority : wallet_address,
+                                                     vote_account_pubkey : vote_account_address,
+                                                     maximum_price_lamports : maximum_price_lamports,
+                                                     whitelist_first_slot : whitelist_leaf ?
+                                                         whitelist_leaf.first_slot : 0,
+                                                     whitelist_allowance : whitelist_leaf ?
+                                                         whitelist_leaf.allowance : 0,
+                                                     whitelist_proof : whitelist_leaf ? whitelist_leaf.proof : [ ] });
     }
     
     async make_refund_tx(entry, wallet_address)
@@ -1927,18 +2087,72 @@ class Wallet
    
     async make_bid_tx(entry, minimum_bid_lamports, maximum_bid_lamports, wallet_address)
     {
+        // An entry that escrows its bids refunds the bidder of the highest bid, if there is one, when it is outbid
+        if (entry.escrow_bids) {
+            let previous_bidder_address = (entry.auction_highest_bid_lamports > 0) ?
+                entry.auction_winning_bid_address : wallet_address;
+
+            return _escrowed_bid_tx({ bidding_pubkey : wallet_address,
+                                      entry_pubkey : entry.address,
+                                      previous_bidder_pubkey : previous_bidder_address,
+                                      minimum_bid_lamports : minimum_bid_lamports,
+                                      maximum_bid_lamports : maximum_bid_lamports });
+        }
+
         let bid_marker_token_address = get_bid_marker_token_address(entry.mint_address, wallet_address);
+        let bid_address = get_bid_address(bid_marker_token_address);
+
+        // If another bidder's bid is being outbid, refund it in the same transaction, so that they don't have to
+        // claim it
+        let previous_bid_address = null, previous_bidder_address = null;
+        if ((entry.auction_highest_bid_lamports > 0) && (entry.auction_winning_bid_address != bid_address)) {
+            let result = await this.cluster.rpc_connections.run((rpc_connection) =>
+                {
+                    return rpc_connection.getAccountInfo(entry.auction_winning_bid_address,
+                                                         {
+                                                             dataSlice : { offset : 36,
+                                                                           length : 32 }
+                                                         });
+                }, "fetch winning bid account");
+
+            if (result != null) {
+                previous_bid_address = entry.auction_winning_bid_address;
+                previous_bidder_address = buffer_address(result.data, 0);
+            }
+        }
            
         return _bid_tx({ bidding_pubkey : wallet_address,
                          entry_pubkey : entry.address,
                          bid_marker_token_pubkey : bid_marker_token_address,
-                         bid_pubkey : get_bid_address(bid_marker_token_address),
+                         bid_pubkey : bid_address,
+                         previous_bid_pubkey : previous_bid_address,
+                         previous_bidder_pubkey : previous_bidder_address,
                          minimum_bid_lamports : minimum_bid_lamports,
                          maximum_bid_lamports : maximum_bid_lamports });
     }
     
     async make_claim_tx(entry, won, wallet_address)
     {
+        // An entry that escrows its bids is itself the winning bid, and has no losing bids, which were all refunded
+        // when they were outbid
+        if (entry.escrow_bids) {
+            if (!won) {
+                throw new Error("Losing bids on this entry were refunded when outbid");
+            }
+
+            let admin_address = await this.fetch_admin_address();
+
+            return _claim_escrowed_winning_tx({ bidding_pubkey : wallet_address,
+                                                entry_pubkey : entry.address,
+                                                config_pubkey : g_config_address,
+                                                admin_pubkey : admin_address,
+                                                entry_token_pubkey : entry.token_address,
+                                                entry_mint_pubkey : entry.mint_address,
+                                                token_destination_pubkey :
+                                                    get_associated_token_address(wallet_address, entry.mint_address),
+                                                token_destination_owner_pubkey : wallet_address });
+        }
+
         let bid_marker_token_address = get_bid_marker_token_address(entry.mint_address, wallet_address);
         let bid_address = get_bid_address(bid_marker_token_address);
 
@@ -1967,6 +2181,42 @@ class Wallet
         }
     }
     
+    async make_claim_losing_many_tx(entries, wallet_address)
+    {
+        return _claim_losing_many_tx({ bidding_pubkey : wallet_address,
+                                       entries : entries.map((entry) => {
+                                           let bid_marker_token_address =
+                                               get_bid_marker_token_address(entry.mint_address, wallet_address);
+                                           return { entry_pubkey : entry.address,
+                                                    bid_pubkey : get_bid_address(bid_marker_token_address),
+                                                    bid_marker_token_pubkey : bid_marker_token_address };
+                                       }) });
+    }
+    
+    async make_claim_winning_and_stake_with_vote_account_tx(entry, stake_address, vote_account_address,
+                                                           wallet_address)
+    {
+        let admin_address = await this.fetch_admin_address();
+
+        let bid_marker_token_address = get_bid_marker_token_address(entry.mint_address, wallet_address);
+
+        return _claim_winning_and_stake_with_vote_account_tx({
+            bidding_pubkey : wallet_address,
+            entry_pubkey : entry.address,
+            bid_pubkey : get_bid_address(bid_marker_token_address),
+            config_pubkey : g_config_address,
+            admin_pubkey : admin_address,
+            entry_token_pubkey : entry.token_address,
+            entry_mint_pubkey : entry.mint_address,
+            token_destination_pubkey : get_associated_token_address(wallet_address, entry.mint_address),
+            token_destination_owner_pubkey : wallet_address,
+            bid_marker_token_pubkey : bid_marker_token_address,
+            block_pubkey : entry.block.address,
+            stake_pubkey : stake_address,
+            withdraw_authority : wallet_address,
+            vote_account_pubkey : vote_account_address });
+    }
+    
     async make_stake_with_vote_account_tx(entry, stake_address, vote_account_address, wallet_address)
     {
         return _stake_tx({ block_pubkey : entry.block.address,
@@ -2003,14 +2253,32 @@ class Wallet
                              ki_destination_owner_pubkey : wallet_address });
     }
     
-    async make_level_up_tx(entry, wallet_address)
+    async make_harvest_many_tx(entries, wallet_address)
+    {
+        return _harvest_many_tx({ funding_pubkey : wallet_address,
+                                  token_owner_pubkey : wallet_address,
+                                  ki_destination_pubkey : get_associated_token_address(wallet_address,
+                                                                                       g_ki_mint_address),
+                                  ki_destination_owner_pubkey : wallet_address,
+                                  entries : entries.map((entry) => {
+                                      return { entry_pubkey : entry.address,
+                                               token_pubkey : get_associated_token_address(wallet_address,
+                                                                                           entry.mint_address),
+                                               stake_pubkey : entry.owned_stake_account };
+                                  }) });
+    }
+    
+    async make_level_up_tx(entry, target_level, level_metadata_proof, wallet_address)
     {
         return _level_up_tx({ entry_pubkey : entry.address,
+                              block_pubkey : entry.block.address,
                               token_owner_pubkey : wallet_address,
                               token_pubkey : get_associated_token_address(wallet_address, entry.mint_address),
                               entry_metaplex_metadata_pubkey : entry.metaplex_metadata_address,
                               ki_source_pubkey : get_associated_token_address(wallet_address, g_ki_mint_address),
-                              ki_source_owner_pubkey : wallet_address });
+                              ki_source_owner_pubkey : wallet_address,
+                              target_level : target_level,
+                              level_metadata_proof : level_metadata_proof });
     }
     
     async complete_tx(tx_maker_func, sign_callback)
@@ -2140,6 +2408,16 @@ function get_whitelist_address(block_address)
 }
 
 
+// The whitelist shard that holds a wallet address is selected by the high 4 bits of the first byte of the address
+function get_whitelist_shard_address(block_address, wallet_address)
+{
+    return find_pda([ [ 17 ],
+                      address_to_buffer(block_address),
+                      [ address_to_buffer(wallet_address)[0] >> 4 ] ],
+                    g_self_program_pubkey)[0].toBase58();
+}
+
+
 function get_entry_mint_address(block_address, entry_index)
 {
     return find_pda([ [ 5 ],
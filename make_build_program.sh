@@ -5,6 +5,8 @@
 # The resulting script requires the following variables to be defined:
 # SDK_ROOT -- path to the root of the Solana SDK to use for building the program
 # SOURCE_ROOT -- path to the Shinobi Immortals source
+# The resulting script also accepts the following optional variable:
+# SHINOBI_PROFILE -- if non-empty, builds the program with compute unit profiling markers (see program/inc/profile.h)
 
 SELF_PROGRAM_PUBKEY=$1
 SUPERUSER_PUBKEY=$2
@@ -139,6 +141,7 @@ BID_MARKER_METADATA_PUBKEY_C_ARRAY="$BID_MARKER_METADATA_PUBKEY_C_ARRAY"
     -I\$SOURCE_ROOT/program                                                                \\
     -o program.po                                                                         \\
     -c \$SOURCE_ROOT/program/entrypoint.c                                                  \\
+    \${SHINOBI_PROFILE:+-DSHINOBI_PROFILE}                                                 \\
     -DSUPERUSER_PUBKEY_ARRAY="\$SUPERUSER_PUBKEY_C_ARRAY"                                  \\
     -DCONFIG_PUBKEY_ARRAY="\$CONFIG_PUBKEY_C_ARRAY"                                        \\
     -DCONFIG_BUMP_SEED="\$CONFIG_BUMP_SEED"                                                \\
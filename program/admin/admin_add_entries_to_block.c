@@ -7,9 +7,37 @@
 #include "util/util_block.c"
 #include "util/util_entry.c"
 #include "util/util_metaplex.c"
+#include "util/util_program_config.c"
 #include "util/util_token.c"
 
 
+// These are the bump seeds of the Program Derived Addresses of the accounts created for an entry.  They are supplied
+// by the client so that the program does not need to search for them.
+typedef struct
+{
+    uint8_t mint_bump_seed;
+
+    uint8_t token_bump_seed;
+
+    uint8_t entry_bump_seed;
+
+    uint8_t bridge_bump_seed;
+
+} AddEntryBumpSeeds;
+
+
+typedef struct
+{
+    // This is a sha256 of the metadata + salt to copy into the entry as reveal_sha256, which will ensure that when the
+    // reveal of the entry occurs, it will reveal metadata which was already determined at the time that the entry was
+    // added
+    sha256_t reveal_sha256;
+
+    AddEntryBumpSeeds bump_seeds;
+
+} AddEntryData;
+
+
 typedef struct
 {
     // This is the instruction code for AddEntriesToBlockData
@@ -25,10 +53,13 @@ typedef struct
     // Index of first entry included here
     uint16_t first_entry;
 
-    // Each account to be computed requires as ha256 of the metadata + salt to copy into the entry as reveal_sha256,
-    // which will ensure that when the reveal of the entry occurs, it will reveal metadata which was already
-    // determined at the time that the entry was added
-    sha256_t entry_sha256s[0];
+    // The details of each entry to add.  If the block has a reveal_merkle_root, then the reveal of every entry has
+    // already been committed to by the block, and so only the bump seeds of each entry are supplied.
+    union {
+        AddEntryData entries[0];
+
+        AddEntryBumpSeeds merkle_entries[0];
+    };
 
 } AddEntriesToBlockData;
 
@@ -36,23 +67,31 @@ typedef struct
 // Forward declaration
 static uint64_t add_entry(SolAccountInfo *entry_accounts, const SolPubkey *block_key, const Block *block,
                           uint16_t entry_index, const SolPubkey *funding_key, const AddEntriesToBlockData *data,
-                          const sha256_t *entry_sha256, const SolAccountInfo *transaction_accounts,
-                          int transaction_accounts_len);
+                          const sha256_t *reveal_sha256, const AddEntryBumpSeeds *bump_seeds,
+                          MetaplexCreateMetadataData *metaplex_metadata, const ProgramConfigCache *cache,
+                          const SolAccountInfo *transaction_accounts, int transaction_accounts_len);
 
 
-static uint64_t compute_add_entries_data_size(uint16_t entry_count)
+static uint64_t compute_add_entries_data_size(uint16_t entry_count, bool has_reveal_merkle_root)
 {
     const AddEntriesToBlockData *d = 0;
 
     // The total space needed is from the beginning of AddEntriesToBlockData to the entries element one beyond the
     // total supported (i.e. if there are 100 entries, then then entry at index 100 starts at the first byte beyond
     // the array)
-    return ((uint64_t) &(d->entry_sha256s[entry_count]));
+    if (has_reveal_merkle_root) {
+        return ((uint64_t) &(d->merkle_entries[entry_count]));
+    }
+    else {
+        return ((uint64_t) &(d->entries[entry_count]));
+    }
 }
 
 
 static uint64_t admin_add_entries_to_block(const SolParameters *params)
 {
+    PROFILE_SCOPE("admin_add_entries_to_block");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
@@ -77,20 +116,23 @@ static uint64_t admin_add_entries_to_block(const SolParameters *params)
         return Error_PermissionDenied;
     }
 
-    // Make sure that the input data is the correct size
-    if (params->data_len != compute_add_entries_data_size(entry_count)) {
-        return Error_InvalidDataSize;
-    }
-
-    // Cast to instruction data
-    const AddEntriesToBlockData *data = (AddEntriesToBlockData *) params->data;
-
     // Get the validated Block data
     Block *block = get_validated_block(block_account);
     if (!block) {
         return Error_InvalidAccount_First + 3;
     }
 
+    // Make sure that the input data is the correct size, which depends upon how the block commits to the reveal of
+    // its entries
+    bool has_reveal_merkle_root = block_has_reveal_merkle_root(block);
+
+    if (params->data_len != compute_add_entries_data_size(entry_count, has_reveal_merkle_root)) {
+        return Error_InvalidDataSize;
+    }
+
+    // Cast to instruction data
+    const AddEntriesToBlockData *data = (AddEntriesToBlockData *) params->data;
+
     // If the block is already complete, then can't add entries
     if (is_block_complete(block)) {
         return Error_BlockAlreadyComplete;
@@ -101,6 +143,27 @@ static uint64_t admin_add_entries_to_block(const SolParameters *params)
         return Error_InvalidData_First + 2;
     }
 
+    // The metaplex metadata of all entries added here is the same except for the entry index digits of its name,
+    // so it is encoded once and only those digits are set for each entry
+    MetaplexCreateMetadataData metaplex_metadata;
+    encode_entry_metaplex_metadata_template(&metaplex_metadata, block->config.group_number,
+                                            block->config.block_number, data->metaplex_metadata_uri,
+                                            &(data->second_metaplex_metadata_creator));
+
+    // Get the program config cache, so that the rent exempt minimum of each created account is computed without
+    // reading the rent sysvar
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    ProgramConfigCache cache_buffer;
+    const ProgramConfigCache *cache;
+    uint64_t ret = get_program_config_cache(config_account, 0, &clock, &cache_buffer, &cache);
+    if (ret) {
+        return ret;
+    }
+
     // Add each entry one by one
     for (uint8_t i = 0; i < entry_count; i++) {
         uint16_t entry_index = ((uint16_t) data->first_entry) + i;
@@ -111,14 +174,25 @@ static uint64_t admin_add_entries_to_block(const SolParameters *params)
         }
 
         // This is the group of accounts for this entry
-        SolAccountInfo *entry_accounts = &(params->ka[9 + (4 * i)]);
-
-        // This is the entry details for the entry
-        const sha256_t *entry_sha256 = &(data->entry_sha256s[i]);
+        SolAccountInfo *entry_accounts = get_instruction_accounts(params, 9 + (4 * i), 4);
+
+        // These are the entry details for the entry.  If the block has a reveal Merkle root, then the entry's
+        // reveal_sha256 is a copy of the root, which marks the entry as not yet revealed.
+        const sha256_t *reveal_sha256;
+        const AddEntryBumpSeeds *bump_seeds;
+        if (has_reveal_merkle_root) {
+            reveal_sha256 = &(block->config.reveal_merkle_root);
+            bump_seeds = &(data->merkle_entries[i]);
+        }
+        else {
+            reveal_sha256 = &(data->entries[i].reveal_sha256);
+            bump_seeds = &(data->entries[i].bump_seeds);
+        }
 
         // Add the entry
         uint64_t result = add_entry(entry_accounts, block_account->key, block, entry_index, funding_account->key,
-                                    data, entry_sha256, params->ka, params->ka_num);
+                                    data, reveal_sha256, bump_seeds, &metaplex_metadata, cache, params->ka,
+                                    params->ka_num);
 
         if (result) {
             return result;
@@ -134,10 +208,6 @@ static uint64_t admin_add_entries_to_block(const SolParameters *params)
     // If the block has just been completed, then set the block_start_time to the current time, and set the
     // block last_commission_change_epoch so that commission can't be changed this epoch.
     if (is_block_complete(block)) {
-        Clock clock;
-        if (sol_get_clock_sysvar(&clock)) {
-            return Error_FailedToGetClock;
-        }
         block->block_start_timestamp = clock.unix_timestamp;
         // If the number of mysteries is 0, then the mystery phase is already done, and so the reveal phase starts
         // immediately.
@@ -153,9 +223,12 @@ static uint64_t admin_add_entries_to_block(const SolParameters *params)
 
 static uint64_t add_entry(SolAccountInfo *entry_accounts, const SolPubkey *block_key, const Block *block,
                           uint16_t entry_index, const SolPubkey *funding_key, const AddEntriesToBlockData *data,
-                          const sha256_t *entry_sha256, const SolAccountInfo *transaction_accounts,
-                          int transaction_accounts_len)
+                          const sha256_t *reveal_sha256, const AddEntryBumpSeeds *bump_seeds,
+                          MetaplexCreateMetadataData *metaplex_metadata, const ProgramConfigCache *cache,
+                          const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("add_entry");
+
     SolAccountInfo *entry_account =                     &(entry_accounts[0]);
     SolAccountInfo *mint_account =                      &(entry_accounts[1]);
     SolAccountInfo *token_account =                     &(entry_accounts[2]);
@@ -176,15 +249,15 @@ static uint64_t add_entry(SolAccountInfo *entry_accounts, const SolPubkey *block
     }
 
     // Create the mint account
-    uint64_t ret = create_entry_mint_account(mint_account, block_key, entry_index, funding_key, transaction_accounts,
-                                             transaction_accounts_len);
+    uint64_t ret = create_entry_mint_account(mint_account, block_key, entry_index, bump_seeds->mint_bump_seed,
+                                             funding_key, cache, transaction_accounts, transaction_accounts_len);
     if (ret) {
         return ret;
     }
 
     // Create the entry token account
-    ret = create_entry_token_account(token_account, mint_account->key, funding_key, transaction_accounts,
-                                     transaction_accounts_len);
+    ret = create_entry_token_account(token_account, mint_account->key, bump_seeds->token_bump_seed, funding_key,
+                                     cache, transaction_accounts, transaction_accounts_len);
     if (ret) {
         return ret;
     }
@@ -197,12 +270,10 @@ static uint64_t add_entry(SolAccountInfo *entry_accounts, const SolPubkey *block
     }
 
     // Create the metaplex metadata
-    ret = create_entry_metaplex_metadata(metaplex_metadata_account->key, mint_account->key,
-                                         funding_key, block->config.group_number, block->config.block_number,
-                                         entry_index, data->metaplex_metadata_uri,
-                                         &(Constants.shinobi_systems_vote_pubkey),
-                                         &(data->second_metaplex_metadata_creator),
-                                         transaction_accounts, transaction_accounts_len);
+    set_entry_metaplex_metadata_index(metaplex_metadata, entry_index);
+
+    ret = create_metaplex_metadata(metaplex_metadata_account->key, mint_account->key, funding_key, metaplex_metadata,
+                                   transaction_accounts, transaction_accounts_len);
     if (ret) {
         return ret;
     }
@@ -225,8 +296,8 @@ static uint64_t add_entry(SolAccountInfo *entry_accounts, const SolPubkey *block
     // if it proves necessarry for people to see this useless "master edition" metadata.
 
     // Create the entry account
-    ret = create_entry_account(entry_account, mint_account->key, funding_key, transaction_accounts,
-                               transaction_accounts_len);
+    ret = create_entry_account(entry_account, mint_account->key, bump_seeds->entry_bump_seed, funding_key, cache,
+                               transaction_accounts, transaction_accounts_len);
     if (ret) {
         return ret;
     }
@@ -254,11 +325,22 @@ static uint64_t add_entry(SolAccountInfo *entry_accounts, const SolPubkey *block
 
     entry->has_auction = block->config.has_auction;
 
+    entry->escrow_bids = block->config.escrow_bids;
+
     entry->duration = block->config.duration;
 
     entry->non_auction_start_price_lamports = block->config.final_start_price_lamports;
 
-    entry->reveal_sha256 = *entry_sha256;
+    entry->reveal_sha256 = *reveal_sha256;
+
+    entry->state = EntryState_PreRevealUnowned;
+
+    // The bridge account is not created until the entry is staked, but its bump seed is recorded now so that it
+    // never needs to be searched for
+    entry->bridge_bump_seed = bump_seeds->bridge_bump_seed;
+
+    // The creators of the metaplex metadata are needed again whenever the metadata is updated for a level
+    entry->second_metaplex_metadata_creator = data->second_metaplex_metadata_creator;
 
     return 0;
 }
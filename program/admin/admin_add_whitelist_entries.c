@@ -1,16 +1,22 @@
 #pragma once
 
 #include "inc/block.h"
+#include "inc/clock.h"
+#include "util/util_program_config.c"
 #include "util/util_whitelist.c"
 
-#define MAX_WHITELIST_ADD_ENTRIES 28
-
 // Instruction data type for AddWhitelistEntries instruction.
 typedef struct
 {
     // This is the instruction code for AddWhitelistEntries
     uint8_t instruction_code;
 
+    // Index of the whitelist shard that the entries are added to; every entry must belong in this shard
+    uint8_t whitelist_shard_index;
+
+    // Bump seed of the Program Derived Address of the whitelist shard
+    uint8_t whitelist_shard_bump_seed;
+
     // This is the number of whitelist entries to add
     uint16_t count;
 
@@ -31,6 +37,8 @@ static uint64_t add_whitelist_entries_data_size(uint16_t count)
 // Creates a new block of entries
 static uint64_t admin_add_whitelist_entries(const SolParameters *params)
 {
+    PROFILE_SCOPE("admin_add_whitelist_entries");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
@@ -38,9 +46,10 @@ static uint64_t admin_add_whitelist_entries(const SolParameters *params)
         DECLARE_ACCOUNT(2,   funding_account,               ReadWrite,  Signer,     KnownAccount_NotKnown);
         DECLARE_ACCOUNT(3,   block_account,                 ReadOnly,   NotSigner,  KnownAccount_NotKnown);
         DECLARE_ACCOUNT(4,   whitelist_account,             ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(5,   system_program_account,        ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
+        DECLARE_ACCOUNT(5,   whitelist_shard_account,       ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(6,   system_program_account,        ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
     }
-    DECLARE_ACCOUNTS_NUMBER(6);
+    DECLARE_ACCOUNTS_NUMBER(7);
 
     // Ensure the the transaction has been authenticated by the admin
     if (!is_admin_account(config_account, admin_account->key)) {
@@ -65,7 +74,33 @@ static uint64_t admin_add_whitelist_entries(const SolParameters *params)
         return Error_InvalidDataSize;
     }
 
-    // Create the whitelist entry account
-    return add_whitelist_entries(whitelist_account, block_account, funding_account->key, data->count,
-                                 data->entries, params->ka, params->ka_num);
+    // Ensure that the shard index is valid
+    if (data->whitelist_shard_index >= WHITELIST_SHARD_COUNT) {
+        return Error_InvalidData_First + 1;
+    }
+
+    // Ensure that all entries belong in the shard
+    for (uint16_t i = 0; i < data->count; i++) {
+        if (whitelist_shard_index(&(data->entries[i])) != data->whitelist_shard_index) {
+            return Error_InvalidData_First + 2;
+        }
+    }
+
+    // Get the program config cache, which supplies the rent exempt minimums of the accounts that may be created
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    ProgramConfigCache cache_buffer;
+    const ProgramConfigCache *cache;
+    uint64_t ret = get_program_config_cache(config_account, 0, &clock, &cache_buffer, &cache);
+    if (ret) {
+        return ret;
+    }
+
+    // Add the entries to the whitelist shard, creating the whitelist and whitelist shard accounts if necessary
+    return add_whitelist_entries(whitelist_account, whitelist_shard_account, block_account, data->whitelist_shard_index,
+                                 data->whitelist_shard_bump_seed, funding_account->key, data->count, data->entries,
+                                 cache, params->ka, params->ka_num);
 }
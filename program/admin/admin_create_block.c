@@ -1,7 +1,9 @@
 #pragma once
 
 #include "inc/block.h"
+#include "inc/clock.h"
 #include "util/util_entry.c"
+#include "util/util_program_config.c"
 #include "util/util_rent.c"
 
 // instruction data type for CreateBlock instruction.
@@ -10,18 +12,32 @@ typedef struct
     // This is the instruction code for CreateBlock
     uint8_t instruction_code;
 
+    // Bump seed of the block's Program Derived Address
+    uint8_t block_bump_seed;
+
     // Initial commission to use in the newly created block
     commission_t initial_commission;
 
+    // Bump seed of the Program Derived Address of the block's whitelist, which must be supplied whether or not the
+    // block has a whitelist.  This must be the canonical bump seed, since that is the one that AddWhitelistEntries
+    // creates the whitelist with.
+    uint8_t whitelist_bump_seed;
+
     // The actual configuration of the block is provided
     BlockConfiguration config;
 
+    // This is followed by the URI prefixes of the block, of which there may be up to MAX_BLOCK_URI_PREFIXES, each of
+    // which is given as a one byte length followed by that many characters.  Any prefixes not supplied are empty.
+    uint8_t uri_prefixes[];
+
 } CreateBlockData;
 
 
 // Creates a new block of entries
 static uint64_t admin_create_block(const SolParameters *params)
 {
+    PROFILE_SCOPE("admin_create_block");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
@@ -42,8 +58,8 @@ static uint64_t admin_create_block(const SolParameters *params)
         return Error_InvalidAccount_First + 3;
     }
 
-    // Ensure that the instruction data is the correct size
-    if (params->data_len != sizeof(CreateBlockData)) {
+    // Ensure that the instruction data is at least large enough for the fixed portion
+    if (params->data_len < sizeof(CreateBlockData)) {
         return Error_InvalidDataSize;
     }
 
@@ -77,6 +93,11 @@ static uint64_t admin_create_block(const SolParameters *params)
         return Error_InvalidData_First + 4;
     }
 
+    // Only auctions have bids to escrow
+    if (config->escrow_bids && !config->has_auction) {
+        return Error_InvalidData_First + 9;
+    }
+
     // Ensure that the final start price is no more than 100,000 SOL, to avoid rounding errors in price calculations
     if (config->final_start_price_lamports > (100ul * 1000ul * LAMPORTS_PER_SOL)) {
         return Error_InvalidData_First + 5;
@@ -86,15 +107,67 @@ static uint64_t admin_create_block(const SolParameters *params)
         return Error_InvalidData_First + 6;
     }
 
+    // Get the program config cache, which supplies the rent exempt minimums of the bid and block accounts
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    ProgramConfigCache cache_buffer;
+    const ProgramConfigCache *cache;
+    uint64_t ret = get_program_config_cache(config_account, 0, &clock, &cache_buffer, &cache);
+    if (ret) {
+        return ret;
+    }
+
     // Ensure that the minimum price of an entry is >= rent exempt minimum of a bid account, to ensure that bids
     // can always be created
-    if (config->minimum_price_lamports < get_rent_exempt_minimum(sizeof(Bid))) {
+    if (config->minimum_price_lamports < get_cached_rent_exempt_minimum(cache, sizeof(Bid))) {
         return Error_InvalidData_First + 7;
     }
 
+    // Ensure that the whitelist bump seed is the canonical one, so that it is the bump seed of the whitelist that
+    // AddWhitelistEntries created, if any
+    {
+        uint8_t prefix = PDA_Account_Seed_Prefix_Whitelist;
+
+        SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
+                                  { (uint8_t *) block_account->key, sizeof(*(block_account->key)) },
+                                  { &(data->whitelist_bump_seed), sizeof(data->whitelist_bump_seed) } };
+
+        SolPubkey whitelist_pubkey;
+
+        if (sol_create_program_address(seeds, ARRAY_LEN(seeds), &(Constants.self_program_pubkey), &whitelist_pubkey) ||
+            !is_canonical_bump_seed(seeds, ARRAY_LEN(seeds))) {
+            return Error_InvalidData_First + 10;
+        }
+    }
+
+    // Decode the URI prefixes, which must exactly consume the rest of the instruction data
+    uint8_t uri_prefixes[MAX_BLOCK_URI_PREFIXES][MAX_URI_PREFIX_LENGTH];
+    sol_memset(uri_prefixes, 0, sizeof(uri_prefixes));
+    {
+        const uint8_t *encoded = data->uri_prefixes;
+        uint64_t encoded_len = params->data_len - sizeof(CreateBlockData);
+        uint8_t count = 0;
+        while (encoded_len) {
+            uint8_t len = *encoded++;
+            encoded_len--;
+            if (len > encoded_len) {
+                return Error_InvalidDataSize;
+            }
+            if ((count == MAX_BLOCK_URI_PREFIXES) || (len > MAX_URI_PREFIX_LENGTH)) {
+                return Error_InvalidData_First + 8;
+            }
+            sol_memcpy(uri_prefixes[count++], encoded, len);
+            encoded += len, encoded_len -= len;
+        }
+    }
+
     // Create the block account
-    uint64_t ret = create_block_account(block_account, config->group_number, config->block_number,
-                                        config->total_entry_count, funding_account->key, params->ka, params->ka_num);
+    ret = create_block_account(block_account, config->group_number, config->block_number, data->block_bump_seed,
+                               config->total_entry_count, config->whitelist_slot_count, funding_account->key, cache,
+                               params->ka, params->ka_num);
     if (ret) {
         return ret;
     }
@@ -108,5 +181,9 @@ static uint64_t admin_create_block(const SolParameters *params)
 
     block->commission = data->initial_commission;
 
+    block->whitelist_bump_seed = data->whitelist_bump_seed;
+
+    sol_memcpy(block->uri_prefixes, uri_prefixes, sizeof(block->uri_prefixes));
+
     return 0;
 }
@@ -15,6 +15,8 @@ typedef struct
 // Deletes a whitelist that is no longer needed
 static uint64_t admin_delete_whitelist(const SolParameters *params)
 {
+    PROFILE_SCOPE("admin_delete_whitelist");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
@@ -22,7 +24,16 @@ static uint64_t admin_delete_whitelist(const SolParameters *params)
         DECLARE_ACCOUNT(2,   block_account,                 ReadOnly,   NotSigner,  KnownAccount_NotKnown);
         DECLARE_ACCOUNT(3,   whitelist_account,             ReadWrite,  NotSigner,  KnownAccount_NotKnown);
     }
-    DECLARE_ACCOUNTS_NUMBER(4);
+
+    // The whitelist shards to delete follow the fixed accounts.  Every shard of the whitelist must be supplied.
+    uint8_t whitelist_shard_count = params->ka_num - 4;
+
+    // Must be the fixed accounts plus at most one account per whitelist shard
+    if (params->ka_num > (4 + WHITELIST_SHARD_COUNT)) {
+        return Error_IncorrectNumberOfAccounts;
+    }
+
+    DECLARE_ACCOUNTS_NUMBER(4 + whitelist_shard_count);
 
     // Ensure the the transaction has been authenticated by the admin
     if (!is_admin_account(config_account, admin_account->key)) {
@@ -40,8 +51,18 @@ static uint64_t admin_delete_whitelist(const SolParameters *params)
         return Error_FailedToGetClock;
     }
 
-    // Delete the whitelist account if the conditions are correct for doing so, returning the lamports to the
-    // admin account
-    return delete_whitelist_account(whitelist_account, block_account, &clock, admin_account,
-                                    params->ka, params->ka_num);
+    // _account_num is defined by DECLARE_ACCOUNTS
+    SolAccountInfo *whitelist_shard_accounts = get_instruction_accounts(params, _account_num, whitelist_shard_count);
+
+    // Ensure that the whitelist shard accounts are writable
+    for (uint8_t i = 0; i < whitelist_shard_count; i++) {
+        if (!whitelist_shard_accounts[i].is_writable) {
+            return Error_InvalidAccountPermissions_First + 4 + i;
+        }
+    }
+
+    // Delete the whitelist account and whitelist shard accounts if the conditions are correct for doing so,
+    // returning the lamports to the admin account
+    return delete_whitelist_account(whitelist_account, whitelist_shard_accounts, whitelist_shard_count,
+                                    block_account, &clock, admin_account, params->ka, params->ka_num);
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "inc/merkle.h"
+#include "util/util_merkle.c"
 #include "util/util_token.c"
 #include "util/util_transfer_lamports.c"
 
@@ -12,23 +14,42 @@ typedef struct
     // Index within the block account of the first entry included here
     uint16_t first_entry;
 
-    // These are the salt values that were used to compute the SHA-256 hash of each entry
+    // These are the salt values that were used to compute the SHA-256 hash of each entry.  These are followed by one
+    // LevelMetadataProof per entry, in the same order, proving the level 0 metadata of the entry.  If the block has a
+    // reveal_merkle_root, those are followed by a RevealEntriesProof.  The level 0 metadata is needed at reveal
+    // because it supplies the entry's Ki factor and its metaplex metadata.  With its two accounts, each entry takes
+    // about 360 bytes of a transaction, so only two entries fit in a single transaction.
     salt_t entry_salt[0];
 
 } RevealEntriesData;
 
 
+// This is the proof of the range of entries revealed, which follows the level metadata proofs of the RevealEntries
+// instruction data for blocks that have a reveal_merkle_root
+typedef struct
+{
+    // Number of hashes in the proof
+    uint8_t proof_length;
+
+    // The hashes of the proof (see inc/merkle.h)
+    sha256_t proof[0];
+
+} RevealEntriesProof;
+
+
 // Forward declaration
 static uint64_t reveal_single_entry(const Block *block,
                                     Entry *entry,
                                     const Clock *clock,
                                     salt_t salt,
+                                    const LevelMetadataProof *level_metadata_proof,
                                     const SolAccountInfo *admin_account,
                                     const SolAccountInfo *authority_account,
                                     const SolAccountInfo *metaplex_metadata_account,
                                     const SolAccountInfo *transaction_accounts,
                                     int transaction_accounts_len,
-                                    /* modifies */ uint64_t *total_lamports_to_move);
+                                    /* modifies */ uint64_t *total_lamports_to_move,
+                                    /* returns */ sha256_t *merkle_leaf);
 
 
 static uint64_t compute_reveal_entries_data_size(uint16_t entry_count)
@@ -42,8 +63,18 @@ static uint64_t compute_reveal_entries_data_size(uint16_t entry_count)
 }
 
 
+static uint64_t compute_reveal_entries_proof_size(uint8_t proof_length)
+{
+    const RevealEntriesProof *p = 0;
+
+    return ((uint64_t) &(p->proof[proof_length]));
+}
+
+
 static uint64_t admin_reveal_entries(const SolParameters *params)
 {
+    PROFILE_SCOPE("admin_reveal_entries");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
@@ -65,8 +96,43 @@ static uint64_t admin_reveal_entries(const SolParameters *params)
         return Error_PermissionDenied;
     }
 
-    // Make sure that the data is properly sized given the number of entries
-    if (params->data_len != compute_reveal_entries_data_size(entry_count)) {
+    // Make sure that the data is properly sized given the number of entries, the lengths of the level metadata
+    // proofs, and the length of the proof if there is one
+    uint64_t data_size = compute_reveal_entries_data_size(entry_count);
+
+    if (params->data_len < data_size) {
+        return Error_InvalidDataSize;
+    }
+
+    // These are the level 0 metadata proofs of the entries.  entry_count is limited by the number of accounts that an
+    // instruction may have.
+    const LevelMetadataProof *level_metadata_proofs[(MAX_INSTRUCTION_ACCOUNTS - 6) / 2];
+
+    for (uint8_t i = 0; i < entry_count; i++) {
+        if ((params->data_len - data_size) < compute_level_metadata_proof_size(0)) {
+            return Error_InvalidDataSize;
+        }
+        level_metadata_proofs[i] = (LevelMetadataProof *) &(params->data[data_size]);
+        if (level_metadata_proofs[i]->proof_length > MAX_LEVEL_METADATA_PROOF_LENGTH) {
+            return Error_InvalidDataSize;
+        }
+        data_size += compute_level_metadata_proof_size(level_metadata_proofs[i]->proof_length);
+        if (params->data_len < data_size) {
+            return Error_InvalidDataSize;
+        }
+    }
+
+    const RevealEntriesProof *proof = 0;
+
+    if (params->data_len > data_size) {
+        proof = (RevealEntriesProof *) &(params->data[data_size]);
+        if (proof->proof_length > MAX_MERKLE_RANGE_PROOF_LENGTH) {
+            return Error_InvalidDataSize;
+        }
+        data_size += compute_reveal_entries_proof_size(proof->proof_length);
+    }
+
+    if (params->data_len != data_size) {
         return Error_InvalidDataSize;
     }
 
@@ -79,6 +145,13 @@ static uint64_t admin_reveal_entries(const SolParameters *params)
         return Error_InvalidAccount_First + 2;
     }
 
+    // A proof is supplied if and only if the block commits to the reveal of its entries with a reveal Merkle root
+    bool has_reveal_merkle_root = block_has_reveal_merkle_root(block);
+
+    if (has_reveal_merkle_root != (proof != 0)) {
+        return Error_InvalidDataSize;
+    }
+
     // Load the clock, which is needed below
     Clock clock;
     if (sol_get_clock_sysvar(&clock)) {
@@ -105,6 +178,10 @@ static uint64_t admin_reveal_entries(const SolParameters *params)
     // un-revealed entries, that need to be moved to the admin account now that the entries are revealed.
     uint64_t total_lamports_to_move = 0;
 
+    // For blocks with a reveal Merkle root, these are the Merkle tree leaves of the entries revealed.  entry_count is
+    // limited by the number of accounts that an instruction may have.
+    sha256_t merkle_leaves[(MAX_INSTRUCTION_ACCOUNTS - 6) / 2];
+
     // Reveal entries one by one
     for (uint16_t i = 0; i < entry_count; i++) {
         uint16_t destination_index = data->first_entry + i;
@@ -112,7 +189,7 @@ static uint64_t admin_reveal_entries(const SolParameters *params)
         // _account_num is defined by DECLARE_ACCOUNTS
 
         // This is the account info of the entry, as passed into the accounts list
-        const SolAccountInfo *entry_account = &(params->ka[_account_num++]);
+        const SolAccountInfo *entry_account = get_instruction_account(params, _account_num++);
 
         // Ensure that the entry account is writable
         if (!entry_account->is_writable) {
@@ -134,7 +211,7 @@ static uint64_t admin_reveal_entries(const SolParameters *params)
         }
 
         // This is the account info of the metaplex metadata for the entry, as passed into the accounts list
-        const SolAccountInfo *metaplex_metadata_account = &(params->ka[_account_num++]);
+        const SolAccountInfo *metaplex_metadata_account = get_instruction_account(params, _account_num++);
 
         // Ensure that it's the correct metadata account for this entry
         if (!SolPubkey_same(metaplex_metadata_account->key, &(entry->metaplex_metadata_pubkey))) {
@@ -147,9 +224,11 @@ static uint64_t admin_reveal_entries(const SolParameters *params)
         }
 
         // Do the reveal of this entry
-        uint64_t result = reveal_single_entry(block, entry, &clock, salt, admin_account, authority_account,
-                                              metaplex_metadata_account, params->ka, params->ka_num,
-                                              /* modifies */ &total_lamports_to_move);
+        uint64_t result = reveal_single_entry(block, entry, &clock, salt, level_metadata_proofs[i], admin_account,
+                                              authority_account, metaplex_metadata_account, params->ka,
+                                              params->ka_num,
+                                              /* modifies */ &total_lamports_to_move,
+                                              /* returns */ has_reveal_merkle_root ? &(merkle_leaves[i]) : 0);
 
         // If that reveal failed, then the entire transaction fails
         if (result) {
@@ -157,6 +236,17 @@ static uint64_t admin_reveal_entries(const SolParameters *params)
         }
     }
 
+    // For blocks with a reveal Merkle root, the leaves of the entries must hash up to the root, as proven by the
+    // proof of their range.  If they do not, then the transaction fails and so all of the reveals above are undone.
+    if (has_reveal_merkle_root) {
+        sha256_t root;
+        if (!compute_merkle_range_root(merkle_leaves, data->first_entry, entry_count,
+                                       block->config.total_entry_count, proof->proof, proof->proof_length, &root) ||
+            sol_memcmp(&root, &(block->config.reveal_merkle_root), sizeof(root))) {
+            return Error_InvalidHash;
+        }
+    }
+
     // All entries revealed successfully.  Move the escrow lamports that needed to move.  This must be done at the end
     // to avoid errors with modified accounts used in cross-program invoke elsewhere in the transaction execution.
     if (total_lamports_to_move) {
@@ -170,18 +260,24 @@ static uint64_t admin_reveal_entries(const SolParameters *params)
 
 // This function reveals a single entry, which means ensuring that it meets all requirements for being a valid
 // reveal, and then updates the entry state to their post-reveal values.  It returns nonzero on error, zero on
-// success.
+// success.  If merkle_leaf is non-null, then the entry's block has a reveal Merkle root, and instead of checking the
+// entry's reveal_sha256, this computes the entry's leaf of the block's reveal Merkle tree into merkle_leaf, which the
+// caller must check.  level_metadata_proof must prove the level 0 metadata of the entry.
 static uint64_t reveal_single_entry(const Block *block,
                                     Entry *entry,
                                     const Clock *clock,
                                     salt_t salt,
+                                    const LevelMetadataProof *level_metadata_proof,
                                     const SolAccountInfo *admin_account,
                                     const SolAccountInfo *authority_account,
                                     const SolAccountInfo *metaplex_metadata_account,
                                     const SolAccountInfo *transaction_accounts,
                                     int transaction_accounts_len,
-                                    /* modifies */ uint64_t *total_lamports_to_move)
+                                    /* modifies */ uint64_t *total_lamports_to_move,
+                                    /* returns */ sha256_t *merkle_leaf)
 {
+    PROFILE_SCOPE("reveal_single_entry");
+
     // Ensure that the metaplex metadata account passed in is the actual metaplex metadata account for this token
     if (!SolPubkey_same(metaplex_metadata_account->key, &(entry->metaplex_metadata_pubkey))) {
         return Error_InvalidMetadataAccount;
@@ -208,53 +304,81 @@ static uint64_t reveal_single_entry(const Block *block,
     // OK at this point, it is known that the mint account is valid, the token account is valid, the metaplex metadata
     // accounts is valid, and the entry is in a valid state.  So now compute the SHA-256 hash that will ensure that
     // these are correct for the reveal of this entry.
-    sha256_t computed_sha256;
+    PROFILE("sha256");
 
-    // The computation of the hash is a two step process:
-    // 1. Compute the SHA-256 hash of the entry metadata, into a contiguous buffer of bytes.  Then append the 8 bytes
-    //    of salt onto the end.
-    // 2. Compute SHA-256 of this buffer
+    // Both forms of hash begin with the SHA-256 hash of the entry metadata, into a contiguous buffer of bytes, with the
+    // 8 bytes of salt appended onto the end
+    uint8_t buffer[sizeof(sha256_t) + 8];
     {
-        uint8_t buffer[sizeof(sha256_t) + 8];
-        {
-            SolBytes bytes;
-            bytes.addr = (uint8_t *) &(entry->metadata);
-            bytes.len = sizeof(entry->metadata);
-            if (sol_sha256(&bytes, 1, buffer)) {
-                return Error_InvalidHash;
-            }
+        SolBytes bytes;
+        bytes.addr = (uint8_t *) &(entry->metadata);
+        bytes.len = sizeof(entry->metadata);
+        if (sol_sha256(&bytes, 1, buffer)) {
+            return Error_InvalidHash;
         }
+    }
+
+    * (salt_t *) &(((sha256_t *) buffer)[1]) = salt;
+
+    if (merkle_leaf) {
+        // The leaf is the SHA-256 of the leaf prefix, the entry index, and the buffer, which holds the SHA-256 of the
+        // metadata followed by the 8 bytes of salt
+        uint8_t prefix = MERKLE_LEAF_PREFIX;
 
-        * (salt_t *) &(((sha256_t *) buffer)[1]) = salt;
+        SolBytes leaf[] = { { &prefix, sizeof(prefix) },
+                            { (uint8_t *) &(entry->entry_index), sizeof(entry->entry_index) },
+                            { buffer, sizeof(buffer) } };
 
-        {
-            SolBytes bytes;
-            bytes.addr = buffer;
-            bytes.len = sizeof(buffer);
-            if (sol_sha256(&bytes, 1, (uint8_t *) &computed_sha256)) {
-                return Error_InvalidHash;
-            }
+        if (sol_sha256(leaf, ARRAY_LEN(leaf), (uint8_t *) merkle_leaf)) {
+            return Error_InvalidHash;
         }
     }
+    else {
+        // The entry's own hash is the SHA-256 of the buffer
+        sha256_t computed_sha256;
+
+        SolBytes bytes;
+        bytes.addr = buffer;
+        bytes.len = sizeof(buffer);
+        if (sol_sha256(&bytes, 1, (uint8_t *) &computed_sha256)) {
+            return Error_InvalidHash;
+        }
 
-    // Now ensure that the entry's reveal_sha256 hash matches the computed hash.  This then verifies that the entry
-    // has had its metadata set already to the correct revealed values.
-    if (sol_memcmp(&computed_sha256, &(entry->reveal_sha256), sizeof(sha256_t))) {
+        // Now ensure that the entry's reveal_sha256 hash matches the computed hash.  This then verifies that the
+        // entry has had its metadata set already to the correct revealed values.
+        if (sol_memcmp(&computed_sha256, &(entry->reveal_sha256), sizeof(sha256_t))) {
+            return Error_InvalidHash;
+        }
+    }
+
+    // Now that the entry's metadata is known to be correct, its level_metadata_merkle_root can be used to check the
+    // supplied level 0 metadata
+    LevelMetadata level_metadata;
+    if (!get_proven_level_metadata(entry, 0, level_metadata_proof, &level_metadata)) {
         return Error_InvalidHash;
     }
 
+    set_entry_current_level(entry, &level_metadata);
+
+    PROFILE("metadata");
+
     // Update the metaplex metadata for the entry to include the level 0 state.
-    uint64_t ret = set_metaplex_metadata_for_level(entry, 0, metaplex_metadata_account, transaction_accounts,
+    uint64_t ret = set_metaplex_metadata_for_level(block, entry, &level_metadata, transaction_accounts,
                                                    transaction_accounts_len);
     if (ret) {
         return ret;
     }
 
-    // Now that the entry is revealed, set its reveal timestamp, and zero out its reveal_sha256, which is what puts
-    // the Entry into its revealed state.
+    // Now that the entry is revealed, set its reveal timestamp, and zero out its reveal_sha256, and put the Entry
+    // into its revealed state, which is owned if it was purchased as a mystery
     entry->reveal_timestamp = clock->unix_timestamp;
     sol_memset(&(entry->reveal_sha256), 0, sizeof(entry->reveal_sha256));
 
+    if (!set_entry_state(entry, (entry->state == EntryState_PreRevealOwned) ? EntryState_Owned :
+                         EntryState_Unowned)) {
+        return Error_InternalProgrammingError;
+    }
+
     // That's all that is needed to complete the reveal of an entry
     return 0;
 }
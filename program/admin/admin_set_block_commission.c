@@ -15,6 +15,8 @@ typedef struct
 
 static uint64_t admin_set_block_commission(const SolParameters *params)
 {
+    PROFILE_SCOPE("admin_set_block_commission");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,  config_account,                ReadOnly,  NotSigner,   KnownAccount_ProgramConfig);
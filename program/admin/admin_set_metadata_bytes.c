@@ -32,6 +32,8 @@ static uint64_t compute_set_metadata_bytes_data_size(uint16_t bytes_count)
 
 static uint64_t admin_set_metadata_bytes(const SolParameters *params)
 {
+    PROFILE_SCOPE("admin_set_metadata_bytes");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "inc/clock.h"
+#include "util/util_accounts.c"
+#include "util/util_block.c"
+
+
+typedef struct
+{
+    // This is the instruction code for SetMetadataBytesMany
+    uint8_t instruction_code;
+
+    // The entire metadata of each entry, in the order that the entry accounts are supplied
+    EntryMetadata metadata[];
+
+} SetMetadataBytesManyData;
+
+
+static uint64_t compute_set_metadata_bytes_many_data_size(uint8_t entry_count)
+{
+    const SetMetadataBytesManyData *b = 0;
+
+    return ((uint64_t) &(b->metadata[entry_count]));
+}
+
+
+static uint64_t admin_set_metadata_bytes_many(const SolParameters *params)
+{
+    PROFILE_SCOPE("admin_set_metadata_bytes_many");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,   config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
+        DECLARE_ACCOUNT(1,   admin_account,                 ReadOnly,   Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(2,   block_account,                 ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+    }
+
+    // The entry accounts follow the 3 fixed accounts, and there must be at least one
+    if (params->ka_num < 4) {
+        return Error_IncorrectNumberOfAccounts;
+    }
+
+    uint8_t entry_count = params->ka_num - 3;
+
+    DECLARE_ACCOUNTS_NUMBER(3 + entry_count);
+
+    // Ensure the the transaction has been authenticated by the admin
+    if (!is_admin_account(config_account, admin_account->key)) {
+        return Error_PermissionDenied;
+    }
+
+    // Get the instruction data, which must hold the metadata of exactly as many entries as were supplied
+    if (params->data_len != compute_set_metadata_bytes_many_data_size(entry_count)) {
+        return Error_InvalidDataSize;
+    }
+
+    const SetMetadataBytesManyData *data = (SetMetadataBytesManyData *) params->data;
+
+    // Get the block data
+    const Block *block = get_validated_block(block_account);
+    if (!block) {
+        return Error_InvalidAccount_First + 2;
+    }
+
+    // Make sure that the block is complete; can't be setting metadata into blocks for which all the entries
+    // have not been added yet
+    if (!is_block_complete(block)) {
+        return Error_BlockNotComplete;
+    }
+
+    // Make sure that the block has achieved its reveal criteria
+    Clock clock;
+    uint64_t retval = sol_get_clock_sysvar(&clock);
+    if (retval) {
+        return retval;
+    }
+    if (!is_complete_block_revealable(block, &clock)) {
+        return Error_BlockNotRevealable;
+    }
+
+    for (uint8_t i = 0; i < entry_count; i++) {
+        uint8_t account_index = 3 + i;
+
+        SolAccountInfo *entry_account = get_instruction_account(params, account_index);
+
+        // Ensure that the entry account is writable
+        if (!entry_account->is_writable) {
+            return Error_InvalidAccountPermissions_First + account_index;
+        }
+
+        // Get the validated Entry and ensure that it's for the provided block
+        Entry *entry = get_validated_entry_of_block(entry_account, block_account->key);
+        if (!entry) {
+            return Error_InvalidAccount_First + account_index;
+        }
+
+        // The entry can only have its metadata set if it's waiting for reveal, i.e. in a PreReveal state
+        // Not passing in block because don't care which exact PreReveal state it is
+        if (get_entry_state(0, entry, &clock) != EntryState_PreReveal) {
+            return Error_AlreadyRevealed;
+        }
+
+        // All checks passed for this entry, set its data.  If a later entry fails its checks, then the transaction
+        // fails, and so none of the metadata is modified.
+        entry->metadata = data->metadata[i];
+    }
+
+    // All done
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "util/util_program_config.c"
+
+
+typedef struct
+{
+    // This is the instruction code for SetSettlementThreshold
+    uint8_t instruction_code;
+
+    // The new commission settlement threshold.  Commission accrued on a staked entry is moved out of its stake account
+    // once it reaches this many lamports, or when the entry is destaked.
+    uint64_t threshold_lamports;
+
+} SetSettlementThresholdData;
+
+
+static uint64_t admin_set_settlement_threshold(const SolParameters *params)
+{
+    PROFILE_SCOPE("admin_set_settlement_threshold");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,  config_account,                ReadWrite, NotSigner,   KnownAccount_ProgramConfig);
+        DECLARE_ACCOUNT(1,  admin_account,                 ReadOnly,  Signer,      KnownAccount_NotKnown);
+    }
+    DECLARE_ACCOUNTS_NUMBER(2);
+
+    // Ensure the the transaction has been authenticated by the admin
+    if (!is_admin_account(config_account, admin_account->key)) {
+        return Error_PermissionDenied;
+    }
+
+    // Ensure that the data is the correct size
+    if (params->data_len != sizeof(SetSettlementThresholdData)) {
+        return Error_InvalidDataSize;
+    }
+
+    // Now the data can be used
+    const SetSettlementThresholdData *data = (SetSettlementThresholdData *) params->data;
+
+    ProgramConfig *config = get_validated_program_config(config_account);
+    if (!config) {
+        return Error_InvalidAccount_First;
+    }
+
+    // Entries that have already accrued commission settle against the new threshold at their next commission charge
+    config->commission_settlement_threshold_lamports = data->threshold_lamports;
+
+    return 0;
+}
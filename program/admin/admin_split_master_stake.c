@@ -1,5 +1,9 @@
 #pragma once
 
+#include "inc/clock.h"
+#include "util/util_program_config.c"
+
+
 typedef struct
 {
     // This is the instruction code for SplitMasterStake
@@ -27,6 +31,8 @@ typedef struct
 
 static uint64_t admin_split_master_stake(const SolParameters *params)
 {
+    PROFILE_SCOPE("admin_split_master_stake");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,  config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
@@ -93,8 +99,21 @@ static uint64_t admin_split_master_stake(const SolParameters *params)
         to_split += stake.stake.delegation.stake;
     }
 
+    // Get the program config cache, which supplies the rent exempt minimum of the split into account
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    ProgramConfigCache cache_buffer;
+    const ProgramConfigCache *cache;
+    uint64_t ret = get_program_config_cache(config_account, 0, &clock, &cache_buffer, &cache);
+    if (ret) {
+        return ret;
+    }
+
     // The split will be into the master_stake_split_account, which will be set with the withdraw authority of
     // the admin account
     return split_master_stake_signed(admin_account->key, master_stake_account, pre_merge_account, split_into_account,
-                                     to_split, params->ka, params->ka_num);
+                                     to_split, cache, params->ka, params->ka_num);
 }
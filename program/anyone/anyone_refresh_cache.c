@@ -0,0 +1,31 @@
+#pragma once
+
+#include "util/util_program_config.c"
+
+
+static uint64_t anyone_refresh_cache(const SolParameters *params)
+{
+    PROFILE_SCOPE("anyone_refresh_cache");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,  config_account,                ReadWrite,  NotSigner,  KnownAccount_ProgramConfig);
+        DECLARE_ACCOUNT(1,  stake_program_account,         ReadOnly,   NotSigner,  KnownAccount_StakeProgram);
+    }
+    DECLARE_ACCOUNTS_NUMBER(2);
+
+    ProgramConfig *config = get_validated_program_config(config_account);
+    if (!config) {
+        return Error_InvalidAccount_First;
+    }
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    // Refresh the cache even if it was already refreshed in the current epoch, since it costs little and ensures that
+    // a change to any of the values within an epoch is picked up
+    return refresh_program_config_cache(&(config->cache), clock.epoch);
+}
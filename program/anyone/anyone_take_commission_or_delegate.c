@@ -1,8 +1,13 @@
 #pragma once
 
+#include "util/util_commission.c"
+#include "util/util_program_config.c"
+
 
 static uint64_t anyone_take_commission_or_delegate(const SolParameters *params)
 {
+    PROFILE_SCOPE("anyone_take_commission_or_delegate");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,  funding_account,               ReadWrite,  Signer,     KnownAccount_NotKnown);
@@ -16,8 +21,9 @@ static uint64_t anyone_take_commission_or_delegate(const SolParameters *params)
         DECLARE_ACCOUNT(8,  system_program_account,        ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
         DECLARE_ACCOUNT(9,  stake_program_account,         ReadOnly,   NotSigner,  KnownAccount_StakeProgram);
         DECLARE_ACCOUNT(10, stake_history_sysvar_account,  ReadOnly,   NotSigner,  KnownAccount_StakeHistorySysvar);
+        DECLARE_ACCOUNT(11, config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
     }
-    DECLARE_ACCOUNTS_NUMBER(11);
+    DECLARE_ACCOUNTS_NUMBER(12);
 
     // Get validated block and entry, which checks all validity of those accounts
     const Block *block = get_validated_block(block_account);
@@ -43,7 +49,7 @@ static uint64_t anyone_take_commission_or_delegate(const SolParameters *params)
     }
 
     // Check to make sure that the entry is staked
-    if (get_entry_state(block, entry, &clock) != EntryState_OwnedAndStaked) {
+    if (get_entry_state(0, entry, &clock) != EntryState_OwnedAndStaked) {
         return Error_NotStaked;
     }
 
@@ -58,30 +64,16 @@ static uint64_t anyone_take_commission_or_delegate(const SolParameters *params)
         return Error_InvalidAccount_First + 3;
     }
 
-    // If the stake account is in an initialized state, then it's not delegated, so delegate it to Shinobi Systems
-    if (stake.state == StakeState_Initialized) {
-        uint64_t ret = delegate_stake_signed(stake_account->key, &(Constants.shinobi_systems_vote_pubkey),
-                                             params->ka, params->ka_num);
-        if (ret) {
-            return ret;
-        }
-
-        // Re-decode the stake account, to get the new delegation information
-        if (!decode_stake_account(stake_account, &stake)) {
-            return Error_InvalidAccount_First + 3;
-        }
-
-        // Record current lamports in the stake account to be used for ki harvesting purposes
-        entry->owned.last_ki_harvest_stake_account_lamports = stake.stake.delegation.stake;
-
-        // Record current lamports in the stake account to be used for commission purposes
-        entry->owned.last_commission_charge_stake_account_lamports = stake.stake.delegation.stake;
-
-        return 0;
-    }
-    // Else, it's initialized, so try charging commission
-    else {
-        return charge_commission(&stake, block, entry, funding_account->key, bridge_stake_account, stake_account->key,
-                                 params->ka, params->ka_num);
+    // Get the cached values of the program config
+    ProgramConfigCache cache_buffer;
+    const ProgramConfigCache *cache;
+    uint64_t ret = get_program_config_cache(config_account, 11, &clock, &cache_buffer, &cache);
+    if (ret) {
+        return ret;
     }
+
+    // Delegate the stake account, or charge commission, settling it only once the program config's threshold is met
+    return take_commission_or_delegate(&stake, block, entry, funding_account->key, stake_account, 3,
+                                       bridge_stake_account, cache, get_commission_settlement_threshold(config_account),
+                                       params->ka, params->ka_num);
 }
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "util/util_commission.c"
+#include "util/util_program_config.c"
+
+
+typedef struct
+{
+    // This is the instruction code for TakeCommissionOrDelegateMany
+    uint8_t instruction_code;
+
+    // Entries are processed in order until the estimated compute units used by processing the next entry would take
+    // the total beyond this budget
+    uint32_t compute_unit_budget;
+
+} TakeCommissionOrDelegateManyData;
+
+
+static uint64_t anyone_take_commission_or_delegate_many(const SolParameters *params)
+{
+    PROFILE_SCOPE("anyone_take_commission_or_delegate_many");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,  funding_account,               ReadWrite,  Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(1,  block_account,                 ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(2,  master_stake_account,          ReadWrite,  NotSigner,  KnownAccount_MasterStake);
+        DECLARE_ACCOUNT(3,  authority_account,             ReadOnly,   NotSigner,  KnownAccount_Authority);
+        DECLARE_ACCOUNT(4,  clock_sysvar_account,          ReadOnly,   NotSigner,  KnownAccount_ClockSysvar);
+        DECLARE_ACCOUNT(5,  system_program_account,        ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
+        DECLARE_ACCOUNT(6,  stake_program_account,         ReadOnly,   NotSigner,  KnownAccount_StakeProgram);
+        DECLARE_ACCOUNT(7,  stake_history_sysvar_account,  ReadOnly,   NotSigner,  KnownAccount_StakeHistorySysvar);
+        DECLARE_ACCOUNT(8,  config_account,                ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
+    }
+
+    // The (entry, stake, bridge) account triples follow the 9 fixed accounts, and there must be at least one
+    if ((params->ka_num < 12) || ((params->ka_num - 9) % 3)) {
+        return Error_IncorrectNumberOfAccounts;
+    }
+
+    uint8_t entry_count = (params->ka_num - 9) / 3;
+
+    DECLARE_ACCOUNTS_NUMBER(9 + (entry_count * 3));
+
+    // Get the instruction data
+    if (params->data_len != sizeof(TakeCommissionOrDelegateManyData)) {
+        return Error_InvalidDataSize;
+    }
+
+    const TakeCommissionOrDelegateManyData *data = (TakeCommissionOrDelegateManyData *) params->data;
+
+    // Get validated block, which checks all validity of that account
+    const Block *block = get_validated_block(block_account);
+    if (!block) {
+        return Error_InvalidAccount_First + 1;
+    }
+
+    // Ensure that the block is complete; cannot stake in a block that is not complete yet
+    if (!is_block_complete(block)) {
+        return Error_BlockNotComplete;
+    }
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    // Get the cached values of the program config, which are shared by all entries.  If the config account is
+    // writable and the values are from a prior epoch, they are refreshed in the config.
+    ProgramConfigCache cache_buffer;
+    const ProgramConfigCache *cache;
+    uint64_t ret = get_program_config_cache(config_account, 8, &clock, &cache_buffer, &cache);
+    if (ret) {
+        return ret;
+    }
+
+    // Commission is only settled once enough has accrued
+    uint64_t settlement_threshold_lamports = get_commission_settlement_threshold(config_account);
+
+    // Estimated compute units used so far by the processing of entries
+    uint32_t units = 0;
+
+    uint8_t processed_count = 0;
+
+    for (; processed_count < entry_count; processed_count++) {
+        uint8_t account_index = 9 + (processed_count * 3);
+
+        SolAccountInfo *entry_account = get_instruction_account(params, account_index);
+        SolAccountInfo *stake_account = get_instruction_account(params, account_index + 1);
+        SolAccountInfo *bridge_stake_account = get_instruction_account(params, account_index + 2);
+
+        // Ensure that the accounts of the entry are writable
+        for (uint8_t i = 0; i < 3; i++) {
+            if (!get_instruction_account(params, account_index + i)->is_writable) {
+                return Error_InvalidAccountPermissions_First + account_index + i;
+            }
+        }
+
+        // This is the entry data
+        Entry *entry = get_validated_entry_of_block(entry_account, block_account->key);
+        if (!entry) {
+            return Error_InvalidAccount_First + account_index;
+        }
+
+        // An entry that is no longer staked, which may happen if it was destaked after the caller looked it up, is
+        // skipped rather than failing the whole instruction
+        if (get_entry_state(0, entry, &clock) != EntryState_OwnedAndStaked) {
+            if ((units + TAKE_COMMISSION_CHECK_UNITS) > data->compute_unit_budget) {
+                break;
+            }
+            units += TAKE_COMMISSION_CHECK_UNITS;
+            continue;
+        }
+
+        // Check to make sure that the stake account passed in is actually staked in the entry
+        if (!SolPubkey_same(&(entry->owned.stake_account), stake_account->key)) {
+            return Error_InvalidAccount_First + account_index + 1;
+        }
+
+        // Decode the stake account
+        Stake stake;
+        if (!decode_stake_account(stake_account, &stake)) {
+            return Error_InvalidAccount_First + account_index + 1;
+        }
+
+        // Stop if processing this entry could exceed the budget
+        uint32_t entry_units = estimate_take_commission_or_delegate_units(&stake, entry, settlement_threshold_lamports);
+        if ((units + entry_units) > data->compute_unit_budget) {
+            break;
+        }
+        units += entry_units;
+
+        ret = take_commission_or_delegate(&stake, block, entry, funding_account->key, stake_account,
+                                          account_index + 1, bridge_stake_account, cache,
+                                          settlement_threshold_lamports, params->ka, params->ka_num);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    // Return the number of entries that were processed, so that the caller can submit the remainder in another
+    // transaction
+    sol_set_return_data(&processed_count, sizeof(processed_count));
+
+    return 0;
+}
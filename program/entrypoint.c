@@ -8,6 +8,12 @@
 // Include definition of all errors
 #include "inc/error.h"
 
+// Include compute unit profiling macros, which do nothing unless SHINOBI_PROFILE is defined
+#include "inc/profile.h"
+
+// Include the parser of program input
+#include "util/util_input.c"
+
 
 // These are all instructions that this program can execute
 typedef enum
@@ -61,7 +67,7 @@ typedef enum
     Instruction_Destake                       = 16,
     // Harvest Ki
     Instruction_Harvest                       = 17,
-    // Level up an entry.  This requires as input am amount of Ki, which is burned.
+    // Level up an entry, by one or more levels.  This requires as input am amount of Ki, which is burned.
     Instruction_LevelUp                       = 18,
 
     // Anyone functions: anyone may perform these actions --------------------------------------------------------------
@@ -78,7 +84,42 @@ typedef enum
     // bugs or problems with this program; or a need to upgrade the program to handle new conditions.  The program
     // can't be upgraded but a new program can be made and then given authority over all user owned entries via this
     // instruction (but only if both the user and admin agree to do so).
-    Instruction_ReAuthorize                   = 20
+    Instruction_ReAuthorize                   = 20,
+
+    // Admin functions added later -------------------------------------------------------------------------------------
+    // Set the entire metadata of one or more entries of a block at once.  This has the same requirements as
+    // SetMetadataBytes.
+    Instruction_SetMetadataBytesMany          = 21,
+
+    // User functions added later --------------------------------------------------------------------------------------
+    // Harvest Ki from many staked entries of the same owner at once, minting the total into a single Ki account
+    Instruction_HarvestMany                   = 22,
+
+    // Anyone functions added later ------------------------------------------------------------------------------------
+    // TakeCommissionOrDelegate for many staked entries of a block at once, stopping once the estimated compute units
+    // used would exceed a budget given in the instruction data.  Returns the number of entries processed as return
+    // data.
+    Instruction_TakeCommissionOrDelegateMany  = 23,
+    // Refresh the values cached in the program config, which are otherwise refreshed by the first instruction of each
+    // epoch that is given the program config account as writable
+    Instruction_RefreshCache                  = 24,
+
+    // Admin functions added later -------------------------------------------------------------------------------------
+    // Set the number of lamports of commission that must accrue on a staked entry before it is moved out of the
+    // entry's stake account into the master stake account
+    Instruction_SetSettlementThreshold        = 25,
+
+    // User functions added later --------------------------------------------------------------------------------------
+    // Buy an entry that has already been revealed, and stake it to a stake account in the same instruction, as Buy
+    // followed by Stake would
+    Instruction_BuyAndStake                   = 26,
+    // Claim a winning bid, reclaiming the bid marker token, and stake the entry to a stake account in the same
+    // instruction, as ClaimWinning followed by Stake would
+    Instruction_ClaimWinningAndStake          = 27,
+    // Bid on an entry whose bids are escrowed in the entry itself, refunding the bid that is outbid
+    Instruction_EscrowedBid                   = 28,
+    // ClaimLosing for many losing bids of the same bidder at once, reclaiming all of their bid marker tokens
+    Instruction_ClaimLosingMany               = 29
 
 } Instruction;
 
@@ -95,6 +136,8 @@ typedef enum
 #include "admin/admin_split_master_stake.c"
 #include "admin/admin_add_whitelist_entries.c"
 #include "admin/admin_delete_whitelist.c"
+#include "admin/admin_set_metadata_bytes_many.c"
+#include "admin/admin_set_settlement_threshold.c"
 
 #include "user/user_buy.c"
 #include "user/user_refund.c"
@@ -105,8 +148,15 @@ typedef enum
 #include "user/user_destake.c"
 #include "user/user_harvest.c"
 #include "user/user_level_up.c"
+#include "user/user_harvest_many.c"
+#include "user/user_buy_and_stake.c"
+#include "user/user_claim_winning_and_stake.c"
+#include "user/user_escrowed_bid.c"
+#include "user/user_claim_losing_many.c"
 
 #include "anyone/anyone_take_commission_or_delegate.c"
+#include "anyone/anyone_take_commission_or_delegate_many.c"
+#include "anyone/anyone_refresh_cache.c"
 
 #include "special/special_reauthorize.c"
 
@@ -116,13 +166,9 @@ uint64_t entrypoint(const uint8_t *input)
 {
     SolParameters params;
 
-    // At most 21 accounts are supported for any command.  This is enough for 3 entries in the "add entries to block"
-    // instruction.
-    SolAccountInfo account_info[21];
-    params.ka = account_info;
-
-    // Deserialize parameters.  Must succeed.
-    if (!sol_deserialize(input, &params, ARRAY_LEN(account_info))) {
+    // Deserialize parameters.  Must succeed.  Accounts are only decoded as they are declared by the instruction
+    // handler.  At most MAX_INSTRUCTION_ACCOUNTS accounts are supported for any command.
+    if (!deserialize_input(input, &params)) {
         return Error_InvalidData;
     }
 
@@ -197,6 +243,33 @@ uint64_t entrypoint(const uint8_t *input)
     case Instruction_ReAuthorize:
         return special_reauthorize(&params);
 
+    case Instruction_SetMetadataBytesMany:
+        return admin_set_metadata_bytes_many(&params);
+
+    case Instruction_HarvestMany:
+        return user_harvest_many(&params);
+
+    case Instruction_TakeCommissionOrDelegateMany:
+        return anyone_take_commission_or_delegate_many(&params);
+
+    case Instruction_RefreshCache:
+        return anyone_refresh_cache(&params);
+
+    case Instruction_SetSettlementThreshold:
+        return admin_set_settlement_threshold(&params);
+
+    case Instruction_BuyAndStake:
+        return user_buy_and_stake(&params);
+
+    case Instruction_ClaimWinningAndStake:
+        return user_claim_winning_and_stake(&params);
+
+    case Instruction_EscrowedBid:
+        return user_escrowed_bid(&params);
+
+    case Instruction_ClaimLosingMany:
+        return user_claim_losing_many(&params);
+
     default:
         return Error_UnknownInstruction;
     }
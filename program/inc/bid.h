@@ -12,4 +12,7 @@ typedef struct
     // The bidder account
     SolPubkey bidder_pubkey;
 
+    // Bump seed of the Program Derived Address of the bid marker token account of the bidder
+    uint8_t bid_marker_token_bump_seed;
+
 } Bid;
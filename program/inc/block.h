@@ -4,6 +4,13 @@
 #include "inc/types.h"
 
 
+// This is the maximum number of URI prefixes of a block
+#define MAX_BLOCK_URI_PREFIXES 4
+
+// This is the maximum length of each URI prefix of a block
+#define MAX_URI_PREFIX_LENGTH 96
+
+
 // This is all configuration values that define the operational parameters of a block of entries.  These values are
 // supplied when the block is first created, and can never be changed
 typedef struct
@@ -45,6 +52,12 @@ typedef struct
     // price that is determined by parameters in [non_auction];
     bool has_auction;
 
+    // If this is true, then the entries of the block, which must have an auction, hold their bids in escrow
+    // themselves: each entry holds the lamports of its current highest bid and records its bidder, and a bidder who
+    // is outbid is refunded by the EscrowedBid instruction that outbids them.  No Bid accounts or bid marker tokens
+    // are created, and there are no losing bids to claim.  If this is false, each bid is held in its own Bid account.
+    bool escrow_bids;
+
     // This is the duration to use for auctions and for final sale periods.
     uint32_t duration;
 
@@ -62,6 +75,27 @@ typedef struct
     // then no whitelist is ever used for this block.
     uint32_t whitelist_duration;
 
+    // Blocks with a whitelist may instead use a Merkle whitelist, which requires no whitelist accounts at all.  If
+    // whitelist_slot_count is nonzero, then whitelist_merkle_root is the root of a Merkle tree of whitelist leaves (see
+    // inc/whitelist.h), each of which allows a system account some number of purchases, and the buyer supplies the
+    // proof of their leaf with the Buy instruction.  Every purchase allowed by the tree has its own slot, numbered
+    // from 0 to whitelist_slot_count - 1, and the block records which slots have been used in its whitelist claimed
+    // bitmap.  If whitelist_slot_count is zero, then the whitelist (if any) is stored in whitelist accounts.
+    uint16_t whitelist_slot_count;
+
+    // Root of the Merkle tree of whitelist leaves; only used if whitelist_slot_count is nonzero
+    sha256_t whitelist_merkle_root;
+
+    // If this is all zeroes, then each entry of the block is committed to by its own reveal_sha256, supplied when
+    // the entry is added.  Otherwise, this is the root of a Merkle tree (see inc/merkle.h) with one leaf per entry,
+    // which commits to the reveal of every entry of the block at once.  Leaf N of the tree is the SHA-256 of:
+    //   MERKLE_LEAF_PREFIX (1 byte)
+    //   N, the index of the entry (2 bytes, little endian)
+    //   the SHA-256 of the Entry metadata that will be supplied by the reveal transaction (32 bytes)
+    //   8 bytes of salt
+    // and the RevealEntries instruction supplies the proof of the range of entries that it reveals.
+    sha256_t reveal_merkle_root;
+
 } BlockConfiguration;
 
 
@@ -71,6 +105,10 @@ typedef struct
     // This is an indicator that the data is a Block
     DataType data_type;
 
+    // Bump seed of the Program Derived Address of the whitelist of this block.  This is recorded even if the block has
+    // no whitelist, so that the address of any whitelist account supplied with the block can be verified.
+    uint8_t whitelist_bump_seed;
+
     // This is the configuration of the block.  It is never changed after the block is created.  Each entry of the
     // block contains a duplicate of this data in its config.
     BlockConfiguration config;
@@ -98,8 +136,21 @@ typedef struct
     // Epoch of the last time that the commission was changed
     uint64_t last_commission_change_epoch;
 
+    // For blocks with a Merkle whitelist, this is the number of whitelist slots that have been claimed.  Once all of
+    // them have been claimed, the whitelist no longer restricts purchases.
+    uint16_t whitelist_claimed_count;
+
+    // These are the prefixes of the Metadata URLs of the levels of the entries of this block, each of which is
+    // completed by the uri_suffix of a level (see LevelMetadata).  They are supplied when the block is created and are
+    // never changed, because entries commit to their metadata, including the uri_prefix_index of each level, before
+    // they are revealed.  Each prefix is padded with zeroes; a prefix of MAX_URI_PREFIX_LENGTH characters has no
+    // terminating zero.  Unused prefixes are all zeroes, i.e. the empty string.
+    uint8_t uri_prefixes[MAX_BLOCK_URI_PREFIXES][MAX_URI_PREFIX_LENGTH];
+
     // This is a bitmap of all entries which have been added to the block.  If a bit is 1, the entry has been
-    // added already; if it is 0, the entry has not been added.  This allows entries to be added in parallel.
+    // added already; if it is 0, the entry has not been added.  This allows entries to be added in parallel.  This is
+    // followed by the whitelist claimed bitmap, which has one bit per whitelist slot (see
+    // get_whitelist_claimed_bitmap()); a bit is 1 if the purchase allowed by that slot has been made.
     uint8_t entries_added_bitmap[0];
 
 } Block;
@@ -11,6 +11,16 @@
 // has to anticipate the maximum possible minimum stake account size.
 #define MASTER_STAKE_ACCOUNT_MIN_LAMPORTS (((2 * 1) + 1) * LAMPORTS_PER_SOL)
 
+// Estimated compute units used by TakeCommissionOrDelegateMany for each entry, including the cross-program invocations
+// and the stake program work that they incur.  These are conservative, so that an instruction that stops when its
+// estimated usage would exceed the caller's compute unit budget never actually runs out of compute units.
+// For validating an entry and its accounts, which applies to every entry, even one that is not staked
+#define TAKE_COMMISSION_CHECK_UNITS 2000
+// For delegating an undelegated stake account
+#define TAKE_COMMISSION_DELEGATE_UNITS 6000
+// For charging commission, assuming that a bridge stake account is needed
+#define TAKE_COMMISSION_CHARGE_UNITS 25000
+
 // This is the Ki token name
 #define KI_TOKEN_NAME "Ki"
 
@@ -66,7 +76,9 @@ typedef enum
 
     PDA_Account_Seed_Prefix_Entry = 15,
 
-    PDA_Account_Seed_Prefix_Master_Split = 16
+    PDA_Account_Seed_Prefix_Master_Split = 16,
+
+    PDA_Account_Seed_Prefix_Whitelist_Shard = 17
 
 } PDA_Account_Seed_Prefix;
 
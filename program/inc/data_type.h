@@ -22,6 +22,9 @@ typedef enum
     DataType_Bid            = 4,
 
     // Whitelist
-    DataType_Whitelist      = 5
+    DataType_Whitelist      = 5,
+
+    // Whitelist shard
+    DataType_WhitelistShard = 6
 
 } DataType;
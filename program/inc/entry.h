@@ -26,6 +26,12 @@ typedef enum EntryState
 } EntryState;
 
 
+// This is the maximum length of the suffix of the Metadata URL of a level of an entry (see
+// LevelMetadata.uri_suffix).  Together with the maximum URI prefix length of a block, this is within the 200 character
+// maximum length of a metaplex metadata uri.
+#define URI_SUFFIX_LENGTH 64
+
+
 typedef struct
 {
     // Form at this level
@@ -34,14 +40,19 @@ typedef struct
     // Attack and defense skill (top 4 bits = attack, bottom 4 = defense)
     uint8_t skill;
 
+    // Index into the uri_prefixes of the entry's block of the prefix of the Metadata URL at this level
+    uint8_t uri_prefix_index;
+
     // This is the number of Ki tokens earned per 1 SOL of stake rewards earned by stake accounts staked to the entry.
     uint32_t ki_factor;
 
     // Name of the entry at each level (metaplex metadata maximum name length of 48)
     uint8_t name[48];
 
-    // Metadata URL of the entry at this level (metaplex metadata uri length is 200)
-    uint8_t uri[200];
+    // The Metadata URL of the entry at this level is the block's URI prefix at uri_prefix_index followed by this
+    // suffix.  The URLs of the entries of a block typically differ only in their last path component, so storing the
+    // shared prefix once in the block rather than in every level of every entry keeps the Entry account small.
+    uint8_t uri_suffix[URI_SUFFIX_LENGTH];
 
     // SHA-256 of the contents of the Metadata URL at this level.  Used to both verify the metadata and also
     // to allow alternate methods (outside of the scope of this program) for fetching metadata
@@ -58,12 +69,35 @@ typedef struct
     // These are random numbers that can be used by other programs.  These values are randomly generated per entry.
     uint32_t random[16];
 
-    // Metadata for each of the 9 levels
-    LevelMetadata level_metadata[9];
+    // Merkle root (see inc/merkle.h) of the metadata of the 9 levels of the entry.  Leaf N of the tree is the SHA-256
+    // of MERKLE_LEAF_PREFIX (1 byte), N (1 byte), and the LevelMetadata of level N.  Only this root is stored in the
+    // entry; the LevelMetadata of a level is supplied, along with its proof, by the instruction that takes the entry
+    // to that level (RevealEntries for level 0, LevelUp for all other levels).
+    sha256_t level_metadata_merkle_root;
 
 } EntryMetadata;
 
 
+// This is the number of hashes in the proof of a single leaf of the 9 leaf level metadata Merkle tree
+#define MAX_LEVEL_METADATA_PROOF_LENGTH 4
+
+
+// This is the LevelMetadata of a level of an entry together with the proof of that level's leaf in the entry's
+// level_metadata_merkle_root, as supplied in instruction data
+typedef struct
+{
+    // The metadata of the level
+    LevelMetadata level_metadata;
+
+    // Number of hashes in proof
+    uint8_t proof_length;
+
+    // The proof of the leaf of the level
+    sha256_t proof[0];
+
+} LevelMetadataProof;
+
+
 typedef struct
 {
     // This is an indicator that the data is an Entry
@@ -91,6 +125,10 @@ typedef struct
     // Program Derived Address of the metaplex metadata account
     SolPubkey metaplex_metadata_pubkey;
 
+    // Bump seed of the Program Derived Address of the bridge stake account that is used when charging commission on
+    // this entry's stake account.  Storing this allows the bridge address to be verified without searching for it.
+    uint8_t bridge_bump_seed;
+
     // This value is used in three ways:
     // - It is the final price of the mystery at the end of this entry's mystery phase
     // - It is the starting price of an auction for this entry
@@ -103,6 +141,10 @@ typedef struct
     // price that is determined by parameters in [non_auction];
     bool has_auction;
 
+    // If this is true, then the bids of this entry's auction are escrowed in the entry itself rather than in Bid
+    // accounts (see BlockConfiguration.escrow_bids)
+    bool escrow_bids;
+
     // If [has_auction] is true, this is a number of seconds to add to entry reveal time to get the end of auction
     // time, which must be > 0.
     // If [has_auction] is false, this is the number of seconds it takes for the entry price to decay from
@@ -116,6 +158,7 @@ typedef struct
     // Before the entry is revealed, this holds the SHA-256 of the following values concatenated together:
     // - The SHA-256 of the Entry metadata that will be supplied by the reveal transaction
     // - 8 bytes of salt
+    // or, if the entry's block has a reveal_merkle_root, a copy of that root.
     // After the entry is revealed, this holds all zeroes
     sha256_t reveal_sha256;
 
@@ -134,6 +177,11 @@ typedef struct
     // entry again.
     bool refund_awarded;
 
+    // The state of the entry as of the last instruction that changed it, which is one of EntryState_PreRevealUnowned,
+    // EntryState_PreRevealOwned, EntryState_Unowned, EntryState_Owned, or EntryState_OwnedAndStaked.  The other
+    // states depend upon the time and the entry's block, and are resolved from this one by get_entry_state().
+    uint8_t state;
+
     // This is the commission to charge for this entry.  It is copied from the entry's block's commission when the
     // entry is first created, and after every commission charge to the entry.  This allows the block's commission
     // to be updated, and only take effect after all owed commission has already been charged at the prior commission.
@@ -147,10 +195,16 @@ typedef struct
         // time left in the auction) higher than the previous bid
         uint64_t highest_bid_lamports;
 
-        // Bid account address of the highest bid.  It is necessary to store this here to track what the winning
-        // bid is; cannot rely just on the lamports value of the bid account since someone could send SOL into that
-        // via a system transfer after it is created.
-        SolPubkey winning_bid_pubkey;
+        union {
+            // Bid account address of the highest bid.  It is necessary to store this here to track what the winning
+            // bid is; cannot rely just on the lamports value of the bid account since someone could send SOL into that
+            // via a system transfer after it is created.
+            SolPubkey winning_bid_pubkey;
+
+            // If [escrow_bids] is true, there are no Bid accounts, and this is instead the address of the bidder of
+            // the highest bid, whose highest_bid_lamports are held in escrow by the entry account itself
+            SolPubkey winning_bidder_pubkey;
+        };
 
     } auction;
 
@@ -169,9 +223,14 @@ typedef struct
         // Lamports in the stake account at which Ki was most recently harvested
         uint64_t last_ki_harvest_stake_account_lamports;
 
-        // Number of lamports in the stake account at the time of its last commission collection
+        // Number of lamports in the stake account at the time that commission was last accrued
         uint64_t last_commission_charge_stake_account_lamports;
 
+        // Commission that has been accrued but is still in the stake account.  It is moved out of the stake account
+        // into the master stake account once it reaches the settlement threshold of the program config, or when the
+        // entry is destaked.  Until then, it does not count towards the stake account earnings that Ki is harvested on.
+        uint64_t accrued_commission_lamports;
+
     } owned;
 
     // Current level of the entry
@@ -180,4 +239,24 @@ typedef struct
     // This is the entry's metadata
     EntryMetadata metadata;
 
+    // These are the values of the entry's current level, copied from the proven LevelMetadata of that level when the
+    // entry is revealed and when it is leveled up
+    struct {
+        // Form at the current level
+        uint32_t form;
+
+        // Attack and defense skill at the current level (top 4 bits = attack, bottom 4 = defense)
+        uint8_t skill;
+
+        // Number of Ki tokens earned per 1 SOL of stake rewards at the current level
+        uint32_t ki_factor;
+
+    } current_level;
+
+    // The second creator of the entry's metaplex metadata, or all zeroes if it has none.  The creators of the metadata
+    // are always the Shinobi Systems vote account, this creator if present, and the program authority, with fixed
+    // shares, so storing this allows the creators to be re-encoded when the metadata is updated without decoding the
+    // existing metadata.
+    SolPubkey second_metaplex_metadata_creator;
+
 } Entry;
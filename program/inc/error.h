@@ -146,6 +146,10 @@ typedef enum
     // Invalid attempt to resize an account
     Error_InvalidResize                                = 1054,
 
+    // Attempt to bid on or claim a bid of an entry in a way that its auction does not use: with Bid accounts when its
+    // bids are escrowed in the entry, or with escrow when they are not
+    Error_WrongAuctionMode                             = 1055,
+
     // Errors Error_InvalidAccount_First through Error_InvalidAccount_Last are used to indicate an error in input
     // account, where the specific input field that was faulty is the offset from Error_InvalidAccount_First
     Error_InvalidAccount_First                         = 1100,
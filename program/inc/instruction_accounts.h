@@ -1,6 +1,8 @@
 #pragma once
 
 #include "inc/constants.h"
+#include "inc/profile.h"
+#include "util/util_input.c"
 
 typedef enum
 {
@@ -38,13 +40,13 @@ typedef enum
     Signer = 1
 } AccountSigner;
 
-#define DECLARE_ACCOUNTS uint8_t _account_num = 0;
+#define DECLARE_ACCOUNTS PROFILE("accounts"); uint8_t _account_num = 0;
 
 #define DECLARE_ACCOUNT(n, name, writable, signer, known_account) }                                                    \
     if (_account_num == params->ka_num) {                                                                              \
         return Error_IncorrectNumberOfAccounts;                                                                        \
     }                                                                                                                  \
-    SolAccountInfo *name = &(params->ka[_account_num++]);                                                              \
+    SolAccountInfo *name = get_instruction_account(params, _account_num++);                                            \
     if (!check_known_account(name, (known_account))) {                                                                 \
         return Error_InvalidAccount_First + (_account_num - 1);                                                        \
     }                                                                                                                  \
@@ -53,11 +55,27 @@ typedef enum
         return Error_InvalidAccountPermissions_First + (_account_num - 1);                                             \
     } {
 
-#define DECLARE_ACCOUNTS_NUMBER(n) if (params->ka_num != (n)) { return Error_IncorrectNumberOfAccounts; }
+#define DECLARE_ACCOUNTS_NUMBER(n)                                                                                     \
+    if (params->ka_num != (n)) { return Error_IncorrectNumberOfAccounts; }                                             \
+    PROFILE("instruction")
 
 
+// Returns true if [account] is [known_account].  Once an account has been found to be a known account, later checks
+// of it (or of a duplicate of it) against the same known account succeed without comparing its key again, so that
+// a role such as the program config, which is checked by DECLARE_ACCOUNT and then again by the functions that read
+// it, has its key compared only once per instruction.
 static bool check_known_account(const SolAccountInfo *account, KnownAccount known_account)
 {
+    if (known_account == KnownAccount_NotKnown) {
+        return true;
+    }
+
+    uint8_t *checked_known_account = get_checked_known_account(account);
+
+    if (checked_known_account && (*checked_known_account == known_account)) {
+        return true;
+    }
+
     const SolPubkey *known_pubkey;
 
     switch (known_account) {
@@ -141,5 +159,13 @@ static bool check_known_account(const SolAccountInfo *account, KnownAccount know
         break;
     }
 
-    return SolPubkey_same(account->key, known_pubkey);
+    if (!SolPubkey_same(account->key, known_pubkey)) {
+        return false;
+    }
+
+    if (checked_known_account) {
+        *checked_known_account = known_account;
+    }
+
+    return true;
 }
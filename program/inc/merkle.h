@@ -0,0 +1,27 @@
+#pragma once
+
+// Merkle trees are used to commit to a large set of values with a single SHA-256 value stored in a block (see
+// BlockConfiguration.whitelist_merkle_root and BlockConfiguration.reveal_merkle_root).  Each leaf of a tree is the
+// SHA-256 of MERKLE_LEAF_PREFIX (1 byte) followed by the values of the leaf, which are described where each tree is
+// defined.  Each interior node of the tree is the SHA-256 of:
+//   MERKLE_NODE_PREFIX (1 byte)
+//   the lesser of its two children (32 bytes)
+//   the greater of its two children (32 bytes)
+// where children are compared by their bytes, as memcmp would.  Leaf N of a level is paired with leaf N ^ 1 of that
+// level; a node without a sibling (the last node of a level with an odd number of nodes) is carried up to the next
+// level of the tree unchanged.  The prefixes ensure that a leaf can never be mistaken for an interior node.
+//
+// Because children are ordered by value, the proof of a single leaf is just the list of sibling hashes from the leaf
+// up to the root.
+//
+// A range of consecutive leaves can be proven together, sharing the nodes that their paths to the root have in
+// common.  The proof of a range is, for each level of the tree from the leaves up, the sibling of the first node of
+// the range if that sibling is outside of the range, followed by the sibling of the last node of the range if that
+// sibling is outside of the range.  The range at the next level up is the parents of the nodes of the range.
+#define MERKLE_LEAF_PREFIX 0
+
+#define MERKLE_NODE_PREFIX 1
+
+// This is the maximum number of hashes in the proof of a range of leaves, which is enough for a tree with 65,535
+// leaves
+#define MAX_MERKLE_RANGE_PROOF_LENGTH 32
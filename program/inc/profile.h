@@ -0,0 +1,42 @@
+#pragma once
+
+#include "solana_sdk.h"
+
+// Compute unit profiling.  When the program is built with SHINOBI_PROFILE defined (SHINOBI_PROFILE=1 ./build_program.sh
+// or make SHINOBI_PROFILE=1 program.so), these macros log a marker followed by the compute units remaining at that
+// point.  scripts/profile_cu.sh converts the logs of a transaction into a table of compute units consumed per phase.
+// When SHINOBI_PROFILE is not defined, the macros expand to nothing and the program that is built is unchanged.
+//
+// Phases nest: PROFILE_SCOPE(name) begins a phase which lasts until the enclosing scope is exited by any means, and
+// within it, PROFILE(name) names each successive step.  Compute units consumed by cross-program invocations are
+// included in the phase that performs the invocation.
+//
+// Each marker costs two log syscalls; scripts/profile_cu.sh subtracts that cost from the phase that contains the
+// marker.
+
+#ifdef SHINOBI_PROFILE
+
+static void profile_scope_exit(const uint8_t *unused)
+{
+    (void) unused;
+
+    sol_log("PROFILE <");
+    sol_log_compute_units();
+}
+
+// Marks the start of a step within the current phase
+#define PROFILE(name) do { sol_log("PROFILE = " name); sol_log_compute_units(); } while (0)
+
+// Begins a phase which ends when the current scope is exited.  Only one may be used per scope.
+#define PROFILE_SCOPE(name)                                                                                            \
+    sol_log("PROFILE > " name);                                                                                        \
+    sol_log_compute_units();                                                                                           \
+    __attribute__((cleanup(profile_scope_exit))) uint8_t _profile_scope = 0
+
+#else
+
+#define PROFILE(name)
+
+#define PROFILE_SCOPE(name)
+
+#endif
@@ -3,6 +3,37 @@
 #include "data_type.h"
 
 
+// The rent exemption parameters of the Rent sysvar, decoded so that the rent exempt minimum of an account can be
+// computed using only integer math.  See compute_rent_exempt_minimum().
+typedef struct
+{
+    uint64_t lamports_per_byte_year;
+
+    // The biased exponent of the f64 exemption threshold
+    uint16_t exemption_threshold_exponent;
+
+    // The top 10 bits of the fraction of the f64 exemption threshold, rounded up
+    uint16_t exemption_threshold_fraction;
+
+} RentExemption;
+
+
+// Values that would otherwise have to be fetched via syscall or cross-program invocation by every instruction that
+// uses them, and which do not change within an epoch
+typedef struct
+{
+    // The epoch in which the values were fetched; they are only used within this epoch
+    uint64_t epoch;
+
+    // The minimum delegation allowed in a stake account
+    uint64_t minimum_stake_delegation_lamports;
+
+    // The rent exemption parameters
+    RentExemption rent_exemption;
+
+} ProgramConfigCache;
+
+
 // This is the type of data stored in the
 typedef struct
 {
@@ -13,4 +44,13 @@ typedef struct
     // account must sign any transaction requiring admin privileges.
     SolPubkey admin_pubkey;
 
+    // Cached values, which are fetched when the config is created and then again by the first instruction of each
+    // epoch that is given the config account as writable, or by RefreshCache
+    ProgramConfigCache cache;
+
+    // Commission accrued on a staked entry is only moved out of its stake account once it reaches this many lamports
+    // (or when the entry is destaked), so that most commission charges need only update the entry.  Set by the admin
+    // via SetSettlementThreshold; zero settles all commission as soon as it is charged.
+    uint64_t commission_settlement_threshold_lamports;
+
 } ProgramConfig;
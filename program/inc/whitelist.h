@@ -1,20 +1,78 @@
 #pragma once
 
-// This is the maximum number of whitelist entries allowed in a whitelist.  The absolute maximum that would fit into
-// the 10KB limit of a PDA is 319.
-#define MAX_WHITELIST_ENTRIES 300
+// A whitelist is stored in a root whitelist account plus up to WHITELIST_SHARD_COUNT shard accounts.  Each whitelisted
+// pubkey is stored in the shard selected by the high bits of its first byte (see whitelist_shard_index()), so that a
+// buyer only needs to supply the root and the one shard that could contain their pubkey.  Within a shard, entries are
+// kept sorted so that they can be found with a binary search.
+#define WHITELIST_SHARD_COUNT 16
 
-// This is the format of data stored in a whitelist account
+// This is the maximum number of whitelist entries allowed in a single whitelist shard.  Shards are grown as entries
+// are added, so this only limits the size that a shard can reach; a shard holding this many entries is 32 KB in size.
+// The whole whitelist can hold WHITELIST_SHARD_COUNT times this many entries, less whatever imbalance there is between
+// shards (which for randomly generated pubkeys is small).
+#define MAX_WHITELIST_SHARD_ENTRIES 1024
+
+// This is the maximum number of whitelist entries that can be added by a single AddWhitelistEntries instruction,
+// which is limited by the maximum size of a transaction
+#define MAX_WHITELIST_ADD_ENTRIES 27
+
+// Blocks with a Merkle whitelist (see BlockConfiguration.whitelist_slot_count) commit to their whitelist with the root
+// of a Merkle tree (see inc/merkle.h) instead of storing it in whitelist accounts.  Each leaf of the tree is the
+// SHA-256 of:
+//   MERKLE_LEAF_PREFIX (1 byte)
+//   pubkey of the whitelisted system account (32 bytes)
+//   first slot of the leaf (2 bytes, little endian)
+//   allowance of the leaf (1 byte)
+// which allows the system account to make [allowance] purchases, using slots [first slot] through
+// [first slot + allowance - 1] of the block's whitelist claimed bitmap.
+
+// This is the maximum number of hashes in a Merkle whitelist proof, which is enough for a tree with one leaf for each
+// of the 65,535 possible whitelist slots
+#define MAX_WHITELIST_PROOF_LENGTH 16
+
+// This is the format of data stored in a whitelist root account
 typedef struct
 {
     // This is an indicator that the data is a Whitelist
     DataType data_type;
 
-    // Number of entries in the whitelist.  Entries may be removed after being added, in which case the entry
-    // at that index will be all zeroes.
-    uint16_t count;
+    // Total number of entries remaining in all shards of the whitelist.  Entries are removed as they are used.
+    uint32_t count;
 
-    // Pubkeys of system accounts that are whitelisted for a block.
-    SolPubkey entries[MAX_WHITELIST_ENTRIES];
+    // The block that this whitelist is for
+    SolPubkey block_pubkey;
+
+    // Bit N is set if the whitelist shard with index N has been created
+    uint16_t shard_mask;
+
+    // Bump seed of the Program Derived Address of this whitelist
+    uint8_t bump_seed;
 }
 Whitelist;
+
+// This is the format of data stored in a whitelist shard account
+typedef struct
+{
+    // This is an indicator that the data is a WhitelistShard
+    DataType data_type;
+
+    // The block that this whitelist shard is for
+    SolPubkey block_pubkey;
+
+    // Index of this shard within the whitelist; only pubkeys for which whitelist_shard_index() is this value are
+    // stored in this shard
+    uint8_t shard_index;
+
+    // Bump seed of the Program Derived Address of this whitelist shard
+    uint8_t bump_seed;
+
+    // Number of entries in the shard.  The account is sized to hold exactly this many entries; it is grown as entries
+    // are added, and shrunk as they are removed by purchases.
+    uint16_t count;
+
+    // Pubkeys of system accounts that are whitelisted for a block, sorted in ascending byte order.  The same pubkey
+    // may appear more than once, allowing more than one purchase.
+    SolPubkey entries[];
+}
+WhitelistShard;
+
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "util/util_commission.c"
+#include "util/util_program_config.c"
+
+
 typedef struct
 {
     // This is the instruction code for Reauthorize
@@ -14,6 +18,8 @@ typedef struct
 
 static uint64_t special_reauthorize(const SolParameters *params)
 {
+    PROFILE_SCOPE("special_reauthorize");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   config_account,                ReadOnly,   NotSigner,   KnownAccount_ProgramConfig);
@@ -27,8 +33,14 @@ static uint64_t special_reauthorize(const SolParameters *params)
         DECLARE_ACCOUNT(8,   clock_sysvar_account,          ReadOnly,   NotSigner,   KnownAccount_ClockSysvar);
         DECLARE_ACCOUNT(9,   metaplex_program_account,      ReadOnly,   NotSigner,   KnownAccount_MetaplexProgram);
         DECLARE_ACCOUNT(10,  stake_program_account,         ReadOnly,   NotSigner,   KnownAccount_StakeProgram);
+        DECLARE_ACCOUNT(11,  block_account,                 ReadOnly,   NotSigner,   KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(12,  funding_account,               ReadWrite,  Signer,      KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(13,  master_stake_account,          ReadWrite,  NotSigner,   KnownAccount_MasterStake);
+        DECLARE_ACCOUNT(14,  bridge_stake_account,          ReadWrite,  NotSigner,   KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(15,  system_program_account,        ReadOnly,   NotSigner,   KnownAccount_SystemProgram);
+        DECLARE_ACCOUNT(16,  stake_history_sysvar_account,  ReadOnly,   NotSigner,   KnownAccount_StakeHistorySysvar);
     }
-    DECLARE_ACCOUNTS_NUMBER(11);
+    DECLARE_ACCOUNTS_NUMBER(17);
 
     // Ensure that the transaction was authorized by the admin
     if (!is_admin_account(config_account, admin_account->key)) {
@@ -43,8 +55,14 @@ static uint64_t special_reauthorize(const SolParameters *params)
     // Can safely use the data now
     const ReauthorizeData *data = (ReauthorizeData *) params->data;
 
+    // Get validated block, which is needed to charge commission on a staked entry
+    const Block *block = get_validated_block(block_account);
+    if (!block) {
+        return Error_InvalidAccount_First + 11;
+    }
+
     // This is the entry data
-    Entry *entry = get_validated_entry(entry_account);
+    Entry *entry = get_validated_entry_of_block(entry_account, block_account->key);
     if (!entry) {
         return Error_InvalidAccount_First + 2;
     }
@@ -99,14 +117,40 @@ static uint64_t special_reauthorize(const SolParameters *params)
             return Error_InvalidAccountPermissions_First + 6;
         }
 
-        uint64_t ret = set_stake_authorities_signed(&(entry->owned.stake_account), &(data->new_authority),
-                                                    params->ka, params->ka_num);
+        // Decode the stake account
+        Stake stake;
+        if (!decode_stake_account(stake_account, &stake)) {
+            return Error_InvalidAccount_First + 6;
+        }
+
+        // Get the cached values of the program config
+        ProgramConfigCache cache_buffer;
+        const ProgramConfigCache *cache;
+        ret = get_program_config_cache(config_account, 0, &clock, &cache_buffer, &cache);
+        if (ret) {
+            return ret;
+        }
+
+        // Charge commission, settling all accrued commission regardless of the settlement threshold since the stake
+        // account is leaving the program's control
+        ret = charge_commission(&stake, block, entry, funding_account->key, bridge_stake_account, stake_account->key,
+                                cache, 0, params->ka, params->ka_num);
+        if (ret) {
+            return ret;
+        }
+
+        ret = set_stake_authorities_signed(&(entry->owned.stake_account), &(data->new_authority), params->ka,
+                                           params->ka_num);
         if (ret) {
             return ret;
         }
 
         // No longer staked, all fields in owned should be zeroed out
         sol_memset(&(entry->owned), 0, sizeof(entry->owned));
+
+        if (!set_entry_state(entry, EntryState_Owned)) {
+            return Error_InternalProgrammingError;
+        }
     }
 
     return 0;
@@ -9,6 +9,7 @@
 #include "inc/types.h"
 #include "util/util_accounts.c"
 #include "util/util_metaplex.c"
+#include "util/util_program_config.c"
 #include "util/util_rent.c"
 #include "util/util_stake.c"
 #include "util/util_token.c"
@@ -26,6 +27,8 @@ typedef struct
 
 static uint64_t super_initialize(const SolParameters *params)
 {
+    PROFILE_SCOPE("super_initialize");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   superuser_account,             ReadOnly,   Signer,     KnownAccount_SuperUser);
@@ -76,15 +79,29 @@ static uint64_t super_initialize(const SolParameters *params)
         ProgramConfig *config = (ProgramConfig *) (config_account->data);
         config->data_type = DataType_ProgramConfig;
         config->admin_pubkey = data->admin_pubkey;
+
+        // Fill in the cache as of the current epoch
+        Clock clock;
+        if (sol_get_clock_sysvar(&clock)) {
+            return Error_FailedToGetClock;
+        }
+
+        uint64_t ret = refresh_program_config_cache(&(config->cache), clock.epoch);
+        if (ret) {
+            return ret;
+        }
     }
 
+    // The rent exempt minimums of the remaining accounts are computed from the cache that was just filled in
+    const ProgramConfigCache *cache = &(((ProgramConfig *) (config_account->data))->cache);
+
     // Create the authority account.  The authority account is derived from a fixed seed and doesn't hold any data.
     {
         const uint8_t *seed_bytes = (uint8_t *) Constants.authority_seed_bytes;
         SolSignerSeed seed = { seed_bytes, sizeof(Constants.authority_seed_bytes) };
 
         if (create_pda(authority_account, &seed, 1, superuser_account->key, &(Constants.self_program_pubkey),
-                       get_rent_exempt_minimum(0), 0, params->ka, params->ka_num)) {
+                       get_cached_rent_exempt_minimum(cache, 0), 0, params->ka, params->ka_num)) {
             return Error_CreateAccountFailed;
         }
     }
@@ -96,7 +113,7 @@ static uint64_t super_initialize(const SolParameters *params)
 
         if (create_stake_account(master_stake_account, &seed, 1, superuser_account->key,
                                  MASTER_STAKE_ACCOUNT_MIN_LAMPORTS, &(Constants.authority_pubkey),
-                                 &(Constants.authority_pubkey), params->ka, params->ka_num)) {
+                                 &(Constants.authority_pubkey), cache, params->ka, params->ka_num)) {
             return Error_CreateAccountFailed;
         }
     }
@@ -113,17 +130,19 @@ static uint64_t super_initialize(const SolParameters *params)
         SolSignerSeed seed = { seed_bytes, sizeof(Constants.ki_mint_seed_bytes) };
 
         if (create_token_mint(ki_mint_account, &seed, 1, &(Constants.authority_pubkey), superuser_account->key,
-                              1, params->ka, params->ka_num)) {
+                              1, cache, params->ka, params->ka_num)) {
             return Error_CreateAccountFailed;
         }
     }
 
     // Create the metadata for the Ki mint
+    MetaplexCreateMetadataData metaplex_metadata;
+    encode_create_metaplex_metadata(&metaplex_metadata, (const uint8_t *) KI_TOKEN_NAME,
+                                    (const uint8_t *) KI_TOKEN_SYMBOL, (const uint8_t *) KI_TOKEN_METADATA_URI,
+                                    &(Constants.system_program_pubkey), &(Constants.system_program_pubkey));
+
     if (create_metaplex_metadata(&(Constants.ki_metadata_pubkey), &(Constants.ki_mint_pubkey),
-                                 superuser_account->key, (const uint8_t *) KI_TOKEN_NAME,
-                                 (const uint8_t *) KI_TOKEN_SYMBOL, (const uint8_t *) KI_TOKEN_METADATA_URI,
-                                 &(Constants.system_program_pubkey), &(Constants.system_program_pubkey),
-                                 params->ka, params->ka_num)) {
+                                 superuser_account->key, &metaplex_metadata, params->ka, params->ka_num)) {
         return Error_CreateAccountFailed;
     }
 
@@ -133,17 +152,19 @@ static uint64_t super_initialize(const SolParameters *params)
         SolSignerSeed seed = { seed_bytes, sizeof(Constants.bid_marker_mint_seed_bytes) };
 
         if (create_token_mint(bid_marker_mint_account, &seed, 1, &(Constants.authority_pubkey),
-                              superuser_account->key, 1, params->ka, params->ka_num)) {
+                              superuser_account->key, 1, cache, params->ka, params->ka_num)) {
             return Error_CreateAccountFailed;
         }
     }
 
     // Create the metadata for the Bid Marker mint
+    encode_create_metaplex_metadata(&metaplex_metadata, (const uint8_t *) BID_MARKER_TOKEN_NAME,
+                                    (const uint8_t *) BID_MARKER_TOKEN_SYMBOL,
+                                    (const uint8_t *) BID_MARKER_TOKEN_METADATA_URI,
+                                    &(Constants.system_program_pubkey), &(Constants.system_program_pubkey));
+
     if (create_metaplex_metadata(&(Constants.bid_marker_metadata_pubkey), &(Constants.bid_marker_mint_pubkey),
-                                 superuser_account->key, (const uint8_t *) BID_MARKER_TOKEN_NAME,
-                                 (const uint8_t *) BID_MARKER_TOKEN_SYMBOL,
-                                 (const uint8_t *) BID_MARKER_TOKEN_METADATA_URI, &(Constants.system_program_pubkey),
-                                 &(Constants.system_program_pubkey), params->ka, params->ka_num)) {
+                                 superuser_account->key, &metaplex_metadata, params->ka, params->ka_num)) {
         return Error_CreateAccountFailed;
     }
 
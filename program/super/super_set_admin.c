@@ -20,6 +20,8 @@ typedef struct
 
 static uint64_t super_set_admin(const SolParameters *params)
 {
+    PROFILE_SCOPE("super_set_admin");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   superuser_account,             ReadOnly,   Signer,     KnownAccount_SuperUser);
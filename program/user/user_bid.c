@@ -2,13 +2,18 @@
 
 #include "util/util_accounts.c"
 #include "util/util_bid.c"
-#include "util/util_math.c"
 
 typedef struct
 {
     // This is the instruction code for Bid
     uint8_t instruction_code;
 
+    // Bump seed of the Program Derived Address of the bid marker token account
+    uint8_t bid_marker_token_bump_seed;
+
+    // Bump seed of the Program Derived Address of the bid account
+    uint8_t bid_bump_seed;
+
     // Minimum bid in lamports
     uint64_t minimum_bid_lamports;
 
@@ -18,12 +23,10 @@ typedef struct
 } BidData;
 
 
-static uint64_t compute_minimum_bid(uint64_t auction_duration, uint64_t initial_minimum_bid, uint64_t current_max_bid,
-                                    uint64_t seconds_elapsed);
-
-
 static uint64_t user_bid(const SolParameters *params)
 {
+    PROFILE_SCOPE("user_bid");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,  bidding_account,               ReadWrite,  Signer,     KnownAccount_NotKnown);
@@ -36,7 +39,24 @@ static uint64_t user_bid(const SolParameters *params)
         DECLARE_ACCOUNT(7,  self_program_account,          ReadOnly,   NotSigner,  KnownAccount_SelfProgram);
         DECLARE_ACCOUNT(8,  spl_token_program_account,     ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
     }
-    DECLARE_ACCOUNTS_NUMBER(9);
+
+    // If there are more than 9 accounts, then the optional refund of the bid that is outbid is requested, and there
+    // must be 11 accounts; else there must be 9
+    SolAccountInfo *previous_bid_account = 0;
+    SolAccountInfo *previous_bidder_account = 0;
+
+    if (params->ka_num > 9) {
+        DECLARE_ACCOUNTS_NUMBER(11);
+        {
+            DECLARE_ACCOUNT(9,   refund_bid_account,            ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+            DECLARE_ACCOUNT(10,  refund_bidder_account,         ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+            previous_bid_account = refund_bid_account;
+            previous_bidder_account = refund_bidder_account;
+        }
+    }
+    else {
+        DECLARE_ACCOUNTS_NUMBER(9);
+    }
 
     // Make sure that the input data is the correct size
     if (params->data_len != sizeof(BidData)) {
@@ -57,6 +77,11 @@ static uint64_t user_bid(const SolParameters *params)
         return Error_InvalidAccount_First + 1;
     }
 
+    // An entry whose bids are escrowed in the entry takes EscrowedBid instead
+    if (entry->escrow_bids) {
+        return Error_WrongAuctionMode;
+    }
+
     // Get the clock sysvar, needed below
     Clock clock;
     if (sol_get_clock_sysvar(&clock)) {
@@ -68,42 +93,50 @@ static uint64_t user_bid(const SolParameters *params)
         return Error_EntryNotInAuction;
     }
 
-    // Compute the minimum auction bid price for the entry
-    uint64_t minimum_bid = compute_minimum_bid(entry->duration, entry->minimum_price_lamports,
-                                               entry->auction.highest_bid_lamports,
-                                               clock.unix_timestamp - entry->reveal_timestamp);
-
-    // If the minimum bid is 0, then no bid is possible
-    if (minimum_bid == 0) {
-        return Error_BidTooLow;
+    // Compute the bid, which is the least amount within the range of this bid that is at least the minimum bid
+    uint64_t minimum_bid;
+    uint64_t ret = compute_bid_lamports(entry, &clock, data->minimum_bid_lamports, data->maximum_bid_lamports,
+                                        &minimum_bid);
+    if (ret) {
+        return ret;
     }
 
-    // If the minimum bid is greater than the maximum range of this bid, then the bid is not large enough
-    if (minimum_bid > data->maximum_bid_lamports) {
-        return Error_BidTooLow;
-    }
+    // Now minimum_bid is the actual bid
 
-    // Update minimum_bid to hold the minimum bid allowed by the range of this bid
-    if (minimum_bid < data->minimum_bid_lamports) {
-        minimum_bid = data->minimum_bid_lamports;
-    }
+    // If the refund of the bid that is outbid was requested, then it must be the winning bid, which is about to be
+    // outbid, and the previous bidder account must be its bidder.  A bidder's own winning bid cannot be refunded this
+    // way, since its Bid account is the one that this bid would be created in.
+    if (previous_bid_account) {
+        if (!SolPubkey_same(previous_bid_account->key, &(entry->auction.winning_bid_pubkey)) ||
+            SolPubkey_same(previous_bid_account->key, bid_account->key)) {
+            return Error_InvalidAccount_First + 9;
+        }
 
-    // Now minimum_bid is the actual bid
+        const Bid *previous_bid = get_validated_bid(previous_bid_account);
+        if (!previous_bid) {
+            return Error_InvalidAccount_First + 9;
+        }
+
+        if (!SolPubkey_same(previous_bidder_account->key, &(previous_bid->bidder_pubkey))) {
+            return Error_InvalidAccount_First + 10;
+        }
+    }
 
     // If one doesn't already exist for this bid, mint a "bid marker" token that will allow user interfaces to
     // recognize that the user has an outstanding bid.  If the user loses this bid marker token, they can still claim
     // their bid but they have to know the mint address of the entry that was bid on, and from that compute the bid
     // marker token account, and from that compute the bid account.
-    uint64_t ret = mint_bid_marker_token_idempotent(bid_marker_token_account, &(entry->mint_pubkey),
-                                                    bidding_account->key, params->ka, params->ka_num);
+    ret = mint_bid_marker_token_idempotent(bid_marker_token_account, &(entry->mint_pubkey), bidding_account->key,
+                                           data->bid_marker_token_bump_seed, params->ka, params->ka_num);
     if (ret) {
         return ret;
     }
 
     // Create the bid account itself, which will hold the bid lamports in escrow and be claimable by a user_claim
     // instruction
-    ret = create_entry_bid_account(bid_account, bid_marker_token_account->key, &(entry->mint_pubkey),
-                                   bidding_account->key, minimum_bid, params->ka, params->ka_num);
+    ret = create_entry_bid_account(bid_account, bid_marker_token_account->key, data->bid_bump_seed,
+                                   data->bid_marker_token_bump_seed, &(entry->mint_pubkey), bidding_account->key,
+                                   minimum_bid, params->ka, params->ka_num);
     if (ret) {
         return ret;
     }
@@ -115,59 +148,14 @@ static uint64_t user_bid(const SolParameters *params)
     // will claim the entry.  All others will reclaim the SOL in the bid account.
     entry->auction.winning_bid_pubkey = *(bid_account->key);
 
-    // Not done yet
-    return 0;
-}
-
-
-static uint64_t compute_minimum_bid(uint64_t auction_duration, uint64_t initial_minimum_bid, uint64_t current_max_bid,
-                                    uint64_t seconds_elapsed)
-{
-    // If the maximum possible bid has been achieved, return 0
-    if (current_max_bid == UINT64_MAX) {
-        return 0;
+    // Refund the bid that was outbid, closing its Bid account, as ClaimLosing would, so that its bidder does not have
+    // to claim it.  This is done after the bid account is created, so that no lamports are moved directly before the
+    // system program is invoked.
+    if (previous_bid_account) {
+        *(previous_bidder_account->lamports) += *(previous_bid_account->lamports);
+        *(previous_bid_account->lamports) = 0;
     }
 
-    // If there have been no bids yet, then use the initial minimum.  Only once the first bid is cast, does the
-    // minimum bid increment come into play.
-    if (current_max_bid < initial_minimum_bid) {
-        return initial_minimum_bid;
-    }
-
-    // Sanitize the seconds elapsed
-    if (seconds_elapsed >= auction_duration) {
-        seconds_elapsed = (auction_duration - 1);
-    }
-
-    // This is a curve based on the formula: y = p * ((1 / (101 - (100 * (a / b)))) + 1.01)
-    // Where a is seconds_elapsed, b is auction_duration, and p is current_max_bid.  This is a curve that goes
-    // from a multiple of 1.02 of the current_max_bid at time 0, up to 2.01x the current_max_bid at the end
-    // of the time range.
-    uint64_t a = seconds_elapsed;
-    uint64_t b = auction_duration;
-    uint64_t p = current_max_bid;
-
-    // Keep track of whether any of the math for computing the minimum bid overflows
-    bool overflow = false;
-
-    // result = (p * (((1000 * b) / ((b + (b / 100)) - a)) + 101000)) / 100000
-    // The term involving b and a cannot overflow since b was originally a uint32_t value; and a is less than b.
-    uint64_t result = checked_multiply(p, ((1000 * b) / ((b + (b / 100)) - a)) + 101000, &overflow) / 100000;
-
-    // Check for overflow
-    if (overflow) {
-        // Overflow has occurred.  This means that the formula can't be used to compute the maximum next bid because
-        // the numbers are too large.  This would only happen with extremely large bids, millions of dollars' worth.
-        // But to be safe, in this case, instead of computing an invalid minimum next bid, just use 1/8 more than the
-        // previous bid.
-        overflow = false;
-        result = checked_add(current_max_bid, (current_max_bid >> 3), &overflow);
-
-        // If this also overflowed, then use the maximum possible bid.
-        if (overflow) {
-            result = UINT64_MAX;
-        }
-    }
-
-    return result;
+    // Not done yet
+    return 0;
 }
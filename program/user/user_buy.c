@@ -2,6 +2,7 @@
 
 #include "inc/types.h"
 #include "util/util_math.c"
+#include "util/util_program_config.c"
 #include "util/util_token.c"
 #include "util/util_transfer_lamports.c"
 #include "util/util_whitelist.c"
@@ -17,51 +18,66 @@ typedef struct
     // height.  That would be rare, but users should be protected.
     uint64_t maximum_price_lamports;
 
+    // The following are only used when buying from a block with a Merkle whitelist during its whitelist period, and
+    // are otherwise ignored (and whitelist_proof_length should be 0).  They give the first slot and allowance of the
+    // whitelist leaf of the funding account, and the proof that the leaf is in the block's whitelist Merkle tree.
+    uint16_t whitelist_first_slot;
+
+    uint8_t whitelist_allowance;
+
+    uint8_t whitelist_proof_length;
+
+    sha256_t whitelist_proof[];
+
 } BuyData;
 
 
+// Returns the size of BuyData carrying a whitelist proof of [whitelist_proof_length] hashes
+static uint64_t buy_data_size(uint8_t whitelist_proof_length)
+{
+    BuyData *zero = 0;
+
+    return (uint64_t) &(zero->whitelist_proof[whitelist_proof_length]);
+}
+
+
 // If start_price > 100,000 SOL, rounding errors could be significant.
 static uint64_t compute_price(uint64_t total_seconds, uint64_t start_price, uint64_t end_price,
                               uint64_t seconds_elapsed);
 
 
-static uint64_t user_buy(const SolParameters *params)
+// Buys the entry in [entry_account], paying the price of the entry from [funding_account] and transferring the entry's
+// token to [token_destination_account].  The accounts are those of the Buy instruction, which have been declared by
+// the caller, and errors refer to them by their indexes in that instruction.  [whitelist_shard_account] may be null if
+// it was not supplied.  The instruction data must begin with a BuyData.  On success, sets [*block_return] and
+// [*entry_return] to the block and the entry that was bought.
+static uint64_t buy_entry(const SolParameters *params, SolAccountInfo *funding_account, SolAccountInfo *config_account,
+                          SolAccountInfo *admin_account, SolAccountInfo *authority_account,
+                          SolAccountInfo *block_account, SolAccountInfo *whitelist_account,
+                          SolAccountInfo *entry_account, SolAccountInfo *entry_token_account,
+                          SolAccountInfo *entry_mint_account, SolAccountInfo *token_destination_account,
+                          SolAccountInfo *token_destination_owner_account, SolAccountInfo *entry_metadata_account,
+                          SolAccountInfo *whitelist_shard_account, const Clock *clock, Block **block_return,
+                          Entry **entry_return)
 {
-    // Declare accounts, which checks the permissions and identity of all accounts
-    DECLARE_ACCOUNTS {
-        DECLARE_ACCOUNT(0,   funding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(1,   config_account,                   ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
-        DECLARE_ACCOUNT(2,   admin_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(3,   authority_account,                ReadWrite,  NotSigner,  KnownAccount_Authority);
-        DECLARE_ACCOUNT(4,   block_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(5,   whitelist_account,                ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(6,   entry_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(7,   entry_token_account,              ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(8,   entry_mint_account,               ReadOnly,   NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(9,   token_destination_account,        ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(10,  token_destination_owner_account,  ReadOnly,   NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(11,  entry_metadata_account,           ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(12,  program_account,                  ReadOnly,   NotSigner,  KnownAccount_SelfProgram);
-        DECLARE_ACCOUNT(13,  spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
-        DECLARE_ACCOUNT(14,  spl_ata_program_account,          ReadOnly,   NotSigner,  KnownAccount_SPLATAProgram);
-        DECLARE_ACCOUNT(15,  metaplex_program_account,         ReadOnly,   NotSigner,  KnownAccount_MetaplexProgram);
-        DECLARE_ACCOUNT(16,  system_program_account,           ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
-    }
-    DECLARE_ACCOUNTS_NUMBER(17);
-
     // Ensure that the correct admin account was passed in
     if (!is_admin_account(config_account, admin_account->key)) {
         return Error_InvalidAccount_First + 2;
     }
 
     // Make sure that the input data is the correct size
-    if (params->data_len != sizeof(BuyData)) {
+    if (params->data_len < buy_data_size(0)) {
         return Error_InvalidDataSize;
     }
 
     // Cast to instruction data
     const BuyData *data = (BuyData *) params->data;
 
+    if ((data->whitelist_proof_length > MAX_WHITELIST_PROOF_LENGTH) ||
+        (params->data_len != buy_data_size(data->whitelist_proof_length))) {
+        return Error_InvalidDataSize;
+    }
+
     // This is the block data
     Block *block = get_validated_block(block_account);
     if (!block) {
@@ -73,6 +89,20 @@ static uint64_t user_buy(const SolParameters *params)
         return Error_BlockNotComplete;
     }
 
+    // A block with a Merkle whitelist does not use whitelist_account, but it must still be either the block's whitelist
+    // address or the block account itself, which adds nothing to the transaction
+    if ((block->config.whitelist_slot_count > 0) && !SolPubkey_same(whitelist_account->key, block_account->key)) {
+        uint8_t prefix = PDA_Account_Seed_Prefix_Whitelist;
+
+        SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
+                                  { (uint8_t *) block_account->key, sizeof(*(block_account->key)) },
+                                  { &(block->whitelist_bump_seed), sizeof(block->whitelist_bump_seed) } };
+
+        if (!is_program_derived_address(whitelist_account->key, seeds, ARRAY_LEN(seeds))) {
+            return Error_InvalidAccount_First + 5;
+        }
+    }
+
     // This is the entry data
     Entry *entry = get_validated_entry_of_block(entry_account, block_account->key);
     if (!entry) {
@@ -94,20 +124,16 @@ static uint64_t user_buy(const SolParameters *params)
         return Error_InvalidAccount_First + 10;
     }
 
-    // Get the clock sysvar, needed below
-    Clock clock;
-    if (sol_get_clock_sysvar(&clock)) {
-        return Error_FailedToGetClock;
-    }
-
     // No need to check that the token is owned by the program; if it is not, then the SPL token program invoke of the
     // transfer of the token from the token account to the destination account will simply fail and the transaction
     // will then fail
 
+    PROFILE("price");
+
     const SolAccountInfo *funds_destination_account;
     uint64_t purchase_price_lamports;
 
-    switch (get_entry_state(block, entry, &clock)) {
+    switch (get_entry_state(block, entry, clock)) {
     case EntryState_PreRevealOwned:
     case EntryState_WaitingForRevealOwned:
     case EntryState_Owned:
@@ -139,13 +165,13 @@ static uint64_t user_buy(const SolParameters *params)
         purchase_price_lamports = compute_price(block->config.mystery_phase_duration,
                                                 block->config.mystery_start_price_lamports,
                                                 block->config.minimum_price_lamports,
-                                                clock.unix_timestamp - block->block_start_timestamp);
+                                                clock->unix_timestamp - block->block_start_timestamp);
 
         // Update the entry's block to indicate that one more mystery was purchased.  If this is the last
         // mystery to purchase before the block becomes revealable, then the block reveal period begins.
         block->mysteries_sold_count += 1;
         if (block->mysteries_sold_count == block->config.total_mystery_count) {
-            block->mystery_phase_end_timestamp = clock.unix_timestamp;
+            block->mystery_phase_end_timestamp = clock->unix_timestamp;
         }
 
         break;
@@ -165,7 +191,7 @@ static uint64_t user_buy(const SolParameters *params)
         else {
             purchase_price_lamports = compute_price(entry->duration, entry->non_auction_start_price_lamports,
                                                     entry->minimum_price_lamports,
-                                                    clock.unix_timestamp - entry->reveal_timestamp);
+                                                    clock->unix_timestamp - entry->reveal_timestamp);
         }
 
         break;
@@ -186,13 +212,38 @@ static uint64_t user_buy(const SolParameters *params)
         return Error_InsufficientFunds;
     }
 
+    PROFILE("payment");
+
     // If the block has a whitelist enabled, check to make sure that the funding account is whitelisted.  This will
     // remove the funding account from the whitelist on success, thus preventing the funding account from buying another
-    // entry in this block (unless it has an additional entry in the whitelist) until the whitelist period ends.
+    // entry in this block (unless it has an additional entry in the whitelist) until the whitelist period ends.  The
+    // whitelist shard account must be the shard that would hold the funding account.  For a block with a Merkle
+    // whitelist, the proof in the instruction data is checked instead, and a slot of the funding account's leaf is
+    // claimed.
     if ((block->config.whitelist_duration > 0) &&
-        (clock.unix_timestamp < (block->block_start_timestamp + block->config.whitelist_duration)) &&
-        !whitelist_check(whitelist_account, block_account->key, funding_account->key)) {
-        return Error_FailedWhitelistCheck;
+        (clock->unix_timestamp < (block->block_start_timestamp + block->config.whitelist_duration))) {
+        if (block->config.whitelist_slot_count > 0) {
+            if (!whitelist_merkle_check(block, funding_account->key, data->whitelist_first_slot,
+                                        data->whitelist_allowance, data->whitelist_proof,
+                                        data->whitelist_proof_length)) {
+                return Error_FailedWhitelistCheck;
+            }
+        }
+        else {
+            // The whitelist shard is shrunk as the funding account's entry is removed from it, with its excess
+            // lamports returned to the admin account
+            ProgramConfigCache cache_buffer;
+            const ProgramConfigCache *cache;
+            uint64_t ret = get_program_config_cache(config_account, 1, clock, &cache_buffer, &cache);
+            if (ret) {
+                return ret;
+            }
+
+            if (!whitelist_check(whitelist_account, whitelist_shard_account, block_account->key, block,
+                                 funding_account->key, cache, admin_account)) {
+                return Error_FailedWhitelistCheck;
+            }
+        }
     }
 
     // Transfer the purchase price from the funds source to the funds destination account
@@ -216,9 +267,14 @@ static uint64_t user_buy(const SolParameters *params)
         return ret;
     }
 
-    // Set the purchase price in the Entry now that it's been purchased
+    // Set the purchase price in the Entry now that it's been purchased, and it is now owned
     entry->purchase_price_lamports = purchase_price_lamports;
 
+    if (!set_entry_state(entry, (entry->state == EntryState_PreRevealUnowned) ? EntryState_PreRevealOwned :
+                         EntryState_Owned)) {
+        return Error_InternalProgrammingError;
+    }
+
     // And set the primary_sale_happened flag on the metaplex metadata, which isn't strictly necessary but just
     // in case there are UI presentations that care
     ret = set_metaplex_metadata_primary_sale_happened(entry, params->ka, params->ka_num);
@@ -228,7 +284,74 @@ static uint64_t user_buy(const SolParameters *params)
 
     // Finally, close the entry's token account since it will never be used again.  The lamports go to the admin
     // account.
-    return close_entry_token(entry, admin_account->key, params->ka, params->ka_num);
+    ret = close_entry_token(entry, admin_account->key, params->ka, params->ka_num);
+    if (ret) {
+        return ret;
+    }
+
+    *block_return = block;
+    *entry_return = entry;
+
+    return 0;
+}
+
+
+static uint64_t user_buy(const SolParameters *params)
+{
+    PROFILE_SCOPE("user_buy");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,   funding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(1,   config_account,                   ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
+        DECLARE_ACCOUNT(2,   admin_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(3,   authority_account,                ReadWrite,  NotSigner,  KnownAccount_Authority);
+        DECLARE_ACCOUNT(4,   block_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(5,   whitelist_account,                ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(6,   entry_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(7,   entry_token_account,              ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(8,   entry_mint_account,               ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(9,   token_destination_account,        ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(10,  token_destination_owner_account,  ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(11,  entry_metadata_account,           ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(12,  program_account,                  ReadOnly,   NotSigner,  KnownAccount_SelfProgram);
+        DECLARE_ACCOUNT(13,  spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
+        DECLARE_ACCOUNT(14,  spl_ata_program_account,          ReadOnly,   NotSigner,  KnownAccount_SPLATAProgram);
+        DECLARE_ACCOUNT(15,  metaplex_program_account,         ReadOnly,   NotSigner,  KnownAccount_MetaplexProgram);
+        DECLARE_ACCOUNT(16,  system_program_account,           ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
+    }
+
+    // The whitelist shard account is optional, and is only needed when buying from a block whose whitelist still
+    // has entries in it
+    SolAccountInfo *whitelist_shard_account = 0;
+
+    if (params->ka_num > 17) {
+        DECLARE_ACCOUNTS_NUMBER(18);
+        {
+            DECLARE_ACCOUNT(17,  shard_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+            whitelist_shard_account = shard_account;
+        }
+    }
+    else {
+        DECLARE_ACCOUNTS_NUMBER(17);
+    }
+
+    // For blocks with a Merkle whitelist, whitelist_account is not used, and either the block's whitelist account or
+    // the block account, which adds nothing to the transaction, may be supplied for it; buy_entry() checks this
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    Block *block;
+    Entry *entry;
+
+    return buy_entry(params, funding_account, config_account, admin_account, authority_account, block_account,
+                     whitelist_account, entry_account, entry_token_account, entry_mint_account,
+                     token_destination_account, token_destination_owner_account, entry_metadata_account,
+                     whitelist_shard_account, &clock, &block, &entry);
 }
 
 
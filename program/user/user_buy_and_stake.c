@@ -0,0 +1,89 @@
+#pragma once
+
+#include "user/user_buy.c"
+#include "user/user_stake.c"
+
+
+// The instruction data of BuyAndStake is a BuyData, with the instruction code of BuyAndStake
+
+static uint64_t user_buy_and_stake(const SolParameters *params)
+{
+    PROFILE_SCOPE("user_buy_and_stake");
+
+    // Declare accounts, which checks the permissions and identity of all accounts.  The first accounts are those of
+    // Buy, and the stake account and its withdraw authority follow, along with the other accounts that Stake uses.
+    // The optional whitelist shard account of Buy comes last.
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,   funding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(1,   config_account,                   ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
+        DECLARE_ACCOUNT(2,   admin_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(3,   authority_account,                ReadWrite,  NotSigner,  KnownAccount_Authority);
+        DECLARE_ACCOUNT(4,   block_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(5,   whitelist_account,                ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(6,   entry_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(7,   entry_token_account,              ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(8,   entry_mint_account,               ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(9,   token_destination_account,        ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(10,  token_destination_owner_account,  ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(11,  entry_metadata_account,           ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(12,  program_account,                  ReadOnly,   NotSigner,  KnownAccount_SelfProgram);
+        DECLARE_ACCOUNT(13,  spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
+        DECLARE_ACCOUNT(14,  spl_ata_program_account,          ReadOnly,   NotSigner,  KnownAccount_SPLATAProgram);
+        DECLARE_ACCOUNT(15,  metaplex_program_account,         ReadOnly,   NotSigner,  KnownAccount_MetaplexProgram);
+        DECLARE_ACCOUNT(16,  system_program_account,           ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
+        DECLARE_ACCOUNT(17,  stake_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(18,  withdraw_authority_account,       ReadOnly,   Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(19,  shinobi_systems_vote_account,     ReadOnly,   NotSigner,  KnownAccount_ShinobiSystemsVote);
+        DECLARE_ACCOUNT(20,  clock_sysvar_account,             ReadOnly,   NotSigner,  KnownAccount_ClockSysvar);
+        DECLARE_ACCOUNT(21,  stake_program_account,            ReadOnly,   NotSigner,  KnownAccount_StakeProgram);
+        DECLARE_ACCOUNT(22,  stake_config_account,             ReadOnly,   NotSigner,  KnownAccount_StakeConfig);
+        DECLARE_ACCOUNT(23,  stake_history_sysvar_account,     ReadOnly,   NotSigner,  KnownAccount_StakeHistorySysvar);
+    }
+
+    // The whitelist shard account is optional, and is only needed when buying from a block whose whitelist still
+    // has entries in it
+    SolAccountInfo *whitelist_shard_account = 0;
+
+    if (params->ka_num > 24) {
+        DECLARE_ACCOUNTS_NUMBER(25);
+        {
+            DECLARE_ACCOUNT(24,  shard_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+            whitelist_shard_account = shard_account;
+        }
+    }
+    else {
+        DECLARE_ACCOUNTS_NUMBER(24);
+    }
+
+    // For blocks with a Merkle whitelist, whitelist_account is not used, and either the block's whitelist account or
+    // the block account, which adds nothing to the transaction, may be supplied for it; buy_entry() checks this
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    Block *block;
+    Entry *entry;
+
+    uint64_t ret = buy_entry(params, funding_account, config_account, admin_account, authority_account, block_account,
+                             whitelist_account, entry_account, entry_token_account, entry_mint_account,
+                             token_destination_account, token_destination_owner_account, entry_metadata_account,
+                             whitelist_shard_account, &clock, &block, &entry);
+    if (ret) {
+        return ret;
+    }
+
+    // Only an entry that was already revealed is Owned once bought; a mystery can't be staked until it is revealed
+    if (get_entry_state(0, entry, &clock) != EntryState_Owned) {
+        return Error_NotStakeable;
+    }
+
+    // There is no need to check the owner of the entry's token, since it was just transferred to the token
+    // destination account.  The entry is staked on behalf of the token destination owner, who will be the one to
+    // destake it.
+    PROFILE("stake");
+
+    return stake_entry(block, entry, stake_account, 17, withdraw_authority_account, &clock, params->ka, params->ka_num);
+}
@@ -1,8 +1,42 @@
 #pragma once
 
 
+// Returns true if [entry] is in a state in which it may have losing bids to claim as of [clock]
+static bool may_have_losing_bids(const Entry *entry, const Clock *clock)
+{
+    switch (get_entry_state(0, entry, clock)) {
+        // For the following, states, it's not possible for a bid to ever have been made
+    case EntryState_PreReveal:
+    case EntryState_PreRevealUnowned:
+    case EntryState_PreRevealOwned:
+    case EntryState_WaitingForRevealUnowned:
+    case EntryState_WaitingForRevealOwned:
+    case EntryState_Unowned:
+        return false;
+
+        // If the entry is in auction, then clearly there could have been losing bids
+    case EntryState_InAuction:
+        break;
+
+        // For the following states, it is possible that there was an auction that this bidder bid on
+    case EntryState_WaitingToBeClaimed:
+    case EntryState_Owned:
+    case EntryState_OwnedAndStaked:
+        // If the entry has no auction, then it's not possible that this bidder bid on it
+        if (!entry->has_auction) {
+            return false;
+        }
+        break;
+    }
+
+    return true;
+}
+
+
 static uint64_t user_claim_losing(const SolParameters *params)
 {
+    PROFILE_SCOPE("user_claim_losing");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   bidding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
@@ -34,34 +68,27 @@ static uint64_t user_claim_losing(const SolParameters *params)
     }
 
     // Ensure that the entry is in the correct state for a losing bid claim to even be possible
-    switch (get_entry_state(0, entry, &clock)) {
-        // For the following, states, it's not possible for a bid to ever have been made
-    case EntryState_PreReveal:
-    case EntryState_PreRevealUnowned:
-    case EntryState_PreRevealOwned:
-    case EntryState_WaitingForRevealUnowned:
-    case EntryState_WaitingForRevealOwned:
-    case EntryState_Unowned:
+    if (!may_have_losing_bids(entry, &clock)) {
         return Error_CannotClaimBid;
-
-        // If the entry is in auction, then clearly there could have been losing bids
-    case EntryState_InAuction:
-        break;
-
-        // For the following states, it is possible that there was an auction that this bidder bid on
-    case EntryState_WaitingToBeClaimed:
-    case EntryState_Owned:
-    case EntryState_OwnedAndStaked:
-        // If the entry has no auction, then it's not possible that this bidder bid on it
-        if (!entry->has_auction) {
-            return Error_CannotClaimBid;
-        }
-        break;
     }
 
     // Get the validated bid account data
     const Bid *bid = get_validated_bid(bid_account);
     if (!bid) {
+        // If the bid account was already closed, as it is when the bid is refunded by the bid that outbids it, then
+        // the bidder's bid marker token account may still be reclaimed
+        if (reclaim_bid_marker && (*(bid_account->lamports) == 0)) {
+            {
+                DECLARE_ACCOUNT(3,   bid_marker_mint_account,    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+                DECLARE_ACCOUNT(4,   bid_marker_token_account,   ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+                DECLARE_ACCOUNT(5,   authority_account,          ReadOnly,   NotSigner,  KnownAccount_Authority);
+                DECLARE_ACCOUNT(6,   spl_token_program_account,  ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
+            }
+
+            return reclaim_orphaned_bid_marker_token(&(entry->mint_pubkey), bidding_account, bid_account,
+                                                     bid_marker_mint_account, bid_marker_token_account, params->ka,
+                                                     params->ka_num);
+        }
         return Error_InvalidAccount_First + 2;
     }
 
@@ -87,7 +114,8 @@ static uint64_t user_claim_losing(const SolParameters *params)
 
         // Burn the bid marker tokens
         uint64_t ret = reclaim_bid_marker_token(&(entry->mint_pubkey), bidding_account, bid_marker_mint_account,
-                                                bid_marker_token_account, params->ka, params->ka_num);
+                                                bid_marker_token_account, bid->bid_marker_token_bump_seed,
+                                                params->ka, params->ka_num);
         if (ret) {
             return ret;
         }
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "user/user_claim_losing.c"
+
+
+// ClaimLosing for many losing bids of the same bidder at once, always reclaiming their bid marker tokens.  As with
+// ClaimLosing, a bid whose Bid account was already closed only has its bid marker token reclaimed.
+static uint64_t user_claim_losing_many(const SolParameters *params)
+{
+    PROFILE_SCOPE("user_claim_losing_many");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,   bidding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(1,   bid_marker_mint_account,          ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(2,   authority_account,                ReadOnly,   NotSigner,  KnownAccount_Authority);
+        DECLARE_ACCOUNT(3,   spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
+    }
+
+    // The (entry, bid, bid marker token) account triples follow the 4 fixed accounts, and there must be at least one
+    if ((params->ka_num < 7) || ((params->ka_num - 4) % 3)) {
+        return Error_IncorrectNumberOfAccounts;
+    }
+
+    uint8_t bid_count = (params->ka_num - 4) / 3;
+
+    DECLARE_ACCOUNTS_NUMBER(4 + (bid_count * 3));
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    for (uint8_t i = 0; i < bid_count; i++) {
+        uint8_t account_index = 4 + (i * 3);
+
+        SolAccountInfo *entry_account = get_instruction_account(params, account_index);
+        SolAccountInfo *bid_account = get_instruction_account(params, account_index + 1);
+        SolAccountInfo *bid_marker_token_account = get_instruction_account(params, account_index + 2);
+
+        // Ensure that the bid and bid marker token accounts are writable
+        if (!bid_account->is_writable) {
+            return Error_InvalidAccountPermissions_First + account_index + 1;
+        }
+        if (!bid_marker_token_account->is_writable) {
+            return Error_InvalidAccountPermissions_First + account_index + 2;
+        }
+
+        // Get the validated entry account data
+        const Entry *entry = get_validated_entry(entry_account);
+        if (!entry) {
+            return Error_InvalidAccount_First + account_index;
+        }
+
+        // Ensure that the entry is in the correct state for a losing bid claim to even be possible
+        if (!may_have_losing_bids(entry, &clock)) {
+            return Error_CannotClaimBid;
+        }
+
+        // Get the validated bid account data
+        const Bid *bid = get_validated_bid(bid_account);
+        if (!bid) {
+            // If the bid account was already closed, as it is when the bid is refunded by the bid that outbids it,
+            // then only the bidder's bid marker token account is left to reclaim
+            if (*(bid_account->lamports) > 0) {
+                return Error_InvalidAccount_First + account_index + 1;
+            }
+            uint64_t ret = reclaim_orphaned_bid_marker_token(&(entry->mint_pubkey), bidding_account, bid_account,
+                                                             bid_marker_mint_account, bid_marker_token_account,
+                                                             params->ka, params->ka_num);
+            if (ret) {
+                return ret;
+            }
+            continue;
+        }
+
+        // The bid must have been made by the bidding account, and be a bid on this entry
+        if (!SolPubkey_same(bidding_account->key, &(bid->bidder_pubkey))) {
+            return Error_InvalidAccount_First;
+        }
+        if (!SolPubkey_same(&(entry->mint_pubkey), &(bid->mint_pubkey))) {
+            return Error_InvalidAccount_First + account_index + 1;
+        }
+
+        // If this is the winning bid, then can't claim it as a losing bid
+        if (SolPubkey_same(bid_account->key, &(entry->auction.winning_bid_pubkey))) {
+            return Error_BidWon;
+        }
+
+        // Burn the bid marker tokens.  SPL Token has no instruction that burns from or closes more than one token
+        // account, so this is still one burn and one close per bid.
+        uint64_t ret = reclaim_bid_marker_token(&(entry->mint_pubkey), bidding_account, bid_marker_mint_account,
+                                                bid_marker_token_account, bid->bid_marker_token_bump_seed,
+                                                params->ka, params->ka_num);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    // Now that all cross-program invocations are done, move the lamports of all bid accounts to the bidding account
+    for (uint8_t i = 0; i < bid_count; i++) {
+        SolAccountInfo *bid_account = get_instruction_account(params, 4 + (i * 3) + 1);
+
+        *(bidding_account->lamports) += *(bid_account->lamports);
+        *(bid_account->lamports) = 0;
+    }
+
+    return 0;
+}
@@ -1,37 +1,22 @@
 #pragma once
 
 
-static uint64_t user_claim_winning(const SolParameters *params)
+// Claims the winning bid in [bid_account] of the entry in [entry_account], transferring the entry's token to
+// [token_destination_account] and the bid's lamports to the admin.  If the entry escrows its bids, then
+// [bid_account] must be [entry_account], which holds the winning bid's lamports.  If [bid_marker_mint_account] is not
+// null, the bidder's bid marker token in [bid_marker_token_account] is reclaimed too, unless the entry escrows its
+// bids, in which case there is no bid marker token.  The accounts are those of the ClaimWinning
+// instruction, which have been declared by the caller, and errors refer to them by their indexes in that instruction.
+// [clock] is the current clock.  On success, sets [*entry_return] to the entry whose winning bid was claimed.
+static uint64_t claim_winning_bid(const SolParameters *params, SolAccountInfo *bidding_account,
+                                  SolAccountInfo *entry_account, SolAccountInfo *bid_account,
+                                  SolAccountInfo *config_account, SolAccountInfo *admin_account,
+                                  SolAccountInfo *entry_token_account, SolAccountInfo *entry_mint_account,
+                                  SolAccountInfo *token_destination_account,
+                                  SolAccountInfo *token_destination_owner_account,
+                                  SolAccountInfo *bid_marker_mint_account, SolAccountInfo *bid_marker_token_account,
+                                  const Clock *clock, Entry **entry_return)
 {
-    // Declare accounts, which checks the permissions and identity of all accounts
-    DECLARE_ACCOUNTS {
-        DECLARE_ACCOUNT(0,   bidding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(1,   entry_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(2,   bid_account,                      ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(3,   config_account,                   ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
-        DECLARE_ACCOUNT(4,   admin_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(5,   entry_token_account,              ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(6,   entry_mint_account,               ReadOnly,   NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(7,   authority_account,                ReadOnly,   NotSigner,  KnownAccount_Authority);
-        DECLARE_ACCOUNT(8,   token_destination_account,        ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(9,   token_destination_owner_account,  ReadOnly,   NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(10,  system_program_account,           ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
-        DECLARE_ACCOUNT(11,  spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
-        DECLARE_ACCOUNT(12,  spl_ata_program_account,          ReadOnly,   NotSigner,  KnownAccount_SPLATAProgram);
-    }
-
-    // If there are more than 13 accounts, then the optional reclaiming of bid marker is requested
-    bool reclaim_bid_marker = (params->ka_num > 13);
-
-    // If reclaiming bid marker, there must be 15 accounts
-    if (reclaim_bid_marker) {
-        DECLARE_ACCOUNTS_NUMBER(15);
-    }
-    // Else there must be 13
-    else {
-        DECLARE_ACCOUNTS_NUMBER(13);
-    }
-
     // This is the entry data
     Entry *entry = get_validated_entry(entry_account);
     if (!entry) {
@@ -53,32 +38,49 @@ static uint64_t user_claim_winning(const SolParameters *params)
         return Error_InvalidAccount_First + 6;
     }
 
-    // Get the clock sysvar, needed below
-    Clock clock;
-    if (sol_get_clock_sysvar(&clock)) {
-        return Error_FailedToGetClock;
-    }
-
     // The only time that a winning bid could possibly be claimed is if the entry is in the WaitingToBeClaimed state
-    if (get_entry_state(0, entry, &clock) != EntryState_WaitingToBeClaimed) {
+    if (get_entry_state(0, entry, clock) != EntryState_WaitingToBeClaimed) {
         return Error_CannotClaimBid;
     }
 
-    // Get the validated bid account data
-    const Bid *bid = get_validated_bid(bid_account);
-    if (!bid) {
-        return Error_InvalidAccount_First + 2;
-    }
+    // This is the Bid of the winning bid, or null if the entry escrows its bids
+    const Bid *bid = 0;
 
-    // If this is the not the winning bid pubkey, then it cannot claim the winning bid
-    if (!SolPubkey_same(bid_account->key, &(entry->auction.winning_bid_pubkey))) {
-        return Error_CannotClaimBid;
+    // This is the number of lamports of the winning bid
+    uint64_t winning_bid_lamports;
+
+    if (entry->escrow_bids) {
+        // The entry itself holds the winning bid
+        if (!SolPubkey_same(bid_account->key, entry_account->key)) {
+            return Error_InvalidAccount_First + 2;
+        }
+
+        // Only the bidder of the winning bid can claim it
+        if (!SolPubkey_same(bidding_account->key, &(entry->auction.winning_bidder_pubkey))) {
+            return Error_CannotClaimBid;
+        }
+
+        winning_bid_lamports = entry->auction.highest_bid_lamports;
     }
+    else {
+        // Get the validated bid account data
+        bid = get_validated_bid(bid_account);
+        if (!bid) {
+            return Error_InvalidAccount_First + 2;
+        }
 
-    // If the bidder pubkey written into the bid is not the same as the bidder that was provided in this transaction,
-    // then this is an invalid attempt to claim a bid
-    if (!SolPubkey_same(bidding_account->key, &(bid->bidder_pubkey))) {
-        return Error_InvalidAccount_First;
+        // If this is the not the winning bid pubkey, then it cannot claim the winning bid
+        if (!SolPubkey_same(bid_account->key, &(entry->auction.winning_bid_pubkey))) {
+            return Error_CannotClaimBid;
+        }
+
+        // If the bidder pubkey written into the bid is not the same as the bidder that was provided in this
+        // transaction, then this is an invalid attempt to claim a bid
+        if (!SolPubkey_same(bidding_account->key, &(bid->bidder_pubkey))) {
+            return Error_InvalidAccount_First;
+        }
+
+        winning_bid_lamports = *(bid_account->lamports);
     }
 
     // Ensure that the token destination account exists
@@ -96,27 +98,83 @@ static uint64_t user_claim_winning(const SolParameters *params)
     }
 
     // If the accounts were provided that would allow the bid marker token account to be reclaimed, do so
-    if (reclaim_bid_marker) {
-        {
-            DECLARE_ACCOUNT(13,   bid_marker_mint_account,          ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-            DECLARE_ACCOUNT(14,   bid_marker_token_account,         ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        }
-
+    if (bid_marker_mint_account && bid) {
         // Burn the bid marker tokens
-        uint64_t ret = reclaim_bid_marker_token(&(entry->mint_pubkey), bidding_account, bid_marker_mint_account,
-                                                bid_marker_token_account, params->ka, params->ka_num);
+        ret = reclaim_bid_marker_token(&(entry->mint_pubkey), bidding_account, bid_marker_mint_account,
+                                       bid_marker_token_account, bid->bid_marker_token_bump_seed, params->ka,
+                                       params->ka_num);
         if (ret) {
             return ret;
         }
     }
 
-    // Set the purchase price on the entry to the winning bid amount, so that the entry now goes into an Owned
-    // state
-    entry->purchase_price_lamports = *(bid_account->lamports);
+    // Set the purchase price on the entry to the winning bid amount, and the entry now goes into an Owned state
+    entry->purchase_price_lamports = winning_bid_lamports;
+
+    if (!set_entry_state(entry, EntryState_Owned)) {
+        return Error_InternalProgrammingError;
+    }
+
+    // OK transferred the token, so move the winning bid lamports to the admin; when the entry escrows its bids, the
+    // bid account is the entry account, which keeps the rest of its lamports
+    *(admin_account->lamports) += winning_bid_lamports;
+    *(bid_account->lamports) -= winning_bid_lamports;
 
-    // OK transferred the token, so move the bid account lamports to the admin
-    *(admin_account->lamports) += *(bid_account->lamports);
-    *(bid_account->lamports) = 0;
+    *entry_return = entry;
 
     return 0;
 }
+
+
+static uint64_t user_claim_winning(const SolParameters *params)
+{
+    PROFILE_SCOPE("user_claim_winning");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,   bidding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(1,   entry_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(2,   bid_account,                      ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(3,   config_account,                   ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
+        DECLARE_ACCOUNT(4,   admin_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(5,   entry_token_account,              ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(6,   entry_mint_account,               ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(7,   authority_account,                ReadOnly,   NotSigner,  KnownAccount_Authority);
+        DECLARE_ACCOUNT(8,   token_destination_account,        ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(9,   token_destination_owner_account,  ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(10,  system_program_account,           ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
+        DECLARE_ACCOUNT(11,  spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
+        DECLARE_ACCOUNT(12,  spl_ata_program_account,          ReadOnly,   NotSigner,  KnownAccount_SPLATAProgram);
+    }
+
+    // If there are more than 13 accounts, then the optional reclaiming of bid marker is requested, and there must be
+    // 15 accounts; else there must be 13
+    SolAccountInfo *bid_marker_mint_account = 0;
+    SolAccountInfo *bid_marker_token_account = 0;
+
+    if (params->ka_num > 13) {
+        DECLARE_ACCOUNTS_NUMBER(15);
+        {
+            DECLARE_ACCOUNT(13,   reclaim_mint_account,             ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+            DECLARE_ACCOUNT(14,   reclaim_token_account,            ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+            bid_marker_mint_account = reclaim_mint_account;
+            bid_marker_token_account = reclaim_token_account;
+        }
+    }
+    else {
+        DECLARE_ACCOUNTS_NUMBER(13);
+    }
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    Entry *entry;
+
+    return claim_winning_bid(params, bidding_account, entry_account, bid_account, config_account, admin_account,
+                             entry_token_account, entry_mint_account, token_destination_account,
+                             token_destination_owner_account, bid_marker_mint_account, bid_marker_token_account,
+                             &clock, &entry);
+}
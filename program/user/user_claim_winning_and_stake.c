@@ -0,0 +1,74 @@
+#pragma once
+
+#include "user/user_claim_winning.c"
+#include "user/user_stake.c"
+
+
+static uint64_t user_claim_winning_and_stake(const SolParameters *params)
+{
+    PROFILE_SCOPE("user_claim_winning_and_stake");
+
+    // Declare accounts, which checks the permissions and identity of all accounts.  The first accounts are those of
+    // ClaimWinning, including the bid marker accounts, which are always reclaimed; the entry's block, the stake
+    // account and its withdraw authority follow, along with the other accounts that Stake uses.
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,   bidding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(1,   entry_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(2,   bid_account,                      ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(3,   config_account,                   ReadOnly,   NotSigner,  KnownAccount_ProgramConfig);
+        DECLARE_ACCOUNT(4,   admin_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(5,   entry_token_account,              ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(6,   entry_mint_account,               ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(7,   authority_account,                ReadOnly,   NotSigner,  KnownAccount_Authority);
+        DECLARE_ACCOUNT(8,   token_destination_account,        ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(9,   token_destination_owner_account,  ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(10,  system_program_account,           ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
+        DECLARE_ACCOUNT(11,  spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
+        DECLARE_ACCOUNT(12,  spl_ata_program_account,          ReadOnly,   NotSigner,  KnownAccount_SPLATAProgram);
+        DECLARE_ACCOUNT(13,  bid_marker_mint_account,          ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(14,  bid_marker_token_account,         ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(15,  block_account,                    ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(16,  stake_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(17,  withdraw_authority_account,       ReadOnly,   Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(18,  shinobi_systems_vote_account,     ReadOnly,   NotSigner,  KnownAccount_ShinobiSystemsVote);
+        DECLARE_ACCOUNT(19,  clock_sysvar_account,             ReadOnly,   NotSigner,  KnownAccount_ClockSysvar);
+        DECLARE_ACCOUNT(20,  stake_program_account,            ReadOnly,   NotSigner,  KnownAccount_StakeProgram);
+        DECLARE_ACCOUNT(21,  stake_config_account,             ReadOnly,   NotSigner,  KnownAccount_StakeConfig);
+        DECLARE_ACCOUNT(22,  stake_history_sysvar_account,     ReadOnly,   NotSigner,  KnownAccount_StakeHistorySysvar);
+    }
+    DECLARE_ACCOUNTS_NUMBER(23);
+
+    // This is the block data, which is needed to stake the entry
+    const Block *block = get_validated_block(block_account);
+    if (!block) {
+        return Error_InvalidAccount_First + 15;
+    }
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    Entry *entry;
+
+    uint64_t ret = claim_winning_bid(params, bidding_account, entry_account, bid_account, config_account,
+                                     admin_account, entry_token_account, entry_mint_account,
+                                     token_destination_account, token_destination_owner_account,
+                                     bid_marker_mint_account, bid_marker_token_account, &clock, &entry);
+    if (ret) {
+        return ret;
+    }
+
+    // The block must be the entry's block
+    if (!SolPubkey_same(&(entry->block_pubkey), block_account->key)) {
+        return Error_InvalidAccount_First + 15;
+    }
+
+    // Claiming the winning bid left the entry Owned.  There is no need to check the owner of the entry's token, since
+    // it was just transferred to the token destination account.  The entry is staked on behalf of the token
+    // destination owner, who will be the one to destake it.
+    PROFILE("stake");
+
+    return stake_entry(block, entry, stake_account, 16, withdraw_authority_account, &clock, params->ka, params->ka_num);
+}
@@ -2,11 +2,14 @@
 
 #include "util/util_commission.c"
 #include "util/util_ki.c"
+#include "util/util_program_config.c"
 #include "util/util_stake.c"
 
 
 static uint64_t user_destake(const SolParameters *params)
 {
+    PROFILE_SCOPE("user_destake");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   funding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
@@ -28,7 +31,14 @@ static uint64_t user_destake(const SolParameters *params)
         DECLARE_ACCOUNT(16,  spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
         DECLARE_ACCOUNT(17,  spl_ata_program_account,          ReadOnly,   NotSigner,  KnownAccount_SPLATAProgram);
     }
-    DECLARE_ACCOUNTS_NUMBER(18);
+
+    // The program config account may optionally follow, in which case the values cached in it are used instead of
+    // being fetched
+    SolAccountInfo *config_account = 0;
+    if (params->ka_num == 19) {
+        config_account = get_instruction_account(params, 18);
+    }
+    DECLARE_ACCOUNTS_NUMBER(config_account ? 19 : 18);
 
     // Get validated block and entry, which checks all validity of those accounts
     const Block *block = get_validated_block(block_account);
@@ -54,7 +64,7 @@ static uint64_t user_destake(const SolParameters *params)
     }
 
     // Check to make sure that the entry is staked
-    if (get_entry_state(block, entry, &clock) != EntryState_OwnedAndStaked) {
+    if (get_entry_state(0, entry, &clock) != EntryState_OwnedAndStaked) {
         return Error_NotStakeable;
     }
 
@@ -74,17 +84,26 @@ static uint64_t user_destake(const SolParameters *params)
         return Error_InvalidAccount_First + 5;
     }
 
-    // Harvest Ki.  Must be done before commission is charged since commission charge actually reduces the number of
-    // lamports in the stake account, which would affect Ki harvest calculations
+    // Harvest Ki.  Must be done before commission is charged since commission charge accrues commission, which is not
+    // counted in Ki harvest calculations
     uint64_t ret = harvest_ki(&stake, entry, ki_destination_account, ki_destination_owner_account->key,
                               funding_account->key, params->ka, params->ka_num);
     if (ret) {
         return ret;
     }
 
-    // Charge commission
+    // Get the cached values of the program config, if it was supplied
+    ProgramConfigCache cache_buffer;
+    const ProgramConfigCache *cache;
+    ret = get_program_config_cache(config_account, 18, &clock, &cache_buffer, &cache);
+    if (ret) {
+        return ret;
+    }
+
+    // Charge commission, settling all accrued commission regardless of the settlement threshold since the stake
+    // account is leaving the program's control
     ret = charge_commission(&stake, block, entry, funding_account->key, bridge_stake_account, stake_account->key,
-                            params->ka, params->ka_num);
+                            cache, 0, params->ka, params->ka_num);
     if (ret) {
         return ret;
     }
@@ -98,5 +117,9 @@ static uint64_t user_destake(const SolParameters *params)
     // No longer staked, all fields in owned should be zeroed out
     sol_memset(&(entry->owned), 0, sizeof(entry->owned));
 
+    if (!set_entry_state(entry, EntryState_Owned)) {
+        return Error_InternalProgrammingError;
+    }
+
     return 0;
 }
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "util/util_bid.c"
+#include "util/util_transfer_lamports.c"
+
+typedef struct
+{
+    // This is the instruction code for EscrowedBid
+    uint8_t instruction_code;
+
+    // Minimum bid in lamports
+    uint64_t minimum_bid_lamports;
+
+    // Maximum bid in lamports
+    uint64_t maximum_bid_lamports;
+
+} EscrowedBidData;
+
+
+// Bids on an entry whose bids are escrowed in the entry itself.  The bid lamports are moved into the entry account,
+// and the bidder of the bid that is outbid, if any, is refunded from it in the same instruction, so no Bid account
+// or bid marker token is created and there is never a losing bid to claim.
+static uint64_t user_escrowed_bid(const SolParameters *params)
+{
+    PROFILE_SCOPE("user_escrowed_bid");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,  bidding_account,               ReadWrite,  Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(1,  entry_account,                 ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(2,  previous_bidder_account,       ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(3,  system_program_account,        ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
+    }
+    DECLARE_ACCOUNTS_NUMBER(4);
+
+    // Make sure that the input data is the correct size
+    if (params->data_len != sizeof(EscrowedBidData)) {
+        return Error_InvalidDataSize;
+    }
+
+    // Cast to instruction data
+    const EscrowedBidData *data = (EscrowedBidData *) params->data;
+
+    // Check to make sure data is sane
+    if (data->minimum_bid_lamports > data->maximum_bid_lamports) {
+        return Error_InvalidData_First;
+    }
+
+    // This is the entry data
+    Entry *entry = get_validated_entry(entry_account);
+    if (!entry) {
+        return Error_InvalidAccount_First + 1;
+    }
+
+    // An entry whose bids are held in Bid accounts takes Bid instead
+    if (!entry->escrow_bids) {
+        return Error_WrongAuctionMode;
+    }
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    // Check to make sure that the entry is in an auction
+    if (get_entry_state(0, entry, &clock) != EntryState_InAuction) {
+        return Error_EntryNotInAuction;
+    }
+
+    // Compute the bid, which is the least amount within the range of this bid that is at least the minimum bid
+    uint64_t bid_lamports;
+    uint64_t ret = compute_bid_lamports(entry, &clock, data->minimum_bid_lamports, data->maximum_bid_lamports,
+                                        &bid_lamports);
+    if (ret) {
+        return ret;
+    }
+
+    // If there is a bid being outbid, then the previous bidder account must be its bidder, who is refunded below.
+    // Otherwise the previous bidder account is not used.
+    uint64_t refund_lamports = entry->auction.highest_bid_lamports;
+
+    if (refund_lamports && !SolPubkey_same(previous_bidder_account->key, &(entry->auction.winning_bidder_pubkey))) {
+        return Error_InvalidAccount_First + 2;
+    }
+
+    // Move the bid lamports into the entry account, which holds them in escrow until they are either refunded to the
+    // bidder when outbid, or moved to the admin when the winning bid is claimed
+    ret = util_transfer_lamports(bidding_account->key, entry_account->key, bid_lamports, params->ka, params->ka_num);
+    if (ret) {
+        return ret;
+    }
+
+    // Refund the previous bidder from escrow, which may be the bidding account itself if it is raising its own bid
+    if (refund_lamports) {
+        *(entry_account->lamports) -= refund_lamports;
+        *(previous_bidder_account->lamports) += refund_lamports;
+    }
+
+    // Update the entry's auction details
+    entry->auction.highest_bid_lamports = bid_lamports;
+
+    entry->auction.winning_bidder_pubkey = *(bidding_account->key);
+
+    return 0;
+}
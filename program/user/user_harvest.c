@@ -3,6 +3,8 @@
 
 static uint64_t user_harvest(const SolParameters *params)
 {
+    PROFILE_SCOPE("user_harvest");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   funding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
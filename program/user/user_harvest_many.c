@@ -0,0 +1,86 @@
+#pragma once
+
+
+static uint64_t user_harvest_many(const SolParameters *params)
+{
+    PROFILE_SCOPE("user_harvest_many");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,   funding_account,                  ReadWrite,  Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(1,   token_owner_account,              ReadOnly,   Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(2,   ki_destination_account,           ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(3,   ki_destination_owner_account,     ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(4,   ki_mint_account,                  ReadWrite,  NotSigner,  KnownAccount_KiMint);
+        DECLARE_ACCOUNT(5,   authority_account,                ReadOnly,   NotSigner,  KnownAccount_Authority);
+        DECLARE_ACCOUNT(6,   system_program_account,           ReadOnly,   NotSigner,  KnownAccount_SystemProgram);
+        DECLARE_ACCOUNT(7,   spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
+        DECLARE_ACCOUNT(8,   spl_ata_program_account,          ReadOnly,   NotSigner,  KnownAccount_SPLATAProgram);
+    }
+
+    // The (entry, token, stake) account triples follow the 9 fixed accounts, and there must be at least one
+    if ((params->ka_num < 12) || ((params->ka_num - 9) % 3)) {
+        return Error_IncorrectNumberOfAccounts;
+    }
+
+    uint8_t entry_count = (params->ka_num - 9) / 3;
+
+    DECLARE_ACCOUNTS_NUMBER(9 + (entry_count * 3));
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    // The total Ki harvested from all entries.  This cannot overflow because the Ki harvested from a single entry is
+    // bounded far below the maximum u64 value by the reduction schedule of compute_ki_harvest().
+    uint64_t total_harvest_amount = 0;
+
+    for (uint8_t i = 0; i < entry_count; i++) {
+        uint8_t account_index = 9 + (i * 3);
+
+        SolAccountInfo *entry_account = get_instruction_account(params, account_index);
+        SolAccountInfo *token_account = get_instruction_account(params, account_index + 1);
+        SolAccountInfo *stake_account = get_instruction_account(params, account_index + 2);
+
+        // Ensure that the entry account is writable
+        if (!entry_account->is_writable) {
+            return Error_InvalidAccountPermissions_First + account_index;
+        }
+
+        // This is the entry data
+        Entry *entry = get_validated_entry(entry_account);
+        if (!entry) {
+            return Error_InvalidAccount_First + account_index;
+        }
+
+        // Check to make sure that the entry is staked
+        if (get_entry_state(0, entry, &clock) != EntryState_OwnedAndStaked) {
+            return Error_NotStaked;
+        }
+
+        // Check to make sure that the entry token is owned by the token owner account
+        if (!is_token_owner(token_account, token_owner_account->key, &(entry->mint_pubkey), 1)) {
+            return Error_InvalidAccount_First + account_index + 1;
+        }
+
+        // Check to make sure that the stake account passed in is actually staked in the entry
+        if (!SolPubkey_same(&(entry->owned.stake_account), stake_account->key)) {
+            return Error_InvalidAccount_First + account_index + 2;
+        }
+
+        // Decode the stake account
+        Stake stake;
+        if (!decode_stake_account(stake_account, &stake)) {
+            return Error_InvalidAccount_First + account_index + 2;
+        }
+
+        // Compute the Ki harvested from this entry; it is minted along with that of all other entries below
+        total_harvest_amount += compute_ki_harvest(&stake, entry);
+    }
+
+    // Mint all harvested Ki at once
+    return mint_ki(total_harvest_amount, ki_destination_account, ki_destination_owner_account->key,
+                   funding_account->key, params->ka, params->ka_num);
+}
@@ -2,8 +2,35 @@
 
 #include "util/util_math.c"
 
+
+typedef struct
+{
+    // This is the instruction code for LevelUp
+    uint8_t instruction_code;
+
+    // The level that the entry is being leveled up to, which may be more than one level above its current level.  0
+    // means the level after the entry's current level.  This occupies what was padding before level_metadata_proof, so
+    // instructions that predate it level up by one level.
+    uint8_t target_level;
+
+    // The metadata of the level that the entry is being leveled up to, and its proof
+    LevelMetadataProof level_metadata_proof;
+
+} LevelUpData;
+
+
+static uint64_t compute_level_up_data_size(uint8_t proof_length)
+{
+    const LevelUpData *d = 0;
+
+    return ((uint64_t) &(d->level_metadata_proof.proof[proof_length]));
+}
+
+
 static uint64_t user_level_up(const SolParameters *params)
 {
+    PROFILE_SCOPE("user_level_up");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   entry_account,                    ReadWrite,  NotSigner,  KnownAccount_NotKnown);
@@ -16,11 +43,30 @@ static uint64_t user_level_up(const SolParameters *params)
         DECLARE_ACCOUNT(7,   authority_account,                ReadOnly,   NotSigner,  KnownAccount_Authority);
         DECLARE_ACCOUNT(8,   spl_token_program_account,        ReadOnly,   NotSigner,  KnownAccount_SPLTokenProgram);
         DECLARE_ACCOUNT(9,   metaplex_program_account,         ReadOnly,   NotSigner,  KnownAccount_MetaplexProgram);
+        DECLARE_ACCOUNT(10,  block_account,                    ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+    }
+    DECLARE_ACCOUNTS_NUMBER(11);
+
+    // Make sure that the data is properly sized given the length of the level metadata proof
+    if (params->data_len < compute_level_up_data_size(0)) {
+        return Error_InvalidDataSize;
+    }
+
+    const LevelUpData *data = (LevelUpData *) params->data;
+
+    if ((data->level_metadata_proof.proof_length > MAX_LEVEL_METADATA_PROOF_LENGTH) ||
+        (params->data_len != compute_level_up_data_size(data->level_metadata_proof.proof_length))) {
+        return Error_InvalidDataSize;
+    }
+
+    // This is the block data, which holds the URI prefixes of the entry's metadata
+    const Block *block = get_validated_block(block_account);
+    if (!block) {
+        return Error_InvalidAccount_First + 10;
     }
-    DECLARE_ACCOUNTS_NUMBER(10);
 
     // This is the entry data
-    Entry *entry = get_validated_entry(entry_account);
+    Entry *entry = get_validated_entry_of_block(entry_account, block_account->key);
     if (!entry) {
         return Error_InvalidAccount_First;
     }
@@ -45,6 +91,12 @@ static uint64_t user_level_up(const SolParameters *params)
         return Error_AlreadyAtMaxLevel;
     }
 
+    // Check to make sure that the target level is above the entry's current level and not above level index 8
+    uint8_t target_level = data->target_level ? data->target_level : (entry->level + 1);
+    if ((target_level <= entry->level) || (target_level > 8)) {
+        return Error_InvalidData_First + 1;
+    }
+
     // Check to make sure that the entry token is owned by the token owner account
     if (!is_token_owner(token_account, token_owner_account->key, &(entry->mint_pubkey), 1)) {
         return Error_InvalidAccount_First + 2;
@@ -54,14 +106,21 @@ static uint64_t user_level_up(const SolParameters *params)
         return Error_InvalidAccount_First + 3;
     }
 
-    // Compute how much Ki to burn from the source account.  Since on-chain Ki are stored with decimal places 1,
-    // or in other words "DeciKi", multiply ki_to_burn by 10 since 10 on-chain tokens equals one Ki.  Keep track
-    // of overflow, and if it occurs, use the maximum value.
+    // Compute how much Ki to burn from the source account, which is the sum of the Ki needed to level up from each
+    // level to the next until the target level is reached.  Since on-chain Ki are stored with decimal places 1,
+    // or in other words "DeciKi", multiply by 10 since 10 on-chain tokens equals one Ki.  Keep track of overflow, and
+    // if it occurs, use the maximum value.
     bool overflow = false;
-    uint64_t ki_to_burn = checked_multiply(entry->metadata.level_1_ki, 10, &overflow);
-    for (uint8_t i = 0; i < entry->level; i++) {
-        // Multiply by 1.5x
-        ki_to_burn = checked_add(ki_to_burn, (ki_to_burn >> 1), &overflow);
+    uint64_t level_ki = checked_multiply(entry->metadata.level_1_ki, 10, &overflow);
+    uint64_t ki_to_burn = 0;
+    for (uint8_t i = 0; i < target_level; i++) {
+        if (i > 0) {
+            // Multiply by 1.5x
+            level_ki = checked_add(level_ki, (level_ki >> 1), &overflow);
+        }
+        if (i >= entry->level) {
+            ki_to_burn = checked_add(ki_to_burn, level_ki, &overflow);
+        }
     }
 
     // If overflow occurred, then use the max value.
@@ -75,6 +134,13 @@ static uint64_t user_level_up(const SolParameters *params)
         return Error_InvalidAccount_First + 5;
     }
 
+    // Check to make sure that the supplied level metadata is that of the target level of the entry; the metadata of
+    // any levels skipped over is never needed
+    LevelMetadata level_metadata;
+    if (!get_proven_level_metadata(entry, target_level, &(data->level_metadata_proof), &level_metadata)) {
+        return Error_InvalidHash;
+    }
+
     // Burn the Ki
     uint64_t ret = burn_tokens(ki_source_account->key, ki_source_owner_account->key,
                                &(Constants.ki_mint_pubkey), ki_to_burn, params->ka, params->ka_num);
@@ -83,8 +149,10 @@ static uint64_t user_level_up(const SolParameters *params)
     }
 
     // Increase the entry's level
-    entry->level += 1;
+    entry->level = target_level;
+
+    set_entry_current_level(entry, &level_metadata);
 
     // Update the metaplex metadata
-    return set_metaplex_metadata_for_level(entry, entry->level, entry_metadata_account, params->ka, params->ka_num);
+    return set_metaplex_metadata_for_level(block, entry, &level_metadata, params->ka, params->ka_num);
 }
@@ -3,6 +3,8 @@
 
 static uint64_t user_refund(const SolParameters *params)
 {
+    PROFILE_SCOPE("user_refund");
+
     // Declare accounts, which checks the permissions and identity of all accounts
     DECLARE_ACCOUNTS {
         DECLARE_ACCOUNT(0,   token_owner_account,              ReadOnly,   Signer,     KnownAccount_NotKnown);
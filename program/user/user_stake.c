@@ -3,53 +3,19 @@
 #include "util/util_stake.c"
 
 
-static uint64_t user_stake(const SolParameters *params)
+// Stakes [entry], which the caller has checked is in the Owned state, to the stake account [stake_account], whose
+// withdraw authority is [withdraw_authority_account].  The stake account's authorities are set to the program's
+// authority, and it is delegated to Shinobi Systems if it is not delegated yet.  [stake_account_index] is the index of
+// the stake account in the instruction's accounts, which is immediately followed by the withdraw authority account.
+static uint64_t stake_entry(const Block *block, Entry *entry, SolAccountInfo *stake_account,
+                            uint8_t stake_account_index, SolAccountInfo *withdraw_authority_account,
+                            const Clock *clock, const SolAccountInfo *transaction_accounts,
+                            int transaction_accounts_len)
 {
-    // Declare accounts, which checks the permissions and identity of all accounts
-    DECLARE_ACCOUNTS {
-        DECLARE_ACCOUNT(0,  block_account,                 ReadOnly,  NotSigner,   KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(1,  entry_account,                 ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(2,  token_owner_account,           ReadOnly,   Signer,     KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(3,  token_account,                 ReadOnly,   NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(4,  stake_account,                 ReadWrite,  NotSigner,  KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(5,  withdraw_authority_account,    ReadOnly,   Signer,     KnownAccount_NotKnown);
-        DECLARE_ACCOUNT(6,  shinobi_systems_vote_account,  ReadOnly,   NotSigner,  KnownAccount_ShinobiSystemsVote);
-        DECLARE_ACCOUNT(7,  authority_account,             ReadOnly,   NotSigner,  KnownAccount_Authority);
-        DECLARE_ACCOUNT(8,  clock_sysvar_account,          ReadOnly,   NotSigner,  KnownAccount_ClockSysvar);
-        DECLARE_ACCOUNT(9,  stake_program_account,         ReadOnly,   NotSigner,  KnownAccount_StakeProgram);
-        DECLARE_ACCOUNT(10, stake_config_account,          ReadOnly,   NotSigner,  KnownAccount_StakeConfig);
-        DECLARE_ACCOUNT(11, stake_history_sysvar_account,  ReadOnly,   NotSigner,  KnownAccount_StakeHistorySysvar);
-    }
-    DECLARE_ACCOUNTS_NUMBER(12);
-
-    // This is the block data
-    const Block *block = get_validated_block(block_account);
-    if (!block) {
-        return Error_InvalidAccount_First;
-    }
-
-    // This is the entry data
-    Entry *entry = get_validated_entry_of_block(entry_account, block_account->key);
-    if (!entry) {
-        return Error_InvalidAccount_First + 1;
-    }
-
-    // Get the clock sysvar, needed below
-    Clock clock;
-    if (sol_get_clock_sysvar(&clock)) {
-        return Error_FailedToGetClock;
-    }
-
-    // Check to make sure that the entry is in an Owned state, which is the only state from which a stake operation is
-    // valid.
-    if (get_entry_state(0, entry, &clock) != EntryState_Owned) {
-        return Error_NotStakeable;
-    }
-
     // Deserialize the stake account into a Stake instance
     Stake stake;
     if (!decode_stake_account(stake_account, &stake)) {
-        return Error_InvalidAccount_First + 4;
+        return Error_InvalidAccount_First + stake_account_index;
     }
 
     // - Must be in Initialized or Stake state
@@ -58,27 +24,22 @@ static uint64_t user_stake(const SolParameters *params)
     case StakeState_Stake:
         break;
     default:
-        return Error_InvalidAccount_First + 4;
+        return Error_InvalidAccount_First + stake_account_index;
     }
 
     // - Must have a withdraw authority equal to the provided withdraw authority
     if (!SolPubkey_same(&(stake.meta.authorize.withdrawer), withdraw_authority_account->key)) {
-        return Error_InvalidAccount_First + 5;
+        return Error_InvalidAccount_First + stake_account_index + 1;
     }
 
     // - Must not be locked.  Don't bother checking custodian, that feature just isn't supported here
-    if ((stake.meta.lockup.unix_timestamp > clock.unix_timestamp) || (stake.meta.lockup.epoch > clock.epoch)) {
-        return Error_InvalidAccount_First + 4;
-    }
-
-    // Check to make sure that the entry token is owned by the token owner account
-    if (!is_token_owner(token_account, token_owner_account->key, &(entry->mint_pubkey), 1)) {
-        return Error_InvalidAccount_First + 2;
+    if ((stake.meta.lockup.unix_timestamp > clock->unix_timestamp) || (stake.meta.lockup.epoch > clock->epoch)) {
+        return Error_InvalidAccount_First + stake_account_index;
     }
 
     // Use stake account program to set all authorities to the authority
     if (set_stake_authorities(stake_account->key, withdraw_authority_account->key,
-                              &(Constants.authority_pubkey), params->ka, params->ka_num)) {
+                              &(Constants.authority_pubkey), transaction_accounts, transaction_accounts_len)) {
         return Error_SetStakeAuthoritiesFailed;
     }
 
@@ -86,20 +47,20 @@ static uint64_t user_stake(const SolParameters *params)
     // The amount of SOL that it will have as delegated after this delegation
     if (stake.state == StakeState_Initialized) {
         if (delegate_stake_signed(stake_account->key, &(Constants.shinobi_systems_vote_pubkey),
-                                  params->ka, params->ka_num)) {
+                                  transaction_accounts, transaction_accounts_len)) {
             return Error_FailedToDelegate;
         }
 
         // Re-decode the stake account, to get the new delegation information
         if (!decode_stake_account(stake_account, &stake)) {
-            return Error_InvalidAccount_First + 4;
+            return Error_InvalidAccount_First + stake_account_index;
         }
     }
     // Else the stake account is delegated (because the only other stake state possible is StakeState_Stake according
     // to the switch done already above), and if it's not delegated to Shinobi Systems, deactivate it, so that in the
     // next epoch it can be re-delegated to Shinobi Systems via the redelegate crank.
     else if (!is_shinobi_systems_vote_account(&(stake.stake.delegation.voter_pubkey))) {
-        if (deactivate_stake_signed(stake_account->key, params->ka, params->ka_num)) {
+        if (deactivate_stake_signed(stake_account->key, transaction_accounts, transaction_accounts_len)) {
             return Error_FailedToDeactivate;
         }
 
@@ -110,11 +71,15 @@ static uint64_t user_stake(const SolParameters *params)
     // Record the stake account address
     entry->owned.stake_account = *(stake_account->key);
 
+    if (!set_entry_state(entry, EntryState_OwnedAndStaked)) {
+        return Error_InternalProgrammingError;
+    }
+
     // Record initial lamports, to be used to calculate APY if needed
     entry->owned.stake_initial_lamports = stake.stake.delegation.stake;
 
     // Record stake epoch, to be used to calculate APY if needed
-    entry->owned.stake_epoch = clock.epoch;
+    entry->owned.stake_epoch = clock->epoch;
 
     // Record current lamports in the stake account to be used for ki harvesting purposes
     entry->owned.last_ki_harvest_stake_account_lamports = stake.stake.delegation.stake;
@@ -127,3 +92,57 @@ static uint64_t user_stake(const SolParameters *params)
 
     return 0;
 }
+
+
+static uint64_t user_stake(const SolParameters *params)
+{
+    PROFILE_SCOPE("user_stake");
+
+    // Declare accounts, which checks the permissions and identity of all accounts
+    DECLARE_ACCOUNTS {
+        DECLARE_ACCOUNT(0,  block_account,                 ReadOnly,  NotSigner,   KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(1,  entry_account,                 ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(2,  token_owner_account,           ReadOnly,   Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(3,  token_account,                 ReadOnly,   NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(4,  stake_account,                 ReadWrite,  NotSigner,  KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(5,  withdraw_authority_account,    ReadOnly,   Signer,     KnownAccount_NotKnown);
+        DECLARE_ACCOUNT(6,  shinobi_systems_vote_account,  ReadOnly,   NotSigner,  KnownAccount_ShinobiSystemsVote);
+        DECLARE_ACCOUNT(7,  authority_account,             ReadOnly,   NotSigner,  KnownAccount_Authority);
+        DECLARE_ACCOUNT(8,  clock_sysvar_account,          ReadOnly,   NotSigner,  KnownAccount_ClockSysvar);
+        DECLARE_ACCOUNT(9,  stake_program_account,         ReadOnly,   NotSigner,  KnownAccount_StakeProgram);
+        DECLARE_ACCOUNT(10, stake_config_account,          ReadOnly,   NotSigner,  KnownAccount_StakeConfig);
+        DECLARE_ACCOUNT(11, stake_history_sysvar_account,  ReadOnly,   NotSigner,  KnownAccount_StakeHistorySysvar);
+    }
+    DECLARE_ACCOUNTS_NUMBER(12);
+
+    // This is the block data
+    const Block *block = get_validated_block(block_account);
+    if (!block) {
+        return Error_InvalidAccount_First;
+    }
+
+    // This is the entry data
+    Entry *entry = get_validated_entry_of_block(entry_account, block_account->key);
+    if (!entry) {
+        return Error_InvalidAccount_First + 1;
+    }
+
+    // Get the clock sysvar, needed below
+    Clock clock;
+    if (sol_get_clock_sysvar(&clock)) {
+        return Error_FailedToGetClock;
+    }
+
+    // Check to make sure that the entry is in an Owned state, which is the only state from which a stake operation is
+    // valid.
+    if (get_entry_state(0, entry, &clock) != EntryState_Owned) {
+        return Error_NotStakeable;
+    }
+
+    // Check to make sure that the entry token is owned by the token owner account
+    if (!is_token_owner(token_account, token_owner_account->key, &(entry->mint_pubkey), 1)) {
+        return Error_InvalidAccount_First + 2;
+    }
+
+    return stake_entry(block, entry, stake_account, 4, withdraw_authority_account, &clock, params->ka, params->ka_num);
+}
@@ -3,6 +3,8 @@
 #include "solana_sdk.h"
 
 #include "inc/constants.h"
+#include "inc/instruction_accounts.h"
+#include "inc/profile.h"
 #include "inc/program_config.h"
 #include "util/util_rent.c"
 #include "util/util_transfer_lamports.c"
@@ -61,7 +63,7 @@ static bool get_admin_account_address(const SolAccountInfo *config_account, SolP
 {
     // The identity of the admin is loaded from the config account; ensure that this is the actual one true config
     // account
-    if (!is_config_account(config_account->key)) {
+    if (!check_known_account(config_account, KnownAccount_ProgramConfig)) {
         return false;
     }
 
@@ -152,6 +154,66 @@ static bool is_metaplex_metadata_program(const SolPubkey *pubkey)
 }
 
 
+// Returns true only if [pubkey] is the address that is derived from [seeds] for this program.  The last element of
+// [seeds] must be the bump seed of the address.  This uses a single sol_create_program_address call, which is much
+// cheaper than searching for the bump seed via sol_try_find_program_address, so the bump seed must either have been
+// stored in the account when it was created, or be supplied by the client in instruction data.
+static bool is_program_derived_address(const SolPubkey *pubkey, const SolSignerSeed *seeds, int seeds_count)
+{
+    PROFILE_SCOPE("is_program_derived_address");
+
+    SolPubkey computed_pubkey;
+
+    // If the bump seed does not produce a valid program derived address, then the address cannot be correct
+    if (sol_create_program_address(seeds, seeds_count, &(Constants.self_program_pubkey), &computed_pubkey)) {
+        return false;
+    }
+
+    return SolPubkey_same(&computed_pubkey, pubkey);
+}
+
+
+// Returns true only if the bump seed that is the last element of [seeds], which must already be known to produce a
+// valid program derived address, is the canonical bump seed of that address, which is the one that
+// sol_try_find_program_address would find.  Accounts that are created from a client supplied bump seed must check
+// this, so that only one account can ever be created for a given set of seeds.  Every larger bump seed is tried, each
+// of which must fail to produce an address; since the canonical bump seed is nearly always 255 or 254, this is usually
+// much cheaper than searching for it.  The last element of [seeds] is temporarily modified, but is restored before
+// returning.
+static bool is_canonical_bump_seed(SolSignerSeed *seeds, int seeds_count)
+{
+    PROFILE_SCOPE("is_canonical_bump_seed");
+
+    SolSignerSeed *bump_seed = &(seeds[seeds_count - 1]);
+
+    if (bump_seed->len != sizeof(uint8_t)) {
+        return false;
+    }
+
+    SolPubkey computed_pubkey;
+
+    const uint8_t *original_addr = bump_seed->addr;
+
+    uint8_t candidate = *original_addr;
+
+    bump_seed->addr = &candidate;
+
+    bool is_canonical = true;
+
+    while (candidate < 255) {
+        candidate += 1;
+        if (!sol_create_program_address(seeds, seeds_count, &(Constants.self_program_pubkey), &computed_pubkey)) {
+            is_canonical = false;
+            break;
+        }
+    }
+
+    bump_seed->addr = original_addr;
+
+    return is_canonical;
+}
+
+
 // Updates an account's data size
 static void set_account_size(SolAccountInfo *account, uint64_t size)
 {
@@ -176,12 +238,37 @@ static uint64_t create_account(SolAccountInfo *new_account, const SolPubkey *fun
                                uint64_t space, const SolSignerSeed *seeds, const int seeds_count,
                                const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("create_account");
+
     SolInstruction instruction;
 
     instruction.program_id = (SolPubkey *) &(Constants.system_program_pubkey);
 
     SolSignerSeeds signer_seeds = { seeds, seeds_count };
 
+    // If the account does not exist yet, which is the usual case, then fund, allocate, and assign it with a single
+    // CreateAccount.  Otherwise, someone may have transferred lamports into it to prevent CreateAccount from
+    // succeeding, so each step is done separately, and only if it is needed.
+    if ((*(new_account->lamports) == 0) && (new_account->data_len == 0) && is_system_program(new_account->owner)) {
+        SolAccountMeta account_metas[] =
+              ///   0. `[WRITE, SIGNER]` Funding account
+            { { /* pubkey */ (SolPubkey *) funding_account_key, /* is_writable */ true, /* is_signer */ true },
+              ///   1. `[WRITE, SIGNER]` New account
+              { /* pubkey */ new_account->key, /* is_writable */ true, /* is_signer */ true } };
+
+        instruction.accounts = account_metas;
+        instruction.account_len = ARRAY_LEN(account_metas);
+
+        util_CreateAccountData data = { 0, funding_lamports, space, *owner_account_key };
+
+        instruction.data = (uint8_t *) &data;
+        instruction.data_len = sizeof(data);
+
+        return seeds ?
+            sol_invoke_signed(&instruction, transaction_accounts, transaction_accounts_len, &signer_seeds, 1) :
+            sol_invoke(&instruction, transaction_accounts, transaction_accounts_len);
+    }
+
     // Fund ------------------------------------------------------------------------------------------------------------
 
     if (*(new_account->lamports) < funding_lamports) {
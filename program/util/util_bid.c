@@ -1,38 +1,35 @@
 #pragma once
 
+#include "util/util_math.c"
+
 
 static uint64_t mint_bid_marker_token_idempotent(SolAccountInfo *bid_marker_token_account,
                                                  const SolPubkey *entry_mint_key,
                                                  const SolPubkey *bidder_key,
+                                                 uint8_t bump_seed,
                                                  const SolAccountInfo *transaction_accounts,
                                                  int transaction_accounts_len)
 {
     // Compute the bid marker token address
     uint8_t prefix = PDA_Account_Seed_Prefix_Bid_Marker_Token;
 
-    uint8_t bump_seed;
-
     SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
                               { (uint8_t *) entry_mint_key, sizeof(*entry_mint_key) },
                               { (uint8_t *) bidder_key, sizeof(*bidder_key) },
                               { &bump_seed, sizeof(bump_seed) } };
 
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return ret;
-    }
-
-    // Verify that the bid marker token address is as expected
-    if (!SolPubkey_same(&pubkey, bid_marker_token_account->key)) {
+    // Verify that the bid marker token address is as expected, and that its bump seed is the canonical one, so that a
+    // bidder can only ever have one bid marker token account per entry
+    if (!is_program_derived_address(bid_marker_token_account->key, seeds, ARRAY_LEN(seeds)) ||
+        !is_canonical_bump_seed(seeds, ARRAY_LEN(seeds))) {
         return Error_CreateAccountFailed;
     }
 
-    // Ensure the bid marker token account exists
-    ret = create_pda_token_account_idempotent(bid_marker_token_account, &(Constants.bid_marker_mint_pubkey),
+    // Ensure the bid marker token account exists.  Bid is not given the program config, so there is no cached rent
+    // exemption to use.
+    uint64_t ret = create_pda_token_account_idempotent(bid_marker_token_account, &(Constants.bid_marker_mint_pubkey),
                                               /* owner */ bidder_key, /* funder */ bidder_key, seeds, ARRAY_LEN(seeds),
-                                              transaction_accounts, transaction_accounts_len);
+                                              /* cache */ 0, transaction_accounts, transaction_accounts_len);
     if (ret) {
         return ret;
     }
@@ -45,31 +42,25 @@ static uint64_t mint_bid_marker_token_idempotent(SolAccountInfo *bid_marker_toke
 
 
 static uint64_t create_entry_bid_account(SolAccountInfo *bid_account, const SolPubkey *bid_marker_key,
-                                         const SolPubkey *mint_key, const SolPubkey *bidder_key, uint64_t bid_lamports,
+                                         uint8_t bump_seed, uint8_t bid_marker_bump_seed, const SolPubkey *mint_key,
+                                         const SolPubkey *bidder_key, uint64_t bid_lamports,
                                          const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
     // Compute the bid address
     uint8_t prefix = PDA_Account_Seed_Prefix_Bid;
 
-    uint8_t bump_seed;
-
     SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
                               { (uint8_t *) bid_marker_key, sizeof(*bid_marker_key) },
                               { &bump_seed, sizeof(bump_seed) } };
 
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return ret;
-    }
-
-    // Verify that the bid account address is as expected
-    if (!SolPubkey_same(&pubkey, bid_account->key)) {
+    // Verify that the bid account address is as expected, and that its bump seed is the canonical one, so that there
+    // can only ever be one bid account per bid marker token
+    if (!is_program_derived_address(bid_account->key, seeds, ARRAY_LEN(seeds)) ||
+        !is_canonical_bump_seed(seeds, ARRAY_LEN(seeds))) {
         return Error_CreateAccountFailed;
     }
 
-    ret = create_pda(bid_account, seeds, ARRAY_LEN(seeds), bidder_key, &(Constants.self_program_pubkey),
+    uint64_t ret = create_pda(bid_account, seeds, ARRAY_LEN(seeds), bidder_key, &(Constants.self_program_pubkey),
                      bid_lamports, sizeof(Bid), transaction_accounts, transaction_accounts_len);
     if (ret) {
         return ret;
@@ -84,15 +75,19 @@ static uint64_t create_entry_bid_account(SolAccountInfo *bid_account, const SolP
 
     bid->bidder_pubkey = *bidder_key;
 
+    bid->bid_marker_token_bump_seed = bid_marker_bump_seed;
+
     return 0;
 }
 
 
-static uint64_t reclaim_bid_marker_token(const SolPubkey *entry_token_mint_pubkey,
-                                         const SolAccountInfo *bidding_account,
-                                         const SolAccountInfo *bid_marker_mint_account,
-                                         const SolAccountInfo *bid_marker_token_account,
-                                         const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
+// Burns the bid marker tokens in [bid_marker_token_account] and closes it, returning its lamports to the bidder.  The
+// caller must already have verified that [bid_marker_token_account] is the bid marker token account of the bidder.
+static uint64_t burn_and_close_bid_marker_token(const SolAccountInfo *bidding_account,
+                                                const SolAccountInfo *bid_marker_mint_account,
+                                                const SolAccountInfo *bid_marker_token_account,
+                                                const SolAccountInfo *transaction_accounts,
+                                                int transaction_accounts_len)
 {
     if (!bidding_account->is_writable) {
         return Error_FailedToReclaimBidMarkerToken;
@@ -109,43 +104,97 @@ static uint64_t reclaim_bid_marker_token(const SolPubkey *entry_token_mint_pubke
         return Error_FailedToReclaimBidMarkerToken;
     }
 
+    // Figure out how many tokens are in it
+    uint64_t token_amount = ((SolanaTokenProgramTokenData *) bid_marker_token_account->data)->amount;
+
+    // If there are tokens in there, burn them
+    if (token_amount > 0) {
+        uint64_t ret = burn_tokens(bid_marker_token_account->key, bidding_account->key,
+                                   &(Constants.bid_marker_mint_pubkey), token_amount,
+                                   transaction_accounts, transaction_accounts_len);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    return close_token_account(bid_marker_token_account->key, bidding_account->key, bidding_account->key,
+                               transaction_accounts, transaction_accounts_len);
+}
+
+
+static uint64_t reclaim_bid_marker_token(const SolPubkey *entry_token_mint_pubkey,
+                                         const SolAccountInfo *bidding_account,
+                                         const SolAccountInfo *bid_marker_mint_account,
+                                         const SolAccountInfo *bid_marker_token_account, uint8_t bump_seed,
+                                         const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
+{
     // Compute the bid marker token address
     uint8_t prefix = PDA_Account_Seed_Prefix_Bid_Marker_Token;
 
-    uint8_t bump_seed;
-
     SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
                               { (uint8_t *) entry_token_mint_pubkey, sizeof(*entry_token_mint_pubkey) },
                               { (uint8_t *) bidding_account->key, sizeof(*(bidding_account->key)) },
                               { &bump_seed, sizeof(bump_seed) } };
 
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return ret;
+    // Verify that the entry token address is as expected
+    if (!is_program_derived_address(bid_marker_token_account->key, seeds, ARRAY_LEN(seeds))) {
+        return Error_FailedToReclaimBidMarkerToken;
     }
 
-    // Verify that the entry token address is as expected
-    if (!SolPubkey_same(&pubkey, bid_marker_token_account->key)) {
+    return burn_and_close_bid_marker_token(bidding_account, bid_marker_mint_account, bid_marker_token_account,
+                                           transaction_accounts, transaction_accounts_len);
+}
+
+
+// Reclaims the bid marker token account of a bidder whose Bid account for the entry has already been closed, which
+// happens when the bid is refunded by the Bid that outbids it.  There is no Bid to record the bump seeds, so the
+// canonical addresses of the bid marker token and bid accounts are searched for, which is the only bump seed that
+// Bid creates them with.  [bid_account] must be the bidder's closed Bid account, so that the bid marker token of a
+// bid that is still open cannot be reclaimed this way.
+static uint64_t reclaim_orphaned_bid_marker_token(const SolPubkey *entry_token_mint_pubkey,
+                                                  const SolAccountInfo *bidding_account,
+                                                  const SolAccountInfo *bid_account,
+                                                  const SolAccountInfo *bid_marker_mint_account,
+                                                  const SolAccountInfo *bid_marker_token_account,
+                                                  const SolAccountInfo *transaction_accounts,
+                                                  int transaction_accounts_len)
+{
+    // The Bid account must have been closed
+    if (*(bid_account->lamports) > 0) {
         return Error_FailedToReclaimBidMarkerToken;
     }
 
-    // Figure out how many tokens are in it
-    uint64_t token_amount = ((SolanaTokenProgramTokenData *) bid_marker_token_account->data)->amount;
+    // Find the bid marker token address
+    uint8_t prefix = PDA_Account_Seed_Prefix_Bid_Marker_Token;
 
-    // If there are tokens in there, burn them
-    if (token_amount > 0) {
-        uint64_t ret = burn_tokens(bid_marker_token_account->key, bidding_account->key,
-                                   &(Constants.bid_marker_mint_pubkey), token_amount,
-                                   transaction_accounts, transaction_accounts_len);
-        if (ret) {
-            return ret;
-        }
+    SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
+                              { (uint8_t *) entry_token_mint_pubkey, sizeof(*entry_token_mint_pubkey) },
+                              { (uint8_t *) bidding_account->key, sizeof(*(bidding_account->key)) } };
+
+    SolPubkey pubkey;
+    uint8_t bump_seed;
+
+    if (sol_try_find_program_address(seeds, ARRAY_LEN(seeds), &(Constants.self_program_pubkey), &pubkey, &bump_seed) ||
+        !SolPubkey_same(&pubkey, bid_marker_token_account->key)) {
+        return Error_FailedToReclaimBidMarkerToken;
     }
 
-    return close_token_account(bid_marker_token_account->key, bidding_account->key, bidding_account->key,
-                               transaction_accounts, transaction_accounts_len);
+    // Find the bid address, which is derived from the bid marker token address
+    uint8_t bid_prefix = PDA_Account_Seed_Prefix_Bid;
+
+    const SolPubkey *bid_marker_token_key = bid_marker_token_account->key;
+
+    SolSignerSeed bid_seeds[] = { { &bid_prefix, sizeof(bid_prefix) },
+                                  { (uint8_t *) bid_marker_token_key, sizeof(*bid_marker_token_key) } };
+
+    if (sol_try_find_program_address(bid_seeds, ARRAY_LEN(bid_seeds), &(Constants.self_program_pubkey), &pubkey,
+                                     &bump_seed) ||
+        !SolPubkey_same(&pubkey, bid_account->key)) {
+        return Error_FailedToReclaimBidMarkerToken;
+    }
+
+    return burn_and_close_bid_marker_token(bidding_account, bid_marker_mint_account, bid_marker_token_account,
+                                           transaction_accounts, transaction_accounts_len);
 }
 
 
@@ -171,3 +220,88 @@ static const Bid *get_validated_bid(const SolAccountInfo *bid_account)
 
     return bid;
 }
+
+
+static uint64_t compute_minimum_bid(uint64_t auction_duration, uint64_t initial_minimum_bid, uint64_t current_max_bid,
+                                    uint64_t seconds_elapsed)
+{
+    // If the maximum possible bid has been achieved, return 0
+    if (current_max_bid == UINT64_MAX) {
+        return 0;
+    }
+
+    // If there have been no bids yet, then use the initial minimum.  Only once the first bid is cast, does the
+    // minimum bid increment come into play.
+    if (current_max_bid < initial_minimum_bid) {
+        return initial_minimum_bid;
+    }
+
+    // Sanitize the seconds elapsed
+    if (seconds_elapsed >= auction_duration) {
+        seconds_elapsed = (auction_duration - 1);
+    }
+
+    // This is a curve based on the formula: y = p * ((1 / (101 - (100 * (a / b)))) + 1.01)
+    // Where a is seconds_elapsed, b is auction_duration, and p is current_max_bid.  This is a curve that goes
+    // from a multiple of 1.02 of the current_max_bid at time 0, up to 2.01x the current_max_bid at the end
+    // of the time range.
+    uint64_t a = seconds_elapsed;
+    uint64_t b = auction_duration;
+    uint64_t p = current_max_bid;
+
+    // Keep track of whether any of the math for computing the minimum bid overflows
+    bool overflow = false;
+
+    // result = (p * (((1000 * b) / ((b + (b / 100)) - a)) + 101000)) / 100000
+    // The term involving b and a cannot overflow since b was originally a uint32_t value; and a is less than b.
+    uint64_t result = checked_multiply(p, ((1000 * b) / ((b + (b / 100)) - a)) + 101000, &overflow) / 100000;
+
+    // Check for overflow
+    if (overflow) {
+        // Overflow has occurred.  This means that the formula can't be used to compute the maximum next bid because
+        // the numbers are too large.  This would only happen with extremely large bids, millions of dollars' worth.
+        // But to be safe, in this case, instead of computing an invalid minimum next bid, just use 1/8 more than the
+        // previous bid.
+        overflow = false;
+        result = checked_add(current_max_bid, (current_max_bid >> 3), &overflow);
+
+        // If this also overflowed, then use the maximum possible bid.
+        if (overflow) {
+            result = UINT64_MAX;
+        }
+    }
+
+    return result;
+}
+
+
+// Computes into [*bid_lamports] the amount of a bid on [entry], which is in auction, whose bidder will bid any amount
+// from [minimum_bid_lamports] to [maximum_bid_lamports]: the least amount in that range that is at least the minimum
+// bid allowed at the time of [clock].  Returns 0 on success, nonzero on error.
+static uint64_t compute_bid_lamports(const Entry *entry, const Clock *clock, uint64_t minimum_bid_lamports,
+                                     uint64_t maximum_bid_lamports, uint64_t *bid_lamports)
+{
+    // Compute the minimum auction bid price for the entry
+    uint64_t minimum_bid = compute_minimum_bid(entry->duration, entry->minimum_price_lamports,
+                                               entry->auction.highest_bid_lamports,
+                                               clock->unix_timestamp - entry->reveal_timestamp);
+
+    // If the minimum bid is 0, then no bid is possible
+    if (minimum_bid == 0) {
+        return Error_BidTooLow;
+    }
+
+    // If the minimum bid is greater than the maximum range of this bid, then the bid is not large enough
+    if (minimum_bid > maximum_bid_lamports) {
+        return Error_BidTooLow;
+    }
+
+    // Update minimum_bid to hold the minimum bid allowed by the range of this bid
+    if (minimum_bid < minimum_bid_lamports) {
+        minimum_bid = minimum_bid_lamports;
+    }
+
+    *bid_lamports = minimum_bid;
+
+    return 0;
+}
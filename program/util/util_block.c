@@ -4,46 +4,65 @@
 #include "util/util_accounts.c"
 
 
-static uint64_t compute_block_size(uint16_t entry_count)
+// Returns the number of bytes of the entries added bitmap of a block with [entry_count] entries
+static uint32_t compute_entries_added_bitmap_size(uint16_t entry_count)
+{
+    return (((uint32_t) entry_count + 1) / 8) + 1;
+}
+
+
+static uint64_t compute_block_size(uint16_t entry_count, uint16_t whitelist_slot_count)
 {
     Block *b = 0;
 
-    return (uint64_t) &(b->entries_added_bitmap[(((uint32_t) entry_count + 1) / 8) + 1]);
+    return (uint64_t) &(b->entries_added_bitmap[compute_entries_added_bitmap_size(entry_count) +
+                                                (((uint32_t) whitelist_slot_count + 7) / 8)]);
+}
+
+
+// Returns true if the block commits to the reveal of its entries with a reveal Merkle root rather than with a
+// reveal_sha256 per entry
+static bool block_has_reveal_merkle_root(const Block *block)
+{
+    return !is_all_zeroes(&(block->config.reveal_merkle_root), sizeof(block->config.reveal_merkle_root));
+}
+
+
+// Returns the whitelist claimed bitmap of the block, which immediately follows its entries added bitmap
+static uint8_t *get_whitelist_claimed_bitmap(Block *block)
+{
+    return &(block->entries_added_bitmap[compute_entries_added_bitmap_size(block->config.total_entry_count)]);
 }
 
 
 // Returns an error if [block_account] is not the correct account
 static uint64_t create_block_account(SolAccountInfo *block_account, uint32_t group_number,
-                                     uint32_t block_number, uint16_t entry_count, const SolPubkey *funding_key,
-                                     const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
+                                     uint32_t block_number, uint8_t bump_seed, uint16_t entry_count,
+                                     uint16_t whitelist_slot_count, const SolPubkey *funding_key,
+                                     const ProgramConfigCache *cache, const SolAccountInfo *transaction_accounts,
+                                     int transaction_accounts_len)
 {
     // Compute the block address
     uint8_t prefix = PDA_Account_Seed_Prefix_Block;
 
-    uint8_t bump_seed;
-
     SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
                               { (uint8_t *) &group_number, sizeof(group_number) },
                               { (uint8_t *) &block_number, sizeof(block_number) },
                               { &bump_seed, sizeof(bump_seed) } };
 
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return ret;
-    }
-
-    // Verify that the block address is as expected
-    if (!SolPubkey_same(&pubkey, block_account->key)) {
+    // Verify that the block address is as expected, and that its bump seed is the canonical one, so that there can
+    // only ever be one block account for each group and block number
+    if (!is_program_derived_address(block_account->key, seeds, ARRAY_LEN(seeds)) ||
+        !is_canonical_bump_seed(seeds, ARRAY_LEN(seeds))) {
         return Error_CreateAccountFailed;
     }
 
-    // The size of the block to create is the sizeof a block + 1 byte per 8 entries (for the entries added bitmap)
-    uint64_t block_size = compute_block_size(entry_count);
+    // The size of the block to create is the sizeof a block + 1 byte per 8 entries (for the entries added bitmap) + 1
+    // byte per 8 whitelist slots (for the whitelist claimed bitmap)
+    uint64_t block_size = compute_block_size(entry_count, whitelist_slot_count);
 
     return create_pda(block_account, seeds, ARRAY_LEN(seeds), funding_key, &(Constants.self_program_pubkey),
-                      get_rent_exempt_minimum(block_size), block_size, transaction_accounts,
+                      get_cached_rent_exempt_minimum(cache, block_size), block_size, transaction_accounts,
                       transaction_accounts_len);
 }
 
@@ -57,14 +76,15 @@ static Block *get_validated_block(const SolAccountInfo *block_account)
     }
 
     // Block account must have at least enough size to hold zero entries
-    if (block_account->data_len < sizeof(Block)) {
+    if (block_account->data_len < compute_block_size(0, 0)) {
         return 0;
     }
 
     const Block *block = (Block *) block_account->data;
 
-    // Block must be correctly sized for the number of entries it contains
-    if (block_account->data_len != compute_block_size(block->config.total_entry_count)) {
+    // Block must be correctly sized for the number of entries and whitelist slots it contains
+    if (block_account->data_len != compute_block_size(block->config.total_entry_count,
+                                                      block->config.whitelist_slot_count)) {
         return 0;
     }
 
@@ -1,61 +1,80 @@
 #pragma once
 
+#include "inc/program_config.h"
+#include "util/util_rent.c"
 #include "util/util_stake.c"
 
 
-// funding_account is only used to provide transient quantities of SOL for a temporary stake account
+// Computes the commission owed by the entry on the earnings of its stake account since commission was last accrued
+static uint64_t compute_commission_lamports(const Stake *stake, const Entry *entry)
+{
+    // It is the commission as set in the block, times the difference between the current lamports in the stake
+    // account minus the lamports that were in the stake account the last time commission was accrued.
+    return (((stake->stake.delegation.stake - entry->owned.last_commission_charge_stake_account_lamports) *
+             entry->commission) / 0xFFFFul);
+}
+
+
+// Accrues the commission owed by the entry, and then if the total accrued commission is at least
+// [settlement_threshold_lamports], settles it by moving it out of the stake account into the master stake account.
+// A threshold of zero settles any accrued commission.
+// funding_account is only used to provide transient quantities of SOL for a temporary stake account.
+// [cache] supplies the minimum stake delegation and rent exemption; if it is null, then they are fetched if needed.
 static uint64_t charge_commission(const Stake *stake, const Block *block, Entry *entry,
                                   const SolPubkey *funding_account_key, SolAccountInfo *bridge_stake_account,
-                                  const SolPubkey *stake_account_key, const SolAccountInfo *transaction_accounts,
-                                  int transaction_accounts_len)
+                                  const SolPubkey *stake_account_key, const ProgramConfigCache *cache,
+                                  uint64_t settlement_threshold_lamports,
+                                  const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
-    // Compute commission to charge.  It is the commission as set in the block, times the difference between
-    // the current lamports in the stake account minus the lamports that were in the stake account the last
-    // time commission was charged.
-    uint64_t commission_lamports =
-        (((stake->stake.delegation.stake - entry->owned.last_commission_charge_stake_account_lamports) *
-          entry->commission) / 0xFFFFul);
+    // Accrue the commission owed on the stake account earnings since the last accrual.  The accrued commission stays
+    // in the stake account until it is settled.
+    entry->owned.accrued_commission_lamports += compute_commission_lamports(stake, entry);
 
-    // Update the entry's last_commission_charge_stake_account_lamports to the value it will hold after the commission
-    // has been charged.
-    entry->owned.last_commission_charge_stake_account_lamports = (stake->stake.delegation.stake - commission_lamports);
+    entry->owned.last_commission_charge_stake_account_lamports = stake->stake.delegation.stake;
 
     // Update the entry's commission with the current value from the block, so that the next commission collection
     // will use it.  In this way, when a block's commission is changed, it doesn't affect any given entry until that
     // entry has had at least one commission collection.
     entry->commission = block->commission;
 
-    // If there is commission to take, do so
-    if (commission_lamports == 0) {
+    // If there is no commission to settle, or not enough has accrued yet, then the entry update is all that is done
+    uint64_t commission_lamports = entry->owned.accrued_commission_lamports;
+
+    if ((commission_lamports == 0) || (commission_lamports < settlement_threshold_lamports)) {
         return 0;
     }
 
+    // Settle the accrued commission.  Update the entry's last_commission_charge_stake_account_lamports to the value it
+    // will hold after the commission has been moved out of the stake account.
+    entry->owned.last_commission_charge_stake_account_lamports -= commission_lamports;
+
+    entry->owned.accrued_commission_lamports = 0;
+
     // Compute the bridge address
     uint8_t prefix = PDA_Account_Seed_Prefix_Bridge;
 
-    uint8_t bump_seed;
-
     SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
                               { (uint8_t *) &(entry->mint_pubkey), sizeof(entry->mint_pubkey) },
-                              { &bump_seed, sizeof(bump_seed) } };
-
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return ret;
-    }
+                              { &(entry->bridge_bump_seed), sizeof(entry->bridge_bump_seed) } };
 
     // Verify that the bridge address is as expected
-    if (!SolPubkey_same(&pubkey, bridge_stake_account->key)) {
+    if (!is_program_derived_address(bridge_stake_account->key, seeds, ARRAY_LEN(seeds))) {
         return Error_CreateAccountFailed;
     }
 
-    // Get minimum stake delegation to ensure that the bridge account is used if necessary.
-    uint64_t minimum_stake_lamports;
-    ret = get_minimum_stake_delegation(&minimum_stake_lamports);
-    if (ret) {
-        return ret;
+    // Get minimum stake delegation to ensure that the bridge account is used if necessary, and the rent exempt
+    // minimum of the bridge account
+    uint64_t minimum_stake_lamports, rent_exempt_minimum;
+    if (cache) {
+        minimum_stake_lamports = cache->minimum_stake_delegation_lamports;
+        rent_exempt_minimum = compute_rent_exempt_minimum(&(cache->rent_exemption), STAKE_ACCOUNT_DATA_LEN);
+    }
+    else {
+        uint64_t ret = get_minimum_stake_delegation(&minimum_stake_lamports);
+        if (ret) {
+            return ret;
+        }
+        rent_exempt_minimum = get_rent_exempt_minimum(STAKE_ACCOUNT_DATA_LEN);
     }
 
     // If the commission to charge is less than the minimum stake in lamports, then it is necessary to use a more
@@ -64,10 +83,11 @@ static uint64_t charge_commission(const Stake *stake, const Block *block, Entry
     // - Merge bridge_stake_account into stake_account
     // - Set the commission_lamports to (minimum_stake_lamports + commission_lamports) and continue with a normal
     //   commission charge (which will return the bridge lamports as well)
+    // The bridge is kept funded after the first move so that the second move reuses it instead of creating it again.
     if (commission_lamports < minimum_stake_lamports) {
         if (move_stake_signed(&(Constants.master_stake_pubkey), bridge_stake_account, seeds, ARRAY_LEN(seeds),
-                              stake_account_key, minimum_stake_lamports, funding_account_key, transaction_accounts,
-                              transaction_accounts_len)) {
+                              stake_account_key, minimum_stake_lamports, funding_account_key, rent_exempt_minimum,
+                              true, transaction_accounts, transaction_accounts_len)) {
             return Error_FailedToMoveStakeOut;
         }
         commission_lamports += minimum_stake_lamports;
@@ -78,9 +98,71 @@ static uint64_t charge_commission(const Stake *stake, const Block *block, Entry
     // - Merge bridge_stake_account into master_stake_account
     if (move_stake_signed(stake_account_key, bridge_stake_account, seeds, ARRAY_LEN(seeds),
                           &(Constants.master_stake_pubkey), commission_lamports, funding_account_key,
-                          transaction_accounts, transaction_accounts_len)) {
+                          rent_exempt_minimum, false, transaction_accounts, transaction_accounts_len)) {
         return Error_FailedToMoveStake;
     }
 
     return 0;
 }
+
+
+// Delegates the stake account of the staked entry to Shinobi Systems if it is not delegated, or else charges
+// commission on it.  [stake] is the decoded stake account, and [stake_account_index] is the index of the stake
+// account within the instruction's accounts.  See charge_commission() for [cache] and
+// [settlement_threshold_lamports].
+static uint64_t take_commission_or_delegate(Stake *stake, const Block *block, Entry *entry,
+                                            const SolPubkey *funding_account_key, SolAccountInfo *stake_account,
+                                            uint8_t stake_account_index, SolAccountInfo *bridge_stake_account,
+                                            const ProgramConfigCache *cache, uint64_t settlement_threshold_lamports,
+                                            const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
+{
+    PROFILE_SCOPE("take_commission_or_delegate");
+
+    // If the stake account is in an initialized state, then it's not delegated, so delegate it to Shinobi Systems
+    if (stake->state == StakeState_Initialized) {
+        uint64_t ret = delegate_stake_signed(stake_account->key, &(Constants.shinobi_systems_vote_pubkey),
+                                             transaction_accounts, transaction_accounts_len);
+        if (ret) {
+            return ret;
+        }
+
+        // Re-decode the stake account, to get the new delegation information
+        if (!decode_stake_account(stake_account, stake)) {
+            return Error_InvalidAccount_First + stake_account_index;
+        }
+
+        // Record current lamports in the stake account to be used for ki harvesting purposes
+        entry->owned.last_ki_harvest_stake_account_lamports = stake->stake.delegation.stake;
+
+        // Record current lamports in the stake account to be used for commission purposes
+        entry->owned.last_commission_charge_stake_account_lamports = stake->stake.delegation.stake;
+
+        return 0;
+    }
+    // Else, it's delegated, so try charging commission
+    else {
+        return charge_commission(stake, block, entry, funding_account_key, bridge_stake_account, stake_account->key,
+                                 cache, settlement_threshold_lamports, transaction_accounts,
+                                 transaction_accounts_len);
+    }
+}
+
+
+// Returns the estimated compute units that take_commission_or_delegate() will use for the entry, given its decoded
+// stake account and the commission settlement threshold
+static uint32_t estimate_take_commission_or_delegate_units(const Stake *stake, const Entry *entry,
+                                                           uint64_t settlement_threshold_lamports)
+{
+    if (stake->state == StakeState_Initialized) {
+        return TAKE_COMMISSION_CHECK_UNITS + TAKE_COMMISSION_DELEGATE_UNITS;
+    }
+
+    uint64_t commission_lamports = entry->owned.accrued_commission_lamports + compute_commission_lamports(stake, entry);
+
+    if ((commission_lamports == 0) || (commission_lamports < settlement_threshold_lamports)) {
+        return TAKE_COMMISSION_CHECK_UNITS;
+    }
+    else {
+        return TAKE_COMMISSION_CHECK_UNITS + TAKE_COMMISSION_CHARGE_UNITS;
+    }
+}
@@ -2,107 +2,91 @@
 
 #include "inc/bid.h"
 #include "inc/clock.h"
+#include "inc/profile.h"
 #include "inc/types.h"
 #include "util_accounts.c"
 #include "util_block.c"
+#include "util_merkle.c"
+#include "util_metaplex.c"
 #include "util_token.c"
 
 
 // Returns an error if [mint_account] is not the correct account
 static uint64_t create_entry_mint_account(SolAccountInfo *mint_account, const SolPubkey *block_key,
-                                          uint16_t entry_index, const SolPubkey *funding_key,
-                                          const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
+                                          uint16_t entry_index, uint8_t bump_seed, const SolPubkey *funding_key,
+                                          const ProgramConfigCache *cache, const SolAccountInfo *transaction_accounts,
+                                          int transaction_accounts_len)
 {
     // Compute the mint address
     uint8_t prefix = PDA_Account_Seed_Prefix_Mint;
 
-    uint8_t bump_seed;
+    SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
+                              { (uint8_t *) block_key, sizeof(*block_key) },
+                              { (uint8_t *) &entry_index, sizeof(entry_index) },
+                              { &bump_seed, sizeof(bump_seed) } };
 
-    const SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
-                                    { (uint8_t *) block_key, sizeof(*block_key) },
-                                    { (uint8_t *) &entry_index, sizeof(entry_index) },
-                                    { &bump_seed, sizeof(bump_seed) } };
-
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return ret;
-    }
-
-    // Verify that the mint address is as expected
-    if (!SolPubkey_same(&pubkey, mint_account->key)) {
+    // Verify that the mint address is as expected, and that its bump seed is the canonical one, so that there can only
+    // ever be one mint for each entry of a block
+    if (!is_program_derived_address(mint_account->key, seeds, ARRAY_LEN(seeds)) ||
+        !is_canonical_bump_seed(seeds, ARRAY_LEN(seeds))) {
         return Error_CreateAccountFailed;
     }
 
     return create_token_mint(mint_account, seeds, ARRAY_LEN(seeds), &(Constants.authority_pubkey), funding_key,
-                             0, transaction_accounts, transaction_accounts_len);
+                             0, cache, transaction_accounts, transaction_accounts_len);
 }
 
 
 // Returns an error if [mint_account] is not the correct account
-static uint64_t create_entry_account(SolAccountInfo *entry_account, const SolPubkey *mint_key,
-                                     const SolPubkey *funding_key, const SolAccountInfo *transaction_accounts,
-                                     int transaction_accounts_len)
+static uint64_t create_entry_account(SolAccountInfo *entry_account, const SolPubkey *mint_key, uint8_t bump_seed,
+                                     const SolPubkey *funding_key, const ProgramConfigCache *cache,
+                                     const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
     // Compute the entry address
     uint8_t prefix = PDA_Account_Seed_Prefix_Entry;
 
-    uint8_t bump_seed;
-
-    const SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
-                                    { (uint8_t *) mint_key, sizeof(*mint_key) },
-                                    { &bump_seed, sizeof(bump_seed) } };
-
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return ret;
-    }
+    SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
+                              { (uint8_t *) mint_key, sizeof(*mint_key) },
+                              { &bump_seed, sizeof(bump_seed) } };
 
-    // Verify that the entry address is as expected
-    if (!SolPubkey_same(&pubkey, entry_account->key)) {
+    // Verify that the entry address is as expected, and that its bump seed is the canonical one, so that there can
+    // only ever be one entry account for each mint
+    if (!is_program_derived_address(entry_account->key, seeds, ARRAY_LEN(seeds)) ||
+        !is_canonical_bump_seed(seeds, ARRAY_LEN(seeds))) {
         return Error_CreateAccountFailed;
     }
 
     return create_pda(entry_account, seeds, ARRAY_LEN(seeds), funding_key, &(Constants.self_program_pubkey),
-                      get_rent_exempt_minimum(sizeof(Entry)), sizeof(Entry), transaction_accounts,
+                      get_cached_rent_exempt_minimum(cache, sizeof(Entry)), sizeof(Entry), transaction_accounts,
                       transaction_accounts_len);
 }
 
 
 static uint64_t create_entry_token_account(SolAccountInfo *token_account, const SolPubkey *mint_key,
-                                           const SolPubkey *funding_key, const SolAccountInfo *transaction_accounts,
-                                           int transaction_accounts_len)
+                                           uint8_t bump_seed, const SolPubkey *funding_key,
+                                           const ProgramConfigCache *cache,
+                                           const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
     // Compute the entry address
     uint8_t prefix = PDA_Account_Seed_Prefix_Token;
 
-    uint8_t bump_seed;
-
-    const SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
-                                    { (uint8_t *) mint_key, sizeof(*mint_key) },
-                                    { &bump_seed, sizeof(bump_seed) } };
-
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return ret;
-    }
+    SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
+                              { (uint8_t *) mint_key, sizeof(*mint_key) },
+                              { &bump_seed, sizeof(bump_seed) } };
 
-    // Verify that the entry token address is as expected
-    if (!SolPubkey_same(&pubkey, token_account->key)) {
+    // Verify that the entry token address is as expected, and that its bump seed is the canonical one, so that there
+    // can only ever be one entry token account for each mint
+    if (!is_program_derived_address(token_account->key, seeds, ARRAY_LEN(seeds)) ||
+        !is_canonical_bump_seed(seeds, ARRAY_LEN(seeds))) {
         return Error_CreateAccountFailed;
     }
 
     // First create the token account, with owner as SPL-token program
-    uint64_t funding_lamports = get_rent_exempt_minimum(sizeof(SolanaTokenProgramTokenData));
+    uint64_t funding_lamports = get_cached_rent_exempt_minimum(cache, sizeof(SolanaTokenProgramTokenData));
 
-    ret = create_pda(token_account, seeds, ARRAY_LEN(seeds), funding_key, &(Constants.spl_token_program_pubkey),
-                     funding_lamports, sizeof(SolanaTokenProgramTokenData), transaction_accounts,
-                     transaction_accounts_len);
+    uint64_t ret = create_pda(token_account, seeds, ARRAY_LEN(seeds), funding_key,
+                              &(Constants.spl_token_program_pubkey), funding_lamports,
+                              sizeof(SolanaTokenProgramTokenData), transaction_accounts, transaction_accounts_len);
     if (ret) {
         return ret;
     }
@@ -133,12 +117,16 @@ static uint64_t create_entry_token_account(SolAccountInfo *token_account, const
 }
 
 
-static uint64_t create_entry_metaplex_metadata(const SolPubkey *metaplex_metadata_key, const SolPubkey *mint_key,
-                                               const SolPubkey *funding_key, uint32_t group_number,
-                                               uint32_t block_number, uint16_t entry_index, const uint8_t *uri,
-                                               const SolPubkey *creator_1, const SolPubkey *creator_2,
-                                               const SolAccountInfo *transaction_accounts,
-                                               int transaction_accounts_len)
+// Offset within the name of the metadata of an entry of the NNNN entry index digits of its "Shinobi LLL-MMM-NNNN" name
+#define ENTRY_METAPLEX_METADATA_NAME_INDEX_OFFSET 16
+
+
+// Encodes into [data] the CreateMetadataAccountV2 instruction data of the metaplex metadata of the entries of a block
+// whose metadata have [uri] and [creator_2] as their second creator.  Only the entry index digits of the name differ
+// between the metadata of such entries, and they are set by set_entry_metaplex_metadata_index() before each use.
+static void encode_entry_metaplex_metadata_template(MetaplexCreateMetadataData *data, uint32_t group_number,
+                                                    uint32_t block_number, const uint8_t *uri,
+                                                    const SolPubkey *creator_2)
 {
     // The name of the NFT will be "Shinobi LLL-MMM-NNNN" where LLL is the group number, MMM is the block number,
     // and NNNN is the entry index (+1).
@@ -149,11 +137,20 @@ static uint64_t create_entry_metaplex_metadata(const SolPubkey *metaplex_metadat
     name[11] = '-';
     number_string(&(name[12]), block_number, 3);
     name[15] = '-';
-    number_string(&(name[16]), entry_index + 1, 4);
+    number_string(&(name[ENTRY_METAPLEX_METADATA_NAME_INDEX_OFFSET]), 0, 4);
     name[sizeof(name) - 1] = 0;
 
-    return create_metaplex_metadata(metaplex_metadata_key, mint_key, funding_key, name, (uint8_t *) "SHIN", uri,
-                                    creator_1, creator_2, transaction_accounts, transaction_accounts_len);
+    encode_create_metaplex_metadata(data, name, (uint8_t *) "SHIN", uri, &(Constants.shinobi_systems_vote_pubkey),
+                                    creator_2);
+}
+
+
+// Sets the entry index digits of the name in [data], as encoded by encode_entry_metaplex_metadata_template(), to
+// those of [entry_index]
+static void set_entry_metaplex_metadata_index(MetaplexCreateMetadataData *data, uint16_t entry_index)
+{
+    number_string(&(data->bytes[METAPLEX_CREATE_METADATA_NAME_OFFSET + ENTRY_METAPLEX_METADATA_NAME_INDEX_OFFSET]),
+                  entry_index + 1, 4);
 }
 
 
@@ -198,63 +195,131 @@ static Entry *get_validated_entry_of_block(const SolAccountInfo *entry_account,
 // otherwise a generic EntryState_PreReveal is returned.
 static EntryState get_entry_state(const Block *block, const Entry *entry, const Clock *clock)
 {
-    // If the entry has been revealed ...
-    if (is_all_zeroes(&(entry->reveal_sha256), sizeof(entry->reveal_sha256))) {
-        // If the entry has been purchased ...
-        if (entry->purchase_price_lamports) {
-            // It's owned, and possibly staked
-            if (is_all_zeroes(&(entry->owned.stake_account), sizeof(entry->owned.stake_account))) {
-                return EntryState_Owned;
-            }
-            else {
-                return EntryState_OwnedAndStaked;
-            }
+    PROFILE_SCOPE("get_entry_state");
+
+    switch (entry->state) {
+    case EntryState_PreRevealUnowned:
+    case EntryState_PreRevealOwned:
+        // It's pre-reveal; if the block is provided, then the specific pre-reveal states can be determined
+        if (!block) {
+            return EntryState_PreReveal;
         }
-        // Else the entry has not been purchased, but has been revealed.
-        else {
-            // If it is configured to have an auction, then it may still be in auction or post auction
-            if (entry->has_auction) {
-                // If the auction is still ongoing, then it's in auction
-                if ((entry->reveal_timestamp + entry->duration) > clock->unix_timestamp) {
-                    return EntryState_InAuction;
-                }
-                // Else it's no longer in auction, if it was bid on, then it's waiting to be claimed
-                else if (entry->auction.highest_bid_lamports) {
-                    return EntryState_WaitingToBeClaimed;
-                }
-                // Else it's no longer in auction but never bid on, so fall through to return the unowned state
-            }
-            // It's simply unowned
-            return EntryState_Unowned;
-        }
-    }
-    // It's pre-reveal; if the block is provided, then the specific pre-reveal states can be determined
-    else if (block) {
-        // Else if the entry's block has reached its reveal criteria, then it's waiting to be revealed
+        // If the entry's block has reached its reveal criteria, then it's waiting to be revealed
         if (is_complete_block_revealable(block, clock)) {
-            // If it's not revealed, but the block has reached reveal criteria, and the entry has a purchase price,
-            // then it's waiting for reveal and owned
-            if (entry->purchase_price_lamports) {
+            if (entry->state == EntryState_PreRevealOwned) {
                 return EntryState_WaitingForRevealOwned;
             }
-            // Else it's not revealed, but the block has reached reveal criteria, and the entry has a purchase price,
-            // so it's waiting for reveal and unowned
             else {
                 return EntryState_WaitingForRevealUnowned;
             }
         }
-        // Else the entry's block has not yet met its reveal criteria; if the entry has been purchased then it's
-        // pre-reveal owned
-        else if (entry->purchase_price_lamports) {
-            return EntryState_PreRevealOwned;
-        }
-        // Else the entry is not revealed, not purchased, and not yet ready to be revealed
-        else {
-            return EntryState_PreRevealUnowned;
+        // Else the entry's block has not yet met its reveal criteria
+        return (EntryState) entry->state;
+
+    case EntryState_Unowned:
+        // The entry has been revealed but not purchased.  If it is configured to have an auction, then it may still
+        // be in auction or post auction
+        if (entry->has_auction) {
+            // If the auction is still ongoing, then it's in auction
+            if ((entry->reveal_timestamp + entry->duration) > clock->unix_timestamp) {
+                return EntryState_InAuction;
+            }
+            // Else it's no longer in auction, if it was bid on, then it's waiting to be claimed
+            else if (entry->auction.highest_bid_lamports) {
+                return EntryState_WaitingToBeClaimed;
+            }
+            // Else it's no longer in auction but never bid on, so fall through to return the unowned state
         }
+        // It's simply unowned
+        return EntryState_Unowned;
+
+    default:
+        // Owned and OwnedAndStaked do not depend upon time
+        return (EntryState) entry->state;
     }
-    // It's pre-reveal but with no supplied block, the specific pre-reveal state cannot be determined
-    else {
-        return EntryState_PreReveal;
+}
+
+
+// Indexed by stored entry state (see Entry.state), the bit mask of the stored entry states that an entry may move to
+// from that state
+static const uint16_t entry_state_transitions[EntryState_OwnedAndStaked + 1] =
+{
+    // Buy as a mystery, or reveal without having been purchased
+    [EntryState_PreRevealUnowned]  = (1 << EntryState_PreRevealOwned) | (1 << EntryState_Unowned),
+    // Reveal after having been purchased as a mystery
+    [EntryState_PreRevealOwned]    = (1 << EntryState_Owned),
+    // Buy, or claim the winning bid
+    [EntryState_Unowned]           = (1 << EntryState_Owned),
+    // Stake
+    [EntryState_Owned]             = (1 << EntryState_OwnedAndStaked),
+    // Destake, or reauthorize
+    [EntryState_OwnedAndStaked]    = (1 << EntryState_Owned)
+};
+
+
+// Moves [entry] to the stored [state].  Returns false if an entry cannot move to [state] from its current stored
+// state.
+static bool set_entry_state(Entry *entry, EntryState state)
+{
+    if ((entry->state > EntryState_OwnedAndStaked) || !(entry_state_transitions[entry->state] & (1 << state))) {
+        return false;
     }
+
+    entry->state = state;
+
+    return true;
+}
+
+
+static uint64_t compute_level_metadata_proof_size(uint8_t proof_length)
+{
+    const LevelMetadataProof *p = 0;
+
+    return ((uint64_t) &(p->proof[proof_length]));
+}
+
+
+// Verifies that [proof] proves the LevelMetadata of level [level] of [entry] against the entry's
+// level_metadata_merkle_root.  Returns false if it does not; otherwise copies the proven LevelMetadata into
+// [level_metadata] and returns true.  The proof is assumed to have already been checked to fit within the instruction
+// data.
+static bool get_proven_level_metadata(const Entry *entry, uint8_t level, const LevelMetadataProof *proof,
+                                      /* returns */ LevelMetadata *level_metadata)
+{
+    PROFILE_SCOPE("get_proven_level_metadata");
+
+    if ((level > 8) || (proof->proof_length > MAX_LEVEL_METADATA_PROOF_LENGTH)) {
+        return false;
+    }
+
+    // Copy out of the instruction data, which is not necessarily aligned
+    sol_memcpy(level_metadata, &(proof->level_metadata), sizeof(*level_metadata));
+
+    // The leaf is the SHA-256 of the leaf prefix, the level, and the level metadata
+    uint8_t prefix = MERKLE_LEAF_PREFIX;
+
+    SolBytes bytes[] = { { &prefix, sizeof(prefix) },
+                         { &level, sizeof(level) },
+                         { (uint8_t *) level_metadata, sizeof(*level_metadata) } };
+
+    sha256_t leaf;
+    if (sol_sha256(bytes, ARRAY_LEN(bytes), (uint8_t *) &leaf)) {
+        return false;
+    }
+
+    sha256_t root;
+    if (!compute_merkle_range_root(&leaf, level, 1, 9, proof->proof, proof->proof_length, &root)) {
+        return false;
+    }
+
+    return !sol_memcmp(&root, &(entry->metadata.level_metadata_merkle_root), sizeof(root));
+}
+
+
+// Sets the values of the current level of [entry] from the LevelMetadata of that level
+static void set_entry_current_level(Entry *entry, const LevelMetadata *level_metadata)
+{
+    entry->current_level.form = level_metadata->form;
+    entry->current_level.skill = level_metadata->skill;
+    entry->current_level.ki_factor = level_metadata->ki_factor;
 }
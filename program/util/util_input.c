@@ -0,0 +1,192 @@
+#pragma once
+
+#include "inc/profile.h"
+
+
+// Parsing of the program input.  The runtime serializes every account of the instruction into the input buffer, in
+// this form:
+//
+//   u8 duplicate marker (0xFF if this is the first occurrence of the account, otherwise the index of the first
+//      occurrence, followed by 7 bytes of padding and nothing else)
+//   u8 is_signer
+//   u8 is_writable
+//   u8 executable
+//   4 bytes padding
+//   32 bytes key
+//   32 bytes owner
+//   u64 lamports
+//   u64 data_len
+//   data_len bytes of data, followed by MAX_PERMITTED_DATA_INCREASE bytes reserved for growth, padded to 8 bytes
+//   u64 rent_epoch
+//
+// Rather than decoding all of that up front, deserialize_input() only walks the accounts to find the instruction
+// data, recording the key of each account as it goes.  The remaining fields of an account are decoded from the
+// serialized input when the account is first requested by get_instruction_account(), which DECLARE_ACCOUNT does for
+// the accounts that an instruction handler uses.
+//
+// Because every account's key is recorded, params->ka can be passed as the account infos of a cross-program
+// invocation, as long as every account that the invoked instruction references has been requested first.  The
+// runtime only decodes the fields of the account infos that the invoked instruction references.
+
+// Maximum number of accounts that may be passed to any instruction.  This is the runtime's limit on the number of
+// accounts that a transaction may lock, which transactions that use address lookup tables can reach.
+#define MAX_INSTRUCTION_ACCOUNTS 64
+
+
+// The account infos are kept on the heap, because they are too large to fit in the stack frame of the entrypoint
+typedef struct
+{
+    // The account infos of the accounts.  The lamports member of an account that has not been requested yet is null.
+    SolAccountInfo accounts[MAX_INSTRUCTION_ACCOUNTS];
+
+    // The index of the first occurrence of each account in the accounts passed to the instruction
+    uint8_t first_occurrence[MAX_INSTRUCTION_ACCOUNTS];
+
+    // For the first occurrence of each account, the known account (a KnownAccount value) that its key has already been
+    // checked to be, or 0 (KnownAccount_NotKnown) if it has not been checked to be any known account
+    uint8_t checked_known_account[MAX_INSTRUCTION_ACCOUNTS];
+
+} InputAccounts;
+
+
+// Walks the serialized input, filling in params.  Returns false if the input has too many accounts.
+static bool deserialize_input(const uint8_t *input, SolParameters *params)
+{
+    PROFILE_SCOPE("deserialize_input");
+
+    InputAccounts *input_accounts = (InputAccounts *) HEAP_START_ADDRESS;
+
+    params->ka = input_accounts->accounts;
+
+    params->ka_num = *(uint64_t *) input;
+    input += sizeof(uint64_t);
+
+    if (params->ka_num > MAX_INSTRUCTION_ACCOUNTS) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < params->ka_num; i++) {
+        SolAccountInfo *account = &(params->ka[i]);
+
+        uint8_t dup_info = input[0];
+
+        // Skip the duplicate marker, the flags, and the padding
+        input += sizeof(uint64_t);
+
+        if (dup_info == UINT8_MAX) {
+            input_accounts->first_occurrence[i] = i;
+
+            account->key = (SolPubkey *) input;
+
+            // Skip the key, owner, and lamports to get to the data length, and then skip the data and the space
+            // reserved for its growth, and then the rent epoch
+            input += sizeof(SolPubkey) + sizeof(SolPubkey) + sizeof(uint64_t);
+            uint64_t data_len = *(uint64_t *) input;
+            input += sizeof(uint64_t) + data_len + MAX_PERMITTED_DATA_INCREASE;
+            input = (uint8_t *) (((uint64_t) input + 8 - 1) & ~(8 - 1));
+            input += sizeof(uint64_t);
+        }
+        // A duplicate can only refer to an earlier account
+        else if (dup_info < i) {
+            input_accounts->first_occurrence[i] = dup_info;
+
+            account->key = params->ka[dup_info].key;
+        }
+        else {
+            return false;
+        }
+
+        // Not requested yet
+        account->lamports = 0;
+
+        input_accounts->checked_known_account[i] = 0;
+    }
+
+    params->data_len = *(uint64_t *) input;
+    input += sizeof(uint64_t);
+
+    params->data = input;
+    input += params->data_len;
+
+    params->program_id = (SolPubkey *) input;
+
+    return true;
+}
+
+
+// Returns the account info of the account at index in the accounts passed to the instruction, decoding it from the
+// serialized input if it has not been requested before.  index must be less than params->ka_num.
+static SolAccountInfo *get_instruction_account(const SolParameters *params, uint8_t index)
+{
+    SolAccountInfo *account = &(params->ka[index]);
+
+    if (account->lamports) {
+        return account;
+    }
+
+    // A duplicate account is a copy of the first occurrence of the account, which is decoded first.  This also
+    // ensures that the account info that a cross-program invocation finds for the account, which is the first one
+    // with its key, has been decoded.
+    uint8_t first_occurrence = ((InputAccounts *) params->ka)->first_occurrence[index];
+
+    SolAccountInfo *first_account = &(params->ka[first_occurrence]);
+
+    if (!first_account->lamports) {
+        // The serialized account begins with the duplicate marker and flags, which precede the key
+        const uint8_t *input = ((const uint8_t *) first_account->key) - sizeof(uint64_t);
+
+        first_account->is_signer = input[1] != 0;
+        first_account->is_writable = input[2] != 0;
+        first_account->executable = input[3] != 0;
+        input += sizeof(uint64_t) + sizeof(SolPubkey);
+
+        first_account->owner = (SolPubkey *) input;
+        input += sizeof(SolPubkey);
+
+        first_account->lamports = (uint64_t *) input;
+        input += sizeof(uint64_t);
+
+        first_account->data_len = *(uint64_t *) input;
+        input += sizeof(uint64_t);
+
+        first_account->data = (uint8_t *) input;
+        input += first_account->data_len + MAX_PERMITTED_DATA_INCREASE;
+        input = (uint8_t *) (((uint64_t) input + 8 - 1) & ~(8 - 1));
+
+        first_account->rent_epoch = *(uint64_t *) input;
+    }
+
+    if (first_occurrence != index) {
+        *account = *first_account;
+    }
+
+    return account;
+}
+
+
+// Returns the account infos of count consecutive accounts starting at index in the accounts passed to the
+// instruction, decoding any that have not been requested before.  index + count must be at most params->ka_num.
+static SolAccountInfo *get_instruction_accounts(const SolParameters *params, uint8_t index, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        (void) get_instruction_account(params, index + i);
+    }
+
+    return &(params->ka[index]);
+}
+
+
+// Returns the location that records which known account [account] has already been checked to be, which is shared by
+// all occurrences of the account, or null if [account] is not one of the account infos of the instruction
+static uint8_t *get_checked_known_account(const SolAccountInfo *account)
+{
+    InputAccounts *input_accounts = (InputAccounts *) HEAP_START_ADDRESS;
+
+    if ((account < input_accounts->accounts) || (account >= &(input_accounts->accounts[MAX_INSTRUCTION_ACCOUNTS]))) {
+        return 0;
+    }
+
+    uint8_t index = account - input_accounts->accounts;
+
+    return &(input_accounts->checked_known_account[input_accounts->first_occurrence[index]]);
+}
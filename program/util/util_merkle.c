@@ -0,0 +1,105 @@
+#pragma once
+
+#include "inc/merkle.h"
+#include "inc/profile.h"
+#include "inc/types.h"
+
+
+// Computes the interior node of a Merkle tree that has the two given children, into [result], which may be the same
+// as either child.  Returns false on failure.
+static bool merkle_hash_pair(const sha256_t *child1, const sha256_t *child2, sha256_t *result)
+{
+    uint8_t prefix = MERKLE_NODE_PREFIX;
+
+    bool is_less = (sol_memcmp(child1, child2, sizeof(sha256_t)) < 0);
+
+    SolBytes node[] = { { &prefix, sizeof(prefix) },
+                        { (uint8_t *) (is_less ? child1 : child2), sizeof(sha256_t) },
+                        { (uint8_t *) (is_less ? child2 : child1), sizeof(sha256_t) } };
+
+    sha256_t parent;
+    if (sol_sha256(node, ARRAY_LEN(node), (uint8_t *) &parent)) {
+        return false;
+    }
+
+    *result = parent;
+
+    return true;
+}
+
+
+// Computes the root of a Merkle tree with [leaf_count] leaves (see inc/merkle.h) from the [range_count] consecutive
+// leaves starting with leaf [first_leaf], given in [nodes], and the proof of that range.  The nodes are overwritten
+// in the process.  Returns false if the proof is not exactly the proof of that range, or if a hash could not be
+// computed; otherwise stores the root in [root] and returns true.
+static bool compute_merkle_range_root(sha256_t *nodes, uint16_t first_leaf, uint16_t range_count, uint16_t leaf_count,
+                                      const sha256_t *proof, uint8_t proof_length, sha256_t *root)
+{
+    PROFILE_SCOPE("compute_merkle_range_root");
+
+    if ((range_count == 0) || (((uint32_t) first_leaf + range_count) > leaf_count)) {
+        return false;
+    }
+
+    // The range of the current level is [first, last], out of [count] nodes in the level
+    uint32_t first = first_leaf;
+    uint32_t last = first + range_count - 1;
+    uint32_t count = leaf_count;
+
+    uint8_t proof_index = 0;
+
+    while (count > 1) {
+        // Take the siblings of the ends of the range from the proof, where they are outside of the range
+        const sha256_t *left = 0, *right = 0;
+
+        if (first & 1) {
+            if (proof_index == proof_length) {
+                return false;
+            }
+            left = &(proof[proof_index++]);
+        }
+
+        if (!(last & 1) && ((last + 1) < count)) {
+            if (proof_index == proof_length) {
+                return false;
+            }
+            right = &(proof[proof_index++]);
+        }
+
+        // Compute the parents of the range.  Each parent is written at or before the position of its first child in
+        // nodes, so no child is overwritten before it is used.
+        uint32_t parent_first = first / 2;
+        uint32_t parent_last = last / 2;
+
+        for (uint32_t parent = parent_first; parent <= parent_last; parent++) {
+            uint32_t child = parent * 2;
+
+            const sha256_t *child1 = (child < first) ? left : &(nodes[child - first]);
+
+            if ((child + 1) == count) {
+                // No sibling, so it is carried up unchanged
+                nodes[parent - parent_first] = *child1;
+                continue;
+            }
+
+            const sha256_t *child2 = ((child + 1) > last) ? right : &(nodes[(child + 1) - first]);
+
+            if (!merkle_hash_pair(child1, child2, &(nodes[parent - parent_first]))) {
+                return false;
+            }
+        }
+
+        first = parent_first;
+        last = parent_last;
+        count = (count + 1) / 2;
+    }
+
+    // The whole proof must have been used
+    if (proof_index != proof_length) {
+        return false;
+    }
+
+    *root = nodes[0];
+
+    return true;
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "inc/block.h"
 #include "inc/constants.h"
 #include "inc/entry.h"
+#include "inc/profile.h"
 #include "util/util_borsh.c"
 
 
@@ -95,6 +97,22 @@ typedef struct __attribute__((__packed__))
 // Use the maximum size possible
 #define METAPLEX_METADATA_DATA_SIZE sizeof(MetaplexMetadataThreeCreators)
 
+// The instruction data of a CreateMetadataAccountV2 instruction, which is encoded once by
+// encode_create_metaplex_metadata() and may then be used to create any number of metadata accounts that differ only in
+// bytes that are patched in between uses
+typedef struct
+{
+    uint8_t bytes[BORSH_SIZE_U8 /* instruction code */ +
+                  METAPLEX_METADATA_DATA_SIZE /* data */ +
+                  BORSH_SIZE_BOOL /* is_mutable */];
+
+    uint32_t len;
+
+} MetaplexCreateMetadataData;
+
+// Offset within MetaplexCreateMetadataData bytes of the name of the metadata
+#define METAPLEX_CREATE_METADATA_NAME_OFFSET (BORSH_SIZE_U8 /* instruction code */ + BORSH_SIZE_U32 /* name_len */)
+
 
 static void number_string(uint8_t *buf, uint32_t number, uint8_t digits)
 {
@@ -107,6 +125,50 @@ static void number_string(uint8_t *buf, uint32_t number, uint8_t digits)
 }
 
 
+// Returns the number of characters in the zero padded string [str], which is at most [max_len] characters long and
+// has no terminating zero if it is exactly [max_len] characters long
+static uint32_t padded_string_length(const uint8_t *str, uint32_t max_len)
+{
+    uint32_t len = 0;
+
+    while ((len < max_len) && str[len]) {
+        len++;
+    }
+
+    return len;
+}
+
+
+// Assembles the Metadata URL of the given level of the entry from the block's URI prefix and the level's URI suffix
+// into [uri], which must have at least MAX_URI_PREFIX_LENGTH + URI_SUFFIX_LENGTH + 1 bytes in it.  Returns false if
+// the level's URI prefix index is not valid.
+static bool assemble_level_uri(const Block *block, const LevelMetadata *level_metadata, uint8_t *uri)
+{
+    if (level_metadata->uri_prefix_index >= MAX_BLOCK_URI_PREFIXES) {
+        return false;
+    }
+
+    const uint8_t *prefix = block->uri_prefixes[level_metadata->uri_prefix_index];
+
+    uint32_t prefix_len = padded_string_length(prefix, MAX_URI_PREFIX_LENGTH);
+    uint32_t suffix_len = padded_string_length(level_metadata->uri_suffix, URI_SUFFIX_LENGTH);
+
+    sol_memcpy(uri, prefix, prefix_len);
+    sol_memcpy(&(uri[prefix_len]), level_metadata->uri_suffix, suffix_len);
+    uri[prefix_len + suffix_len] = 0;
+
+    return true;
+}
+
+
+// Copies the string [src], which is zero terminated or at most [max_len] characters long, into [dst], which must
+// already be zeroed
+static void copy_metadata_string(uint8_t *dst, const uint8_t *src, uint32_t max_len)
+{
+    sol_memcpy(dst, src, padded_string_length(src, max_len));
+}
+
+
 // [data] must have at least METAPLEX_METADATA_DATA_SIZE bytes in it.  Returns the pointer to the byte immediately
 // after the end of data
 static uint8_t *encode_metaplex_metadata(uint8_t *data, const uint8_t *name, const uint8_t *symbol, const uint8_t *uri,
@@ -120,104 +182,83 @@ static uint8_t *encode_metaplex_metadata(uint8_t *data, const uint8_t *name, con
         creator_2 = tmp;
     }
 
+    uint32_t size;
     if (is_empty_pubkey(creator_1)) {
-        MetaplexMetadataOneCreator *metadata = (MetaplexMetadataOneCreator *) data;
-        sol_memset(metadata, 0, sizeof(*metadata));
-        metadata->name_len = 32;
-        uint32_t len = sol_strlen((const char *) name);
-        if (len > metadata->name_len) {
-            len = metadata->name_len;
-        }
-        sol_memcpy(metadata->name, name, len);
-        metadata->symbol_len = 10;
-        len = sol_strlen((const char *) symbol);
-        if (len > metadata->symbol_len) {
-            len = metadata->symbol_len;
-        }
-        sol_memcpy(metadata->symbol, symbol, len);
-        metadata->uri_len = 200;
-        len = sol_strlen((const char *) uri);
-        if (len > metadata->uri_len) {
-            len = metadata->uri_len;
-        }
-        sol_memcpy(metadata->uri, uri, len);
-        metadata->has_creators = true;
+        size = sizeof(MetaplexMetadataOneCreator);
+    }
+    else if (is_empty_pubkey(creator_2)) {
+        size = sizeof(MetaplexMetadataTwoCreators);
+    }
+    else {
+        size = sizeof(MetaplexMetadataThreeCreators);
+    }
+
+    sol_memset(data, 0, size);
+
+    // All three forms are identical up to the creators, so the values before the creators are set via any of them
+    MetaplexMetadataOneCreator *metadata = (MetaplexMetadataOneCreator *) data;
+    metadata->name_len = sizeof(metadata->name);
+    copy_metadata_string(metadata->name, name, sizeof(metadata->name));
+    metadata->symbol_len = sizeof(metadata->symbol);
+    copy_metadata_string(metadata->symbol, symbol, sizeof(metadata->symbol));
+    metadata->uri_len = sizeof(metadata->uri);
+    copy_metadata_string(metadata->uri, uri, sizeof(metadata->uri));
+    metadata->has_creators = true;
+
+    if (size == sizeof(MetaplexMetadataOneCreator)) {
         metadata->creator_count = 1;
         metadata->creator_1_pubkey = *authority_key;
         metadata->creator_1_share = 100;
-        return &(data[sizeof(*metadata)]);
     }
-    else if (is_empty_pubkey(creator_2)) {
-        MetaplexMetadataTwoCreators *metadata = (MetaplexMetadataTwoCreators *) data;
-        sol_memset(metadata, 0, sizeof(*metadata));
-        metadata->name_len = 32;
-        uint32_t len = sol_strlen((const char *) name);
-        if (len > metadata->name_len) {
-            len = metadata->name_len;
-        }
-        sol_memcpy(metadata->name, name, len);
-        metadata->symbol_len = 10;
-        len = sol_strlen((const char *) symbol);
-        if (len > metadata->symbol_len) {
-            len = metadata->symbol_len;
-        }
-        sol_memcpy(metadata->symbol, symbol, len);
-        metadata->uri_len = 200;
-        len = sol_strlen((const char *) uri);
-        if (len > metadata->uri_len) {
-            len = metadata->uri_len;
-        }
-        sol_memcpy(metadata->uri, uri, len);
-        metadata->has_creators = true;
-        metadata->creator_count = 2;
-        metadata->creator_1_pubkey = *creator_1;
-        metadata->creator_1_share = 100;
-        metadata->creator_2_pubkey = *authority_key;
-        return &(data[sizeof(*metadata)]);
+    else if (size == sizeof(MetaplexMetadataTwoCreators)) {
+        MetaplexMetadataTwoCreators *two = (MetaplexMetadataTwoCreators *) data;
+        two->creator_count = 2;
+        two->creator_1_pubkey = *creator_1;
+        two->creator_1_share = 100;
+        two->creator_2_pubkey = *authority_key;
     }
     else {
-        MetaplexMetadataThreeCreators *metadata = (MetaplexMetadataThreeCreators *) data;
-        sol_memset(metadata, 0, sizeof(*metadata));
-        metadata->name_len = 32;
-        uint32_t len = sol_strlen((const char *) name);
-        if (len > metadata->name_len) {
-            len = metadata->name_len;
-        }
-        sol_memcpy(metadata->name, name, len);
-        metadata->symbol_len = 10;
-        len = sol_strlen((const char *) symbol);
-        if (len > metadata->symbol_len) {
-            len = metadata->symbol_len;
-        }
-        sol_memcpy(metadata->symbol, symbol, len);
-        metadata->uri_len = 200;
-        len = sol_strlen((const char *) uri);
-        if (len > metadata->uri_len) {
-            len = metadata->uri_len;
-        }
-        sol_memcpy(metadata->uri, uri, len);
-        metadata->has_creators = true;
-        metadata->creator_count = 3;
-        metadata->creator_1_pubkey = *creator_1;
-        metadata->creator_1_share = 50;
-        metadata->creator_2_pubkey = *creator_2;
-        metadata->creator_2_share = 50;
-        metadata->creator_3_pubkey = *authority_key;
-        return &(data[sizeof(*metadata)]);
+        MetaplexMetadataThreeCreators *three = (MetaplexMetadataThreeCreators *) data;
+        three->creator_count = 3;
+        three->creator_1_pubkey = *creator_1;
+        three->creator_1_share = 50;
+        three->creator_2_pubkey = *creator_2;
+        three->creator_2_share = 50;
+        three->creator_3_pubkey = *authority_key;
     }
+
+    return &(data[size]);
+}
+
+
+// Encodes the CreateMetadataAccountV2 instruction data for metadata with the given values into [data].  The creators
+// are as for encode_metaplex_metadata(), with the program authority as the final creator.
+static void encode_create_metaplex_metadata(MetaplexCreateMetadataData *data, const uint8_t *name,
+                                            const uint8_t *symbol, const uint8_t *uri, const SolPubkey *creator_1,
+                                            const SolPubkey *creator_2)
+{
+    PROFILE_SCOPE("encode_create_metaplex_metadata");
+
+    // Encoding the data for metaplex requires using Borsch serialize format, eugh.
+    uint8_t *d = borsh_encode_u8(data->bytes, 16); // instruction code 16 = CreateMetadataAccountV2
+    d = encode_metaplex_metadata(d, name, symbol, uri, creator_1, creator_2, &(Constants.authority_pubkey));
+    d = borsh_encode_bool(d, true); // is_mutable
+
+    data->len = ((uint64_t) d) - ((uint64_t) data->bytes);
 }
 
 
 // Ensures that the metadata is being created at the correct address, returns an error if not.  Signs the
-// metadata with the authority key.
+// metadata with the authority key.  [data] is the instruction data as encoded by encode_create_metaplex_metadata().
 static uint64_t create_metaplex_metadata(const SolPubkey *metaplex_metadata_key, const SolPubkey *mint_key,
-                                         const SolPubkey *funding_key, const uint8_t *name, const uint8_t *symbol,
-                                         const uint8_t *uri, const SolPubkey *creator_1, const SolPubkey *creator_2,
+                                         const SolPubkey *funding_key, const MetaplexCreateMetadataData *data,
                                          // All cross-program invocation must pass all account infos through, it's
                                          // the only sane way to cross-program invoke
                                          const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 
 {
+    PROFILE_SCOPE("create_metaplex_metadata");
+
     // It is not necessary to verify that the metaplex_metadata_key is the correct account for the given mint,
     // because the Metaplex Metata program already does this
 
@@ -250,16 +291,8 @@ static uint64_t create_metaplex_metadata(const SolPubkey *metaplex_metadata_key,
         instruction.accounts = account_metas;
         instruction.account_len = ARRAY_LEN(account_metas);
 
-        // Encoding the data for metaplex requires using Borsch serialize format, eugh.
-        uint8_t data[BORSH_SIZE_U8 /* instruction code */ +
-                     METAPLEX_METADATA_DATA_SIZE /* data */ +
-                     BORSH_SIZE_BOOL /* is_mutable */];
-        uint8_t *d = borsh_encode_u8(data, 16); // instruction code 16 = CreateMetadataAccountV2
-        d = encode_metaplex_metadata(d, name, symbol, uri, creator_1, creator_2, &(Constants.authority_pubkey));
-        d = borsh_encode_bool(d, true); // is_mutable
-
-        instruction.data = data;
-        instruction.data_len = ((uint64_t) d) - ((uint64_t) instruction.data);
+        instruction.data = (uint8_t *) data->bytes;
+        instruction.data_len = data->len;
 
         uint64_t ret = sol_invoke_signed(&instruction, transaction_accounts, transaction_accounts_len,
                                          &signer_seeds, 1);
@@ -293,6 +326,8 @@ static uint64_t set_metaplex_metadata_authority(const SolPubkey *metaplex_metada
                                                 const SolAccountInfo *transaction_accounts,
                                                 int transaction_accounts_len)
 {
+    PROFILE_SCOPE("set_metaplex_metadata_authority");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.metaplex_program_pubkey);
@@ -338,6 +373,8 @@ static uint64_t set_metaplex_metadata_primary_sale_happened(const Entry *entry,
                                                             const SolAccountInfo *transaction_accounts,
                                                             int transaction_accounts_len)
 {
+    PROFILE_SCOPE("set_metaplex_metadata_primary_sale_happened");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.metaplex_program_pubkey);
@@ -373,129 +410,25 @@ static uint64_t set_metaplex_metadata_primary_sale_happened(const Entry *entry,
 }
 
 
-// Set the metaplex metadata for the entry to that of the given level
-static uint64_t set_metaplex_metadata_for_level(const Entry *entry, uint8_t level,
-                                                const SolAccountInfo *metaplex_metadata_account,
+// Set the metaplex metadata for the entry, which is of [block], to that of the given level metadata, which must
+// already have been proven to be that of the entry's level
+static uint64_t set_metaplex_metadata_for_level(const Block *block, const Entry *entry,
+                                                const LevelMetadata *level_metadata,
                                                 // All cross-program invocation must pass all account infos through,
                                                 // it's the only sane way to cross-program invoke
                                                 const SolAccountInfo *transaction_accounts,
                                                 int transaction_accounts_len)
 {
-    // The values to update are name and uri.  Symbol is always "SHIN".  seller_fee_basis_points is always 0,
-    // and collection and uses are always empty.  What must be read from the existing metadata is the
-    // creators array so that it can be re-used in the new metadata.
+    PROFILE_SCOPE("set_metaplex_metadata_for_level");
 
-    // Decode the metadata
-    uint8_t name[200 + 1];
-    uint8_t symbol[10 + 1];
-    uint8_t uri[200 + 1];
-
-    uint32_t creator_count;
-    SolPubkey creator_keys[3];
-
-    {
-        const uint8_t *data = metaplex_metadata_account->data;
-        uint32_t data_len = (uint32_t) metaplex_metadata_account->data_len;
-
-        // Skip these:
-        // pub key: Key,  -- 1 byte
-        // pub update_authority: Pubkey, -- 32 bytes
-        // pub mint: Pubkey, -- 32 bytes
-        if (data_len < (1 + 32 + 32)) {
-            return Error_InvalidMetadataValues;
-        }
-        data = &(data[1 + 32 + 32]);
-        data_len -= (1 + 32 + 32);
-
-        // Decode name, string of at most 200 characters
-        uint32_t ret = borsh_decode_string(data, data_len, sizeof(name) - 1, name);
-        if (!ret) {
-            return Error_InvalidMetadataValues;
-        }
-        data += ret, data_len -= ret;
-
-        // Decode symbol, string of at most 4 characters
-        ret = borsh_decode_string(data, data_len, sizeof(symbol) - 1, symbol);
-        if (!ret) {
-            return Error_InvalidMetadataValues;
-        }
-        data += ret, data_len -= ret;
-
-        // Decode uri, string of at most 200 characters
-        ret = borsh_decode_string(data, data_len, sizeof(uri) - 1, uri);
-        if (!ret) {
-            return Error_InvalidMetadataValues;
-        }
-        data += ret, data_len -= ret;
-
-        // Decode seller_fee_basis_points, which is ignored
-        {
-            uint16_t seller_fee_basis_points;
-            ret = borsh_decode_u16(data, data_len, &seller_fee_basis_points);
-            if (!ret) {
-                return Error_InvalidMetadataValues;
-            }
-            data += ret, data_len -= ret;
-        }
-
-        // Read creators, which may be None or Some(vector of creator)
-        bool option;
-        ret = borsh_decode_option(data, data_len, &option);
-        if (!ret) {
-            return Error_InvalidMetadataValues;
-        }
-        data += ret, data_len -= ret;
-
-        if (option) {
-            // Read number of elements in vector
-            ret = borsh_decode_vec_count(data, data_len, &creator_count);
-            if (!ret) {
-                return Error_InvalidMetadataValues;
-            }
-            data += ret, data_len -= ret;
-            // Must be 2 or 3 creators
-            if ((creator_count < 2) || (creator_count > 3)) {
-                return Error_InvalidMetadataValues;
-            }
-
-            // Read each creator
-            for (uint32_t i = 0; i < creator_count; i++) {
-                // Decode creator pubkey
-                ret = borsh_decode_pubkey(data, data_len, &(creator_keys[i]));
-                if (!ret) {
-                    return Error_InvalidMetadataValues;
-                }
-                data += ret, data_len -= ret;
-                // Decode verified status of creator, which is ignored
-                bool verified;
-                ret = borsh_decode_bool(data, data_len, &verified);
-                if (!ret) {
-                    return Error_InvalidMetadataValues;
-                }
-                data += ret, data_len -= ret;
-                // Decode creator share, which is ignored
-                uint8_t share;
-                ret = borsh_decode_u8(data, data_len, &share);
-                if (!ret) {
-                    return Error_InvalidMetadataValues;
-                }
-                data += ret, data_len -= ret;
-            }
-        }
-        else {
-            creator_count = 0;
-        }
-    }
-
-    const LevelMetadata *level_metadata = &(entry->metadata.level_metadata[level]);
-
-    // creator_1 is always the first creator
-    SolPubkey *creator_1 = &(creator_keys[0]);
-    SolPubkey *creator_2 = &(creator_keys[1]);
+    // The values to update are name and uri.  Symbol is always "SHIN".  seller_fee_basis_points is always 0,
+    // and collection and uses are always empty.  The creators are the same as when the metadata was created, which
+    // the entry records, so the existing metadata need not be read.
 
-    if (creator_count == 2) {
-        // creator_2 is an empty pubkey if there are only 2 creators
-        sol_memset(&(creator_keys[1]), 0, sizeof(creator_keys[1]));
+    // Reassemble the full uri of the level from the block's prefix and the level's suffix
+    uint8_t level_uri[MAX_URI_PREFIX_LENGTH + URI_SUFFIX_LENGTH + 1];
+    if (!assemble_level_uri(block, level_metadata, level_uri)) {
+        return Error_InvalidMetadataValues;
     }
 
     // UpdateMetadataAccountV2
@@ -528,8 +461,9 @@ static uint64_t set_metaplex_metadata_for_level(const Entry *entry, uint8_t leve
 
         uint8_t *d = borsh_encode_u8(data, 15); // instruction code 15 = UpdateMetadataAccountV2
         d = borsh_encode_option_some(d);
-        d = encode_metaplex_metadata(d, level_metadata->name, (uint8_t *) "SHIN", level_metadata->uri, creator_1,
-                                     creator_2, &(Constants.authority_pubkey));
+        d = encode_metaplex_metadata(d, level_metadata->name, (uint8_t *) "SHIN", level_uri,
+                                     &(Constants.shinobi_systems_vote_pubkey),
+                                     &(entry->second_metaplex_metadata_creator), &(Constants.authority_pubkey));
         d = borsh_encode_option_none(d); // update_authority
         d = borsh_encode_option_none(d); // primary_sale_happened
         d = borsh_encode_option_none(d); // is_mutable
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "inc/clock.h"
+#include "inc/program_config.h"
+#include "util/util_accounts.c"
+#include "util/util_rent.c"
+#include "util/util_stake.c"
+
+
+// Returns the program config, or null if [config_account] is not the program config account
+static ProgramConfig *get_validated_program_config(const SolAccountInfo *config_account)
+{
+    if (!check_known_account(config_account, KnownAccount_ProgramConfig)) {
+        return 0;
+    }
+
+    // The data must be correctly sized
+    if (config_account->data_len != sizeof(ProgramConfig)) {
+        return 0;
+    }
+
+    ProgramConfig *config = (ProgramConfig *) (config_account->data);
+
+    // If the config does not have the correct data type, then this is an error
+    if (config->data_type != DataType_ProgramConfig) {
+        return 0;
+    }
+
+    return config;
+}
+
+
+// Fetches all of the values of [cache] as of [epoch].  Returns 0 on success, nonzero on error.
+static uint64_t refresh_program_config_cache(ProgramConfigCache *cache, uint64_t epoch)
+{
+    PROFILE_SCOPE("refresh_program_config_cache");
+
+    uint64_t ret = get_minimum_stake_delegation(&(cache->minimum_stake_delegation_lamports));
+    if (ret) {
+        return ret;
+    }
+
+    get_rent_exemption(&(cache->rent_exemption));
+
+    cache->epoch = epoch;
+
+    return 0;
+}
+
+
+// Sets [*cache] to the cached values of the program config in [config_account], which is at [config_account_index]
+// within the instruction's accounts, first refreshing them if they were not fetched in the current epoch.  Refreshed
+// values are stored back into the program config only if [config_account] is writable; otherwise they are stored in
+// [buffer], to be used only by the current instruction.  If [config_account] is null, [*cache] is set to null.
+// Returns 0 on success, nonzero on error.
+static uint64_t get_program_config_cache(SolAccountInfo *config_account, uint8_t config_account_index,
+                                         const Clock *clock, ProgramConfigCache *buffer,
+                                         const ProgramConfigCache **cache)
+{
+    if (!config_account) {
+        *cache = 0;
+        return 0;
+    }
+
+    ProgramConfig *config = get_validated_program_config(config_account);
+    if (!config) {
+        return Error_InvalidAccount_First + config_account_index;
+    }
+
+    if (config->cache.epoch == clock->epoch) {
+        *cache = &(config->cache);
+        return 0;
+    }
+
+    ProgramConfigCache *refreshed = config_account->is_writable ? &(config->cache) : buffer;
+
+    uint64_t ret = refresh_program_config_cache(refreshed, clock->epoch);
+    if (ret) {
+        return ret;
+    }
+
+    *cache = refreshed;
+
+    return 0;
+}
+
+
+// Returns the commission settlement threshold of the program config in [config_account], which must already have been
+// validated as the program config
+static uint64_t get_commission_settlement_threshold(const SolAccountInfo *config_account)
+{
+    return ((const ProgramConfig *) (config_account->data))->commission_settlement_threshold_lamports;
+}
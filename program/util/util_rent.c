@@ -1,5 +1,7 @@
 #pragma once
 
+#include "inc/program_config.h"
+
 // Data structure stored in the Rent sysvar
 typedef struct
 {
@@ -15,7 +17,8 @@ typedef struct
 extern uint64_t sol_get_rent_sysvar(void *ret);
 
 
-static uint64_t get_rent_exempt_minimum(uint64_t account_size)
+// Reads the rent sysvar and decodes its rent exemption parameters into [fill_in]
+static void get_rent_exemption(RentExemption *fill_in)
 {
     // Get the rent sysvar value
     Rent rent;
@@ -33,11 +36,34 @@ static uint64_t get_rent_exempt_minimum(uint64_t account_size)
         // Unsupported and basically nonsensical rent exemption threshold.  Just use some hopefully sane default based
         // on historical values that were true for 2021/2022: lamports_per_byte_year = 3480, exemption_threshold = 2
         // years
-        return (account_size + 128) * 3480 * 2;
+        fill_in->lamports_per_byte_year = 3480;
+        fill_in->exemption_threshold_exponent = 1024;
+        fill_in->exemption_threshold_fraction = 0;
+        return;
     }
 
+    fill_in->lamports_per_byte_year = rent.lamports_per_byte_year;
+    fill_in->exemption_threshold_exponent = exp;
+
+    // Reduce fraction to 10 bits, to avoid overflow.  Keep track of whether or not to round up.
+    uint64_t fraction = u & 0x000FFFFFFFFFFFFFul;
+    bool round_up = (fraction & 0x3FFFFFFFFFFul);
+
+    fraction >>= 42;
+    if (round_up) {
+        fraction += 1;
+    }
+
+    fill_in->exemption_threshold_fraction = fraction;
+}
+
+
+static uint64_t compute_rent_exempt_minimum(const RentExemption *rent_exemption, uint64_t account_size)
+{
     // 128 bytes are added for account overhead
-    uint64_t min = (account_size + 128) * rent.lamports_per_byte_year;
+    uint64_t min = (account_size + 128) * rent_exemption->lamports_per_byte_year;
+
+    uint64_t exp = rent_exemption->exemption_threshold_exponent;
 
     if (exp >= 1023) {
         min *= (1 << (exp - 1023));
@@ -46,17 +72,27 @@ static uint64_t get_rent_exempt_minimum(uint64_t account_size)
         min /= (1 << (1023 - exp));
     }
 
-    // Reduce fraction to 10 bits, to avoid overflow.  Keep track of whether or not to round up.
-    uint64_t fraction = u & 0x000FFFFFFFFFFFFFul;
-    bool round_up = (fraction & 0x3FFFFFFFFFFul);
+    return min + ((rent_exemption->exemption_threshold_fraction * min) / 0x3FF);
+}
 
-    fraction >>= 42;
-    if (round_up) {
-        fraction += 1;
-    }
 
-    fraction *= min;
-    fraction /= 0x3FF;
+static uint64_t get_rent_exempt_minimum(uint64_t account_size)
+{
+    RentExemption rent_exemption;
+
+    get_rent_exemption(&rent_exemption);
+
+    return compute_rent_exempt_minimum(&rent_exemption, account_size);
+}
+
+
+// Returns the rent exempt minimum of an account of [account_size] bytes, computed from the rent exemption parameters
+// in [cache] if it is non-null, so that no syscall is needed, and from the rent sysvar otherwise
+static uint64_t get_cached_rent_exempt_minimum(const ProgramConfigCache *cache, uint64_t account_size)
+{
+    if (cache) {
+        return compute_rent_exempt_minimum(&(cache->rent_exemption), account_size);
+    }
 
-    return min + fraction;
+    return get_rent_exempt_minimum(account_size);
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "inc/profile.h"
 #include "inc/types.h"
 #include "util/util_borsh.c"
 
@@ -208,6 +209,8 @@ static bool decode_stake_account(const SolAccountInfo *stake_account, Stake *res
 // account.  Returns 0 on success, nonzero on error getting the minimum stake delegation.
 static uint64_t get_minimum_stake_delegation(uint64_t *fill_in)
 {
+    PROFILE_SCOPE("get_minimum_stake_delegation");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.stake_program_pubkey);
@@ -252,10 +255,13 @@ typedef struct __attribute__((__packed__))
 static uint64_t create_stake_account(SolAccountInfo *stake_account, const SolSignerSeed *seeds, uint8_t seed_count,
                                      const SolPubkey *funding_account_key,  uint64_t stake_lamports,
                                      const SolPubkey *stake_authority_key, const SolPubkey *withdraw_authority_key,
-                                     const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
+                                     const ProgramConfigCache *cache, const SolAccountInfo *transaction_accounts,
+                                     int transaction_accounts_len)
 {
+    PROFILE_SCOPE("create_stake_account");
+
     // Compute rent exempt minimum for a stake account
-    uint64_t rent_exempt_minimum = get_rent_exempt_minimum(STAKE_ACCOUNT_DATA_LEN);
+    uint64_t rent_exempt_minimum = get_cached_rent_exempt_minimum(cache, STAKE_ACCOUNT_DATA_LEN);
 
     // Create the pda with the desired lamports
     {
@@ -311,6 +317,8 @@ static uint64_t set_stake_authorities(const SolPubkey *stake_account, const SolP
                                       const SolPubkey *new_authority, const SolAccountInfo *transaction_accounts,
                                       int transaction_accounts_len)
 {
+    PROFILE_SCOPE("set_stake_authorities");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.stake_program_pubkey);
@@ -349,6 +357,8 @@ static uint64_t set_stake_authorities(const SolPubkey *stake_account, const SolP
 static uint64_t set_stake_authorities_signed(const SolPubkey *stake_account, const SolPubkey *new_authority,
                                              const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("set_stake_authorities_signed");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.stake_program_pubkey);
@@ -409,16 +419,22 @@ typedef struct __attribute__((__packed__))
 
 // lamports is assumed to be at least the stake account minimum or this will fail
 // moves via [bridge_account] which will be created as a PDA of the program
+// rent_exempt_minimum is the rent exempt minimum of a stake account, which funding_account funds the bridge with
+// If keep_bridge is true, the bridge's rent exempt minimum is returned to the bridge instead of to funding_account, so
+// that a following move_stake_signed through the same bridge need not create it again.  The last move through a
+// bridge within an instruction must not keep it, because anyone may initialize a funded uninitialized stake account
+// that is left between transactions.
 static uint64_t move_stake_signed(const SolPubkey *from_account_key, SolAccountInfo *bridge_account,
                                   const SolSignerSeed *bridge_seeds, int bridge_seeds_count,
                                   const SolPubkey *to_account_key, uint64_t lamports,
-                                  const SolPubkey *funding_account_key,
+                                  const SolPubkey *funding_account_key, uint64_t rent_exempt_minimum,
+                                  bool keep_bridge,
                                   const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
-    // Compute rent exempt minimum for a stake account
-    uint64_t rent_exempt_minimum = get_rent_exempt_minimum(STAKE_ACCOUNT_DATA_LEN);
+    PROFILE_SCOPE("move_stake_signed");
 
-    // Create the bridge account as a PDA to ensure that it exist with proper ownership
+    // Create the bridge account as a PDA to ensure that it exist with proper ownership.  If it was kept by a prior
+    // move, this does nothing.
     uint64_t ret = create_pda(bridge_account, bridge_seeds, bridge_seeds_count, funding_account_key,
                               &(Constants.stake_program_pubkey), rent_exempt_minimum, STAKE_ACCOUNT_DATA_LEN,
                               transaction_accounts, transaction_accounts_len);
@@ -489,13 +505,15 @@ static uint64_t move_stake_signed(const SolPubkey *from_account_key, SolAccountI
         }
     }
 
-    // Finally, withdraw the rent exempt minimum back to the funding account
+    // Finally, withdraw the rent exempt minimum back to the funding account, or to the bridge account if it is kept
     {
+        const SolPubkey *recipient_key = keep_bridge ? bridge_account->key : funding_account_key;
+
         SolAccountMeta account_metas[] =
               ///   0. `[WRITE]` Stake account from which to withdraw
             { { /* pubkey */ (SolPubkey *) to_account_key, /* is_writable */ true, /* is_signer */ false },
               ///   1. `[WRITE]` Recipient account
-              { /* pubkey */ (SolPubkey *) funding_account_key, /* is_writable */ true, /* is_signer */ false },
+              { /* pubkey */ (SolPubkey *) recipient_key, /* is_writable */ true, /* is_signer */ false },
               ///   2. `[]` Clock sysvar
               { /* pubkey */ &(Constants.clock_sysvar_pubkey), /* is_writable */ false, /* is_signer */ false },
               ///   3. `[]` Stake history sysvar that carries stake warmup/cooldown history
@@ -521,9 +539,11 @@ static uint64_t move_stake_signed(const SolPubkey *from_account_key, SolAccountI
 
 static uint64_t split_master_stake_signed(const SolPubkey *admin_account_key, SolAccountInfo *master_stake_account,
                                           const SolAccountInfo *pre_merge_account, SolAccountInfo *split_into_account,
-                                          uint64_t lamports, const SolAccountInfo *transaction_accounts,
-                                          int transaction_accounts_len)
+                                          uint64_t lamports, const ProgramConfigCache *cache,
+                                          const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("split_master_stake_signed");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.stake_program_pubkey);
@@ -563,7 +583,7 @@ static uint64_t split_master_stake_signed(const SolPubkey *admin_account_key, So
         }
     }
 
-    uint64_t rent_exempt_minimum = get_rent_exempt_minimum(STAKE_ACCOUNT_DATA_LEN);
+    uint64_t rent_exempt_minimum = get_cached_rent_exempt_minimum(cache, STAKE_ACCOUNT_DATA_LEN);
 
     // Create the stake account with the correct size and with the stake program as owner.  The stake account must
     // be a signer of this transaction.
@@ -612,6 +632,8 @@ static uint64_t split_master_stake_signed(const SolPubkey *admin_account_key, So
 static uint64_t delegate_stake_signed(const SolPubkey *stake_account_key, const SolPubkey *vote_account_key,
                                       const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("delegate_stake_signed");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.stake_program_pubkey);
@@ -650,6 +672,8 @@ static uint64_t delegate_stake_signed(const SolPubkey *stake_account_key, const
 static uint64_t deactivate_stake_signed(const SolPubkey *stake_account_key, const SolAccountInfo *transaction_accounts,
                                         int transaction_accounts_len)
 {
+    PROFILE_SCOPE("deactivate_stake_signed");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.stake_program_pubkey);
@@ -3,6 +3,7 @@
 #include "inc/block.h"
 #include "inc/constants.h"
 #include "inc/entry.h"
+#include "inc/profile.h"
 #include "util/util_rent.c"
 #include "util/util_token.c"
 
@@ -181,11 +182,13 @@ static bool is_token_owner(const SolAccountInfo *token_account, const SolPubkey
 
 static uint64_t create_token_mint(SolAccountInfo *mint_account, const SolSignerSeed *mint_account_seeds,
                                   uint8_t mint_account_seed_count, const SolPubkey *authority_key,
-                                  const SolPubkey *funding_key, uint8_t decimals,
+                                  const SolPubkey *funding_key, uint8_t decimals, const ProgramConfigCache *cache,
                                   const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("create_token_mint");
+
     // First create the mint account, with owner as SPL-token program
-    uint64_t funding_lamports = get_rent_exempt_minimum(sizeof(SolanaMintAccountData));
+    uint64_t funding_lamports = get_cached_rent_exempt_minimum(cache, sizeof(SolanaMintAccountData));
 
     uint64_t result = create_pda(mint_account, mint_account_seeds, mint_account_seed_count, funding_key,
                                  &(Constants.spl_token_program_pubkey), funding_lamports,
@@ -228,6 +231,8 @@ static uint64_t create_associated_token_account_idempotent(const SolAccountInfo
                                                            const SolAccountInfo *transaction_accounts,
                                                            int transaction_accounts_len)
 {
+    PROFILE_SCOPE("create_associated_token_account_idempotent");
+
     // If it's already a token account for this user, then there's nothing more to do
     if ((*(token_account->lamports) > 0) &&
         !is_system_program(token_account->owner) &&
@@ -271,9 +276,12 @@ static uint64_t create_associated_token_account_idempotent(const SolAccountInfo
 static uint64_t create_pda_token_account_idempotent(SolAccountInfo *token_account, const SolPubkey *mint_key,
                                                     const SolPubkey *owner_key, const SolPubkey *funding_key,
                                                     const SolSignerSeed *seeds, int seeds_count,
+                                                    const ProgramConfigCache *cache,
                                                     const SolAccountInfo *transaction_accounts,
                                                     int transaction_accounts_len)
 {
+    PROFILE_SCOPE("create_pda_token_account_idempotent");
+
     // If it's already a token account for this user, then there's nothing more to do
     if ((*(token_account->lamports) > 0) &&
         !is_system_program(token_account->owner) &&
@@ -284,7 +292,7 @@ static uint64_t create_pda_token_account_idempotent(SolAccountInfo *token_accoun
 
     // Create PDA
     uint64_t ret = create_pda(token_account, seeds, seeds_count, funding_key, &(Constants.spl_token_program_pubkey),
-                              get_rent_exempt_minimum(sizeof(SolanaTokenProgramTokenData)),
+                              get_cached_rent_exempt_minimum(cache, sizeof(SolanaTokenProgramTokenData)),
                               sizeof(SolanaTokenProgramTokenData), transaction_accounts, transaction_accounts_len);
     if (ret) {
         return ret;
@@ -319,6 +327,8 @@ static uint64_t create_pda_token_account_idempotent(SolAccountInfo *token_accoun
 static uint64_t mint_tokens(const SolPubkey *mint_key, const SolPubkey *token_key, uint64_t amount,
                             const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("mint_tokens");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.spl_token_program_pubkey);
@@ -354,6 +364,8 @@ static uint64_t mint_tokens(const SolPubkey *mint_key, const SolPubkey *token_ke
 static uint64_t revoke_mint_authority(const SolPubkey *mint_key, const SolPubkey *authority_key,
                                       const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("revoke_mint_authority");
+
 
     SolInstruction instruction;
     instruction.program_id = &(Constants.spl_token_program_pubkey);
@@ -390,6 +402,8 @@ static uint64_t revoke_mint_authority(const SolPubkey *mint_key, const SolPubkey
 static uint64_t transfer_entry_token(const Entry *entry, const SolAccountInfo *token_destination,
                                      const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("transfer_entry_token");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.spl_token_program_pubkey);
@@ -427,6 +441,8 @@ static uint64_t close_token_account(const SolPubkey *token_pubkey, const SolPubk
                                     const SolPubkey *lamports_destination_key,
                                     const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("close_token_account");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.spl_token_program_pubkey);
@@ -471,6 +487,8 @@ static uint64_t burn_tokens(const SolPubkey *token_account_key, const SolPubkey
                             const SolPubkey *mint_key, uint64_t to_burn,
                             const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("burn_tokens");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.spl_token_program_pubkey);
@@ -13,6 +13,8 @@ static uint64_t util_transfer(const SolPubkey *source_account, const SolPubkey *
                               uint64_t lamports, const SolSignerSeed *seeds, int seeds_count,
                               const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
+    PROFILE_SCOPE("util_transfer");
+
     SolInstruction instruction;
 
     instruction.program_id = &(Constants.system_program_pubkey);
@@ -2,12 +2,37 @@
 
 #include "inc/constants.h"
 #include "inc/data_type.h"
+#include "inc/profile.h"
 #include "inc/whitelist.h"
 #include "util/util_accounts.c"
 #include "util/util_block.c"
+#include "util/util_merkle.c"
 #include "util/util_rent.c"
 
 
+// Returns the index of the whitelist shard that holds [pubkey]
+static uint8_t whitelist_shard_index(const SolPubkey *pubkey)
+{
+    return pubkey->x[0] / (256 / WHITELIST_SHARD_COUNT);
+}
+
+
+// Returns the size of a whitelist shard account that holds [count] entries
+static uint64_t whitelist_shard_size(uint16_t count)
+{
+    WhitelistShard *zero = 0;
+
+    return (uint64_t) &(zero->entries[count]);
+}
+
+
+// Orders pubkeys by their bytes, as memcmp would
+static int compare_pubkeys(const SolPubkey *a, const SolPubkey *b)
+{
+    return sol_memcmp(a, b, sizeof(*a));
+}
+
+
 static Whitelist *get_validated_whitelist(const SolAccountInfo *whitelist_account)
 {
     // Make sure that the whitelist account is owned by the program
@@ -31,19 +56,66 @@ static Whitelist *get_validated_whitelist(const SolAccountInfo *whitelist_accoun
 }
 
 
+// Returns the whitelist shard stored in [whitelist_shard_account] only if it is a shard of the whitelist of the block
+// with address [block_address]
+static WhitelistShard *get_validated_whitelist_shard_of_block(const SolAccountInfo *whitelist_shard_account,
+                                                              const SolPubkey *block_address)
+{
+    // Make sure that the whitelist shard account is owned by the program
+    if (!is_self_program(whitelist_shard_account->owner)) {
+        return 0;
+    }
+
+    // Whitelist shard account must be large enough to hold its header
+    if (whitelist_shard_account->data_len < sizeof(WhitelistShard)) {
+        return 0;
+    }
+
+    const WhitelistShard *whitelist_shard = (WhitelistShard *) whitelist_shard_account->data;
+
+    // If the whitelist shard does not have the correct data type, then this is an error
+    if (whitelist_shard->data_type != DataType_WhitelistShard) {
+        return 0;
+    }
+
+    // Whitelist shard account must be sized to hold exactly its entries, as it is grown when entries are added and
+    // shrunk when they are removed
+    if (whitelist_shard_account->data_len != whitelist_shard_size(whitelist_shard->count)) {
+        return 0;
+    }
+
+    // Whitelist shard must be for the block
+    if (!SolPubkey_same(&(whitelist_shard->block_pubkey), block_address)) {
+        return 0;
+    }
+
+    return (WhitelistShard *) whitelist_shard;
+}
+
+
 // If the block already exists, this function will always return an error.
-// Adds pubkeys to the whitelist for a block.  Creates the whitelist account if it doesn't yet exist.
-static uint64_t add_whitelist_entries(SolAccountInfo *whitelist_account, const SolAccountInfo *block_account,
-                                      const SolPubkey *funding_pubkey, uint16_t whitelisted_pubkey_count,
-                                      const SolPubkey *whitelisted_pubkeys, const SolAccountInfo *transaction_accounts,
+// Adds pubkeys to the whitelist for a block.  All of the pubkeys must belong in the whitelist shard with index
+// [shard_index].  Creates the whitelist and the whitelist shard accounts if they don't yet exist, and grows the
+// whitelist shard account to hold the new entries.  The whitelist is always created with its canonical bump seed, which
+// is the only whitelist bump seed that CreateBlock accepts, so the block always records the bump seed of its whitelist.
+static uint64_t add_whitelist_entries(SolAccountInfo *whitelist_account, SolAccountInfo *whitelist_shard_account,
+                                      const SolAccountInfo *block_account, uint8_t shard_index,
+                                      uint8_t shard_bump_seed, const SolPubkey *funding_pubkey,
+                                      uint16_t whitelisted_pubkey_count, const SolPubkey *whitelisted_pubkeys,
+                                      const ProgramConfigCache *cache, const SolAccountInfo *transaction_accounts,
                                       int transaction_accounts_len)
 {
+    PROFILE_SCOPE("add_whitelist_entries");
+
     // Verify that the block account does not exist.  This is necessary because whitelists cannot be created after a
     // block is created.  This ensures that whitelists are not added to while sales are ongoing.
     if (get_validated_block(block_account)) {
         return Error_BlockAlreadyExists;
     }
 
+    // Get the pre-existing whitelist
+    Whitelist *whitelist = get_validated_whitelist(whitelist_account);
+
     // Compute the whitelist address
     uint8_t prefix = PDA_Account_Seed_Prefix_Whitelist;
 
@@ -53,26 +125,44 @@ static uint64_t add_whitelist_entries(SolAccountInfo *whitelist_account, const S
                               { (uint8_t *) block_account->key, sizeof(*(block_account->key)) },
                               { &bump_seed, sizeof(bump_seed) } };
 
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return ret;
+    // Verify that the whitelist account address is as expected.  If the whitelist already exists, it records its bump
+    // seed; otherwise the canonical bump seed is searched for, which is only done once per whitelist.
+    if (whitelist) {
+        bump_seed = whitelist->bump_seed;
+        if (!is_program_derived_address(whitelist_account->key, seeds, ARRAY_LEN(seeds))) {
+            return Error_NotWhitelistAccount;
+        }
+    }
+    else {
+        SolPubkey computed_pubkey;
+        if (sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
+                                         &computed_pubkey, &bump_seed) ||
+            !SolPubkey_same(&computed_pubkey, whitelist_account->key)) {
+            return Error_NotWhitelistAccount;
+        }
     }
 
-    // Verify that the whitelist account address is as expected
-    if (!SolPubkey_same(&pubkey, whitelist_account->key)) {
+    // Compute the whitelist shard address
+    uint8_t shard_prefix = PDA_Account_Seed_Prefix_Whitelist_Shard;
+
+    SolSignerSeed shard_seeds[] = { { &shard_prefix, sizeof(shard_prefix) },
+                                    { (uint8_t *) block_account->key, sizeof(*(block_account->key)) },
+                                    { &shard_index, sizeof(shard_index) },
+                                    { &shard_bump_seed, sizeof(shard_bump_seed) } };
+
+    // Verify that the whitelist shard account address is as expected, and that its bump seed is the canonical one so
+    // that there can only be one whitelist shard account for each shard index
+    if (!is_program_derived_address(whitelist_shard_account->key, shard_seeds, ARRAY_LEN(shard_seeds)) ||
+        !is_canonical_bump_seed(shard_seeds, ARRAY_LEN(shard_seeds))) {
         return Error_NotWhitelistAccount;
     }
 
-    // Get the pre-existing whitelist
-    Whitelist *whitelist = get_validated_whitelist(whitelist_account);
-
     if (whitelist == 0) {
         // No whitelist existed so create it
-        ret = create_pda(whitelist_account, seeds, ARRAY_LEN(seeds), funding_pubkey, &(Constants.self_program_pubkey),
-                         get_rent_exempt_minimum(sizeof(Whitelist)), sizeof(Whitelist), transaction_accounts,
-                         transaction_accounts_len);
+        uint64_t ret = create_pda(whitelist_account, seeds, ARRAY_LEN(seeds), funding_pubkey,
+                                  &(Constants.self_program_pubkey),
+                                  get_cached_rent_exempt_minimum(cache, sizeof(Whitelist)), sizeof(Whitelist),
+                                  transaction_accounts, transaction_accounts_len);
         if (ret) {
             return ret;
         }
@@ -80,18 +170,85 @@ static uint64_t add_whitelist_entries(SolAccountInfo *whitelist_account, const S
         whitelist = (Whitelist *) whitelist_account->data;
 
         whitelist->data_type = DataType_Whitelist;
+
+        whitelist->block_pubkey = *(block_account->key);
+
+        whitelist->bump_seed = bump_seed;
     }
 
+    // Get the pre-existing whitelist shard
+    WhitelistShard *whitelist_shard = get_validated_whitelist_shard_of_block(whitelist_shard_account,
+                                                                             block_account->key);
+
+    uint16_t existing_count = whitelist_shard ? whitelist_shard->count : 0;
+
     // Make sure they will all fit
-    if ((whitelisted_pubkey_count + whitelist->count) > MAX_WHITELIST_ENTRIES) {
+    if ((whitelisted_pubkey_count + existing_count) > MAX_WHITELIST_SHARD_ENTRIES) {
+        return Error_TooManyWhitelistEntries;
+    }
+
+    // Make sure they can all be sorted
+    if (whitelisted_pubkey_count > MAX_WHITELIST_ADD_ENTRIES) {
         return Error_TooManyWhitelistEntries;
     }
 
-    // Copy them in
-    sol_memcpy(&(whitelist->entries[whitelist->count]), whitelisted_pubkeys,
-               sizeof(SolPubkey) * whitelisted_pubkey_count);
+    // Sort the new entries; there are few enough of them that an insertion sort is fine
+    SolPubkey sorted[MAX_WHITELIST_ADD_ENTRIES];
+    for (uint16_t i = 0; i < whitelisted_pubkey_count; i++) {
+        uint16_t j = i;
+        while ((j > 0) && (compare_pubkeys(&(sorted[j - 1]), &(whitelisted_pubkeys[i])) > 0)) {
+            sorted[j] = sorted[j - 1];
+            j -= 1;
+        }
+        sorted[j] = whitelisted_pubkeys[i];
+    }
+
+    // Create the whitelist shard if it didn't exist, or grow it if it did, so that it is sized to exactly hold all
+    // of its entries
+    uint64_t new_size = whitelist_shard_size(existing_count + whitelisted_pubkey_count);
+
+    uint64_t ret = create_pda(whitelist_shard_account, shard_seeds, ARRAY_LEN(shard_seeds), funding_pubkey,
+                              &(Constants.self_program_pubkey), get_cached_rent_exempt_minimum(cache, new_size),
+                              new_size, transaction_accounts, transaction_accounts_len);
+    if (ret) {
+        return ret;
+    }
+
+    bool is_new_shard = (whitelist_shard == 0);
+
+    whitelist_shard = (WhitelistShard *) whitelist_shard_account->data;
+
+    if (is_new_shard) {
+        whitelist_shard->data_type = DataType_WhitelistShard;
+
+        whitelist_shard->block_pubkey = *(block_account->key);
+
+        whitelist_shard->shard_index = shard_index;
+
+        whitelist_shard->bump_seed = shard_bump_seed;
+    }
+
+    // Merge the sorted new entries into the sorted existing entries, working backwards from the end of the newly
+    // grown shard so that no existing entry is overwritten before it has been moved
+    int32_t existing_index = ((int32_t) existing_count) - 1;
+    int32_t new_index = ((int32_t) whitelisted_pubkey_count) - 1;
+    int32_t destination_index = ((int32_t) (existing_count + whitelisted_pubkey_count)) - 1;
+
+    while (new_index >= 0) {
+        if ((existing_index >= 0) &&
+            (compare_pubkeys(&(whitelist_shard->entries[existing_index]), &(sorted[new_index])) > 0)) {
+            whitelist_shard->entries[destination_index--] = whitelist_shard->entries[existing_index--];
+        }
+        else {
+            whitelist_shard->entries[destination_index--] = sorted[new_index--];
+        }
+    }
+
+    // Counts are increased
+    whitelist_shard->count += whitelisted_pubkey_count;
+
+    whitelist->shard_mask |= (1 << shard_index);
 
-    // Count is increased
     whitelist->count += whitelisted_pubkey_count;
 
     return 0;
@@ -99,102 +256,233 @@ static uint64_t add_whitelist_entries(SolAccountInfo *whitelist_account, const S
 
 
 // Checks the ensure that the given system account address is stored in the whitelist for the given block.  If the
-// block has no whitelist, then this check succeeds.  Otherwise, if the account is in the whitelist, its first entry
-// in the whitelist is cleared and true is returned, otherwise false is returned.
-static bool whitelist_check(const SolAccountInfo *whitelist_account, const SolPubkey *block_address,
-                            const SolPubkey *system_account_address)
+// block has no whitelist, then this check succeeds.  Otherwise, if the account is in the whitelist shard that holds
+// it, one instance of it is removed from the shard and true is returned, otherwise false is returned.  When an entry is
+// removed, the shard is shrunk to hold only its remaining entries, and the lamports beyond the rent exempt minimum of
+// its new size are moved to [lamports_destination_account].  [whitelist_shard_account] may be null, in which case the
+// check fails if the shard would be needed.
+static bool whitelist_check(const SolAccountInfo *whitelist_account, SolAccountInfo *whitelist_shard_account,
+                            const SolPubkey *block_address, const Block *block,
+                            const SolPubkey *system_account_address, const ProgramConfigCache *cache,
+                            const SolAccountInfo *lamports_destination_account)
 {
-    // Compute the whitelist address
-    uint8_t prefix = PDA_Account_Seed_Prefix_Whitelist;
+    PROFILE_SCOPE("whitelist_check");
 
-    uint8_t bump_seed;
+    // Get the whitelist
+    Whitelist *whitelist = get_validated_whitelist(whitelist_account);
 
-    SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
-                              { (uint8_t *) block_address, sizeof(*block_address) },
-                              { &bump_seed, sizeof(bump_seed) } };
+    // If the whitelist account does not hold a whitelist for this block, then either the block has no whitelist, or
+    // the wrong account was supplied; only in the former case does the check succeed
+    if (!whitelist || !SolPubkey_same(&(whitelist->block_pubkey), block_address)) {
+        // Compute the whitelist address, using the whitelist bump seed that was recorded in the block when it was
+        // created
+        uint8_t prefix = PDA_Account_Seed_Prefix_Whitelist;
 
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
+        SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
+                                  { (uint8_t *) block_address, sizeof(*block_address) },
+                                  { (uint8_t *) &(block->whitelist_bump_seed), sizeof(block->whitelist_bump_seed) } };
+
+        return is_program_derived_address(whitelist_account->key, seeds, ARRAY_LEN(seeds));
+    }
+
+    // If no entries are left in the whitelist, then the check implicitly succeeds
+    if (whitelist->count == 0) {
+        return true;
+    }
+
+    // The shard must be the one of this block's whitelist which holds system_account_address; if it isn't, then
+    // system_account_address cannot be found
+    if (!whitelist_shard_account) {
         return false;
     }
 
-    // Verify that the whitelist account address is as expected
-    if (!SolPubkey_same(&pubkey, whitelist_account->key)) {
+    WhitelistShard *whitelist_shard = get_validated_whitelist_shard_of_block(whitelist_shard_account, block_address);
+    if (!whitelist_shard || (whitelist_shard->shard_index != whitelist_shard_index(system_account_address))) {
         return false;
     }
 
-    // Get the whitelist
-    Whitelist *whitelist = get_validated_whitelist(whitelist_account);
+    // Binary search for the first entry that is not less than system_account_address
+    uint16_t low = 0, high = whitelist_shard->count;
+    while (low < high) {
+        uint16_t middle = low + ((high - low) / 2);
+        if (compare_pubkeys(&(whitelist_shard->entries[middle]), system_account_address) < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
 
-    // If no valid whitelist, or no entries in the whitelist, then the check implicitly succeeds
-    if (!whitelist || (whitelist->count == 0)) {
+    // Did not find the system_account_address in the whitelist
+    if ((low == whitelist_shard->count) ||
+        !SolPubkey_same(&(whitelist_shard->entries[low]), system_account_address)) {
+        return false;
+    }
+
+    // Remove the entry by moving all subsequent entries down by one, which keeps the entries sorted
+    whitelist_shard->count -= 1;
+    for (uint16_t i = low; i < whitelist_shard->count; i++) {
+        whitelist_shard->entries[i] = whitelist_shard->entries[i + 1];
+    }
+
+    whitelist->count -= 1;
+
+    // Shrink the shard to drop the now unused last entry, and reclaim the lamports that its rent exemption no longer
+    // needs
+    uint64_t new_size = whitelist_shard_size(whitelist_shard->count);
+
+    set_account_size(whitelist_shard_account, new_size);
+
+    uint64_t rent_exempt_minimum = get_cached_rent_exempt_minimum(cache, new_size);
+
+    if (*(whitelist_shard_account->lamports) > rent_exempt_minimum) {
+        *(lamports_destination_account->lamports) += *(whitelist_shard_account->lamports) - rent_exempt_minimum;
+        *(whitelist_shard_account->lamports) = rent_exempt_minimum;
+    }
+
+    return true;
+}
+
+
+// Checks that the given system account address is in the Merkle whitelist of the given block, as proven by the leaf
+// with [first_slot] and [allowance] and the sibling hashes in [proof].  If all whitelist slots have already been
+// claimed, then this check succeeds.  Otherwise, if the proof is valid and the leaf has a slot that has not been
+// claimed yet, then that slot is claimed and true is returned, otherwise false is returned.
+static bool whitelist_merkle_check(Block *block, const SolPubkey *system_account_address, uint16_t first_slot,
+                                   uint8_t allowance, const sha256_t *proof, uint8_t proof_length)
+{
+    PROFILE_SCOPE("whitelist_merkle_check");
+
+    // If no slots are left in the whitelist, then the check implicitly succeeds
+    if (block->whitelist_claimed_count == block->config.whitelist_slot_count) {
         return true;
     }
 
-    // Find the system_account_address in the whitelist
-    for (uint16_t i = 0; i < whitelist->count; i++) {
-        // This is the pubkey in the whitelist at the whitelist_index
-        SolPubkey *whitelist_entry = &(whitelist->entries[i]);
-        // If this matches, then if there are more entries, copy the last one over top of the found one, zero out
-        // the last one, and reduce the count by 1
-        if (SolPubkey_same(system_account_address, whitelist_entry)) {
-            SolPubkey *last_entry = &(whitelist->entries[whitelist->count - 1]);
-            *whitelist_entry = *last_entry;
-            *last_entry = Constants.system_program_pubkey; // All zeroes
-            whitelist->count -= 1;
+    // The slots of the leaf must all be within the block's whitelist slots
+    if ((allowance == 0) || (((uint32_t) first_slot + allowance) > block->config.whitelist_slot_count)) {
+        return false;
+    }
+
+    // Compute the hash of the leaf
+    uint8_t prefix = MERKLE_LEAF_PREFIX;
+
+    SolBytes leaf[] = { { &prefix, sizeof(prefix) },
+                        { (uint8_t *) system_account_address, sizeof(*system_account_address) },
+                        { (uint8_t *) &first_slot, sizeof(first_slot) },
+                        { &allowance, sizeof(allowance) } };
+
+    sha256_t hash;
+    if (sol_sha256(leaf, ARRAY_LEN(leaf), (uint8_t *) &hash)) {
+        return false;
+    }
+
+    // Hash up the tree
+    for (uint8_t i = 0; i < proof_length; i++) {
+        if (!merkle_hash_pair(&hash, &(proof[i]), &hash)) {
+            return false;
+        }
+    }
+
+    // The result must be the root of the block's whitelist Merkle tree
+    if (sol_memcmp(&hash, &(block->config.whitelist_merkle_root), sizeof(hash))) {
+        return false;
+    }
+
+    // Claim the first unclaimed slot of the leaf
+    uint8_t *claimed_bitmap = get_whitelist_claimed_bitmap(block);
+
+    for (uint32_t slot = first_slot; slot < ((uint32_t) first_slot + allowance); slot++) {
+        if (!(claimed_bitmap[slot / 8] & (1 << (slot % 8)))) {
+            claimed_bitmap[slot / 8] |= (1 << (slot % 8));
+            block->whitelist_claimed_count += 1;
             return true;
         }
     }
 
-    // Did not find the system_account_address in the whitelist
+    // All purchases allowed by the leaf have already been made
     return false;
 }
 
 
-// Deletes a whitelist, returning the lamports in it to the destination account.  An empty whitelist can always
-// be deleted.  This is not allowed if the block exists, uses a non-empty whitelist, and is not yet past its
-// whitelist phase.
-static uint64_t delete_whitelist_account(const SolAccountInfo *whitelist_account, const SolAccountInfo *block_account,
-                                         const Clock *clock, const SolAccountInfo *destination_account,
+// Deletes a whitelist and its shards, returning the lamports in them to the destination account and truncating their
+// data so that they are closed.  An empty whitelist can always be deleted.  This is not allowed if the block exists,
+// uses a non-empty whitelist, and is not yet past its whitelist phase.
+static uint64_t delete_whitelist_account(SolAccountInfo *whitelist_account,
+                                         SolAccountInfo *whitelist_shard_accounts, uint8_t whitelist_shard_count,
+                                         const SolAccountInfo *block_account, const Clock *clock,
+                                         const SolAccountInfo *destination_account,
                                          const SolAccountInfo *transaction_accounts, int transaction_accounts_len)
 {
-    // Compute the whitelist address
-    uint8_t prefix = PDA_Account_Seed_Prefix_Whitelist;
+    PROFILE_SCOPE("delete_whitelist_account");
 
+    const Whitelist *whitelist = get_validated_whitelist(whitelist_account);
+
+    const Block *block = get_validated_block(block_account);
+
+    // The bump seed of the whitelist address is recorded in the whitelist itself, and also in the block if the block
+    // exists; if neither exists, then there is no way to verify the whitelist address, and also nothing to delete
     uint8_t bump_seed;
+    if (whitelist) {
+        bump_seed = whitelist->bump_seed;
+    }
+    else if (block) {
+        bump_seed = block->whitelist_bump_seed;
+    }
+    else {
+        return Error_NotWhitelistAccount;
+    }
+
+    // Compute the whitelist address
+    uint8_t prefix = PDA_Account_Seed_Prefix_Whitelist;
 
     SolSignerSeed seeds[] = { { &prefix, sizeof(prefix) },
                               { (uint8_t *) block_account->key, sizeof(*(block_account->key)) },
                               { &bump_seed, sizeof(bump_seed) } };
 
-    SolPubkey pubkey;
-    uint64_t ret = sol_try_find_program_address(seeds, ARRAY_LEN(seeds) - 1, &(Constants.self_program_pubkey),
-                                                &pubkey, &bump_seed);
-    if (ret) {
-        return Error_NotWhitelistAccount;
-    }
-
     // Verify that the whitelist account address is as expected
-    if (!SolPubkey_same(&pubkey, whitelist_account->key)) {
+    if (!is_program_derived_address(whitelist_account->key, seeds, ARRAY_LEN(seeds))) {
         return Error_NotWhitelistAccount;
     }
 
     // If the whitelist has entries in it, then check the block to make sure that it isn't valid with an in-progress
     // whitelist
-    const Whitelist *whitelist = get_validated_whitelist(whitelist_account);
     if (whitelist && whitelist->count) {
-        const Block *block = get_validated_block(block_account);
         if (block && (block->config.whitelist_duration > 0) &&
             ((block->block_start_timestamp + block->config.whitelist_duration) > clock->unix_timestamp)) {
             return Error_WhitelistBlockInProgress;
         }
     }
 
-    // Move the lamports from the whitelist
+    // Every whitelist shard must be a shard of this block's whitelist, and if the whitelist still exists, every one
+    // of its shards must be present so that none is left behind.  This is checked for all shards before any lamports
+    // are moved.
+    uint16_t shard_mask = 0;
+    for (uint8_t i = 0; i < whitelist_shard_count; i++) {
+        const WhitelistShard *whitelist_shard =
+            get_validated_whitelist_shard_of_block(&(whitelist_shard_accounts[i]), block_account->key);
+        if (!whitelist_shard) {
+            return Error_NotWhitelistAccount;
+        }
+        shard_mask |= (1 << whitelist_shard->shard_index);
+    }
+
+    if (whitelist && (shard_mask != whitelist->shard_mask)) {
+        return Error_NotWhitelistAccount;
+    }
+
+    // Move the lamports from the whitelist shards and close them
+    for (uint8_t i = 0; i < whitelist_shard_count; i++) {
+        *(destination_account->lamports) += *(whitelist_shard_accounts[i].lamports);
+        *(whitelist_shard_accounts[i].lamports) = 0;
+        set_account_size(&(whitelist_shard_accounts[i]), 0);
+    }
+
+    // Move the lamports from the whitelist and close it, if it exists
     *(destination_account->lamports) += *(whitelist_account->lamports);
     *(whitelist_account->lamports) = 0;
+    if (whitelist) {
+        set_account_size(whitelist_account, 0);
+    }
 
     return 0;
 }
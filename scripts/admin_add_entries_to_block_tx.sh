@@ -2,7 +2,8 @@
 
 set -e
 
-# Emits an encoded transaction that adds entries to a block.  Assumes that admin is the funding_account.
+# Emits an encoded transaction that adds entries to a block.  Assumes that admin is the funding_account.  Each
+# SHA_256 is "none" if the block has a reveal Merkle root, since the entries then have no reveal hashes of their own.
 
 function require ()
 {
@@ -11,7 +12,7 @@ function require ()
 
 Usage: admin_add_entries_to_block_tx.sh <ADMIN_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <METAPLEX_METADATA_URI> \\
                                         <SECOND_METAPLEX_METADATA_CREATOR or "none"> <FIRST_ENTRY_INDEX> \\
-                                        <SHA_256>...
+                                        <SHA_256 or "none">...
 
 EOF
         exit 1
@@ -100,9 +101,9 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
                                  [ u8 9                                                                               \
                                    $BID_MARKER_TOKEN_PUBKEY ]"
 
-# Compute entry pubkeys and sha256               
+# Compute entry pubkeys, sha256, and bump seeds
 ENTRY_ACCOUNTS=
-ENTERY_SHA256S=
+ENTRY_DATA=
 ENTRY_INDEX=$FIRST_ENTRY_INDEX
 while [ -n "$7" ]; do
     MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 5 $BLOCK_PUBKEY u16 $ENTRY_INDEX ]"
@@ -113,12 +114,20 @@ while [ -n "$7" ]; do
     
     ENTRY_ACCOUNTS="$ENTRY_ACCOUNTS account $ENTRY_PUBKEY w account $MINT_PUBKEY w account $TOKEN_PUBKEY w            \
                     account $METADATA_PUBKEY w"
-    SHA256_DATA="$SHA256_DATA $(echo "$7" | xxd -r -p | od -An -tu1 | tr -d '\n' | tr -s '[:space:]')"
+    if [ "$7" != "none" ]; then
+        ENTRY_DATA="$ENTRY_DATA $(echo "$7" | xxd -r -p | od -An -tu1 | tr -d '\n' | tr -s '[:space:]')"
+    fi
+    # Each sha256 (if any) is followed by the bump seeds of the mint, token, entry, and bridge addresses
+    BRIDGE_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 10 $MINT_PUBKEY ]"
+    ENTRY_DATA="$ENTRY_DATA `solxact $MINT_PUBKEY | cut -d . -f 2`"
+    ENTRY_DATA="$ENTRY_DATA `solxact $TOKEN_PUBKEY | cut -d . -f 2`"
+    ENTRY_DATA="$ENTRY_DATA `solxact $ENTRY_PUBKEY | cut -d . -f 2`"
+    ENTRY_DATA="$ENTRY_DATA `solxact $BRIDGE_PUBKEY | cut -d . -f 2`"
     shift
     ENTRY_INDEX=$(($ENTRY_INDEX+1))
 done
 
-require $SHA256_DATA
+require $ENTRY_DATA
                
 solxact encode                                                                                                        \
         encoding c                                                                                                    \
@@ -139,4 +148,4 @@ solxact encode
         c_string 200 $METAPLEX_METADATA_URI                                                                           \
         pubkey $SECOND_METAPLEX_METADATA_CREATOR_OR_NONE                                                              \
         u16 $FIRST_ENTRY_INDEX                                                                                        \
-        u8 $SHA256_DATA
+        u8 $ENTRY_DATA
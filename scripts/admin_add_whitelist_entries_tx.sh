@@ -3,7 +3,8 @@
 set -e
 
 # Emits an encoded transaction that adds whitelist entries to the whitelist of a block.  Assumes that admin is the
-# funding_account.
+# funding_account.  All of the pubkeys must belong in the same whitelist shard (see whitelist_shard_index.sh); pubkeys
+# belonging in different shards must be added by separate transactions.
 
 function require ()
 {
@@ -21,10 +22,18 @@ ADMIN_PUBKEY=$1
 GROUP_NUMBER=$2
 BLOCK_NUMBER=$3
 
-# Compose whitelist pubkey list
+# Compose whitelist pubkey list, checking that all pubkeys belong in the same whitelist shard
 WHITELIST_PUBKEYS=
 WHITELIST_PUBKEYS_COUNT=0
+WHITELIST_SHARD_INDEX=
 while [ -n "$4" ]; do
+    PUBKEY_SHARD_INDEX=`$(dirname $0)/whitelist_shard_index.sh $4`
+    if [ -z "$WHITELIST_SHARD_INDEX" ]; then
+        WHITELIST_SHARD_INDEX=$PUBKEY_SHARD_INDEX
+    elif [ "$PUBKEY_SHARD_INDEX" != "$WHITELIST_SHARD_INDEX" ]; then
+        echo "$4 belongs in whitelist shard $PUBKEY_SHARD_INDEX, not $WHITELIST_SHARD_INDEX"
+        exit 1
+    fi
     WHITELIST_PUBKEYS="$WHITELIST_PUBKEYS pubkey $4"
     WHITELIST_PUBKEYS_COUNT=$(($WHITELIST_PUBKEYS_COUNT+1))
     shift
@@ -73,6 +82,10 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
            WHITELIST_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
                                  [ u8 13                                                                              \
                                    $BLOCK_PUBKEY ]"
+     WHITELIST_SHARD_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 17                                                                              \
+                                   $BLOCK_PUBKEY                                                                      \
+                                   u8 $WHITELIST_SHARD_INDEX ]"
           ENTRY_MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
                                  [ u8 5                                                                               \
                                    $BLOCK_PUBKEY                                                                      \
@@ -98,7 +111,10 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
                  BID_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
                                  [ u8 9                                                                               \
                                    $BID_MARKER_TOKEN_PUBKEY ]"
-               
+
+# The program is given the bump seed of the whitelist shard address so that it does not have to search for it
+WHITELIST_SHARD_BUMP_SEED=`solxact $WHITELIST_SHARD_PUBKEY | cut -d . -f 2`
+
 solxact encode                                                                                                        \
         encoding c                                                                                                    \
         fee_payer $ADMIN_PUBKEY                                                                                       \
@@ -108,8 +124,11 @@ solxact encode
         account $ADMIN_PUBKEY ws                                                                                      \
         account $BLOCK_PUBKEY                                                                                         \
         account $WHITELIST_PUBKEY w                                                                                   \
+        account $WHITELIST_SHARD_PUBKEY w                                                                             \
         account $SYSTEM_PROGRAM_PUBKEY                                                                                \
         // Instruction code 8 = AddWhitelistEntries //                                                                \
         u8 8                                                                                                          \
+        u8 $WHITELIST_SHARD_INDEX                                                                                     \
+        u8 $WHITELIST_SHARD_BUMP_SEED                                                                                 \
         u16 $WHITELIST_PUBKEYS_COUNT                                                                                  \
         $WHITELIST_PUBKEYS
@@ -2,7 +2,12 @@
 
 set -e
 
-# Emits an encoded transaction that creates a block.  Assumes that admin is the funding_account.
+# Emits an encoded transaction that creates a block.  Assumes that admin is the funding_account.  If HAS_AUCTION is
+# "escrow", the block has auctions whose bids are escrowed in the entries (see user_escrowed_bid_tx.sh).  If
+# WHITELIST_FILE is given (and is not "none"), the block uses a Merkle whitelist of the system accounts listed in it
+# (see whitelist_merkle.sh).  If REVEAL_MERKLE_FILE is given (and is not "none"), the block commits to the reveal of
+# its entries with the Merkle root of the entries listed in it (see reveal_merkle.sh).  Any further arguments are the
+# URI prefixes of the block, of which there may be up to 4, each at most 96 characters long.
 
 function require ()
 {
@@ -12,7 +17,8 @@ function require ()
 Usage: admin_create_block_tx.sh <ADMIN_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <COMMISSION (0-65535)> \\
                                 <TOTAL_ENTRY_COUNT> <TOTAL_MYSTERY_COUNT> <MYSTERY_PHASE_DURATION> \\
                                 <MYSTERY_START_PRICE_LAMPORTS> <REVEAL_PERIOD_DURATION> <MINIMUM_PRICE_LAMPORTS> \\
-                                <HAS_AUCTION> <DURATION> <FINAL_START_PRICE_LAMPORTS> <WHITELIST_DURATION>
+                                <HAS_AUCTION> <DURATION> <FINAL_START_PRICE_LAMPORTS> <WHITELIST_DURATION> \\
+                                [WHITELIST_FILE] [REVEAL_MERKLE_FILE] [URI_PREFIX]...
 
 EOF
         exit 1
@@ -33,6 +39,8 @@ HAS_AUCTION=${11}
 DURATION=${12}
 FINAL_START_PRICE_LAMPORTS=${13}
 WHITELIST_DURATION=${14}
+WHITELIST_FILE=${15}
+REVEAL_MERKLE_FILE=${16}
 
 require $ADMIN_PUBKEY
 require $GROUP_NUMBER
@@ -49,10 +57,15 @@ require $DURATION
 require $FINAL_START_PRICE_LAMPORTS
 require $WHITELIST_DURATION
 
+ESCROW_BIDS=false
+
 if [ "$HAS_AUCTION" = "1" ]; then
     HAS_AUCTION=true
 elif [ "$HAS_AUCTION" = "0" ]; then
     HAS_AUCTION=false
+elif [ "$HAS_AUCTION" = "escrow" ]; then
+    HAS_AUCTION=true
+    ESCROW_BIDS=true
 fi
 
 # Compute program, block, entry, and related pubkeys.  These may not all be valid, depending on input parameters
@@ -119,6 +132,52 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
                                  [ u8 9                                                                               \
                                    $BID_MARKER_TOKEN_PUBKEY ]"
 
+# The program is given the bump seeds of the block and whitelist addresses so that it does not have to search for them
+BLOCK_BUMP_SEED=`solxact $BLOCK_PUBKEY | cut -d . -f 2`
+WHITELIST_BUMP_SEED=`solxact $WHITELIST_PUBKEY | cut -d . -f 2`
+
+# A block without a Merkle whitelist has no whitelist slots and a zero Merkle root
+WHITELIST_SLOT_COUNT=0
+WHITELIST_MERKLE_ROOT=0000000000000000000000000000000000000000000000000000000000000000
+
+if [ -n "$WHITELIST_FILE" -a "$WHITELIST_FILE" != "none" ]; then
+    WHITELIST_MERKLE=`$(dirname $0)/whitelist_merkle.sh root $WHITELIST_FILE`
+    WHITELIST_SLOT_COUNT=${WHITELIST_MERKLE% *}
+    WHITELIST_MERKLE_ROOT=${WHITELIST_MERKLE#* }
+fi
+
+WHITELIST_MERKLE_ROOT=$(echo $WHITELIST_MERKLE_ROOT | xxd -r -p | od -An -tu1 -v | tr -d '\n' | tr -s '[:space:]')
+
+# A block without a reveal Merkle root has a zero root, and its entries are each given their own reveal hash
+REVEAL_MERKLE_ROOT=0000000000000000000000000000000000000000000000000000000000000000
+
+if [ -n "$REVEAL_MERKLE_FILE" -a "$REVEAL_MERKLE_FILE" != "none" ]; then
+    REVEAL_MERKLE_ROOT=`$(dirname $0)/reveal_merkle.sh root $REVEAL_MERKLE_FILE`
+fi
+
+REVEAL_MERKLE_ROOT=$(echo $REVEAL_MERKLE_ROOT | xxd -r -p | od -An -tu1 -v | tr -d '\n' | tr -s '[:space:]')
+
+# The URI prefixes follow the block configuration, each as a one byte length followed by its characters
+URI_PREFIXES=
+
+if [ $# -gt 16 ]; then
+    shift 16
+    if [ $# -gt 4 ]; then
+        echo "At most 4 URI prefixes may be given" 1>&2
+        exit 1
+    fi
+    for URI_PREFIX in "$@"; do
+        if [ ${#URI_PREFIX} -gt 96 ]; then
+            echo "URI prefix is longer than 96 characters: $URI_PREFIX" 1>&2
+            exit 1
+        fi
+        URI_PREFIXES="$URI_PREFIXES u8 ${#URI_PREFIX}"
+        if [ ${#URI_PREFIX} -gt 0 ]; then
+            URI_PREFIXES="$URI_PREFIXES u8 $(echo -n "$URI_PREFIX" | od -An -tu1 -v | tr -d '\n' | tr -s '[:space:]')"
+        fi
+    done
+fi
+
 solxact encode                                                                                                        \
         encoding c                                                                                                    \
         fee_payer $ADMIN_PUBKEY                                                                                       \
@@ -130,7 +189,9 @@ solxact encode
         account $SYSTEM_PROGRAM_PUBKEY                                                                                \
         // Instruction code 2 = CreateBlock //                                                                        \
         u8 2                                                                                                          \
+        u8 $BLOCK_BUMP_SEED                                                                                           \
         u16 $COMMISSION                                                                                               \
+        u8 $WHITELIST_BUMP_SEED                                                                                       \
         // Block Configuration //                                                                                     \
         struct [                                                                                                      \
         u32 $GROUP_NUMBER                                                                                             \
@@ -142,7 +203,12 @@ solxact encode
         u32 $REVEAL_PERIOD_DURATION                                                                                   \
         u64 $MINIMUM_PRICE_LAMPORTS                                                                                   \
         bool $HAS_AUCTION                                                                                             \
+        bool $ESCROW_BIDS                                                                                             \
         u32 $DURATION                                                                                                 \
         u64 $FINAL_START_PRICE_LAMPORTS                                                                               \
         u32 $WHITELIST_DURATION                                                                                       \
-        ]
+        u16 $WHITELIST_SLOT_COUNT                                                                                     \
+        u8 $WHITELIST_MERKLE_ROOT                                                                                     \
+        u8 $REVEAL_MERKLE_ROOT                                                                                        \
+        ]                                                                                                             \
+        $URI_PREFIXES
@@ -2,14 +2,15 @@
 
 set -e
 
-# Emits an encoded transaction that deletes a block's whitelist.  Assumes that admin is the funding_account.
+# Emits an encoded transaction that deletes a block's whitelist.  Assumes that admin is the funding_account.  The
+# indexes of all whitelist shards of the whitelist must be supplied, as shown by "show.sh whitelist".
 
 function require ()
 {
     if [ -z "$1" ]; then
         cat <<EOF
 
-Usage: admin_delete_whitelist_tx.sh <ADMIN_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER>
+Usage: admin_delete_whitelist_tx.sh <ADMIN_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> [<WHITELIST_SHARD_INDEX>...]
 
 EOF
         exit 1
@@ -24,6 +25,8 @@ require $ADMIN_PUBKEY
 require $GROUP_NUMBER
 require $BLOCK_NUMBER
 
+shift 3
+
 # Compute program, block, entry, and related pubkeys.  These may not all be valid, depending on input parameters
 # to the script, but any that are invalid won't be used by the solxact encode command that follows.
 
@@ -87,7 +90,14 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
                  BID_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
                                  [ u8 9                                                                               \
                                    $BID_MARKER_TOKEN_PUBKEY ]"
-               
+
+# Compose whitelist shard account list
+WHITELIST_SHARD_ACCOUNTS=
+while [ -n "$1" ]; do
+    WHITELIST_SHARD_ACCOUNTS="$WHITELIST_SHARD_ACCOUNTS account pda $SELF_PROGRAM_PUBKEY [ u8 17 $BLOCK_PUBKEY u8 $1 ] w"
+    shift
+done
+
 solxact encode                                                                                                        \
         encoding c                                                                                                    \
         fee_payer $ADMIN_PUBKEY                                                                                       \
@@ -96,5 +106,6 @@ solxact encode
         account $ADMIN_PUBKEY ws                                                                                      \
         account $BLOCK_PUBKEY                                                                                         \
         account $WHITELIST_PUBKEY w                                                                                   \
+        $WHITELIST_SHARD_ACCOUNTS                                                                                     \
         // Instruction code 9 = DeleteWhitelist //                                                                    \
         u8 9
@@ -2,7 +2,12 @@
 
 set -e
 
-# Emits an encoded transaction that reveals block entries.  Assumes that admin is the funding_account.
+# Emits an encoded transaction that reveals block entries.  Assumes that admin is the funding_account.  If the block
+# has a reveal Merkle root, REVEAL_MERKLE_FILE must be set to the file that the root was computed from (see
+# reveal_merkle.sh), and the proof of the revealed entries is included.  The level 0 metadata of each entry, with its
+# proof, is taken from the file named by the entry index in LEVEL_METADATA_DIR (see level_merkle.sh), or is all
+# zeroes if LEVEL_METADATA_DIR is not set.  Each entry adds about 360 bytes to the transaction, so at most two entries
+# can be revealed at a time.
 
 function require ()
 {
@@ -91,9 +96,16 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
                                  [ u8 9                                                                               \
                                    $BID_MARKER_TOKEN_PUBKEY ]"
 
-# Compose entry salt and accounts
+# Prints the bytes given in hex as solxact u8 values
+function hex_to_u8_values ()
+{
+    echo $1 | xxd -r -p | od -An -tu1 -v | tr -d '\n' | tr -s '[:space:]'
+}
+
+# Compose entry salt, level metadata, and accounts
 ENTRY_ACCOUNTS=
 SALT_VALUES=
+LEVEL_VALUES=
 ENTRY_INDEX=$FIRST_ENTRY_INDEX
 while [ -n "$5" ]; do
     MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 5 $BLOCK_PUBKEY u16 $ENTRY_INDEX ]"
@@ -103,12 +115,35 @@ while [ -n "$5" ]; do
     
     ENTRY_ACCOUNTS="$ENTRY_ACCOUNTS account $ENTRY_PUBKEY w account $METADATA_PUBKEY w"
     SALT_VALUES="$SALT_VALUES $5"
+    # The LevelMetadataProof of level 0 of the entry: the LevelMetadata, a u8 count of hashes, and the hashes
+    if [ -n "$LEVEL_METADATA_DIR" ]; then
+        LEVELS_FILE=$LEVEL_METADATA_DIR/$ENTRY_INDEX
+    else
+        LEVELS_FILE=none
+    fi
+    LEVEL_PROOF=`$(dirname $0)/level_merkle.sh proof $LEVELS_FILE 0`
+    LEVEL_VALUES="$LEVEL_VALUES u8 $(hex_to_u8_values `$(dirname $0)/level_merkle.sh level $LEVELS_FILE 0`)"
+    LEVEL_VALUES="$LEVEL_VALUES u8 `echo $LEVEL_PROOF | wc -w`"
+    for HASH in $LEVEL_PROOF; do
+        LEVEL_VALUES="$LEVEL_VALUES u8 $(hex_to_u8_values $HASH)"
+    done
     shift
     ENTRY_INDEX=$(($ENTRY_INDEX+1))
 done
 
 require $SALT_VALUES
 
+# The proof of the range of revealed entries, as a u8 count of hashes followed by the bytes of the hashes
+PROOF_VALUES=
+if [ -n "$REVEAL_MERKLE_FILE" ]; then
+    ENTRY_COUNT=$(($ENTRY_INDEX-$FIRST_ENTRY_INDEX))
+    PROOF=`$(dirname $0)/reveal_merkle.sh proof $REVEAL_MERKLE_FILE $FIRST_ENTRY_INDEX $ENTRY_COUNT`
+    PROOF_VALUES="u8 `echo $PROOF | wc -w`"
+    for HASH in $PROOF; do
+        PROOF_VALUES="$PROOF_VALUES $(hex_to_u8_values $HASH)"
+    done
+fi
+
 solxact encode                                                                                                        \
         encoding c                                                                                                    \
         fee_payer $ADMIN_PUBKEY                                                                                       \
@@ -123,4 +158,6 @@ solxact encode
         // Instruction code 5 = RevealEntriesData //                                                                  \
         u8 5                                                                                                          \
         u16 $FIRST_ENTRY_INDEX                                                                                        \
-        u64 $SALT_VALUES
+        u64 $SALT_VALUES                                                                                              \
+        $LEVEL_VALUES                                                                                                 \
+        $PROOF_VALUES
@@ -0,0 +1,101 @@
+#!/bin/sh
+
+set -e
+
+# Emits an encoded transaction that performs a take commission/delegate action on many entries of a block.  Entries
+# are processed in order until the estimated compute units used would exceed COMPUTE_UNIT_BUDGET; the number of
+# entries processed is the return data of the transaction.  The program config account is supplied writable so that
+# the first such transaction of each epoch refreshes the values cached in it.
+
+function require ()
+{
+    if [ -z "$1" ]; then
+        cat <<EOF
+
+Usage: anyone_take_commission_or_delegate_many_tx.sh <FEE_PAYER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> \\
+                                                     <COMPUTE_UNIT_BUDGET> \\
+                                                     <ENTRY_INDEX> <ENTRY_STAKE_ACCOUNT_PUBKEY> \\
+                                                     [<ENTRY_INDEX> <ENTRY_STAKE_ACCOUNT_PUBKEY>...]
+
+EOF
+        exit 1
+    fi
+}
+
+FEE_PAYER_PUBKEY=$1
+GROUP_NUMBER=$2
+BLOCK_NUMBER=$3
+COMPUTE_UNIT_BUDGET=$4
+
+require $FEE_PAYER_PUBKEY
+require $GROUP_NUMBER
+require $BLOCK_NUMBER
+require $COMPUTE_UNIT_BUDGET
+require $5
+require $6
+
+# Compute program, block, entry, and related pubkeys.  These may not all be valid, depending on input parameters
+# to the script, but any that are invalid won't be used by the solxact encode command that follows.
+
+if [ -z "$SELF_PROGRAM_PUBKEY" ]; then
+        SELF_PROGRAM_PUBKEY="Shin1cdrR1pmemXZU3yDV3PnQ48SX9UmrtHF4GbKzWG"
+fi
+if [ -z $SHINOBI_SYSTEMS_VOTE_PUBKEY ]; then
+SHINOBI_SYSTEMS_VOTE_PUBKEY="BLADE1qNA1uNjRgER6DtUFf7FU3c1TWLLdpPeEcKatZ2"
+fi
+      SYSTEM_PROGRAM_PUBKEY="11111111111111111111111111111111"
+   SPL_TOKEN_PROGRAM_PUBKEY="TokenkegQfeZyiNwAJbNbGKPFXCWuBvf9Ss623VQ5DA"
+      SPLATA_PROGRAM_PUBKEY="ATokenGPvbdGVxr1b2hvZbsiqW5xWH25efTNsLJA8knL"
+       STAKE_PROGRAM_PUBKEY="Stake11111111111111111111111111111111111111"
+        CLOCK_SYSVAR_PUBKEY="SysvarC1ock11111111111111111111111111111111"
+         RENT_SYSVAR_PUBKEY="SysvarRent111111111111111111111111111111111"
+    METAPLEX_PROGRAM_PUBKEY="metaqbxxUerdq28cj1RbAWkYQm3ybzjb6a8bt518x1s"
+STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
+        STAKE_CONFIG_PUBKEY="StakeConfig11111111111111111111111111111111"
+              CONFIG_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 1 ]"
+           AUTHORITY_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 2 ]"
+        MASTER_STAKE_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 3 ]"
+             KI_MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 4 ]"
+     BID_MARKER_MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 11 ]"
+         KI_METADATA_PUBKEY="pda $METAPLEX_PROGRAM_PUBKEY                                                             \
+                                 [ string metadata                                                                    \
+                                   pubkey $METAPLEX_PROGRAM_PUBKEY                                                    \
+                                   $KI_MINT_PUBKEY ]"
+ BID_MARKER_METADATA_PUBKEY="pda $METAPLEX_PROGRAM_PUBKEY                                                             \
+                                 [ string metadata                                                                    \
+                                   pubkey $METAPLEX_PROGRAM_PUBKEY                                                    \
+                                   $BID_MARKER_MINT_PUBKEY ]"
+               BLOCK_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 14                                                                              \
+                                   u32 $GROUP_NUMBER                                                                  \
+                                   u32 $BLOCK_NUMBER ]"
+
+# Collect the (entry, stake, bridge) account triples
+ENTRY_ACCOUNTS=
+shift 4
+while [ -n "$1" ]; do
+    require $2
+    MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 5 $BLOCK_PUBKEY u16 $1 ]"
+    ENTRY_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 15 $MINT_PUBKEY ]"
+    BRIDGE_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 10 $MINT_PUBKEY ]"
+    ENTRY_ACCOUNTS="$ENTRY_ACCOUNTS account $ENTRY_PUBKEY w account $2 w account $BRIDGE_PUBKEY w"
+    shift 2
+done
+
+solxact encode                                                                                                        \
+        encoding c                                                                                                    \
+        fee_payer $FEE_PAYER_PUBKEY                                                                                   \
+        program $SELF_PROGRAM_PUBKEY                                                                                  \
+        account $FEE_PAYER_PUBKEY ws                                                                                  \
+        account $BLOCK_PUBKEY                                                                                         \
+        account $MASTER_STAKE_PUBKEY w                                                                                \
+        account $AUTHORITY_PUBKEY                                                                                     \
+        account $CLOCK_SYSVAR_PUBKEY                                                                                  \
+        account $SYSTEM_PROGRAM_PUBKEY                                                                                \
+        account $STAKE_PROGRAM_PUBKEY                                                                                 \
+        account $STAKE_HISTORY_SYSVAR_PUBKEY                                                                          \
+        account $CONFIG_PUBKEY w                                                                                      \
+        $ENTRY_ACCOUNTS                                                                                               \
+        // Instruction code 23 = TakeCommissionOrDelegateMany //                                                      \
+        u8 23                                                                                                         \
+        u32 $COMPUTE_UNIT_BUDGET
@@ -115,6 +115,7 @@ solxact encode
         account $SYSTEM_PROGRAM_PUBKEY                                                                                \
         account $STAKE_PROGRAM_PUBKEY                                                                                 \
         account $STAKE_HISTORY_SYSVAR_PUBKEY                                                                          \
+        account $CONFIG_PUBKEY                                                                                        \
         // Instruction code 19 = TakeCommissionOrDelegate //                                                          \
         u8 19                                                                                                         \
         u64 $MINIMUM_STAKE_LAMPORTS
@@ -0,0 +1,138 @@
+#!/bin/bash
+
+set -e
+
+# Computes the level metadata Merkle tree of an entry (see EntryMetadata.level_metadata_merkle_root in
+# program/inc/entry.h).  The levels are read from LEVELS_FILE, which has 9 lines, one per level in level order, each
+# giving the base64 encoded bytes of the LevelMetadata of that level.  LevelMetadata shorter than the full size of
+# LevelMetadata is padded with zeroes.  If LEVELS_FILE is "none", then all levels are all zeroes.
+#
+# "root" prints the Merkle root in hex, which is the level_metadata_merkle_root of the entry's metadata.
+#
+# "level" prints in hex the full LevelMetadata bytes of level LEVEL.
+#
+# "proof" prints the hashes in hex of the proof of level LEVEL, which are the proof of the LevelMetadataProof of the
+# RevealEntries (for level 0) or LevelUp instruction data that supplies that level.
+
+function usage_exit ()
+{
+    cat <<EOF
+
+Usage: level_merkle.sh root <LEVELS_FILE>
+       level_merkle.sh level <LEVELS_FILE> <LEVEL>
+       level_merkle.sh proof <LEVELS_FILE> <LEVEL>
+
+EOF
+    exit 1
+}
+
+COMMAND=$1
+LEVELS_FILE=$2
+LEVEL=$3
+
+case "$COMMAND" in
+    root)
+        if [ -z "$LEVELS_FILE" -o -n "$LEVEL" ]; then
+            usage_exit
+        fi
+        ;;
+    level|proof)
+        if [ -z "$LEVELS_FILE" -o -z "$LEVEL" -o -n "$4" ]; then
+            usage_exit
+        fi
+        if [ "$LEVEL" -lt 0 -o "$LEVEL" -gt 8 ]; then
+            usage_exit
+        fi
+        ;;
+    *)
+        usage_exit
+        ;;
+esac
+
+# Size of LevelMetadata
+LEVEL_METADATA_SIZE=156
+
+# Hex strings are compared bytewise, as memcmp would
+export LC_ALL=C
+
+# Prints the SHA-256 of the bytes given in hex
+function sha256_hex ()
+{
+    echo -n "$1" | xxd -r -p | sha256sum | cut -d ' ' -f 1
+}
+
+# Read the levels, as hex
+LEVELS=()
+
+if [ "$LEVELS_FILE" = "none" ]; then
+    for ((i = 0; i < 9; i++)); do
+        LEVELS+=("")
+    done
+else
+    while read LINE; do
+        LEVELS+=("`echo -n "$LINE" | base64 -d | xxd -p | tr -d '\n'`")
+    done < $LEVELS_FILE
+fi
+
+if [ ${#LEVELS[@]} -ne 9 ]; then
+    echo "$LEVELS_FILE does not have 9 levels" 1>&2
+    exit 1
+fi
+
+for ((i = 0; i < 9; i++)); do
+    if [ ${#LEVELS[$i]} -gt $((2 * $LEVEL_METADATA_SIZE)) ]; then
+        echo "LevelMetadata of level $i is larger than $LEVEL_METADATA_SIZE bytes" 1>&2
+        exit 1
+    fi
+    while [ ${#LEVELS[$i]} -lt $((2 * $LEVEL_METADATA_SIZE)) ]; do
+        LEVELS[$i]="${LEVELS[$i]}00"
+    done
+done
+
+if [ "$COMMAND" = "level" ]; then
+    echo ${LEVELS[$LEVEL]}
+    exit 0
+fi
+
+# Compute the leaves; each is the prefix byte 0, the level as a u8, and the LevelMetadata of the level
+HASHES=()
+
+for ((i = 0; i < 9; i++)); do
+    HASHES+=(`sha256_hex 00$(printf "%02x" $i)${LEVELS[$i]}`)
+done
+
+# Hash up the tree, collecting the proof of LEVEL along the way.  For each level of the tree, the sibling of the node
+# is in the proof, if it has one.  A node without a sibling is carried up to the next level unchanged.
+PROOF=
+COUNT=${#HASHES[@]}
+INDEX=$LEVEL
+
+while [ $COUNT -gt 1 ]; do
+    if [ "$COMMAND" = "proof" ]; then
+        if [ $(($INDEX & 1)) -eq 1 ]; then
+            PROOF="$PROOF ${HASHES[$(($INDEX - 1))]}"
+        elif [ $(($INDEX + 1)) -lt $COUNT ]; then
+            PROOF="$PROOF ${HASHES[$(($INDEX + 1))]}"
+        fi
+        INDEX=$(($INDEX / 2))
+    fi
+    # Interior nodes are the prefix byte 1 followed by the lesser and then the greater child
+    NEXT=()
+    for ((i = 0; i < $COUNT; i += 2)); do
+        if [ $(($i + 1)) -eq $COUNT ]; then
+            NEXT+=(${HASHES[$i]})
+        elif [[ "${HASHES[$i]}" < "${HASHES[$(($i + 1))]}" ]]; then
+            NEXT+=(`sha256_hex 01${HASHES[$i]}${HASHES[$(($i + 1))]}`)
+        else
+            NEXT+=(`sha256_hex 01${HASHES[$(($i + 1))]}${HASHES[$i]}`)
+        fi
+    done
+    HASHES=(${NEXT[@]})
+    COUNT=${#HASHES[@]}
+done
+
+if [ "$COMMAND" = "root" ]; then
+    echo ${HASHES[0]}
+else
+    echo $PROOF
+fi
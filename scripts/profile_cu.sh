@@ -0,0 +1,161 @@
+#!/bin/bash
+
+# Converts the logs of a transaction executed by a profiling build of the Shinobi Immortals program (built with
+# SHINOBI_PROFILE=1, see program/inc/profile.h) into a table of compute units consumed per phase.
+#
+# The logs are read from LOG_FILE, or from stdin if no LOG_FILE is given, in the format printed by
+# "solana confirm -v <TRANSACTION_SIGNATURE>" or by "solana logs".  If the transaction executed more than one
+# instruction of the program, the phases of all instructions are summed.
+
+function usage_exit ()
+{
+    echo "Usage: profile_cu.sh [-o MARKER_COST] [LOG_FILE]"
+    echo
+    echo "MARKER_COST is the compute units consumed by each profiling marker, which is subtracted from the phase"
+    echo "that contains the marker.  The default is 200 (two log syscalls)."
+    exit 1
+}
+
+MARKER_COST=200
+
+while [ -n "$1" ]; do
+    case "$1" in
+        -o)
+            shift
+            MARKER_COST=$1
+            if [ -z "$MARKER_COST" ]; then
+                usage_exit
+            fi
+            ;;
+        -*)
+            usage_exit
+            ;;
+        *)
+            if [ -n "$LOG_FILE" ]; then
+                usage_exit
+            fi
+            LOG_FILE=$1
+            ;;
+    esac
+    shift
+done
+
+awk -v marker_cost="$MARKER_COST" '
+# Attributes the compute units consumed since the last reading to the current phase
+function charge(remaining, is_marker,    units, path, i)
+{
+    units = last_remaining - remaining;
+    if (is_marker) {
+        units -= marker_cost;
+    }
+    if (units < 0) {
+        units = 0;
+    }
+
+    path = stack[1];
+    for (i = 2; i <= stack_len; i++) {
+        path = path " / " stack[i];
+    }
+    if (step[stack_len] != "") {
+        path = path " : " step[stack_len];
+    }
+
+    if (!(path in phase_units)) {
+        phase_order[++phase_count] = path;
+    }
+    phase_units[path] += units;
+
+    last_remaining = remaining;
+}
+
+# Processes the markers of one complete instruction once its starting and ending compute units are known
+function finish_instruction(start, end,    i, name)
+{
+    stack_len = 1;
+    stack[1] = "entrypoint";
+    step[1] = "";
+    last_remaining = start;
+
+    for (i = 1; i <= marker_count; i++) {
+        charge(marker_remaining[i], 1);
+        name = marker_name[i];
+        if (marker_op[i] == ">") {
+            stack[++stack_len] = name;
+            step[stack_len] = "";
+        }
+        else if (marker_op[i] == "<") {
+            if (stack_len > 1) {
+                stack_len--;
+            }
+        }
+        else {
+            step[stack_len] = name;
+        }
+    }
+
+    charge(end, 0);
+
+    total_units += start - end;
+    marker_count = 0;
+}
+
+{
+    sub(/^[ \t]+/, "");
+}
+
+/^Program [^ ]+ invoke \[[0-9]+\]/ {
+    depth = substr($4, 2, length($4) - 2) + 0;
+    if (depth == 1) {
+        marker_count = 0;
+        pending = 0;
+    }
+    next;
+}
+
+/^Program [^ ]+ (success|failed)/ {
+    depth--;
+    next;
+}
+
+/^Program log: PROFILE / {
+    pending_op = $4;
+    pending_name = "";
+    for (i = 5; i <= NF; i++) {
+        pending_name = pending_name (i > 5 ? " " : "") $i;
+    }
+    pending = 1;
+    next;
+}
+
+/^Program consumption: [0-9]+ units remaining/ {
+    if (pending) {
+        marker_count++;
+        marker_op[marker_count] = pending_op;
+        marker_name[marker_count] = pending_name;
+        marker_remaining[marker_count] = $3 + 0;
+        pending = 0;
+    }
+    next;
+}
+
+/^Program [^ ]+ consumed [0-9]+ of [0-9]+ compute units/ {
+    if ((depth == 1) && (marker_count > 0)) {
+        finish_instruction($6 + 0, ($6 + 0) - ($4 + 0));
+    }
+    next;
+}
+
+END {
+    if (phase_count == 0) {
+        print "No profiling markers found; was the program built with SHINOBI_PROFILE=1?" > "/dev/stderr";
+        exit 1;
+    }
+
+    printf "%-80s %8s %6s\n", "Phase", "Units", "%";
+    for (i = 1; i <= phase_count; i++) {
+        path = phase_order[i];
+        printf "%-80s %8d %6.1f\n", path, phase_units[path], (100.0 * phase_units[path]) / total_units;
+    }
+    printf "%-80s %8d\n", "Total (including profiling markers)", total_units;
+}
+' ${LOG_FILE:+"$LOG_FILE"}
@@ -0,0 +1,137 @@
+#!/bin/bash
+
+set -e
+
+# Computes the reveal Merkle tree of a block (see BlockConfiguration.reveal_merkle_root in program/inc/block.h).  The
+# entries are read from REVEAL_MERKLE_FILE, which has one line per entry of the block, in entry index order, giving
+# the SHA-256 in hex of the entry's metadata bytes and the entry's salt as a u64.
+#
+# "root" prints the Merkle root in hex, which is the reveal_merkle_root of the block configuration.
+#
+# "proof" prints the hashes in hex of the proof of the ENTRY_COUNT entries starting with entry FIRST_ENTRY_INDEX, which
+# are the proof of the RevealEntries instruction data that reveals those entries.
+
+function usage_exit ()
+{
+    cat <<EOF
+
+Usage: reveal_merkle.sh root <REVEAL_MERKLE_FILE>
+       reveal_merkle.sh proof <REVEAL_MERKLE_FILE> <FIRST_ENTRY_INDEX> <ENTRY_COUNT>
+
+EOF
+    exit 1
+}
+
+COMMAND=$1
+REVEAL_MERKLE_FILE=$2
+FIRST_ENTRY_INDEX=$3
+ENTRY_COUNT=$4
+
+case "$COMMAND" in
+    root)
+        if [ -z "$REVEAL_MERKLE_FILE" -o -n "$FIRST_ENTRY_INDEX" ]; then
+            usage_exit
+        fi
+        ;;
+    proof)
+        if [ -z "$REVEAL_MERKLE_FILE" -o -z "$FIRST_ENTRY_INDEX" -o -z "$ENTRY_COUNT" -o -n "$5" ]; then
+            usage_exit
+        fi
+        if [ "$ENTRY_COUNT" -lt 1 ]; then
+            usage_exit
+        fi
+        ;;
+    *)
+        usage_exit
+        ;;
+esac
+
+# Hex strings are compared bytewise, as memcmp would
+export LC_ALL=C
+
+# Prints the SHA-256 of the bytes given in hex
+function sha256_hex ()
+{
+    echo -n "$1" | xxd -r -p | sha256sum | cut -d ' ' -f 1
+}
+
+# Prints a number as little endian hex of the given number of bytes
+function le_hex ()
+{
+    local i VALUE=$1
+
+    for ((i = 0; i < $2; i++)); do
+        printf "%02x" $(($VALUE & 255))
+        VALUE=$(($VALUE >> 8))
+    done
+}
+
+# Compute the leaves
+HASHES=()
+
+while read METADATA_SHA256 SALT; do
+    if [ -z "$METADATA_SHA256" ]; then
+        continue
+    fi
+    if [ ${#METADATA_SHA256} -ne 64 -o -z "$SALT" ]; then
+        echo "Invalid entry line: $METADATA_SHA256 $SALT" 1>&2
+        exit 1
+    fi
+    # The leaf is the prefix byte 0, the entry index as a little endian u16, the SHA-256 of the entry's metadata, and
+    # the salt as a little endian u64
+    LEAF_HEX=00`le_hex ${#HASHES[@]} 2`$METADATA_SHA256`le_hex $SALT 8`
+    HASHES+=(`sha256_hex $LEAF_HEX`)
+done < $REVEAL_MERKLE_FILE
+
+if [ ${#HASHES[@]} -eq 0 ]; then
+    echo "No entries" 1>&2
+    exit 1
+fi
+
+# Hash up the tree, collecting the proof of the range of entries from FIRST to LAST along the way.  For each level,
+# the sibling of the first node of the range is in the proof if it is outside of the range, followed by the sibling
+# of the last node of the range if it is outside of the range.  A node without a sibling is carried up to the next
+# level unchanged.
+PROOF=
+COUNT=${#HASHES[@]}
+
+if [ "$COMMAND" = "proof" ]; then
+    FIRST=$FIRST_ENTRY_INDEX
+    LAST=$(($FIRST_ENTRY_INDEX + $ENTRY_COUNT - 1))
+    if [ $LAST -ge $COUNT ]; then
+        echo "Entries $FIRST through $LAST are not all listed" 1>&2
+        exit 1
+    fi
+fi
+
+while [ $COUNT -gt 1 ]; do
+    if [ "$COMMAND" = "proof" ]; then
+        if [ $(($FIRST & 1)) -eq 1 ]; then
+            PROOF="$PROOF ${HASHES[$(($FIRST - 1))]}"
+        fi
+        if [ $(($LAST & 1)) -eq 0 -a $(($LAST + 1)) -lt $COUNT ]; then
+            PROOF="$PROOF ${HASHES[$(($LAST + 1))]}"
+        fi
+        FIRST=$(($FIRST / 2))
+        LAST=$(($LAST / 2))
+    fi
+    # Interior nodes are the prefix byte 1 followed by the lesser and then the greater child
+    NEXT=()
+    for ((i = 0; i < $COUNT; i += 2)); do
+        if [ $(($i + 1)) -eq $COUNT ]; then
+            NEXT+=(${HASHES[$i]})
+        elif [[ "${HASHES[$i]}" < "${HASHES[$(($i + 1))]}" ]]; then
+            NEXT+=(`sha256_hex 01${HASHES[$i]}${HASHES[$(($i + 1))]}`)
+        else
+            NEXT+=(`sha256_hex 01${HASHES[$(($i + 1))]}${HASHES[$i]}`)
+        fi
+    done
+    HASHES=(${NEXT[@]})
+    COUNT=${#HASHES[@]}
+done
+
+if [ "$COMMAND" = "root" ]; then
+    echo ${HASHES[0]}
+else
+    echo $PROOF
+fi
@@ -305,7 +305,15 @@ case $1 in
 
         ADMIN_PUBKEY=`get_data_pubkey 4 "$ACCOUNT_DATA"`
 
-        echo '{"config_account":"$CONFIG_PUBKEY","admin_pubkey":"$ADMIN_PUBKEY"}'
+        echo -n '{"config_account":"'$CONFIG_PUBKEY'","admin_pubkey":"'$ADMIN_PUBKEY'",'
+        echo -n '"cache":{'
+        echo -n '"epoch":'`get_data_u64 40 "$ACCOUNT_DATA"`','
+        echo -n '"minimum_stake_delegation":'`to_sol \`get_data_u64 48 "$ACCOUNT_DATA"\``','
+        echo -n '"rent_lamports_per_byte_year":'`get_data_u64 56 "$ACCOUNT_DATA"`','
+        echo -n '"rent_exemption_threshold_exponent":'`get_data_u16 64 "$ACCOUNT_DATA"`','
+        echo -n '"rent_exemption_threshold_fraction":'`get_data_u16 66 "$ACCOUNT_DATA"`'},'
+        echo -n '"commission_settlement_threshold":'`to_sol \`get_data_u64 72 "$ACCOUNT_DATA"\``
+        echo '}'
     ;;
 
     block)
@@ -327,8 +335,8 @@ case $1 in
 
         ACCOUNT_DATA_LEN=`echo "$ACCOUNT_DATA" | base64 -d | wc -c`
 
-        if [ $ACCOUNT_DATA_LEN -lt 120 ]; then
-            echo "Block account has invalid size $ACCOUNT_DATA_LEN, expected at least 120"
+        if [ $ACCOUNT_DATA_LEN -lt 570 ]; then
+            echo "Block account has invalid size $ACCOUNT_DATA_LEN, expected at least 570"
             exit 1
         fi
 
@@ -375,6 +383,8 @@ case $1 in
 
         echo -n '"has_auction":'$HAS_AUCTION','
 
+        echo -n '"escrow_bids":'`to_bool \`get_data_u8 49 "$ACCOUNT_DATA"\``','
+
         # Both the auction and final sale price have the same duration
         DURATION=`get_data_u32 52 "$ACCOUNT_DATA"`
 
@@ -390,11 +400,25 @@ case $1 in
         
         echo -n '"whitelist_duration_display":"'`to_duration $WHITELIST_DURATION`'"'
 
+        WHITELIST_SLOT_COUNT=`get_data_u16 68 "$ACCOUNT_DATA"`
+
+        if [ "0$WHITELIST_SLOT_COUNT" -ne 0 ]; then
+            echo -n ',"whitelist_slot_count":'$WHITELIST_SLOT_COUNT','
+
+            echo -n '"whitelist_merkle_root":"'`get_data_sha256 70 "$ACCOUNT_DATA"`'"'
+        fi
+
+        REVEAL_MERKLE_ROOT=`get_data_sha256 102 "$ACCOUNT_DATA"`
+
+        if [ "$REVEAL_MERKLE_ROOT" != "0000000000000000000000000000000000000000000000000000000000000000" ]; then
+            echo -n ',"reveal_merkle_root":"'$REVEAL_MERKLE_ROOT'"'
+        fi
+
         echo -n '},'
 
-        echo -n '"added_entries_count":'`get_data_u16 72 "$ACCOUNT_DATA"`','
+        echo -n '"added_entries_count":'`get_data_u16 136 "$ACCOUNT_DATA"`','
 
-        BLOCK_START_TIMESTAMP=`get_data_u64 80 "$ACCOUNT_DATA"`
+        BLOCK_START_TIMESTAMP=`get_data_u64 144 "$ACCOUNT_DATA"`
 
         echo -n '"block_start_timestamp":'$BLOCK_START_TIMESTAMP','
 
@@ -404,9 +428,9 @@ case $1 in
 
         if [ "0$MYSTERY_COUNT" -ne 0 ]; then
         
-            echo -n '"mysteries_sold_count":'`get_data_u16 88 "$ACCOUNT_DATA"`','
+            echo -n '"mysteries_sold_count":'`get_data_u16 152 "$ACCOUNT_DATA"`','
 
-            TIMESTAMP=`get_data_u64 96 "$ACCOUNT_DATA"`
+            TIMESTAMP=`get_data_u64 160 "$ACCOUNT_DATA"`
 
             echo -n '"mystery_phase_end_timestamp":'$TIMESTAMP','
 
@@ -421,14 +445,25 @@ case $1 in
             echo -n '"auction_end_timestamp_display":"'`to_timestamp $TIMESTAMP_SECONDS`'",'
         fi
 
-        echo -n '"commission":'`to_commission \`get_data_u16 104 "$ACCOUNT_DATA"\``','
+        echo -n '"commission":'`to_commission \`get_data_u16 168 "$ACCOUNT_DATA"\``','
+
+        echo -n '"last_commission_change_epoch":'`get_data_u64 176 "$ACCOUNT_DATA"`','
+
+        echo -n '"uri_prefixes":['
 
-        echo -n '"last_commission_change_epoch":'`get_data_u64 112 "$ACCOUNT_DATA"`','
+        for i in `seq 0 3`; do
+            echo -n '"'`get_data_string $(($i*96+186)) 96 "$ACCOUNT_DATA"`'"'
+            if [ $i -lt 3 ]; then
+                echo -n ','
+            fi
+        done
+
+        echo -n '],'
 
         echo -n '"entries_added":['
 
         # Skip to the entries added bitmap
-        BITMAP_BYTES=`echo "$ACCOUNT_DATA" | base64 -d | dd bs=1 skip=120 status=none | od -An -tu1 -v`
+        BITMAP_BYTES=`echo "$ACCOUNT_DATA" | base64 -d | dd bs=1 skip=570 status=none | od -An -tu1 -v`
 
         N=0
         COMMA=
@@ -461,7 +496,13 @@ case $1 in
             N=$(($N+8))
         done
 
-        echo ']}'
+        echo -n ']'
+
+        if [ "0$WHITELIST_SLOT_COUNT" -ne 0 ]; then
+            echo -n ',"whitelist_claimed_count":'`get_data_u16 184 "$ACCOUNT_DATA"`
+        fi
+
+        echo '}'
     ;;
 
     entry)
@@ -487,8 +528,8 @@ case $1 in
 
         ACCOUNT_DATA_LEN=`echo "$ACCOUNT_DATA" | base64 -d | wc -c`
 
-        if [ $ACCOUNT_DATA_LEN -ne 3032 ]; then
-            echo "Block account has invalid size $ACCOUNT_DATA_LEN, expected 3032"
+        if [ $ACCOUNT_DATA_LEN -ne 488 ]; then
+            echo "Block account has invalid size $ACCOUNT_DATA_LEN, expected 488"
             exit 1
         fi
 
@@ -519,6 +560,10 @@ case $1 in
 
         echo -n '"has_auction":'`to_bool \`get_data_u8 152 "$ACCOUNT_DATA"\``','
 
+        ESCROW_BIDS=`to_bool \`get_data_u8 153 "$ACCOUNT_DATA"\``
+
+        echo -n '"escrow_bids":'$ESCROW_BIDS','
+
         echo -n '"duration":'`get_data_u32 156 "$ACCOUNT_DATA"`','
 
         echo -n '"non_auction_start_price":'`to_sol \`get_data_u64 160 "$ACCOUNT_DATA"\``','
@@ -546,7 +591,11 @@ case $1 in
         PUBKEY=`get_data_pubkey 232 "$ACCOUNT_DATA"`
 
         if [ "$PUBKEY" != "11111111111111111111111111111111" ]; then
-            echo -n ',"winning_bid_pubkey":'`get_data_pubkey 232 "$ACCOUNT_DATA"`
+            if [ "$ESCROW_BIDS" = "true" ]; then
+                echo -n ',"winning_bidder_pubkey":"'$PUBKEY'"'
+            else
+                echo -n ',"winning_bid_pubkey":'`get_data_pubkey 232 "$ACCOUNT_DATA"`
+            fi
         fi
 
         echo -n '},"owned":{'
@@ -563,46 +612,43 @@ case $1 in
 
         echo -n '"last_harvest_ki_stake":'`to_sol \`get_data_u64 312 "$ACCOUNT_DATA"\``','
 
-        echo -n '"last_commission_charge_stake":'`to_sol \`get_data_u64 320 "$ACCOUNT_DATA"\``
+        echo -n '"last_commission_charge_stake":'`to_sol \`get_data_u64 320 "$ACCOUNT_DATA"\``','
+
+        echo -n '"accrued_commission":'`to_sol \`get_data_u64 328 "$ACCOUNT_DATA"\``
 
         echo -n '},'
 
-        echo -n '"level":'`get_data_u8 328 "$ACCOUNT_DATA"`','
+        echo -n '"level":'`get_data_u8 336 "$ACCOUNT_DATA"`','
 
         echo -n '"metadata":{'
 
-        echo -n '"level_1_ki":'`get_data_u32 332 "$ACCOUNT_DATA"`','
+        echo -n '"level_1_ki":'`get_data_u32 340 "$ACCOUNT_DATA"`','
 
         echo -n '"random":['
 
         for i in `seq 1 15`; do
-            echo -n `get_data_u32 $(($i*4+336)) "$ACCOUNT_DATA"`','
+            echo -n `get_data_u32 $(($i*4+344)) "$ACCOUNT_DATA"`','
         done
 
-        echo -n `get_data_u32 396 "$ACCOUNT_DATA"`'],"level_metadata":['
-
-        for i in `seq 0 8`; do
-            OFFSET=$(($i*292+400))
-            echo -n '{"form":'`get_data_u32 $(($OFFSET+0)) "$ACCOUNT_DATA"`','
+        echo -n `get_data_u32 404 "$ACCOUNT_DATA"`'],'
 
-            echo -n '"skill":'`get_data_u8 $(($OFFSET+4)) "$ACCOUNT_DATA"`','
+        echo -n '"level_metadata_merkle_root":"'`get_data_sha256 408 "$ACCOUNT_DATA"`'"},'
 
-            echo -n '"ki_factor":'`get_data_u32 $(($OFFSET+8)) "$ACCOUNT_DATA"`','
+        echo -n '"current_level":{'
 
-            echo -n '"name":"'`get_data_string $(($OFFSET+12)) 48 "$ACCOUNT_DATA"`'",'
+        echo -n '"form":'`get_data_u32 440 "$ACCOUNT_DATA"`','
 
-            echo -n '"uri":"'`get_data_string $(($OFFSET+60)) 200 "$ACCOUNT_DATA"`'",'
+        echo -n '"skill":'`get_data_u8 444 "$ACCOUNT_DATA"`','
 
-            echo -n '"uri_contents_sha256":"'`get_data_sha256 $(($OFFSET+260)) "$ACCOUNT_DATA"`'"'
+        echo -n '"ki_factor":'`get_data_u32 448 "$ACCOUNT_DATA"`'}'
 
-            echo -n '}'
+        PUBKEY=`get_data_pubkey 456 "$ACCOUNT_DATA"`
 
-            if [ $i -lt 8 ]; then
-                echo -n ','
-            fi
-        done            
+        if [ "$PUBKEY" != "11111111111111111111111111111111" ]; then
+            echo -n ',"second_metaplex_metadata_creator":"'$PUBKEY'"'
+        fi
 
-        echo ']}}'
+        echo '}'
 
     ;;
 
@@ -633,7 +679,7 @@ case $1 in
 
         ACCOUNT_DATA_LEN=`echo "$ACCOUNT_DATA" | base64 -d | wc -c`
 
-        if [ "0$ACCOUNT_DATA_LEN" -ne 68 ]; then
+        if [ "0$ACCOUNT_DATA_LEN" -ne 72 ]; then
             echo "Bid account has invalid size $ACCOUNT_DATA_LEN"
             exit 1
         fi
@@ -680,8 +726,8 @@ case $1 in
 
         ACCOUNT_DATA_LEN=`echo "$ACCOUNT_DATA" | base64 -d | wc -c`
 
-        if [ $ACCOUNT_DATA_LEN -ne 9608 ]; then
-            echo "Whitelist account has invalid size $ACCOUNT_DATA_LEN, expected 9608"
+        if [ $ACCOUNT_DATA_LEN -ne 44 ]; then
+            echo "Whitelist account has invalid size $ACCOUNT_DATA_LEN, expected 44"
             exit 1
         fi
 
@@ -692,12 +738,9 @@ case $1 in
             exit 1
         fi
 
-        LIST_COUNT=`get_data_u16 4 "$ACCOUNT_DATA"`
+        LIST_COUNT=`get_data_u32 4 "$ACCOUNT_DATA"`
 
-        if [ "0$LIST_COUNT" -eq 0 -o "0$LIST_COUNT" -gt 300 ]; then
-            echo "Invalid list count: $LIST_COUNT"
-            exit 1
-        fi
+        SHARD_MASK=`get_data_u16 40 "$ACCOUNT_DATA"`
 
         echo -n '{'
 
@@ -705,15 +748,59 @@ case $1 in
         
         echo -n '"whitelist_pubkey":"'$WHITELIST_PUBKEY'",'
 
-        echo -n '"whitelisted_pubkeys":['
+        echo -n '"count":'$LIST_COUNT','
+
+        # The whitelisted pubkeys of all shards, in shard order
+        WHITELISTED_PUBKEYS=
+
+        echo -n '"shards":['
+
+        FIRST_SHARD=1
+        for SHARD_INDEX in `seq 0 15`; do
+            if [ $(($SHARD_MASK & (1 << $SHARD_INDEX))) -eq 0 ]; then
+                continue
+            fi
+
+            SHARD_PUBKEY=`pda $PROGRAM_PUBKEY [ u8 17 pubkey $BLOCK_PUBKEY u8 $SHARD_INDEX ]`
+
+            SHARD_DATA=`get_account_data $RPC_URL $SHARD_PUBKEY`
+
+            if [ -z "$SHARD_DATA" ]; then
+                echo "Whitelist shard account $SHARD_INDEX does not exist"
+                exit 1
+            fi
+
+            DATA_TYPE=`get_data_u32 0 "$SHARD_DATA"`
+
+            if [ "0$DATA_TYPE" -ne 6 ]; then
+                echo "Invalid whitelist shard $SHARD_INDEX data type: $DATA_TYPE"
+                exit 1
+            fi
+
+            SHARD_COUNT=`get_data_u16 38 "$SHARD_DATA"`
 
-        for i in `seq 1 $LIST_COUNT`; do
-            if [ $i -gt 1 ]; then
+            if [ $FIRST_SHARD -eq 0 ]; then
                 echo -n ","
             fi
-            echo -n '"'`get_data_pubkey $((32*$i-26)) "$ACCOUNT_DATA"`'"'
+            FIRST_SHARD=0
+
+            echo -n '{"index":'$SHARD_INDEX','
+
+            echo -n '"pubkey":"'$SHARD_PUBKEY'",'
+
+            echo -n '"count":'$SHARD_COUNT'}'
+
+            for i in `seq 1 $SHARD_COUNT`; do
+                if [ -n "$WHITELISTED_PUBKEYS" ]; then
+                    WHITELISTED_PUBKEYS="$WHITELISTED_PUBKEYS,"
+                fi
+                WHITELISTED_PUBKEYS="$WHITELISTED_PUBKEYS\"`get_data_pubkey $((32*$i+8)) "$SHARD_DATA"`\""
+            done
         done
 
+        echo -n '],'
+
+        echo -n '"whitelisted_pubkeys":['$WHITELISTED_PUBKEYS
         echo -n ']}'
     ;;
 
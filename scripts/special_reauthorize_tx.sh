@@ -14,6 +14,8 @@ Usage: special_reauthorize_tx.sh <FEE_PAYER_PUBKEY> <ADMIN_PUBKEY> <USER_PUBKEY>
 
 If <TOKEN_PUBKEY> is not provided, it is assumed to be the Associated Token Account.
 If the entry is not staked, then any key can be passed in for <ENTRY_STAKE_ACCOUNT_PUBKEY>, it will be ignored.
+If the entry is staked, then all of its accrued commission is settled first, with <FEE_PAYER_PUBKEY> funding the
+temporary bridge stake account.
 
 EOF
         exit 1
@@ -102,6 +104,9 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
                  BID_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
                                  [ u8 9                                                                               \
                                    $BID_MARKER_TOKEN_PUBKEY ]"
+              BRIDGE_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 10                                                                              \
+                                   $ENTRY_MINT_PUBKEY ]"
 if [ -z "$TOKEN_PUBKEY" ]; then 
                TOKEN_PUBKEY="pda $SPLATA_PROGRAM_PUBKEY                                                               \
                                  [ pubkey $USER_PUBKEY                                                                \
@@ -124,6 +129,12 @@ solxact encode
         account $CLOCK_SYSVAR_PUBKEY                                                                                  \
         account $METAPLEX_PROGRAM_PUBKEY                                                                              \
         account $STAKE_PROGRAM_PUBKEY                                                                                 \
+        account $BLOCK_PUBKEY                                                                                         \
+        account $FEE_PAYER_PUBKEY ws                                                                                  \
+        account $MASTER_STAKE_PUBKEY w                                                                                \
+        account $BRIDGE_PUBKEY w                                                                                      \
+        account $SYSTEM_PROGRAM_PUBKEY                                                                                \
+        account $STAKE_HISTORY_SYSVAR_PUBKEY                                                                          \
         // Instruction code 20 = Reauthorize //                                                                       \
         u8 20                                                                                                         \
         pubkey $NEW_AUTHORITY_PUBKEY
@@ -2,7 +2,8 @@
 
 set -e
 
-# Emits an encoded transaction that bids on an entry.
+# Emits an encoded transaction that bids on an entry.  If PREVIOUS_BIDDER_PUBKEY is given, it is the bidder of the
+# entry's winning bid, which is outbid, and is refunded by the bid so that it does not have to be claimed.
 
 function require ()
 {
@@ -10,7 +11,7 @@ function require ()
         cat <<EOF
 
 Usage: user_bid_tx.sh <USER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX> <MINIMUM_BID_LAMPORTS> \\
-                      <MAXIMUM_BID_LAMPORTS>
+                      <MAXIMUM_BID_LAMPORTS> [PREVIOUS_BIDDER_PUBKEY]
 
 EOF
         exit 1
@@ -23,6 +24,7 @@ BLOCK_NUMBER=$3
 ENTRY_INDEX=$4
 MINIMUM_BID_LAMPORTS=$5
 MAXIMUM_BID_LAMPORTS=$6
+PREVIOUS_BIDDER_PUBKEY=$7
 
 require $USER_PUBKEY
 require $GROUP_NUMBER
@@ -94,7 +96,26 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
                  BID_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
                                  [ u8 9                                                                               \
                                    $BID_MARKER_TOKEN_PUBKEY ]"
-                 
+
+# The program is given the bump seeds of the bid marker token and bid addresses so that it does not have to search for
+# them
+BID_MARKER_TOKEN_BUMP_SEED=`solxact $BID_MARKER_TOKEN_PUBKEY | cut -d . -f 2`
+BID_BUMP_SEED=`solxact $BID_PUBKEY | cut -d . -f 2`
+
+if [ -n "$PREVIOUS_BIDDER_PUBKEY" ]; then
+    PREVIOUS_BID_MARKER_TOKEN_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                        \
+                                          [ u8 12                                                                     \
+                                            $ENTRY_MINT_PUBKEY                                                        \
+                                            pubkey $PREVIOUS_BIDDER_PUBKEY ]"
+    PREVIOUS_BID_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                     \
+                             [ u8 9                                                                                   \
+                               $PREVIOUS_BID_MARKER_TOKEN_PUBKEY ]"
+    EXTRA_ACCOUNTS="account $PREVIOUS_BID_PUBKEY w                                                                    \
+                    account $PREVIOUS_BIDDER_PUBKEY w"
+else
+    EXTRA_ACCOUNTS=
+fi
+
 solxact encode                                                                                                        \
         encoding c                                                                                                    \
         fee_payer $USER_PUBKEY                                                                                        \
@@ -108,7 +129,10 @@ solxact encode
         account $SYSTEM_PROGRAM_PUBKEY                                                                                \
         account $SELF_PROGRAM_PUBKEY                                                                                  \
         account $SPL_TOKEN_PROGRAM_PUBKEY                                                                             \
+        $EXTRA_ACCOUNTS                                                                                               \
         // Instruction code 12 = Bid //                                                                               \
         u8 12                                                                                                         \
+        u8 $BID_MARKER_TOKEN_BUMP_SEED                                                                                \
+        u8 $BID_BUMP_SEED                                                                                             \
         u64 $MINIMUM_BID_LAMPORTS                                                                                     \
         u64 $MAXIMUM_BID_LAMPORTS
@@ -0,0 +1,165 @@
+#!/bin/sh
+
+set -e
+
+# Emits an encoded transaction that buys an already revealed entry and stakes it to a stake account, in a single
+# instruction.  Assumes that the user is the funding account.  The stake account withdrawal authority must be the user
+# pubkey.  If the block has a Merkle whitelist, WHITELIST_FILE must be the file that the block was created from (see
+# whitelist_merkle.sh), and the proof that the user is in it is included in the transaction.
+
+function require ()
+{
+    if [ -z "$1" ]; then
+        cat <<EOF
+
+Usage: user_buy_and_stake_tx.sh <ADMIN_PUBKEY> <USER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX> \\
+                                <MAX_LAMPORTS> <STAKE_ACCOUNT_PUBKEY> [WHITELIST_FILE]
+
+EOF
+        exit 1
+    fi
+}
+
+ADMIN_PUBKEY=$1
+USER_PUBKEY=$2
+GROUP_NUMBER=$3
+BLOCK_NUMBER=$4
+ENTRY_INDEX=$5
+MAX_LAMPORTS=$6
+STAKE_ACCOUNT_PUBKEY=$7
+WHITELIST_FILE=$8
+
+require $ADMIN_PUBKEY
+require $USER_PUBKEY
+require $GROUP_NUMBER
+require $BLOCK_NUMBER
+require $ENTRY_INDEX
+require $MAX_LAMPORTS
+require $STAKE_ACCOUNT_PUBKEY
+
+# Compute program, block, entry, and related pubkeys.  These may not all be valid, depending on input parameters
+# to the script, but any that are invalid won't be used by the solxact encode command that follows.
+
+if [ -z "$SELF_PROGRAM_PUBKEY" ]; then
+        SELF_PROGRAM_PUBKEY="Shin1cdrR1pmemXZU3yDV3PnQ48SX9UmrtHF4GbKzWG"
+fi
+if [ -z $SHINOBI_SYSTEMS_VOTE_PUBKEY ]; then
+SHINOBI_SYSTEMS_VOTE_PUBKEY="BLADE1qNA1uNjRgER6DtUFf7FU3c1TWLLdpPeEcKatZ2"
+fi
+      SYSTEM_PROGRAM_PUBKEY="11111111111111111111111111111111"
+   SPL_TOKEN_PROGRAM_PUBKEY="TokenkegQfeZyiNwAJbNbGKPFXCWuBvf9Ss623VQ5DA"
+      SPLATA_PROGRAM_PUBKEY="ATokenGPvbdGVxr1b2hvZbsiqW5xWH25efTNsLJA8knL"
+       STAKE_PROGRAM_PUBKEY="Stake11111111111111111111111111111111111111"
+        CLOCK_SYSVAR_PUBKEY="SysvarC1ock11111111111111111111111111111111"
+         RENT_SYSVAR_PUBKEY="SysvarRent111111111111111111111111111111111"
+    METAPLEX_PROGRAM_PUBKEY="metaqbxxUerdq28cj1RbAWkYQm3ybzjb6a8bt518x1s"
+STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
+        STAKE_CONFIG_PUBKEY="StakeConfig11111111111111111111111111111111"
+              CONFIG_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 1 ]"
+           AUTHORITY_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 2 ]"
+        MASTER_STAKE_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 3 ]"
+             KI_MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 4 ]"
+     BID_MARKER_MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 11 ]"
+         KI_METADATA_PUBKEY="pda $METAPLEX_PROGRAM_PUBKEY                                                             \
+                                 [ string metadata                                                                    \
+                                   pubkey $METAPLEX_PROGRAM_PUBKEY                                                    \
+                                   $KI_MINT_PUBKEY ]"
+ BID_MARKER_METADATA_PUBKEY="pda $METAPLEX_PROGRAM_PUBKEY                                                             \
+                                 [ string metadata                                                                    \
+                                   pubkey $METAPLEX_PROGRAM_PUBKEY                                                    \
+                                   $BID_MARKER_MINT_PUBKEY ]"
+               BLOCK_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 14                                                                              \
+                                   u32 $GROUP_NUMBER                                                                  \
+                                   u32 $BLOCK_NUMBER ]"
+           WHITELIST_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 13                                                                              \
+                                   $BLOCK_PUBKEY ]"
+     WHITELIST_SHARD_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 17                                                                              \
+                                   $BLOCK_PUBKEY                                                                      \
+                                   u8 `$(dirname $0)/whitelist_shard_index.sh $USER_PUBKEY` ]"
+          ENTRY_MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 5                                                                               \
+                                   $BLOCK_PUBKEY                                                                      \
+                                   u16 $ENTRY_INDEX ]"
+               ENTRY_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 15                                                                              \
+                                   $ENTRY_MINT_PUBKEY ]"
+         ENTRY_TOKEN_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 6                                                                               \
+                                   $ENTRY_MINT_PUBKEY ]"
+      ENTRY_METADATA_PUBKEY="pda $METAPLEX_PROGRAM_PUBKEY                                                             \
+                                 [ string metadata                                                                    \
+                                   pubkey $METAPLEX_PROGRAM_PUBKEY                                                    \
+                                   $ENTRY_MINT_PUBKEY ]"
+   TOKEN_DESTINATION_PUBKEY="pda $SPLATA_PROGRAM_PUBKEY                                                               \
+                                 [ pubkey $USER_PUBKEY                                                                \
+                                   pubkey $SPL_TOKEN_PROGRAM_PUBKEY                                                   \
+                                   $ENTRY_MINT_PUBKEY ]"
+    BID_MARKER_TOKEN_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 12                                                                              \
+                                   $ENTRY_MINT_PUBKEY                                                                 \
+                                   pubkey $USER_PUBKEY ]"
+                 BID_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 9                                                                               \
+                                   $BID_MARKER_TOKEN_PUBKEY ]"
+
+# With a Merkle whitelist, the whitelist accounts are not used, so the block account is supplied in place of the
+# whitelist account and the optional whitelist shard account is left off, and the instruction data carries the first
+# slot, allowance, and proof of the user's whitelist leaf
+WHITELIST_SHARD_ACCOUNT="account $WHITELIST_SHARD_PUBKEY w"
+WHITELIST_FIRST_SLOT=0
+WHITELIST_ALLOWANCE=0
+WHITELIST_PROOF_LENGTH=0
+WHITELIST_PROOF=
+
+if [ -n "$WHITELIST_FILE" ]; then
+    WHITELIST_PUBKEY=$BLOCK_PUBKEY
+    WHITELIST_SHARD_ACCOUNT=
+    set -- `$(dirname $0)/whitelist_merkle.sh proof $WHITELIST_FILE $USER_PUBKEY`
+    WHITELIST_FIRST_SLOT=$1
+    WHITELIST_ALLOWANCE=$2
+    shift 2
+    WHITELIST_PROOF_LENGTH=$#
+    if [ $# -gt 0 ]; then
+        WHITELIST_PROOF="u8 $(echo $@ | tr -d ' ' | xxd -r -p | od -An -tu1 -v | tr -d '\n' | tr -s '[:space:]')"
+    fi
+fi
+
+solxact encode                                                                                                        \
+        encoding c                                                                                                    \
+        fee_payer $USER_PUBKEY                                                                                        \
+        program $SELF_PROGRAM_PUBKEY                                                                                  \
+        account $USER_PUBKEY ws                                                                                       \
+        account $CONFIG_PUBKEY                                                                                        \
+        account $ADMIN_PUBKEY w                                                                                       \
+        account $AUTHORITY_PUBKEY w                                                                                   \
+        account $BLOCK_PUBKEY w                                                                                       \
+        account $WHITELIST_PUBKEY w                                                                                   \
+        account $ENTRY_PUBKEY w                                                                                       \
+        account $ENTRY_TOKEN_PUBKEY w                                                                                 \
+        account $ENTRY_MINT_PUBKEY                                                                                    \
+        account $TOKEN_DESTINATION_PUBKEY w                                                                           \
+        account $USER_PUBKEY                                                                                          \
+        account $ENTRY_METADATA_PUBKEY w                                                                              \
+        account $SELF_PROGRAM_PUBKEY                                                                                  \
+        account $SPL_TOKEN_PROGRAM_PUBKEY                                                                             \
+        account $SPLATA_PROGRAM_PUBKEY                                                                                \
+        account $METAPLEX_PROGRAM_PUBKEY                                                                              \
+        account $SYSTEM_PROGRAM_PUBKEY                                                                                \
+        account $STAKE_ACCOUNT_PUBKEY w                                                                               \
+        account $USER_PUBKEY s                                                                                        \
+        account $SHINOBI_SYSTEMS_VOTE_PUBKEY                                                                          \
+        account $CLOCK_SYSVAR_PUBKEY                                                                                  \
+        account $STAKE_PROGRAM_PUBKEY                                                                                 \
+        account $STAKE_CONFIG_PUBKEY                                                                                  \
+        account $STAKE_HISTORY_SYSVAR_PUBKEY                                                                          \
+        $WHITELIST_SHARD_ACCOUNT                                                                                      \
+        // Instruction code 26 = BuyAndStake //                                                                       \
+        u8 26                                                                                                         \
+        u64 $MAX_LAMPORTS                                                                                             \
+        u16 $WHITELIST_FIRST_SLOT                                                                                     \
+        u8 $WHITELIST_ALLOWANCE                                                                                       \
+        u8 $WHITELIST_PROOF_LENGTH                                                                                    \
+        $WHITELIST_PROOF
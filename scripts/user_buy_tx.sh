@@ -2,14 +2,17 @@
 
 set -e
 
-# Emits an encoded transaction that buys an entry.  Assumes that the user is the funding account.
+# Emits an encoded transaction that buys an entry.  Assumes that the user is the funding account.  If the block has a
+# Merkle whitelist, WHITELIST_FILE must be the file that the block was created from (see whitelist_merkle.sh), and the
+# proof that the user is in it is included in the transaction.
 
 function require ()
 {
     if [ -z "$1" ]; then
         cat <<EOF
 
-Usage: user_buy_tx.sh <ADMIN_PUBKEY> <USER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX> <MAX_LAMPORTS>
+Usage: user_buy_tx.sh <ADMIN_PUBKEY> <USER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX> <MAX_LAMPORTS> \\
+                      [WHITELIST_FILE]
 
 EOF
         exit 1
@@ -22,6 +25,7 @@ GROUP_NUMBER=$3
 BLOCK_NUMBER=$4
 ENTRY_INDEX=$5
 MAX_LAMPORTS=$6
+WHITELIST_FILE=$7
 
 require $ADMIN_PUBKEY
 require $USER_PUBKEY
@@ -68,6 +72,10 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
            WHITELIST_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
                                  [ u8 13                                                                              \
                                    $BLOCK_PUBKEY ]"
+     WHITELIST_SHARD_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
+                                 [ u8 17                                                                              \
+                                   $BLOCK_PUBKEY                                                                      \
+                                   u8 `$(dirname $0)/whitelist_shard_index.sh $USER_PUBKEY` ]"
           ENTRY_MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
                                  [ u8 5                                                                               \
                                    $BLOCK_PUBKEY                                                                      \
@@ -94,6 +102,28 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
                                  [ u8 9                                                                               \
                                    $BID_MARKER_TOKEN_PUBKEY ]"
 
+# With a Merkle whitelist, the whitelist accounts are not used, so the block account is supplied in place of the
+# whitelist account and the optional whitelist shard account is left off, and the instruction data carries the first
+# slot, allowance, and proof of the user's whitelist leaf
+WHITELIST_SHARD_ACCOUNT="account $WHITELIST_SHARD_PUBKEY w"
+WHITELIST_FIRST_SLOT=0
+WHITELIST_ALLOWANCE=0
+WHITELIST_PROOF_LENGTH=0
+WHITELIST_PROOF=
+
+if [ -n "$WHITELIST_FILE" ]; then
+    WHITELIST_PUBKEY=$BLOCK_PUBKEY
+    WHITELIST_SHARD_ACCOUNT=
+    set -- `$(dirname $0)/whitelist_merkle.sh proof $WHITELIST_FILE $USER_PUBKEY`
+    WHITELIST_FIRST_SLOT=$1
+    WHITELIST_ALLOWANCE=$2
+    shift 2
+    WHITELIST_PROOF_LENGTH=$#
+    if [ $# -gt 0 ]; then
+        WHITELIST_PROOF="u8 $(echo $@ | tr -d ' ' | xxd -r -p | od -An -tu1 -v | tr -d '\n' | tr -s '[:space:]')"
+    fi
+fi
+
 solxact encode                                                                                                        \
         encoding c                                                                                                    \
         fee_payer $USER_PUBKEY                                                                                        \
@@ -115,6 +145,11 @@ solxact encode
         account $SPLATA_PROGRAM_PUBKEY                                                                                \
         account $METAPLEX_PROGRAM_PUBKEY                                                                              \
         account $SYSTEM_PROGRAM_PUBKEY                                                                                \
+        $WHITELIST_SHARD_ACCOUNT                                                                                      \
         // Instruction code 10 = Buy //                                                                               \
         u8 10                                                                                                         \
-        u64 $MAX_LAMPORTS
+        u64 $MAX_LAMPORTS                                                                                             \
+        u16 $WHITELIST_FIRST_SLOT                                                                                     \
+        u8 $WHITELIST_ALLOWANCE                                                                                       \
+        u8 $WHITELIST_PROOF_LENGTH                                                                                    \
+        $WHITELIST_PROOF
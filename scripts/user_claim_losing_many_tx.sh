@@ -0,0 +1,85 @@
+#!/bin/sh
+
+set -e
+
+# Emits an encoded transaction that claims many losing bids of a user at once, reclaiming all of their bid marker
+# tokens.
+
+function require ()
+{
+    if [ -z "$1" ]; then
+        cat <<EOF
+
+Usage: user_claim_losing_many_tx.sh <USER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX> \\
+                                     [<GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX>...]
+
+EOF
+        exit 1
+    fi
+}
+
+USER_PUBKEY=$1
+
+require $USER_PUBKEY
+require $2
+require $3
+require $4
+
+# Compute program, block, entry, and related pubkeys.  These may not all be valid, depending on input parameters
+# to the script, but any that are invalid won't be used by the solxact encode command that follows.
+
+if [ -z "$SELF_PROGRAM_PUBKEY" ]; then
+        SELF_PROGRAM_PUBKEY="Shin1cdrR1pmemXZU3yDV3PnQ48SX9UmrtHF4GbKzWG"
+fi
+if [ -z $SHINOBI_SYSTEMS_VOTE_PUBKEY ]; then
+SHINOBI_SYSTEMS_VOTE_PUBKEY="BLADE1qNA1uNjRgER6DtUFf7FU3c1TWLLdpPeEcKatZ2"
+fi
+      SYSTEM_PROGRAM_PUBKEY="11111111111111111111111111111111"
+   SPL_TOKEN_PROGRAM_PUBKEY="TokenkegQfeZyiNwAJbNbGKPFXCWuBvf9Ss623VQ5DA"
+      SPLATA_PROGRAM_PUBKEY="ATokenGPvbdGVxr1b2hvZbsiqW5xWH25efTNsLJA8knL"
+       STAKE_PROGRAM_PUBKEY="Stake11111111111111111111111111111111111111"
+        CLOCK_SYSVAR_PUBKEY="SysvarC1ock11111111111111111111111111111111"
+         RENT_SYSVAR_PUBKEY="SysvarRent111111111111111111111111111111111"
+    METAPLEX_PROGRAM_PUBKEY="metaqbxxUerdq28cj1RbAWkYQm3ybzjb6a8bt518x1s"
+STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
+        STAKE_CONFIG_PUBKEY="StakeConfig11111111111111111111111111111111"
+              CONFIG_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 1 ]"
+           AUTHORITY_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 2 ]"
+        MASTER_STAKE_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 3 ]"
+             KI_MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 4 ]"
+     BID_MARKER_MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 11 ]"
+         KI_METADATA_PUBKEY="pda $METAPLEX_PROGRAM_PUBKEY                                                             \
+                                 [ string metadata                                                                    \
+                                   pubkey $METAPLEX_PROGRAM_PUBKEY                                                    \
+                                   $KI_MINT_PUBKEY ]"
+ BID_MARKER_METADATA_PUBKEY="pda $METAPLEX_PROGRAM_PUBKEY                                                             \
+                                 [ string metadata                                                                    \
+                                   pubkey $METAPLEX_PROGRAM_PUBKEY                                                    \
+                                   $BID_MARKER_MINT_PUBKEY ]"
+
+# Collect the (entry, bid, bid marker token) account triples
+ENTRY_ACCOUNTS=
+shift 1
+while [ -n "$1" ]; do
+    require $2
+    require $3
+    BLOCK_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 14 u32 $1 u32 $2 ]"
+    MINT_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 5 $BLOCK_PUBKEY u16 $3 ]"
+    ENTRY_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 15 $MINT_PUBKEY ]"
+    BID_MARKER_TOKEN_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 12 $MINT_PUBKEY pubkey $USER_PUBKEY ]"
+    BID_PUBKEY="pda $SELF_PROGRAM_PUBKEY [ u8 9 $BID_MARKER_TOKEN_PUBKEY ]"
+    ENTRY_ACCOUNTS="$ENTRY_ACCOUNTS account $ENTRY_PUBKEY account $BID_PUBKEY w account $BID_MARKER_TOKEN_PUBKEY w"
+    shift 3
+done
+
+solxact encode                                                                                                        \
+        encoding c                                                                                                    \
+        fee_payer $USER_PUBKEY                                                                                        \
+        program $SELF_PROGRAM_PUBKEY                                                                                  \
+        account $USER_PUBKEY ws                                                                                       \
+        account $BID_MARKER_MINT_PUBKEY w                                                                             \
+        account $AUTHORITY_PUBKEY                                                                                     \
+        account $SPL_TOKEN_PROGRAM_PUBKEY                                                                             \
+        $ENTRY_ACCOUNTS                                                                                               \
+        // Instruction code 29 = ClaimLosingMany //                                                                   \
+        u8 29
@@ -9,9 +9,11 @@ function require ()
     if [ -z "$1" ]; then
         cat <<EOF
 
-Usage: user_claim_winning_tx.sh <ADMIN_PUBKEY> <USER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX> [true]
+Usage: user_claim_winning_tx.sh <ADMIN_PUBKEY> <USER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX> \\
+                               [true|escrow]
 
-If true is supplied as the last argument, then the bid marker will be reclaimed.
+If true is supplied as the last argument, then the bid marker will be reclaimed.  If escrow is supplied as the last
+argument, then the entry escrows its bids, and is itself supplied as the bid account.
 
 EOF
         exit 1
@@ -23,10 +25,12 @@ USER_PUBKEY=$2
 GROUP_NUMBER=$3
 BLOCK_NUMBER=$4
 ENTRY_INDEX=$5
+RECLAIM_BID_MARKER=false
+ESCROW_BIDS=false
 if [ "$6" = "true" ]; then
     RECLAIM_BID_MARKER=true
-else
-    RECLAIM_BID_MARKER=false
+elif [ "$6" = "escrow" ]; then
+    ESCROW_BIDS=true
 fi
 
 require $ADMIN_PUBKEY
@@ -98,6 +102,11 @@ STAKE_HISTORY_SYSVAR_PUBKEY="SysvarStakeHistory1111111111111111111111111"
                  BID_PUBKEY="pda $SELF_PROGRAM_PUBKEY                                                                 \
                                  [ u8 9                                                                               \
                                    $BID_MARKER_TOKEN_PUBKEY ]"
+
+# An entry that escrows its bids holds the winning bid itself
+if [ $ESCROW_BIDS = true ]; then
+    BID_PUBKEY=$ENTRY_PUBKEY
+fi
    
 if [ $RECLAIM_BID_MARKER = true ]; then
     EXTRA_ACCOUNTS="account $BID_MARKER_MINT_PUBKEY w                                                                 \
@@ -137,6 +137,7 @@ solxact encode
         account $STAKE_HISTORY_SYSVAR_PUBKEY                                                                          \
         account $SPL_TOKEN_PROGRAM_PUBKEY                                                                             \
         account $SPLATA_PROGRAM_PUBKEY                                                                                \
+        account $CONFIG_PUBKEY                                                                                        \
         // Instruction code 16 = Destake //                                                                           \
         u8 16                                                                                                         \
         u64 $MINIMUM_STAKE_LAMPORTS
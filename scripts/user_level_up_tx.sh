@@ -2,14 +2,17 @@
 
 set -e
 
-# Emits an encoded transaction that performs an entry level up.
+# Emits an encoded transaction that performs an entry level up to LEVEL, which must be the level after the entry's
+# current level, unless LEVEL_UP_TO is set, in which case LEVEL is sent as the target level and may be any level above
+# the entry's current level.  The metadata of that level, with its proof, is taken from the file named by the entry
+# index in LEVEL_METADATA_DIR (see level_merkle.sh), or is all zeroes if LEVEL_METADATA_DIR is not set.
 
 function require ()
 {
     if [ -z "$1" ]; then
         cat <<EOF
 
-Usage: user_level_up_tx.sh <USER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX> [<TOKEN_PUBKEY>]
+Usage: user_level_up_tx.sh <USER_PUBKEY> <GROUP_NUMBER> <BLOCK_NUMBER> <ENTRY_INDEX> <LEVEL> [<TOKEN_PUBKEY>]
 
 If <TOKEN_PUBKEY> is not provided, it is assumed to be the Associated Token Account.
 
@@ -22,12 +25,14 @@ USER_PUBKEY=$1
 GROUP_NUMBER=$2
 BLOCK_NUMBER=$3
 ENTRY_INDEX=$4
-TOKEN_PUBKEY=$5
+LEVEL=$5
+TOKEN_PUBKEY=$6
 
 require $USER_PUBKEY
 require $GROUP_NUMBER
 require $BLOCK_NUMBER
 require $ENTRY_INDEX
+require $LEVEL
 
 # Compute program, block, entry, and related pubkeys.  These may not all be valid, depending on input parameters
 # to the script, but any that are invalid won't be used by the solxact encode command that follows.
@@ -102,7 +107,31 @@ if [ -z "$TOKEN_PUBKEY" ]; then
                                    pubkey $SPL_TOKEN_PROGRAM_PUBKEY                                                   \
                                    $ENTRY_MINT_PUBKEY ]"
 fi
-                                  
+
+# Prints the bytes given in hex as solxact u8 values
+function hex_to_u8_values ()
+{
+    echo $1 | xxd -r -p | od -An -tu1 -v | tr -d '\n' | tr -s '[:space:]'
+}
+
+# The LevelMetadataProof of the level: the LevelMetadata, a u8 count of hashes, and the hashes
+if [ -n "$LEVEL_METADATA_DIR" ]; then
+    LEVELS_FILE=$LEVEL_METADATA_DIR/$ENTRY_INDEX
+else
+    LEVELS_FILE=none
+fi
+if [ -n "$LEVEL_UP_TO" ]; then
+    TARGET_LEVEL=$LEVEL
+else
+    TARGET_LEVEL=0
+fi
+LEVEL_PROOF=`$(dirname $0)/level_merkle.sh proof $LEVELS_FILE $LEVEL`
+LEVEL_VALUES="u8 $(hex_to_u8_values `$(dirname $0)/level_merkle.sh level $LEVELS_FILE $LEVEL`)"
+LEVEL_VALUES="$LEVEL_VALUES u8 `echo $LEVEL_PROOF | wc -w`"
+for HASH in $LEVEL_PROOF; do
+    LEVEL_VALUES="$LEVEL_VALUES u8 $(hex_to_u8_values $HASH)"
+done
+
 solxact encode                                                                                                        \
         encoding c                                                                                                    \
         fee_payer $USER_PUBKEY                                                                                        \
@@ -117,5 +146,11 @@ solxact encode
         account $AUTHORITY_PUBKEY                                                                                     \
         account $SPL_TOKEN_PROGRAM_PUBKEY                                                                             \
         account $METAPLEX_PROGRAM_PUBKEY                                                                              \
+        account $BLOCK_PUBKEY                                                                                         \
         // Instruction code 18 = LevelUp //                                                                           \
-        u8 18
+        u8 18                                                                                                         \
+        // Target level, 0 meaning the level after the current level of the entry //                                  \
+        u8 $TARGET_LEVEL                                                                                              \
+        // Padding that aligns the LevelMetadataProof //                                                              \
+        u8 0 0                                                                                                        \
+        $LEVEL_VALUES
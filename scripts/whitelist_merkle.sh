@@ -0,0 +1,155 @@
+#!/bin/bash
+
+set -e
+
+# Computes the Merkle tree of a Merkle whitelist (see program/inc/whitelist.h).  The whitelist is read from
+# WHITELIST_FILE, which has one line per whitelisted system account, giving its pubkey and optionally the number of
+# purchases it is allowed (which defaults to 1).  Slots are assigned to the lines in order.
+#
+# "root" prints the whitelist slot count and the Merkle root in hex, which are the whitelist_slot_count and
+# whitelist_merkle_root of the block configuration.
+#
+# "proof" prints the first slot and allowance of the first line for PUBKEY, followed by the hashes of its proof in
+# hex, which are the whitelist values of the Buy instruction data.
+
+function usage_exit ()
+{
+    cat <<EOF
+
+Usage: whitelist_merkle.sh root <WHITELIST_FILE>
+       whitelist_merkle.sh proof <WHITELIST_FILE> <PUBKEY>
+
+EOF
+    exit 1
+}
+
+COMMAND=$1
+WHITELIST_FILE=$2
+PUBKEY=$3
+
+case "$COMMAND" in
+    root)
+        if [ -z "$WHITELIST_FILE" -o -n "$PUBKEY" ]; then
+            usage_exit
+        fi
+        ;;
+    proof)
+        if [ -z "$WHITELIST_FILE" -o -z "$PUBKEY" -o -n "$4" ]; then
+            usage_exit
+        fi
+        ;;
+    *)
+        usage_exit
+        ;;
+esac
+
+# Hex strings are compared bytewise, as memcmp would
+export LC_ALL=C
+
+BASE58_CHARS=123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz
+
+# Prints the 32 bytes of a base58 pubkey in hex
+function pubkey_hex ()
+{
+    local BYTES=(0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0)
+    local i j PREFIX CARRY
+
+    for ((i = 0; i < ${#1}; i++)); do
+        PREFIX=${BASE58_CHARS%%${1:$i:1}*}
+        if [ ${#PREFIX} -eq ${#BASE58_CHARS} ]; then
+            echo "Invalid pubkey: $1" 1>&2
+            exit 1
+        fi
+        CARRY=${#PREFIX}
+        for ((j = 31; j >= 0; j--)); do
+            CARRY=$((${BYTES[$j]} * 58 + $CARRY))
+            BYTES[$j]=$(($CARRY & 255))
+            CARRY=$(($CARRY >> 8))
+        done
+    done
+
+    printf "%02x" ${BYTES[@]}
+}
+
+# Prints the SHA-256 of the bytes given in hex
+function sha256_hex ()
+{
+    echo -n "$1" | xxd -r -p | sha256sum | cut -d ' ' -f 1
+}
+
+# Compute the leaves
+HASHES=()
+SLOT=0
+INDEX=
+
+while read LINE_PUBKEY ALLOWANCE; do
+    if [ -z "$LINE_PUBKEY" ]; then
+        continue
+    fi
+    if [ -z "$ALLOWANCE" ]; then
+        ALLOWANCE=1
+    fi
+    if [ "$ALLOWANCE" -lt 1 -o "$ALLOWANCE" -gt 255 ]; then
+        echo "Invalid allowance for $LINE_PUBKEY: $ALLOWANCE" 1>&2
+        exit 1
+    fi
+    if [ -z "$INDEX" -a "$LINE_PUBKEY" = "$PUBKEY" ]; then
+        INDEX=${#HASHES[@]}
+        FIRST_SLOT=$SLOT
+        PUBKEY_ALLOWANCE=$ALLOWANCE
+    fi
+    # The leaf is the prefix byte 0, the pubkey, the first slot as a little endian u16, and the allowance as a u8
+    LEAF_HEX=`pubkey_hex $LINE_PUBKEY`
+    LEAF_HEX=00$LEAF_HEX`printf "%02x%02x%02x" $(($SLOT & 255)) $(($SLOT >> 8)) $ALLOWANCE`
+    HASHES+=(`sha256_hex $LEAF_HEX`)
+    SLOT=$(($SLOT + $ALLOWANCE))
+done < $WHITELIST_FILE
+
+if [ ${#HASHES[@]} -eq 0 ]; then
+    echo "Empty whitelist" 1>&2
+    exit 1
+fi
+
+if [ $SLOT -gt 65535 ]; then
+    echo "Too many whitelist slots: $SLOT" 1>&2
+    exit 1
+fi
+
+if [ "$COMMAND" = "proof" -a -z "$INDEX" ]; then
+    echo "$PUBKEY is not in the whitelist" 1>&2
+    exit 1
+fi
+
+# Hash up the tree, collecting the proof of the leaf at INDEX along the way.  A node without a sibling is carried up
+# to the next level unchanged.
+PROOF=
+COUNT=${#HASHES[@]}
+
+while [ $COUNT -gt 1 ]; do
+    if [ -n "$INDEX" ]; then
+        SIBLING=$(($INDEX ^ 1))
+        if [ $SIBLING -lt $COUNT ]; then
+            PROOF="$PROOF ${HASHES[$SIBLING]}"
+        fi
+        INDEX=$(($INDEX / 2))
+    fi
+    # Interior nodes are the prefix byte 1 followed by the lesser and then the greater child
+    NEXT=()
+    for ((i = 0; i < $COUNT; i += 2)); do
+        if [ $(($i + 1)) -eq $COUNT ]; then
+            NEXT+=(${HASHES[$i]})
+        elif [[ "${HASHES[$i]}" < "${HASHES[$(($i + 1))]}" ]]; then
+            NEXT+=(`sha256_hex 01${HASHES[$i]}${HASHES[$(($i + 1))]}`)
+        else
+            NEXT+=(`sha256_hex 01${HASHES[$(($i + 1))]}${HASHES[$i]}`)
+        fi
+    done
+    HASHES=(${NEXT[@]})
+    COUNT=${#HASHES[@]}
+done
+
+if [ "$COMMAND" = "root" ]; then
+    echo $SLOT ${HASHES[0]}
+else
+    echo $FIRST_SLOT $PUBKEY_ALLOWANCE$PROOF
+fi
@@ -0,0 +1,36 @@
+#!/bin/bash
+
+set -e
+
+# Prints the index of the whitelist shard that holds a pubkey, which is the high 4 bits of the first byte of the
+# pubkey (see whitelist_shard_index() in program/util/util_whitelist.c).
+
+if [ -z "$1" -o -n "$2" ]; then
+    cat <<EOF
+
+Usage: whitelist_shard_index.sh <PUBKEY>
+
+EOF
+    exit 1
+fi
+
+BASE58_CHARS=123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz
+
+# Decode the base58 pubkey into its 32 bytes, most significant first
+BYTES=(0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0)
+
+for ((i = 0; i < ${#1}; i++)); do
+    PREFIX=${BASE58_CHARS%%${1:$i:1}*}
+    if [ ${#PREFIX} -eq ${#BASE58_CHARS} ]; then
+        echo "Invalid pubkey: $1"
+        exit 1
+    fi
+    CARRY=${#PREFIX}
+    for ((j = 31; j >= 0; j--)); do
+        CARRY=$((${BYTES[$j]} * 58 + $CARRY))
+        BYTES[$j]=$(($CARRY & 255))
+        CARRY=$(($CARRY >> 8))
+    done
+done
+
+echo $((${BYTES[0]} >> 4))
@@ -30,6 +30,8 @@ source $SOURCE/test/test_admin_add_entries_to_block
 
 source $SOURCE/test/test_admin_set_metadata_bytes
 
+source $SOURCE/test/test_admin_set_metadata_bytes_many
+
 source $SOURCE/test/test_admin_reveal_entries
 
 source $SOURCE/test/test_admin_set_block_commission
@@ -46,20 +48,36 @@ source $SOURCE/test/test_user_refund
 
 source $SOURCE/test/test_user_bid
 
+source $SOURCE/test/test_user_escrowed_bid
+
 source $SOURCE/test/test_user_claim_losing
 
+source $SOURCE/test/test_user_claim_losing_many
+
 source $SOURCE/test/test_user_claim_winning
 
 source $SOURCE/test/test_user_stake
 
+source $SOURCE/test/test_user_buy_and_stake
+
+source $SOURCE/test/test_user_claim_winning_and_stake
+
 source $SOURCE/test/test_user_destake
 
 source $SOURCE/test/test_user_harvest
 
+source $SOURCE/test/test_user_harvest_many
+
 source $SOURCE/test/test_user_level_up
 
 source $SOURCE/test/test_anyone_take_commission_or_delegate
 
+source $SOURCE/test/test_anyone_take_commission_or_delegate_many
+
+source $SOURCE/test/test_anyone_refresh_cache
+
+source $SOURCE/test/test_admin_set_settlement_threshold
+
 source $SOURCE/test/test_special_reauthorize
 
 teardown